@@ -0,0 +1,177 @@
+//
+// Host test bench for the flash response cache.
+//
+// GETs a small set of URLs from the loopback httpbin server over and over,
+// first with no cache and then through an HttpCache in a file-backed block
+// device (an image file standing in for the board's flash), and compares
+// the time per request and the body bytes that crossed the link.  Every
+// body must match what the server sends.  Then the board "reboots": a new
+// HttpCache on the same image has to find the entries again and answer
+// from them straight away.
+//
+//   make bench-http-cache CACHE_REQUESTS=200
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mbed.h"
+#include "easy-connect.h"
+#include "FileBlockDevice.h"
+#include "http-cache.h"
+#include "http-client.h"
+
+#define CACHE_SLOTS     4
+
+// hello.txt and a body near a slot's capacity are cached; the 8 KB one is
+// too big for a slot and always comes over the link.
+static const char *const urls[] = {
+    "http://httpbin.org/media/uploads/mbed_official/hello.txt",
+    "http://httpbin.org/range/3000",
+    "http://httpbin.org/range/8192",
+};
+#define URL_COUNT       (sizeof(urls) / sizeof(urls[0]))
+
+struct Run {
+    uint32_t requests;
+    uint32_t failures;
+    uint32_t from_cache;
+    uint32_t link_bytes;    // body bytes received over the link
+    double seconds;
+};
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// What the server sends for url.
+//
+// Checks a body against what the server sends for url as it streams past:
+// the 8 KB one is more than a response stores.
+//
+class BodyCheck : public HttpBodySink {
+public:
+    BodyCheck(const char *url) : _length(0), _ok(true) {
+        const char *range = strstr(url, "/range/");
+        _range = range != NULL;
+        _expected = _range ? atol(range + 7) : strlen(HELLO);
+    }
+
+    virtual int write(const void *data, size_t size) {
+        const char *body = static_cast<const char *>(data);
+        for (size_t ix = 0; ix < size && _ok; ix++, _length++) {
+            char expected = _range ? (char)('a' + _length % 26) : HELLO[_length];
+            _ok = _length < _expected && body[ix] == expected;
+        }
+        return 0;
+    }
+
+    bool ok() const { return _ok && _length == _expected; }
+
+private:
+    static const char HELLO[];
+
+    size_t _length;
+    size_t _expected;
+    bool _range;
+    bool _ok;
+};
+
+const char BodyCheck::HELLO[] = "Hello world!\n";
+
+static void fetch(HttpTransport *transport, uint32_t requests, Run *run)
+{
+    memset(run, 0, sizeof(*run));
+    double start = now_s();
+    for (uint32_t ix = 0; ix < requests; ix++) {
+        const char *url = urls[ix % URL_COUNT];
+        BodyCheck check(url);
+        HttpClientRequest *request = new HttpClientRequest(transport, HTTP_GET, url, &check);
+        HttpClientResponse *response = request->send();
+        run->requests++;
+        if (!response || response->get_status_code() != 200 || !check.ok()) {
+            run->failures++;
+        } else if (response->is_from_cache()) {
+            run->from_cache++;
+        } else {
+            run->link_bytes += response->get_body_length();
+        }
+        delete request;
+    }
+    run->seconds = now_s() - start;
+}
+
+static void report(const char *what, const Run &run)
+{
+    printf("  %-16s %6.2f ms/request, %5lu of %lu from flash, %8lu body bytes over the link, %lu failed\n",
+           what, run.seconds * 1000 / run.requests, (unsigned long)run.from_cache, (unsigned long)run.requests,
+           (unsigned long)run.link_bytes, (unsigned long)run.failures);
+}
+
+static void report_cache(const HttpCache &cache)
+{
+    const HttpCache::Stats &stats = cache.stats();
+    printf("  cache: %lu entries, %lu hits, %lu misses, %lu stores, %lu evictions, %lu uncacheable, "
+           "%lu bytes saved\n", (unsigned long)cache.entries(), (unsigned long)stats.hits,
+           (unsigned long)stats.misses, (unsigned long)stats.stores, (unsigned long)stats.evictions,
+           (unsigned long)stats.uncacheable, (unsigned long)stats.bytes_saved);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t requests = argc > 1 ? atol(argv[1]) : 200;
+    const char *image = argc > 2 ? argv[2] : "http-cache.img";
+
+    NetworkInterface *net = easy_connect();
+    TCPTransport transport(net, "httpbin.org", 80);
+    FileBlockDevice bd(image, CACHE_SLOTS * MBED_CONF_APP_HTTP_CACHE_SLOT_SIZE);
+    if (bd.init() != 0) {
+        printf("cannot open %s\n", image);
+        return 1;
+    }
+    printf("%lu GETs over %u URLs, %u cache slots of %u bytes in %s\n", (unsigned long)requests,
+           (unsigned)URL_COUNT, CACHE_SLOTS, MBED_CONF_APP_HTTP_CACHE_SLOT_SIZE, image);
+
+    Run plain, cached, rebooted;
+    fetch(&transport, requests, &plain);
+    report("no cache:", plain);
+
+    HttpCache *cache = new HttpCache(&bd, 0, bd.size());
+    int ret = cache->init();
+    if (ret == 0) {
+        ret = cache->clear();
+    }
+    if (ret != 0) {
+        printf("cache init failed (error code %d)\n", ret);
+        return 1;
+    }
+    http_cache_enable(cache);
+    fetch(&transport, requests, &cached);
+    report("cache:", cached);
+    report_cache(*cache);
+    http_cache_enable(NULL);
+    delete cache;
+
+    // A new cache on the same image: the stored entries must still be there.
+    cache = new HttpCache(&bd, 0, bd.size());
+    ret = cache->init();
+    size_t found = cache->entries();
+    http_cache_enable(cache);
+    fetch(&transport, URL_COUNT, &rebooted);
+    report("after reboot:", rebooted);
+    report_cache(*cache);
+    http_cache_enable(NULL);
+    delete cache;
+
+    bd.deinit();
+    int failed = ret != 0 || plain.failures || cached.failures || rebooted.failures || found != 2 ||
+                 rebooted.from_cache != 2;
+    if (failed) {
+        printf("FAILED: %u entries found after reboot\n", (unsigned)found);
+    }
+    return failed;
+}
@@ -0,0 +1,96 @@
+//
+// Host benchmark for request/response body compression.
+//
+// Compresses JSON telemetry documents of a few sizes, like the bodies the
+// demos POST, with http_deflate() and inflates them again through an
+// InflateSink fed in receive-buffer sized pieces.  Reports the compression
+// ratio (the bytes the modem would no longer send) and the CPU time per KB
+// of plain text each way.  The output only uses the fixed Huffman codes, so
+// the inflate figures leave out building dynamic tables, which servers'
+// larger responses add once per block.
+//
+//   make bench-http-deflate DEFLATE_KB=4096
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mbed.h"
+#include "http-deflate.h"
+
+class NullSink : public HttpBodySink {
+public:
+    virtual int write(const void *data, size_t size) { (void)data; return size; }
+};
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// A batch of sensor readings, as a device would upload them.
+static size_t make_document(char *doc, size_t size)
+{
+    size_t length = snprintf(doc, size, "{\"device\":\"wnc14a2a-0042\",\"readings\":[");
+    for (int ix = 0; length + 96 < size; ix++) {
+        length += snprintf(doc + length, size - length,
+                           "{\"t\":%d,\"temp\":%d.%d,\"humidity\":%d,\"accel\":[%d,%d,%d]},",
+                           1514764800 + ix * 60, 20 + rand() % 5, rand() % 10, 40 + rand() % 20,
+                           rand() % 2000 - 1000, rand() % 2000 - 1000, 9810 + rand() % 50);
+    }
+    length += snprintf(doc + length - 1, size - length + 1, "]}") - 1;
+    return length;
+}
+
+int main(int argc, char **argv)
+{
+    long total_kb = argc > 1 ? atol(argv[1]) : 1024;
+    static const size_t sizes[] = { 256, 1024, 4096 };
+    static InflateSink inflater;
+    NullSink sink;
+
+    printf("%ld KB of JSON per size, inflate window %d bytes\n", total_kb, MBED_CONF_APP_HTTP_INFLATE_WINDOW);
+    printf("  %6s  %8s  %8s  %6s  %12s  %12s\n", "size", "gzip", "deflate", "saved", "compress", "inflate");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        char doc[4096];
+        uint8_t out[4096 + 64];
+        size_t length = make_document(doc, sizes[s]);
+        size_t gzip = http_deflate(HTTP_ENCODING_GZIP, doc, length, out, sizeof(out));
+        size_t zlib = http_deflate(HTTP_ENCODING_DEFLATE, doc, length, out, sizeof(out));
+        long rounds = total_kb * 1024 / length + 1;
+
+        // Best of three, so a busy machine does not inflate the figures.
+        double compress = 1e9, inflate = 1e9;
+        for (int pass = 0; pass < 3; pass++) {
+            double start = now_s();
+            for (long ix = 0; ix < rounds; ix++) {
+                http_deflate(HTTP_ENCODING_GZIP, doc, length, out, sizeof(out));
+            }
+            double took = now_s() - start;
+            compress = took < compress ? took : compress;
+
+            start = now_s();
+            for (long ix = 0; ix < rounds; ix++) {
+                inflater.reset(&sink, HTTP_ENCODING_GZIP);
+                for (size_t pos = 0; pos < gzip; pos += 1024) {
+                    inflater.write(out + pos, gzip - pos < 1024 ? gzip - pos : 1024);
+                }
+                inflater.finish(true);
+                if (!inflater.done() || inflater.output_length() != length) {
+                    printf("inflate failed at %u bytes\n", (unsigned)inflater.output_length());
+                    return 1;
+                }
+            }
+            took = now_s() - start;
+            inflate = took < inflate ? took : inflate;
+        }
+
+        double kb = rounds * (double)length / 1024;
+        printf("  %6u  %8u  %8u  %5.1f%%  %7.2f us/KB  %7.2f us/KB\n", (unsigned)length, (unsigned)gzip,
+               (unsigned)zlib, 100.0 * (length - gzip) / length, compress / kb * 1e6, inflate / kb * 1e6);
+    }
+    return 0;
+}
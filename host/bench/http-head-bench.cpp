@@ -0,0 +1,215 @@
+//
+// Host benchmark for request head templates.
+//
+// Sends the same JSON POST over an in-memory transport that answers with a
+// canned response, once with the head built from the URL and set_header()
+// and once from an HttpHeadTemplate, and reports requests per second, the
+// transport send() calls and heap allocations (operator new, counted here)
+// per request, and the head each way.  Then times the head alone: the
+// snprintf the client does without a template against http_head_render().
+//
+//   make bench-http-head REQUESTS=200000
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <new>
+#include "mbed.h"
+#include "http-client.h"
+#include "http-head-template.h"
+
+static unsigned long allocations;
+
+void *operator new(size_t size) throw(std::bad_alloc)
+{
+    allocations++;
+    void *p = malloc(size ? size : 1);
+    if (!p) {
+        abort();
+    }
+    return p;
+}
+
+void operator delete(void *p) throw()
+{
+    free(p);
+}
+
+static const HttpHeadTemplate post_json = HTTP_HEAD_TEMPLATE_WITH_BODY(
+    "POST", "/post", "httpbin.org", HTTP_HEADER_LINE("Content-Type", "application/json")
+                                    HTTP_HEADER_LINE("Accept", "application/json"));
+
+static const char body[] = "{\"sensor\":\"temp\",\"value\":21.5}";
+
+static const char response[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Server: bench\r\n"
+    "Content-Type: application/json\r\n"
+    "Content-Length: 64\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"
+    "{\"origin\":\"127.0.0.1\",\"url\":\"http://httpbin.org/get\",\"args\":{ }}";
+
+class CannedTransport : public HttpTransport {
+public:
+    CannedTransport() : sends(0), _connected(false), _pos(sizeof(response) - 1) { head[0] = '\0'; }
+
+    virtual nsapi_error_t connect() { _connected = true; return NSAPI_ERROR_OK; }
+    virtual nsapi_size_or_error_t send(const void *data, nsapi_size_t size)
+    {
+        // Keep the head of what went out, for the report.
+        const char *text = static_cast<const char *>(data);
+        size_t length = 0;
+        while (length + 4 <= size && memcmp(text + length, "\r\n\r\n", 4) != 0) {
+            length++;
+        }
+        if (length + 4 > size) {
+            length = 0;
+        }
+        if (length < sizeof(head)) {
+            memcpy(head, data, length);
+            head[length] = '\0';
+        }
+        sends++;
+        _pos = 0;       // a request went out: the response is ready
+        return size;
+    }
+    virtual nsapi_size_or_error_t recv(void *data, nsapi_size_t size)
+    {
+        size_t left = sizeof(response) - 1 - _pos;
+        if (size > left) {
+            size = left;
+        }
+        memcpy(data, response + _pos, size);
+        _pos += size;
+        return size;
+    }
+    virtual nsapi_error_t close() { _connected = false; return NSAPI_ERROR_OK; }
+    virtual bool connected() const { return _connected; }
+    virtual const char *host() const { return "httpbin.org"; }
+    virtual uint16_t port() const { return 80; }
+
+    unsigned long sends;
+    char head[256];
+
+private:
+    bool _connected;
+    size_t _pos;
+};
+
+class NullSink : public HttpBodySink {
+public:
+    virtual int write(const void *data, size_t size) { (void)data; return size; }
+};
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct Result {
+    double rate;
+    double sends;
+    double allocations;
+};
+
+// A fresh request each time, as an application would make them.
+static Result run(CannedTransport *transport, bool templated, long requests)
+{
+    NullSink sink;
+    unsigned long sends = transport->sends;
+    unsigned long allocs = allocations;
+    double start = now_s();
+    for (long ix = 0; ix < requests; ix++) {
+        HttpClientRequest *request = new HttpClientRequest(transport, HTTP_POST, "http://httpbin.org/post", &sink);
+        if (templated) {
+            request->set_head_template(&post_json);
+        } else {
+            request->set_header("Content-Type", "application/json");
+            request->set_header("Accept", "application/json");
+        }
+        if (!request->send(body, sizeof(body) - 1)) {
+            printf("request %ld failed: %d\n", ix, request->get_error());
+            exit(1);
+        }
+        delete request;
+    }
+    Result result;
+    result.rate = requests / (now_s() - start);
+    result.sends = (double)(transport->sends - sends) / requests;
+    result.allocations = (double)(allocations - allocs) / requests;
+    return result;
+}
+
+// What build_head() does without a template, for the same head.
+static size_t format_head(char *buffer, size_t size, uint32_t content_length)
+{
+    return snprintf(buffer, size, "%s %s HTTP/1.1\r\nHost: %s%s\r\n%s%sContent-Length: %u\r\n\r\n",
+                    "POST", "/post", "httpbin.org", "", "Content-Type: application/json\r\n",
+                    "Accept: application/json\r\n", (unsigned)content_length);
+}
+
+static void print_head(const char *what, const char *head)
+{
+    printf("  %s\n", what);
+    for (const char *line = head; *line; ) {
+        const char *end = strstr(line, "\r\n");
+        int length = end ? (int)(end - line) : (int)strlen(line);
+        printf("    |%.*s|\n", length, line);
+        line += length + (end ? 2 : 0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long requests = argc > 1 ? atol(argv[1]) : 200000;
+    CannedTransport transport;
+
+    run(&transport, false, requests / 10);     // warm up, and fill the pools
+    run(&transport, true, requests / 10);
+
+    // Alternate, keeping the best round of each, so drift in machine load
+    // hits both the same way.
+    Result built = { 0, 0, 0 }, templated = { 0, 0, 0 };
+    for (int round = 0; round < 8; round++) {
+        Result result = run(&transport, false, requests / 8);
+        if (result.rate > built.rate) {
+            built = result;
+        }
+        result = run(&transport, true, requests / 8);
+        if (result.rate > templated.rate) {
+            templated = result;
+        }
+    }
+
+    printf("%ld POSTs of %u bytes over an in-memory transport\n", requests, (unsigned)sizeof(body) - 1);
+    printf("  head from the URL:  %10.0f requests/s, %.2f sends and %.2f allocations per request\n",
+           built.rate, built.sends, built.allocations);
+    printf("  head from template: %10.0f requests/s, %.2f sends and %.2f allocations per request\n",
+           templated.rate, templated.sends, templated.allocations);
+
+    run(&transport, false, 1);
+    print_head("from the URL:", transport.head);
+    run(&transport, true, 1);
+    print_head("from the template:", transport.head);
+
+    // The head alone.
+    char buffer[256];
+    volatile size_t sink = 0;
+    long heads = requests * 10;
+    double start = now_s();
+    for (long ix = 0; ix < heads; ix++) {
+        sink += format_head(buffer, sizeof(buffer), ix & 0xffff);
+    }
+    double formatted = (now_s() - start) / heads * 1e9;
+    start = now_s();
+    for (long ix = 0; ix < heads; ix++) {
+        sink += http_head_render(&post_json, ix & 0xffff, buffer, sizeof(buffer));
+    }
+    double rendered = (now_s() - start) / heads * 1e9;
+    printf("  one head: snprintf %.0f ns, template %.0f ns\n", formatted, rendered);
+    return 0;
+}
@@ -0,0 +1,129 @@
+//
+// Host benchmark for the incremental JSON parser.
+//
+// Parses a body made of /stream/N style documents (httpbin's echo of the
+// request: url, args, headers, origin, id) followed by a device config with
+// a command list, fed in receive-buffer sized pieces, as a body callback
+// sees it.  Reports MB/s with every value reported to the handler, with
+// filters picking out three fields, and for a plain byte loop over the same
+// pieces as the ceiling.
+//
+//   make bench-json-stream JSON_MB=64
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mbed.h"
+#include "json-stream.h"
+
+#define CHUNK_SIZE      512
+
+class CountingHandler : public JsonHandler {
+public:
+    CountingHandler() : values(0), checksum(0) {}
+
+    virtual int value(const char *path, JsonType type, const char *text, size_t length)
+    {
+        (void)path;
+        values++;
+        checksum += type + length + (length ? (uint8_t)text[0] : 0);
+        return 0;
+    }
+
+    uint32_t values;
+    uint32_t checksum;
+};
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t make_body(char *body, size_t size)
+{
+    size_t length = 0;
+    for (int id = 0; length + 1024 < size / 2; id++) {
+        length += snprintf(body + length, size - length,
+                           "{\"url\": \"http://httpbin.org/stream/20\", \"args\": {}, "
+                           "\"headers\": {\"Host\": \"httpbin.org\", \"Connection\": \"keep-alive\", "
+                           "\"Accept-Encoding\": \"gzip, deflate\", \"User-Agent\": \"mbed-http/1.0 (WNC14A2A)\"}, "
+                           "\"origin\": \"10.192.220.207\", \"id\": %d}\n", id);
+    }
+    length += snprintf(body + length, size - length,
+                       "{\"config\": {\"interval\": 30, \"server\": \"https://telemetry.example.com/v1\", "
+                       "\"retry\": {\"min_ms\": 500, \"max_ms\": 60000, \"jitter\": 0.25}, \"debug\": false}, "
+                       "\"commands\": [");
+    for (int id = 0; length + 256 < size; id++) {
+        length += snprintf(body + length, size - length,
+                           "%s{\"id\": %d, \"name\": \"set-led\", \"args\": {\"color\": \"\\u00e9blue\", "
+                           "\"blink\": [100, 200, 1.5e2]}, \"ack\": true}", id ? ", " : "", id);
+    }
+    length += snprintf(body + length, size - length, "]}\n");
+    return length;
+}
+
+static volatile uint32_t sink;
+
+static double run(JsonStreamParser *parser, const char *body, size_t length, long rounds)
+{
+    double start = now_s();
+    for (long round = 0; round < rounds; round++) {
+        if (parser) {
+            parser->reset();
+        }
+        for (size_t pos = 0; pos < length; pos += CHUNK_SIZE) {
+            size_t size = length - pos < CHUNK_SIZE ? length - pos : CHUNK_SIZE;
+            if (parser) {
+                if (parser->write(body + pos, size) < 0) {
+                    printf("parse failed at byte %u: %d\n", (unsigned)parser->length(), parser->failure());
+                    exit(1);
+                }
+            } else {
+                uint32_t sum = sink;
+                for (size_t ix = 0; ix < size; ix++) {
+                    sum += (uint8_t)body[pos + ix] == '"';
+                }
+                sink = sum;
+            }
+        }
+        if (parser) {
+            parser->finish(true);
+            if (parser->failure()) {
+                printf("parse failed: %d\n", parser->failure());
+                exit(1);
+            }
+        }
+    }
+    return length * (double)rounds / (now_s() - start) / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    long megabytes = argc > 1 ? atol(argv[1]) : 64;
+    static char body[64 * 1024];
+    size_t length = make_body(body, sizeof(body));
+    long rounds = megabytes * 1000000 / length + 1;
+
+    static const char *const wanted[] = { "id", "config.interval", "commands[*].id" };
+    CountingHandler all_handler, some_handler;
+    JsonStreamParser all(&all_handler);
+    JsonStreamParser some(&some_handler, wanted, 3);
+
+    run(&all, body, length, rounds / 10 + 1);        // warm up
+
+    double scan = run(NULL, body, length, rounds);
+    double every = run(&all, body, length, rounds);
+    double filtered = run(&some, body, length, rounds);
+
+    printf("%ld MB of JSON in %u byte pieces (%u byte body, %u documents)\n",
+           megabytes, CHUNK_SIZE, (unsigned)length, (unsigned)all.documents());
+    printf("  byte loop:       %8.1f MB/s\n", scan);
+    printf("  every value:     %8.1f MB/s (%u values per body)\n", every, (unsigned)all.values());
+    printf("  3 path filters:  %8.1f MB/s (%u values per body)\n", filtered, (unsigned)some.values());
+    printf("  parser state:    %u bytes\n", (unsigned)sizeof(JsonStreamParser));
+    return 0;
+}
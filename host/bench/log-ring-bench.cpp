@@ -0,0 +1,89 @@
+//
+// Host benchmark for the console log ring.
+//
+// A "request thread" pushes response body chunks through a stand-in parse
+// step while logging each one, as stream_callback does, against a console
+// that drains at 115200 baud.  It compares logging switched off, printing
+// byte by byte straight to the UART (the old stream_callback), and queueing
+// into LogRing, and reports how many body bytes per second the request
+// thread got through in each case.
+//
+//   make bench-log-ring LOG_BYTES=65536
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "mbed.h"
+#include "log-ring.h"
+
+#define UART_BAUD       115200
+#define CHUNK_SIZE      512
+
+// 10 bits per character on the wire.
+static void uart_write(const char *data, size_t size)
+{
+    (void)data;
+    usleep((useconds_t)(size * 10ULL * 1000000 / UART_BAUD));
+}
+
+static volatile uint32_t checksum;
+
+static void parse(const char *data, size_t size)
+{
+    uint32_t sum = checksum;
+    for (size_t ix = 0; ix < size; ix++) {
+        sum = sum * 31 + (uint8_t)data[ix];
+    }
+    checksum = sum;
+}
+
+enum Mode { LOG_OFF, LOG_BLOCKING, LOG_RING };
+
+static double run(Mode mode, const char *body, size_t total, LogRing *ring)
+{
+    Timer timer;
+    timer.start();
+    for (size_t done = 0; done < total; done += CHUNK_SIZE) {
+        size_t size = total - done < CHUNK_SIZE ? total - done : CHUNK_SIZE;
+        const char *chunk = body + done % (64 * 1024);
+
+        parse(chunk, size);
+        if (mode == LOG_BLOCKING) {
+            uart_write("Chunk Received:\n", 16);
+            for (size_t x = 0; x < size; x++) {
+                uart_write(chunk + x, 1);
+            }
+            uart_write("\n", 1);
+        } else if (mode == LOG_RING) {
+            ring->printf("Chunk Received:\n");
+            ring->write(chunk, size);
+            ring->write("\n", 1);
+        }
+    }
+    timer.stop();
+    return total / (timer.read_high_resolution_us() / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    size_t total = argc > 1 ? strtoul(argv[1], NULL, 0) : 16 * 1024;
+    static char body[64 * 1024 + CHUNK_SIZE];
+    for (size_t ix = 0; ix < sizeof(body); ix++) {
+        body[ix] = ' ' + ix % 95;
+    }
+
+    static LogRing ring(callback(uart_write));
+    ring.start();
+
+    printf("%u body bytes in %u byte chunks, console at %u baud, %u byte ring\n",
+           (unsigned)total, CHUNK_SIZE, UART_BAUD, MBED_CONF_APP_LOG_RING_SIZE);
+    printf("logging off        : %12.0f bytes/s\n", run(LOG_OFF, body, total, NULL));
+    printf("printf per byte    : %12.0f bytes/s\n", run(LOG_BLOCKING, body, total, NULL));
+    printf("LogRing            : %12.0f bytes/s\n", run(LOG_RING, body, total, &ring));
+    printf("LogRing records    : %lu queued, %lu dropped (%lu bytes), %lu bytes high water\n",
+           (unsigned long)ring.stats().records, (unsigned long)ring.stats().dropped_records,
+           (unsigned long)ring.stats().dropped_bytes, (unsigned long)ring.stats().high_water);
+    ring.flush();
+    return 0;
+}
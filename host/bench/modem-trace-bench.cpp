@@ -0,0 +1,86 @@
+//
+// Host benchmark for the modem round-trip trace.
+//
+// Records a stand-in HTTP session over the modem (DNS, socket open, connect,
+// a request write, reads, close) again and again, with made-up latencies of
+// the size the WNC14A2A shows, and reports what each record costs.  The last
+// trace is written as the console lines main.cpp prints, for
+// tools/modem-trace.py to decode.
+//
+//   make bench-modem-trace TRACE_RECORDS=1000000
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mbed.h"
+#include "modem-trace.h"
+
+struct Step {
+    uint8_t command;
+    uint32_t latency_us;
+    uint32_t bytes;
+    int result;
+};
+
+// One request: most of it is waiting on AT@SOCKREAD.
+static const Step session[] = {
+    { MODEM_DNS,            420000,   0, 0 },
+    { MODEM_SOCKET_OPEN,     35000,   0, 0 },
+    { MODEM_SOCKET_CONNECT, 610000,   0, 0 },
+    { MODEM_SOCKET_SEND,     48000, 180, 0 },
+    { MODEM_SOCKET_RECV,     21000,   0, NSAPI_ERROR_WOULD_BLOCK },
+    { MODEM_SOCKET_RECV,    390000, 512, 0 },
+    { MODEM_SOCKET_RECV,     60000, 212, 0 },
+    { MODEM_SOCKET_CLOSE,    30000,   0, 0 },
+};
+
+#define SESSION_STEPS   (sizeof(session) / sizeof(session[0]))
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static FILE *trace_file;
+
+static void file_write(const char *data, size_t size)
+{
+    fwrite(data, 1, size, trace_file);
+}
+
+int main(int argc, char **argv)
+{
+    long records = argc > 1 ? atol(argv[1]) : 1000000;
+    const char *path = argc > 2 ? argv[2] : NULL;
+    ModemTrace trace;
+
+    double start = now_s();
+    for (long ix = 0; ix < records; ix++) {
+        const Step &step = session[ix % SESSION_STEPS];
+        trace.record(step.command, 1 + (ix / SESSION_STEPS) % 3, us_ticker_read() - step.latency_us,
+                     step.bytes, step.result);
+    }
+    double elapsed = now_s() - start;
+
+    printf("%ld modem round trips recorded\n", records);
+    printf("  %.0f ns per record: %.5f %% of a 20 ms AT round trip\n",
+           elapsed / records * 1e9, elapsed / records / 20e-3 * 100);
+    printf("  %u records kept, %lu overwritten\n\n",
+           (unsigned)trace.count(), (unsigned long)trace.overwritten());
+    trace_file = stdout;
+    trace.export_summary(callback(file_write));
+
+    if (path) {
+        trace_file = fopen(path, "w");
+        if (!trace_file) {
+            perror(path);
+            return 1;
+        }
+        trace.export_hex(callback(file_write));
+        fclose(trace_file);
+    }
+    return 0;
+}
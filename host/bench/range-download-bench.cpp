@@ -0,0 +1,138 @@
+//
+// Host test bench for the resumable Range download.
+//
+// Downloads /range/N from the loopback httpbin server into a file-backed
+// block device (an image file standing in for the board's flash) twice:
+// once straight through, and once with the board "reset" after every few
+// blocks, each boot a new RangeDownload that has to pick the download up
+// from the progress it finds in the image.  Both must end with the SHA-256
+// of the file, which is known here without asking the server.  Run through
+// the link emulator (LINK=cell-edge) the dropped connections exercise the
+// retries as well.
+//
+//   make bench-download DOWNLOAD_KB=1024 BOOT_BLOCKS=8
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mbed.h"
+#include "easy-connect.h"
+#include "FileBlockDevice.h"
+#include "range-download.h"
+
+#define PROGRESS_SIZE   (2 * 4096)
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// SHA-256 of what /range/N serves: the alphabet over and over.
+static void expected_digest(uint32_t length, uint8_t digest[32])
+{
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz";
+    char block[26 * 40];
+    for (size_t ix = 0; ix < sizeof(block); ix++) {
+        block[ix] = alphabet[ix % 26];
+    }
+    HashSink hash;
+    for (uint32_t done = 0; done < length; done += sizeof(block)) {
+        hash.write(block, length - done < sizeof(block) ? length - done : sizeof(block));
+    }
+    hash.finish(true);
+    memcpy(digest, hash.digest(), 32);
+}
+
+static void report(const char *what, RangeDownload *download, int ret, double seconds, uint32_t requests,
+                   uint32_t failures)
+{
+    printf("  %-22s %s, %7.1f KB/s, %lu requests, %lu failed and retried\n", what,
+           ret != 0 ? "FAILED" : download->complete() ? "digest ok" : "incomplete",
+           download->committed() / 1024.0 / seconds, (unsigned long)requests, (unsigned long)failures);
+    if (ret != 0) {
+        printf("  error %d after %lu of %lu bytes\n", ret, (unsigned long)download->committed(),
+               (unsigned long)download->length());
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t kilobytes = argc > 1 ? atol(argv[1]) : 1024;
+    const char *image = argc > 2 ? argv[2] : "download.img";
+    uint32_t boot_blocks = argc > 3 ? atol(argv[3]) : 8;
+
+    uint32_t length = kilobytes * 1024;
+    bd_size_t region = (length + 4095) / 4096 * 4096;
+    if (region < MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE) {
+        region = MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE;
+    }
+    char url[64];
+    snprintf(url, sizeof(url), "http://httpbin.org/range/%lu", (unsigned long)length);
+    uint8_t digest[32];
+    expected_digest(length, digest);
+
+    NetworkInterface *net = easy_connect();
+    TCPTransport transport(net, "httpbin.org", 80);
+    FileBlockDevice bd(image, region + PROGRESS_SIZE);
+    if (bd.init() != 0) {
+        printf("cannot open %s\n", image);
+        return 1;
+    }
+    printf("%s: %lu KB in %u byte blocks to %s\n", url, (unsigned long)kilobytes,
+           MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE, image);
+
+    // Straight through, from nothing.
+    RangeDownload *download = new RangeDownload(&transport, url, &bd, 0, region, region, PROGRESS_SIZE);
+    download->set_digest(digest);
+    int ret = download->init();
+    if (ret == 0) {
+        ret = download->reset();
+    }
+    double start = now_s();
+    if (ret == 0) {
+        ret = download->run();
+    }
+    report("straight through:", download, ret, now_s() - start,
+           download->stats().requests, download->stats().failures);
+    int failed = ret != 0 || !download->complete();
+    download->reset();
+    delete download;
+
+    // Reset every boot_blocks blocks; every boot resumes from the image.
+    uint32_t boots = 0;
+    uint32_t requests = 0;
+    uint32_t failures = 0;
+    start = now_s();
+    do {
+        download = new RangeDownload(&transport, url, &bd, 0, region, region, PROGRESS_SIZE);
+        download->set_digest(digest);
+        ret = download->init();
+        if (ret == 0) {
+            if (download->stats().resumed_at == 0 && boots > 0) {
+                printf("  boot %lu found no progress\n", (unsigned long)boots);
+                ret = -1;
+            }
+            ret = ret ? ret : download->run(boot_blocks);
+        }
+        boots++;
+        requests += download->stats().requests;
+        failures += download->stats().failures;
+        if (ret != 0 || download->complete()) {
+            break;
+        }
+        delete download;
+        transport.close();
+    } while (true);
+    char what[32];
+    snprintf(what, sizeof(what), "%lu boots:", (unsigned long)boots);
+    report(what, download, ret, now_s() - start, requests, failures);
+    failed |= ret != 0 || !download->complete();
+    delete download;
+
+    bd.deinit();
+    return failed;
+}
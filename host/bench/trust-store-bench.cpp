@@ -0,0 +1,87 @@
+//
+// Host benchmark for the shared trust store.
+//
+// Compares what each TLS connection used to pay (decoding and parsing the
+// PEM root list into a private mbedtls_x509_crt, as mbed-http's TLSSocket
+// does) against looking up the chain parsed once from the DER images in
+// ca-roots.cpp.
+//
+//   make bench-trust-store CONNECTIONS=200
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mbedtls/x509_crt.h"
+#include "trust-store.h"
+#include "host-ca-pem.h"
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static double bench_pem(int connections)
+{
+    double start = now_us();
+    for (int ix = 0; ix < connections; ix++) {
+        mbedtls_x509_crt cacert;
+        mbedtls_x509_crt_init(&cacert);
+        int ret = mbedtls_x509_crt_parse(&cacert, (const unsigned char *)SSL_CA_PEM,
+                                         strlen(SSL_CA_PEM) + 1);
+        if (ret != 0) {
+            printf("PEM parse failed (-0x%04X)\n", -ret);
+            exit(1);
+        }
+        mbedtls_x509_crt_free(&cacert);
+    }
+    return now_us() - start;
+}
+
+static double bench_shared(int connections)
+{
+    double start = now_us();
+    for (int ix = 0; ix < connections; ix++) {
+        if (!trust_store_chain()) {
+            printf("Trust store is empty\n");
+            exit(1);
+        }
+    }
+    return now_us() - start;
+}
+
+static double bench_der_once(void)
+{
+    double start = now_us();
+    mbedtls_x509_crt chain;
+    mbedtls_x509_crt_init(&chain);
+    for (size_t ix = 0; ix < TRUST_ANCHOR_COUNT; ix++) {
+        mbedtls_x509_crt_parse_der(&chain, TRUST_ANCHORS[ix].der, TRUST_ANCHORS[ix].len);
+    }
+    mbedtls_x509_crt_free(&chain);
+    return now_us() - start;
+}
+
+int main(int argc, char **argv)
+{
+    int connections = argc > 1 ? atoi(argv[1]) : 100;
+    size_t der_bytes = 0;
+
+    for (size_t ix = 0; ix < TRUST_ANCHOR_COUNT; ix++) {
+        der_bytes += TRUST_ANCHORS[ix].len;
+    }
+
+    double pem = bench_pem(connections);
+    double der = bench_der_once();
+    double shared = bench_shared(connections);
+
+    printf("roots: %u, PEM text %u bytes, DER %u bytes\n", (unsigned)TRUST_ANCHOR_COUNT,
+           (unsigned)strlen(SSL_CA_PEM), (unsigned)der_bytes);
+    printf("PEM parse per connection : %9.1f us total, %7.1f us/connection\n", pem, pem / connections);
+    printf("DER parse (once)         : %9.1f us\n", der);
+    printf("shared chain lookup      : %9.1f us total, %7.1f us/connection\n", shared, shared / connections);
+    return 0;
+}
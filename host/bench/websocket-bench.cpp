@@ -0,0 +1,115 @@
+//
+// Host benchmark for the WebSocket channel.
+//
+// Sends the same small telemetry reading MESSAGES times to the loopback
+// server, each waiting for its answer: as HTTP POSTs to /post over one
+// kept-alive connection, then as WebSocket messages to the server's echo.
+// Reports round trips per second and the bytes each costs on the wire and
+// on air (traffic-meter.h), the WebSocket handshake apart.  Run through the
+// link emulator (LINK=lte-m) the round trips show what the link does to
+// each.
+//
+//   make bench-websocket MESSAGES=2000
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mbed.h"
+#include "easy-connect.h"
+#include "http-client.h"
+#include "websocket.h"
+
+static const char reading[] = "{\"sensor\":\"temp\",\"value\":21.5}";
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+class EchoCounter : public WebSocketHandler {
+public:
+    EchoCounter() : messages(0) {}
+
+    virtual int message(WebSocketOpcode opcode, const char *data, size_t size, bool first, bool last)
+    {
+        (void)opcode; (void)data; (void)size; (void)first;
+        messages += last;
+        return 0;
+    }
+
+    unsigned long messages;
+};
+
+static void report(const char *what, const TrafficCounters &traffic, unsigned long messages, double seconds)
+{
+    printf("  %-20s %8.0f round trips/s, per message %5lu/%5lu bytes sent/received, %5lu/%5lu on air\n",
+           what, seconds > 0 ? messages / seconds : 0.0,
+           (unsigned long)(traffic.wire_sent / messages), (unsigned long)(traffic.wire_received / messages),
+           (unsigned long)(traffic_air_sent(traffic) / messages),
+           (unsigned long)(traffic_air_received(traffic) / messages));
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long messages = argc > 1 ? atol(argv[1]) : 2000;
+    if (messages == 0) {
+        messages = 1;
+    }
+    NetworkInterface *net = easy_connect();
+    printf("%lu messages of %u bytes\n", messages, (unsigned)(sizeof(reading) - 1));
+
+    TCPTransport http(net, "httpbin.org", 80);
+    if (http.connect() != 0) {
+        printf("connect failed\n");
+        return 1;
+    }
+    TrafficCounters before = http.traffic();
+    double start = now_s();
+    for (unsigned long ix = 0; ix < messages; ix++) {
+        HttpClientRequest req(&http, HTTP_POST, "http://httpbin.org/post");
+        req.set_header("Content-Type", "application/json");
+        if (!req.send(reading, sizeof(reading) - 1)) {
+            printf("POST failed (error code %d)\n", req.get_error());
+            return 1;
+        }
+    }
+    double seconds = now_s() - start;
+    TrafficCounters traffic;
+    traffic_delta(&traffic, http.traffic(), before);
+    http.close();
+    report("HTTP POST", traffic, messages, seconds);
+
+    TCPTransport socket(net, "echo.websocket.org", 80);
+    EchoCounter echo;
+    WebSocketClient ws(&socket, &echo);
+    int ret = ws.connect("ws://echo.websocket.org/");
+    if (ret != 0) {
+        printf("WebSocket handshake failed (error code %d)\n", ret);
+        return 1;
+    }
+    before = socket.traffic();
+    printf("  %-20s %5lu/%5lu bytes sent/received\n", "WebSocket handshake",
+           (unsigned long)before.wire_sent, (unsigned long)before.wire_received);
+    start = now_s();
+    for (unsigned long ix = 0; ix < messages && ret >= 0; ix++) {
+        ret = ws.send(reading, sizeof(reading) - 1);
+        while (ret >= 0 && echo.messages <= ix) {
+            ret = ws.receive();
+            if (ret == NSAPI_ERROR_WOULD_BLOCK) {
+                ret = 0;
+            }
+        }
+    }
+    seconds = now_s() - start;
+    if (ret < 0) {
+        printf("WebSocket failed (error code %d)\n", ret);
+        return 1;
+    }
+    traffic_delta(&traffic, socket.traffic(), before);
+    report("WebSocket", traffic, messages, seconds);
+    ws.close();
+    return 0;
+}
@@ -0,0 +1,363 @@
+#!/usr/bin/env python3
+#
+# Loopback stand-in for httpbin.org used by the host build of the HTTPx demo.
+#
+# Serves the endpoints the demos call (/post, /put, /delete, /get,
+# /stream/N, /status/N, /gzip, /deflate, /range/N, /etag/TAG and the mbed
+# hello.txt page) over HTTP/1.1 with keep-alive, and optionally over TLS on
+# a second port.
+# Request bodies sent with Content-Encoding gzip or deflate are inflated
+# before they are echoed.  hello.txt, /range/N and /etag/TAG carry
+# validators, and a GET whose If-None-Match or If-Modified-Since still holds
+# gets a 304.
+# The first request carrying ?drop=KEY for a given KEY is not answered: the
+# connection is closed on it, as a server or NAT dropping it would.
+# A GET that asks to upgrade to WebSocket (any path, like
+# echo.websocket.org) gets an echo: each frame comes back unmasked with the
+# same opcode and FIN bit, pings are answered and a close is returned.
+#
+#   python3 httpbin_server.py --port 8080 --tls-port 8443 \
+#           --cert build/certs/server.crt --key build/certs/server.key
+#
+
+import argparse
+import base64
+import hashlib
+import json
+import struct
+import ssl
+import sys
+import threading
+import zlib
+from email.utils import parsedate_to_datetime
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import urlsplit, parse_qsl
+
+HELLO_TXT = b"Hello world!\n"
+HELLO_VALIDATORS = [("ETag", '"hello1"'), ("Last-Modified", "Mon, 15 Jan 2018 09:00:00 GMT")]
+
+ALPHABET = b"abcdefghijklmnopqrstuvwxyz"
+RANGE_MAX = 64 * 1024 * 1024    # httpbin.org stops at 100 KB; downloads test bigger
+
+WEBSOCKET_GUID = b"258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+TEAPOT = (b"\n"
+          b"    -=[ teapot ]=-\n\n"
+          b"       _...._\n"
+          b"     .'  _ _ `.\n"
+          b"    | .\"` ^ `\". _,\n"
+          b"    \\_;`\"---\"`|//\n"
+          b"      |       ;/\n"
+          b"      \\_     _/\n"
+          b"        `\"\"\"`\n")
+
+
+class HttpbinHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    server_version = "httpbin-loopback/1.0"
+    scheme = "http"
+    # Headers and body go out in separate writes; with Nagle on, the body
+    # would wait for the client's delayed ACK (40 ms a response on Linux).
+    disable_nagle_algorithm = True
+    dropped = set()
+    dropped_lock = threading.Lock()
+
+    def log_message(self, fmt, *args):
+        if self.server.verbose:
+            sys.stderr.write("%s - %s\n" % (self.address_string(), fmt % args))
+
+    # -- request helpers -------------------------------------------------
+
+    def read_body(self):
+        body = self.read_raw_body()
+        encoding = self.headers.get("Content-Encoding", "").lower()
+        if encoding in ("gzip", "x-gzip"):
+            return zlib.decompress(body, 16 + zlib.MAX_WBITS)
+        if encoding == "deflate":
+            return zlib.decompress(body)
+        return body
+
+    def read_raw_body(self):
+        if self.headers.get("Transfer-Encoding", "").lower() == "chunked":
+            body = bytearray()
+            while True:
+                size = int(self.rfile.readline().split(b";")[0].strip(), 16)
+                if size == 0:
+                    while self.rfile.readline() not in (b"\r\n", b"\n", b""):
+                        pass
+                    return bytes(body)
+                body += self.rfile.read(size)
+                self.rfile.readline()
+        length = int(self.headers.get("Content-Length", 0))
+        return self.rfile.read(length) if length else b""
+
+    def url(self):
+        return "%s://%s%s" % (self.scheme, self.headers.get("Host", "localhost"), self.path)
+
+    def args(self):
+        return dict(parse_qsl(urlsplit(self.path).query))
+
+    def echo(self, body=None):
+        doc = {
+            "args": self.args(),
+            "headers": dict(self.headers.items()),
+            "origin": self.client_address[0],
+            "url": self.url(),
+        }
+        if body is not None:
+            text = body.decode("utf-8", "replace")
+            try:
+                parsed = json.loads(text) if text else None
+            except ValueError:
+                parsed = None
+            doc.update({"data": text, "files": {}, "form": {}, "json": parsed})
+        return doc
+
+    # -- response helpers ------------------------------------------------
+
+    def not_modified(self, extra):
+        """True when a conditional request's validators match extra's."""
+        validators = dict(extra)
+        etag = validators.get("ETag")
+        match = self.headers.get("If-None-Match")
+        if match is not None:
+            return etag is not None and (match.strip() == "*" or
+                                         etag in [tag.strip() for tag in match.split(",")])
+        modified = validators.get("Last-Modified")
+        since = self.headers.get("If-Modified-Since")
+        if modified is None or since is None:
+            return False
+        try:
+            return parsedate_to_datetime(modified) <= parsedate_to_datetime(since)
+        except (TypeError, ValueError):
+            return False
+
+    def send_body(self, status, body, content_type="application/json", extra=()):
+        if status == 200 and self.command in ("GET", "HEAD") and self.not_modified(extra):
+            self.send_response(304)
+            for name, value in extra:
+                self.send_header(name, value)
+            self.end_headers()
+            return
+        self.send_response(status)
+        self.send_header("Content-Type", content_type)
+        self.send_header("Content-Length", str(len(body)))
+        self.send_header("Access-Control-Allow-Origin", "*")
+        for name, value in extra:
+            self.send_header(name, value)
+        self.end_headers()
+        if self.command != "HEAD":
+            self.wfile.write(body)
+
+    def send_json(self, doc, status=200):
+        self.send_body(status, (json.dumps(doc, indent=2) + "\n").encode())
+
+    def send_compressed(self, doc, encoding):
+        body = (json.dumps(doc, indent=2) + "\n").encode()
+        if encoding == "gzip":
+            packer = zlib.compressobj(6, zlib.DEFLATED, 16 + zlib.MAX_WBITS)
+        else:
+            packer = zlib.compressobj(6, zlib.DEFLATED, zlib.MAX_WBITS)
+        body = packer.compress(body) + packer.flush()
+        self.send_body(200, body, extra=[("Content-Encoding", encoding)])
+
+    def send_range(self, size):
+        """/range/N: N bytes of the alphabet, honouring a single Range."""
+        extra = [("ETag", '"range%d"' % size), ("Accept-Ranges", "bytes")]
+        first, last, status = 0, size - 1, 200
+        spec = self.headers.get("Range", "")
+        if spec.startswith("bytes=") and "," not in spec:
+            start, _, end = spec[6:].partition("-")
+            try:
+                if start:
+                    first, last = int(start), min(int(end) if end else size - 1, size - 1)
+                else:
+                    first = max(0, size - int(end))
+            except ValueError:
+                first, last = 1, 0
+            if first > last or first >= size:
+                return self.send_body(416, b"", "text/plain", [("Content-Range", "bytes */%d" % size)])
+            status = 206
+            extra.append(("Content-Range", "bytes %d-%d/%d" % (first, last, size)))
+        body = (ALPHABET * ((last + 26) // 26 + 1))[first % 26:first % 26 + last - first + 1]
+        self.send_body(status, body, "application/octet-stream", extra)
+
+    def send_chunked(self, chunks, content_type="application/json"):
+        self.send_response(200)
+        self.send_header("Content-Type", content_type)
+        self.send_header("Transfer-Encoding", "chunked")
+        self.end_headers()
+        for chunk in chunks:
+            self.wfile.write(b"%x\r\n%s\r\n" % (len(chunk), chunk))
+        self.wfile.write(b"0\r\n\r\n")
+
+    # -- WebSocket echo --------------------------------------------------
+
+    def read_frame(self):
+        """(fin, opcode, payload) of the next client frame, or None at EOF."""
+        head = self.rfile.read(2)
+        if len(head) < 2:
+            return None
+        length = head[1] & 0x7f
+        if length == 126:
+            length = struct.unpack("!H", self.rfile.read(2))[0]
+        elif length == 127:
+            length = struct.unpack("!Q", self.rfile.read(8))[0]
+        mask = self.rfile.read(4) if head[1] & 0x80 else b"\0\0\0\0"
+        payload = bytearray(self.rfile.read(length))
+        if len(payload) < length:
+            return None
+        for ix in range(length):
+            payload[ix] ^= mask[ix & 3]
+        return bool(head[0] & 0x80), head[0] & 0x0f, bytes(payload)
+
+    def write_frame(self, fin, opcode, payload):
+        head = bytes([(0x80 if fin else 0) | opcode])
+        if len(payload) < 126:
+            head += bytes([len(payload)])
+        elif len(payload) < 65536:
+            head += bytes([126]) + struct.pack("!H", len(payload))
+        else:
+            head += bytes([127]) + struct.pack("!Q", len(payload))
+        self.wfile.write(head + payload)
+        self.wfile.flush()
+
+    def websocket_echo(self):
+        key = self.headers.get("Sec-WebSocket-Key", "").strip().encode()
+        accept = base64.b64encode(hashlib.sha1(key + WEBSOCKET_GUID).digest()).decode()
+        self.send_response(101, "Switching Protocols")
+        self.send_header("Upgrade", "websocket")
+        self.send_header("Connection", "Upgrade")
+        self.send_header("Sec-WebSocket-Accept", accept)
+        protocol = self.headers.get("Sec-WebSocket-Protocol")
+        if protocol:
+            self.send_header("Sec-WebSocket-Protocol", protocol.split(",")[0].strip())
+        self.end_headers()
+        self.wfile.flush()
+        self.close_connection = True
+        while True:
+            frame = self.read_frame()
+            if frame is None:
+                return
+            fin, opcode, payload = frame
+            if opcode == 0x9:
+                self.write_frame(True, 0xa, payload)
+            elif opcode == 0x8:
+                self.write_frame(True, 0x8, payload[:2])
+                return
+            elif opcode in (0x0, 0x1, 0x2):
+                self.write_frame(fin, opcode, payload)
+
+    # -- routing ---------------------------------------------------------
+
+    def drop_once(self):
+        key = self.args().get("drop")
+        if key is None:
+            return False
+        with self.dropped_lock:
+            if key in self.dropped:
+                return False
+            self.dropped.add(key)
+        self.close_connection = True
+        return True
+
+    def route(self, method):
+        path = urlsplit(self.path).path
+        if self.drop_once():
+            return
+        body = self.read_body() if method in ("POST", "PUT", "DELETE", "PATCH") else None
+
+        if path == "/" + method.lower() and method != "HEAD":
+            return self.send_json(self.echo(body))
+        if path.startswith("/status/"):
+            code = int(path.split("/")[2])
+            if code == 418:
+                return self.send_body(418, TEAPOT, "text/plain",
+                                      [("x-more-info", "http://tools.ietf.org/html/rfc2324")])
+            return self.send_body(code, b"", "text/html")
+        if path.startswith("/stream/") and method in ("GET", "HEAD"):
+            count = min(int(path.split("/")[2]), 100)
+            doc = self.echo()
+            lines = []
+            for ix in range(count):
+                doc["id"] = ix
+                lines.append((json.dumps(doc) + "\n").encode())
+            return self.send_chunked(lines)
+        if path in ("/gzip", "/deflate") and method == "GET":
+            doc = self.echo()
+            doc["method"] = method
+            doc["gzipped" if path == "/gzip" else "deflated"] = True
+            return self.send_compressed(doc, path[1:])
+        if path.startswith("/range/") and method in ("GET", "HEAD"):
+            return self.send_range(min(int(path.split("/")[2]), RANGE_MAX))
+        if path.startswith("/etag/") and method in ("GET", "HEAD"):
+            body = (json.dumps(self.echo(), indent=2) + "\n").encode()
+            return self.send_body(200, body, extra=[("ETag", '"%s"' % path.split("/")[2])])
+        if path.endswith("/hello.txt") and method in ("GET", "HEAD"):
+            return self.send_body(200, HELLO_TXT, "text/plain", HELLO_VALIDATORS)
+        self.send_body(404, b"Not Found\n", "text/plain")
+
+    def do_GET(self):
+        if self.headers.get("Upgrade", "").lower() == "websocket":
+            return self.websocket_echo()
+        self.route("GET")
+
+    def do_HEAD(self):
+        self.route("HEAD")
+
+    def do_POST(self):
+        self.route("POST")
+
+    def do_PUT(self):
+        self.route("PUT")
+
+    def do_DELETE(self):
+        self.route("DELETE")
+
+
+class TLSHttpbinHandler(HttpbinHandler):
+    scheme = "https"
+
+
+def serve(server):
+    thread = threading.Thread(target=server.serve_forever, daemon=True)
+    thread.start()
+    return thread
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Loopback httpbin stand-in")
+    parser.add_argument("--bind", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--tls-port", type=int, default=0, help="0 disables TLS")
+    parser.add_argument("--cert", help="PEM server certificate chain for --tls-port")
+    parser.add_argument("--key", help="PEM private key for --tls-port")
+    parser.add_argument("-v", "--verbose", action="store_true")
+    opts = parser.parse_args()
+
+    servers = []
+    plain = ThreadingHTTPServer((opts.bind, opts.port), HttpbinHandler)
+    servers.append(plain)
+
+    if opts.tls_port:
+        ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        ctx.load_cert_chain(opts.cert, opts.key)
+        secure = ThreadingHTTPServer((opts.bind, opts.tls_port), TLSHttpbinHandler)
+        secure.socket = ctx.wrap_socket(secure.socket, server_side=True)
+        servers.append(secure)
+
+    for server in servers:
+        server.daemon_threads = True
+        server.verbose = opts.verbose
+    threads = [serve(server) for server in servers]
+    print("httpbin loopback listening on %s:%d%s" % (
+        opts.bind, opts.port, (" (tls %d)" % opts.tls_port) if opts.tls_port else ""), flush=True)
+    try:
+        for thread in threads:
+            thread.join()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,311 @@
+#!/usr/bin/env python3
+#
+# Cellular link emulator for the host build: a TCP proxy that sits between
+# the demo and the loopback httpbin server (httpbin_server.py) and makes the
+# loopback behave like an LTE-M link.
+#
+# Each direction of each connection is a link of its own with
+#   - a one-way delay of half the round trip, plus jitter,
+#   - a bandwidth cap, so a segment waits for the ones ahead of it,
+#   - segment loss, paid for as a retransmission timeout (TCP never loses
+#     bytes, it delivers them late and everything behind them with them),
+# and a connection can be reset (RST both ways) part way through a response.
+# Connecting costs one round trip before the first byte goes through.
+#
+# The settings come from named profiles in link-profiles.json.  A profile
+# may also be a script of phases, each another profile for a number of
+# seconds, repeated, to emulate a device moving in and out of coverage.
+#
+#   python3 link_emulator.py --profile cell-edge --map 8081:8080 --map 8444:8443
+#   HTTPX_PORT_MAP=80:8081,443:8444 ./build/httpx-host
+#
+
+import argparse
+import heapq
+import json
+import os
+import random
+import signal
+import socket
+import struct
+import sys
+import threading
+import time
+
+SEGMENT = 1400                  # bytes read and scheduled at a time
+MIN_RTO = 0.2                   # seconds; a loss costs max(MIN_RTO, 2 x RTT)
+
+SETTINGS = {
+    "rtt_ms": 0,                # round trip time
+    "jitter_ms": 0,             # each segment's delay varies by up to this much
+    "loss": 0.0,                # probability a segment is lost and resent
+    "down_kbps": 0,             # server to device; 0 is unlimited
+    "up_kbps": 0,               # device to server
+    "reset": 0.0,               # probability a connection is reset mid-stream
+    "reset_window": 65536,      # ... somewhere within this many response bytes
+}
+
+
+class Profile:
+    """The settings in force, following the phases of a scripted profile."""
+
+    def __init__(self, profiles, name, overrides):
+        self.name = name
+        self.phases = []
+        self.overrides = overrides
+        self.started = time.monotonic()
+        self.load(profiles, name, 1.0)
+        self.cycle = sum(seconds for seconds, settings in self.phases)
+
+    def load(self, profiles, name, seconds):
+        if name not in profiles:
+            raise SystemExit("unknown link profile '%s' (have: %s)" % (name, ", ".join(sorted(profiles))))
+        profile = profiles[name]
+        if "phases" in profile:
+            for phase in profile["phases"]:
+                self.load(profiles, phase["profile"], phase["seconds"])
+            return
+        settings = dict(SETTINGS)
+        for key, value in profile.items():
+            if key not in SETTINGS and key != "description":
+                raise SystemExit("link profile '%s': unknown setting '%s'" % (name, key))
+            settings[key] = value
+        settings.update(self.overrides)
+        settings.pop("description", None)
+        self.phases.append((seconds, settings))
+
+    def now(self):
+        if len(self.phases) == 1:
+            return self.phases[0][1]
+        at = (time.monotonic() - self.started) % self.cycle
+        for seconds, settings in self.phases:
+            if at < seconds:
+                return settings
+            at -= seconds
+        return self.phases[-1][1]
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.connections = 0
+        self.resets = 0
+        self.losses = 0
+        self.bytes_up = 0
+        self.bytes_down = 0
+
+    def add(self, **counts):
+        with self.lock:
+            for key, value in counts.items():
+                setattr(self, key, getattr(self, key) + value)
+
+    def line(self):
+        with self.lock:
+            return ("%d connections, %d reset, %d segments lost, %d bytes up, %d bytes down"
+                    % (self.connections, self.resets, self.losses, self.bytes_up, self.bytes_down))
+
+
+class Direction:
+    """One way of one connection: reads segments, delivers each on time."""
+
+    def __init__(self, link, src, dst, upstream, opened):
+        self.link = link
+        self.src = src
+        self.dst = dst
+        self.upstream = upstream
+        self.queue = []             # (due, order, data) heap
+        self.order = 0
+        self.cond = threading.Condition()
+        self.busy_until = opened    # the link is sending until then
+        self.last_due = opened      # TCP delivers in order
+        self.closed = False
+
+    def schedule(self, data):
+        settings = self.link.profile.now()
+        now = time.monotonic()
+        kbps = settings["up_kbps" if self.upstream else "down_kbps"]
+        start = max(now, self.busy_until)
+        self.busy_until = start + (len(data) * 8.0 / (kbps * 1000.0) if kbps else 0.0)
+
+        rtt = settings["rtt_ms"] / 1000.0
+        delay = rtt / 2 + random.uniform(-1, 1) * settings["jitter_ms"] / 1000.0
+        due = self.busy_until + max(0.0, delay)
+        if settings["loss"] and random.random() < settings["loss"]:
+            due += max(MIN_RTO, 2 * rtt)
+            self.link.stats.add(losses=1)
+        self.last_due = max(self.last_due, due)
+
+        with self.cond:
+            heapq.heappush(self.queue, (self.last_due, self.order, data))
+            self.order += 1
+            self.cond.notify()
+
+    def finish(self):
+        with self.cond:
+            self.closed = True
+            self.cond.notify()
+
+    def read_loop(self):
+        try:
+            while True:
+                data = self.src.recv(SEGMENT)
+                if not data:
+                    break
+                self.schedule(data)
+        except OSError:
+            pass
+        self.finish()
+
+    def send_loop(self):
+        try:
+            while True:
+                with self.cond:
+                    while not self.queue and not self.closed:
+                        self.cond.wait()
+                    if not self.queue:
+                        break
+                    due, order, data = self.queue[0]
+                    wait = due - time.monotonic()
+                    if wait > 0:
+                        self.cond.wait(wait)
+                        continue
+                    heapq.heappop(self.queue)
+                if not self.upstream and self.link.cut_off(len(data)):
+                    return
+                self.dst.sendall(data)
+                self.link.stats.add(**{"bytes_up" if self.upstream else "bytes_down": len(data)})
+            self.dst.shutdown(socket.SHUT_WR)
+        except OSError:
+            pass
+
+
+class Link:
+    """A proxied connection: the device's socket and the server's."""
+
+    def __init__(self, device, server, profile, stats, verbose):
+        self.device = device
+        self.server = server
+        self.profile = profile
+        self.stats = stats
+        self.verbose = verbose
+        self.lock = threading.Lock()
+        self.reset_done = False
+        settings = profile.now()
+        self.reset_at = None
+        if settings["reset"] and random.random() < settings["reset"]:
+            self.reset_at = random.randrange(max(1, settings["reset_window"]))
+        self.down_bytes = 0
+
+    def cut_off(self, size):
+        """True (after resetting both sides) once the response reaches reset_at."""
+        with self.lock:
+            if self.reset_at is None or self.down_bytes + size <= self.reset_at:
+                self.down_bytes += size
+                return False
+            if not self.reset_done:
+                self.reset_done = True
+                self.stats.add(resets=1)
+                if self.verbose:
+                    sys.stderr.write("link: reset after %d response bytes\n" % self.reset_at)
+                # Shutting down the read side wakes the threads blocked in
+                # recv() without sending anything; closing with a zero
+                # linger then sends the RST.
+                for sock in (self.device, self.server):
+                    try:
+                        sock.setsockopt(socket.SOL_SOCKET, socket.SO_LINGER, struct.pack("ii", 1, 0))
+                        sock.shutdown(socket.SHUT_RD)
+                        sock.close()
+                    except OSError:
+                        pass
+            return True
+
+    def run(self):
+        # The handshake costs a round trip before anything gets through.
+        opened = time.monotonic() + self.profile.now()["rtt_ms"] / 1000.0
+        up = Direction(self, self.device, self.server, True, opened)
+        down = Direction(self, self.server, self.device, False, opened)
+        threads = [threading.Thread(target=target, daemon=True)
+                   for target in (up.read_loop, up.send_loop, down.read_loop, down.send_loop)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        for sock in (self.device, self.server):
+            try:
+                sock.close()
+            except OSError:
+                pass
+
+
+def listen(bind, port, target, profile, stats, verbose):
+    listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    listener.bind((bind, port))
+    listener.listen(16)
+
+    def accept_loop():
+        while True:
+            device, address = listener.accept()
+            try:
+                server = socket.create_connection(target)
+            except OSError as error:
+                sys.stderr.write("link: cannot reach %s:%d: %s\n" % (target[0], target[1], error))
+                device.close()
+                continue
+            for sock in (device, server):
+                sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            stats.add(connections=1)
+            threading.Thread(target=Link(device, server, profile, stats, verbose).run, daemon=True).start()
+
+    thread = threading.Thread(target=accept_loop, daemon=True)
+    thread.start()
+    return thread
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description="Cellular link emulator (TCP proxy)")
+    parser.add_argument("--bind", default="127.0.0.1")
+    parser.add_argument("--target", default="127.0.0.1", help="address of the server behind the link")
+    parser.add_argument("--map", action="append", default=[], metavar="LISTEN:TARGET",
+                        help="proxy port LISTEN to TARGET on --target (repeatable)")
+    parser.add_argument("--profile", default="good-lte")
+    parser.add_argument("--profiles", default=os.path.join(here, "link-profiles.json"))
+    parser.add_argument("--list", action="store_true", help="list the profiles and exit")
+    parser.add_argument("--seed", type=int, help="make loss, jitter and resets repeatable")
+    for key, value in SETTINGS.items():
+        parser.add_argument("--" + key.replace("_", "-"), type=type(value), dest=key,
+                            help="override the profile's %s" % key)
+    parser.add_argument("-v", "--verbose", action="store_true")
+    opts = parser.parse_args()
+
+    profiles = json.load(open(opts.profiles))
+    if opts.list:
+        for name in sorted(profiles):
+            print("%-12s %s" % (name, profiles[name].get("description", "")))
+        return
+    if not opts.map:
+        parser.error("nothing to proxy: give at least one --map")
+    if opts.seed is not None:
+        random.seed(opts.seed)
+
+    overrides = dict((key, getattr(opts, key)) for key in SETTINGS if getattr(opts, key) is not None)
+    profile = Profile(profiles, opts.profile, overrides)
+    stats = Stats()
+    threads = []
+    for pair in opts.map:
+        listen_port, target_port = (int(port) for port in pair.split(":"))
+        threads.append(listen(opts.bind, listen_port, (opts.target, target_port), profile, stats, opts.verbose))
+    print("link emulator '%s' on %s" % (opts.profile, ", ".join(opts.map)), flush=True)
+    # The Makefile stops it with kill; report on the way out either way.
+    signal.signal(signal.SIGTERM, lambda signum, frame: sys.exit(0))
+    try:
+        for thread in threads:
+            thread.join()
+    except (KeyboardInterrupt, SystemExit):
+        pass
+    print("link emulator: " + stats.line(), flush=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,141 @@
+#ifndef _HOST_CALLBACK_H_
+#define _HOST_CALLBACK_H_
+
+//
+// Host build stand-in for mbed's platform/Callback.h.  Only the shapes used by
+// the demo and by mbed-http are provided: plain functions and (object, method)
+// pairs taking up to two arguments.
+//
+
+#include <string.h>
+
+namespace mbed {
+
+class CallbackDummy;
+
+template <typename F>
+class Callback;
+
+template <typename R>
+class Callback<R()> {
+public:
+    Callback(R (*func)() = 0) : _obj(0), _thunk(0) {
+        if (func) {
+            memcpy(_func, &func, sizeof func);
+            _thunk = &Callback::function_thunk;
+        }
+    }
+
+    template <typename T>
+    Callback(T *obj, R (T::*method)()) : _obj(obj), _thunk(&Callback::method_thunk<T>) {
+        memcpy(_func, &method, sizeof method);
+    }
+
+    R call() const { return _thunk(_obj, _func); }
+    R operator()() const { return call(); }
+    operator bool() const { return _thunk != 0; }
+
+private:
+    static R function_thunk(void *, const char *func) {
+        R (*f)(); memcpy(&f, func, sizeof f);
+        return f();
+    }
+    template <typename T>
+    static R method_thunk(void *obj, const char *func) {
+        R (T::*m)(); memcpy(&m, func, sizeof m);
+        return (static_cast<T*>(obj)->*m)();
+    }
+
+    void *_obj;
+    char _func[sizeof(void (CallbackDummy::*)())];
+    R (*_thunk)(void *, const char *);
+};
+
+template <typename R, typename A0>
+class Callback<R(A0)> {
+public:
+    Callback(R (*func)(A0) = 0) : _obj(0), _thunk(0) {
+        if (func) {
+            memcpy(_func, &func, sizeof func);
+            _thunk = &Callback::function_thunk;
+        }
+    }
+
+    template <typename T>
+    Callback(T *obj, R (T::*method)(A0)) : _obj(obj), _thunk(&Callback::method_thunk<T>) {
+        memcpy(_func, &method, sizeof method);
+    }
+
+    R call(A0 a0) const { return _thunk(_obj, _func, a0); }
+    R operator()(A0 a0) const { return call(a0); }
+    operator bool() const { return _thunk != 0; }
+
+private:
+    static R function_thunk(void *, const char *func, A0 a0) {
+        R (*f)(A0); memcpy(&f, func, sizeof f);
+        return f(a0);
+    }
+    template <typename T>
+    static R method_thunk(void *obj, const char *func, A0 a0) {
+        R (T::*m)(A0); memcpy(&m, func, sizeof m);
+        return (static_cast<T*>(obj)->*m)(a0);
+    }
+
+    void *_obj;
+    char _func[sizeof(void (CallbackDummy::*)())];
+    R (*_thunk)(void *, const char *, A0);
+};
+
+template <typename R, typename A0, typename A1>
+class Callback<R(A0, A1)> {
+public:
+    Callback(R (*func)(A0, A1) = 0) : _obj(0), _thunk(0) {
+        if (func) {
+            memcpy(_func, &func, sizeof func);
+            _thunk = &Callback::function_thunk;
+        }
+    }
+
+    template <typename T>
+    Callback(T *obj, R (T::*method)(A0, A1)) : _obj(obj), _thunk(&Callback::method_thunk<T>) {
+        memcpy(_func, &method, sizeof method);
+    }
+
+    R call(A0 a0, A1 a1) const { return _thunk(_obj, _func, a0, a1); }
+    R operator()(A0 a0, A1 a1) const { return call(a0, a1); }
+    operator bool() const { return _thunk != 0; }
+
+private:
+    static R function_thunk(void *, const char *func, A0 a0, A1 a1) {
+        R (*f)(A0, A1); memcpy(&f, func, sizeof f);
+        return f(a0, a1);
+    }
+    template <typename T>
+    static R method_thunk(void *obj, const char *func, A0 a0, A1 a1) {
+        R (T::*m)(A0, A1); memcpy(&m, func, sizeof m);
+        return (static_cast<T*>(obj)->*m)(a0, a1);
+    }
+
+    void *_obj;
+    char _func[sizeof(void (CallbackDummy::*)())];
+    R (*_thunk)(void *, const char *, A0, A1);
+};
+
+template <typename R>
+Callback<R()> callback(R (*func)()) { return Callback<R()>(func); }
+template <typename T, typename R>
+Callback<R()> callback(T *obj, R (T::*method)()) { return Callback<R()>(obj, method); }
+
+template <typename R, typename A0>
+Callback<R(A0)> callback(R (*func)(A0)) { return Callback<R(A0)>(func); }
+template <typename T, typename R, typename A0>
+Callback<R(A0)> callback(T *obj, R (T::*method)(A0)) { return Callback<R(A0)>(obj, method); }
+
+template <typename R, typename A0, typename A1>
+Callback<R(A0, A1)> callback(R (*func)(A0, A1)) { return Callback<R(A0, A1)>(func); }
+template <typename T, typename R, typename A0, typename A1>
+Callback<R(A0, A1)> callback(T *obj, R (T::*method)(A0, A1)) { return Callback<R(A0, A1)>(obj, method); }
+
+} // namespace mbed
+
+#endif // _HOST_CALLBACK_H_
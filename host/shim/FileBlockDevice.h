@@ -0,0 +1,95 @@
+#ifndef _HOST_FILE_BLOCK_DEVICE_H_
+#define _HOST_FILE_BLOCK_DEVICE_H_
+
+//
+// Host-only BlockDevice over an image file, so what is written survives the
+// process the way flash survives a reset.  A missing or short file is
+// extended with 0xFF (erased flash).
+//
+
+#include <stdio.h>
+#include <string.h>
+#include "BlockDevice.h"
+
+class FileBlockDevice : public BlockDevice {
+public:
+    FileBlockDevice(const char *path, bd_size_t size, bd_size_t block = 4096)
+        : _path(path), _size(size), _block(block), _file(NULL) {}
+    virtual ~FileBlockDevice() { deinit(); }
+
+    virtual int init()
+    {
+        if (_file) {
+            return 0;
+        }
+        _file = fopen(_path, "r+b");
+        if (!_file) {
+            _file = fopen(_path, "w+b");
+        }
+        if (!_file || fseek(_file, 0, SEEK_END) != 0) {
+            return BD_ERROR_DEVICE_ERROR;
+        }
+        long length = ftell(_file);
+        uint8_t erased[256];
+        memset(erased, 0xFF, sizeof(erased));
+        for (bd_size_t at = length < 0 ? 0 : length; at < _size; at += sizeof(erased)) {
+            size_t n = _size - at < sizeof(erased) ? _size - at : sizeof(erased);
+            if (fwrite(erased, 1, n, _file) != n) {
+                return BD_ERROR_DEVICE_ERROR;
+            }
+        }
+        return fflush(_file) == 0 ? 0 : BD_ERROR_DEVICE_ERROR;
+    }
+    virtual int deinit()
+    {
+        if (_file) {
+            fclose(_file);
+            _file = NULL;
+        }
+        return 0;
+    }
+    virtual int read(void *buffer, bd_addr_t addr, bd_size_t size)
+    {
+        if (!_file || addr + size > _size || fseek(_file, addr, SEEK_SET) != 0 ||
+                fread(buffer, 1, size, _file) != size) {
+            return BD_ERROR_DEVICE_ERROR;
+        }
+        return 0;
+    }
+    virtual int program(const void *buffer, bd_addr_t addr, bd_size_t size)
+    {
+        if (!_file || addr + size > _size || fseek(_file, addr, SEEK_SET) != 0 ||
+                fwrite(buffer, 1, size, _file) != size || fflush(_file) != 0) {
+            return BD_ERROR_DEVICE_ERROR;
+        }
+        return 0;
+    }
+    virtual int erase(bd_addr_t addr, bd_size_t size)
+    {
+        uint8_t erased[256];
+        memset(erased, 0xFF, sizeof(erased));
+        if (!_file || addr + size > _size || fseek(_file, addr, SEEK_SET) != 0) {
+            return BD_ERROR_DEVICE_ERROR;
+        }
+        for (bd_size_t done = 0; done < size; done += sizeof(erased)) {
+            size_t n = size - done < sizeof(erased) ? size - done : sizeof(erased);
+            if (fwrite(erased, 1, n, _file) != n) {
+                return BD_ERROR_DEVICE_ERROR;
+            }
+        }
+        return fflush(_file) == 0 ? 0 : BD_ERROR_DEVICE_ERROR;
+    }
+
+    virtual bd_size_t get_read_size() const { return 1; }
+    virtual bd_size_t get_program_size() const { return 256; }
+    virtual bd_size_t get_erase_size() const { return _block; }
+    virtual bd_size_t size() const { return _size; }
+
+private:
+    const char *_path;
+    bd_size_t _size;
+    bd_size_t _block;
+    FILE *_file;
+};
+
+#endif // _HOST_FILE_BLOCK_DEVICE_H_
@@ -0,0 +1,55 @@
+#ifndef _HOST_HEAP_BLOCK_DEVICE_H_
+#define _HOST_HEAP_BLOCK_DEVICE_H_
+
+//
+// Host build stand-in for mbed's features/filesystem/bd/HeapBlockDevice.h
+// (mbed OS 5.7 interface): a RAM disk.  Erased blocks read back as 0xFF,
+// as on flash.
+//
+
+#include <string.h>
+#include "BlockDevice.h"
+
+class HeapBlockDevice : public BlockDevice {
+public:
+    HeapBlockDevice(bd_size_t size, bd_size_t block = 512)
+        : _size(size), _block(block), _data(NULL) {}
+    virtual ~HeapBlockDevice() { delete[] _data; }
+
+    virtual int init()
+    {
+        if (!_data) {
+            _data = new uint8_t[_size];
+            memset(_data, 0xFF, _size);
+        }
+        return 0;
+    }
+    virtual int deinit() { return 0; }
+    virtual int read(void *buffer, bd_addr_t addr, bd_size_t size)
+    {
+        memcpy(buffer, _data + addr, size);
+        return 0;
+    }
+    virtual int program(const void *buffer, bd_addr_t addr, bd_size_t size)
+    {
+        memcpy(_data + addr, buffer, size);
+        return 0;
+    }
+    virtual int erase(bd_addr_t addr, bd_size_t size)
+    {
+        memset(_data + addr, 0xFF, size);
+        return 0;
+    }
+
+    virtual bd_size_t get_read_size() const { return _block; }
+    virtual bd_size_t get_program_size() const { return _block; }
+    virtual bd_size_t get_erase_size() const { return _block; }
+    virtual bd_size_t size() const { return _size; }
+
+private:
+    bd_size_t _size;
+    bd_size_t _block;
+    uint8_t *_data;
+};
+
+#endif // _HOST_HEAP_BLOCK_DEVICE_H_
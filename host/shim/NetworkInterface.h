@@ -0,0 +1,31 @@
+#ifndef _HOST_NETWORK_INTERFACE_H_
+#define _HOST_NETWORK_INTERFACE_H_
+
+//
+// Host build stand-in for mbed's NetworkInterface.  Sockets opened on it are
+// plain POSIX sockets; see posix-network.cpp.
+//
+
+#include "nsapi_types.h"
+#include "SocketAddress.h"
+
+class NetworkInterface {
+public:
+    virtual ~NetworkInterface() {}
+
+    virtual nsapi_error_t connect() = 0;
+    virtual nsapi_error_t disconnect() = 0;
+    virtual const char *get_ip_address() = 0;
+    virtual const char *get_mac_address() { return 0; }
+
+    // Resolves with getaddrinfo(); overridden by PosixInterface to steer every
+    // hostname at the loopback server.
+    virtual nsapi_error_t gethostbyname(const char *host, SocketAddress *address,
+                                        nsapi_version_t version = NSAPI_UNSPEC);
+
+    // Host-only hook: lets the interface remap well-known ports (80, 443) onto
+    // the unprivileged ports the local server listens on.
+    virtual uint16_t host_port(uint16_t port) { return port; }
+};
+
+#endif // _HOST_NETWORK_INTERFACE_H_
@@ -0,0 +1,38 @@
+#ifndef _HOST_SOCKET_ADDRESS_H_
+#define _HOST_SOCKET_ADDRESS_H_
+
+//
+// Host build stand-in for mbed's SocketAddress (IPv4 only).
+//
+
+#include <string.h>
+#include "nsapi_types.h"
+
+class SocketAddress {
+public:
+    SocketAddress(const char *addr = 0, uint16_t port = 0) : _port(port) {
+        set_ip_address(addr);
+    }
+
+    bool set_ip_address(const char *addr) {
+        _ip[0] = '\0';
+        if (addr) {
+            strncpy(_ip, addr, sizeof _ip - 1);
+            _ip[sizeof _ip - 1] = '\0';
+        }
+        return _ip[0] != '\0';
+    }
+    void set_port(uint16_t port) { _port = port; }
+
+    const char *get_ip_address() const { return _ip[0] ? _ip : 0; }
+    uint16_t get_port() const { return _port; }
+    nsapi_version_t get_ip_version() const { return _ip[0] ? NSAPI_IPv4 : NSAPI_UNSPEC; }
+
+    operator bool() const { return _ip[0] != '\0'; }
+
+private:
+    char _ip[NSAPI_IP_SIZE];
+    uint16_t _port;
+};
+
+#endif // _HOST_SOCKET_ADDRESS_H_
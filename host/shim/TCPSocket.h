@@ -0,0 +1,67 @@
+#ifndef _HOST_TCP_SOCKET_H_
+#define _HOST_TCP_SOCKET_H_
+
+//
+// Host build stand-in for mbed's Socket/TCPSocket on top of BSD sockets.
+// Timeout semantics follow mbed: -1 blocks forever, 0 is non-blocking.
+// sigio() callbacks come from a poll thread, once each time a non-blocking
+// call would have blocked and the socket has since become ready.
+//
+
+#include "nsapi_types.h"
+#include "SocketAddress.h"
+#include "NetworkInterface.h"
+#include "Callback.h"
+
+class Socket {
+public:
+    virtual ~Socket();
+
+    nsapi_error_t open(NetworkInterface *iface);
+    nsapi_error_t close();
+
+    void set_blocking(bool blocking) { _timeout = blocking ? -1 : 0; }
+    void set_timeout(int timeout) { _timeout = timeout; }
+    void sigio(mbed::Callback<void()> func);
+    void attach(mbed::Callback<void()> func) { sigio(func); }
+
+    // Host-only: the underlying descriptor (-1 when closed).
+    int fd() const { return _fd; }
+
+protected:
+    Socket() : _iface(0), _fd(-1), _timeout(-1), _want_read(false), _want_write(false) {}
+
+    // Waits for the descriptor to become readable/writable within _timeout.
+    nsapi_error_t wait_ready(bool for_write);
+
+    // Asks the poll thread for a sigio() once the descriptor is ready.
+    void arm(bool for_write);
+
+    NetworkInterface *_iface;
+    int _fd;
+    int _timeout;
+    mbed::Callback<void()> _event;
+
+public:
+    // Host-only, for the poll thread.
+    void notify() { _event(); }
+    volatile bool _want_read;
+    volatile bool _want_write;
+};
+
+class TCPSocket : public Socket {
+public:
+    TCPSocket() : _connecting(false) {}
+    template <typename S>
+    TCPSocket(S *iface) : _connecting(false) { open(iface); }
+
+    nsapi_error_t connect(const char *host, uint16_t port);
+    nsapi_error_t connect(const SocketAddress &address);
+    nsapi_size_or_error_t send(const void *data, nsapi_size_t size);
+    nsapi_size_or_error_t recv(void *data, nsapi_size_t size);
+
+private:
+    bool _connecting;
+};
+
+#endif // _HOST_TCP_SOCKET_H_
@@ -0,0 +1,10 @@
+#ifndef _HOST_WNC14A2A_INTERFACE_H_
+#define _HOST_WNC14A2A_INTERFACE_H_
+
+//
+// Host build: there is no modem, easy-connect.h provides the interface.
+//
+
+#include "easy-connect.h"
+
+#endif // _HOST_WNC14A2A_INTERFACE_H_
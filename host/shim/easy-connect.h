@@ -0,0 +1,38 @@
+#ifndef _HOST_EASY_CONNECT_H_
+#define _HOST_EASY_CONNECT_H_
+
+//
+// Host build stand-in for easy-connect: hands back a PosixInterface that
+// routes every hostname to the loopback httpbin server (host/httpbin_server.py).
+//
+//   HTTPX_HOST_ADDR   address every hostname resolves to (default 127.0.0.1)
+//   HTTPX_PORT_MAP    remote:local port pairs (default "80:8080,443:8443")
+//
+
+#include "mbed.h"
+
+class PosixInterface : public NetworkInterface {
+public:
+    PosixInterface();
+
+    virtual nsapi_error_t connect();
+    virtual nsapi_error_t disconnect();
+    virtual const char *get_ip_address();
+    virtual nsapi_error_t gethostbyname(const char *host, SocketAddress *address,
+                                        nsapi_version_t version = NSAPI_UNSPEC);
+    virtual uint16_t host_port(uint16_t port);
+
+private:
+    enum { MAX_PORT_MAP = 8 };
+
+    char _addr[NSAPI_IP_SIZE];
+    uint16_t _map_from[MAX_PORT_MAP];
+    uint16_t _map_to[MAX_PORT_MAP];
+    int _map_count;
+};
+
+NetworkInterface *easy_connect(bool log_messages = false);
+
+#define FIRMWARE_REV(iface)     "posix-host"
+
+#endif // _HOST_EASY_CONNECT_H_
@@ -0,0 +1,64 @@
+#ifndef _HOST_MBED_H_
+#define _HOST_MBED_H_
+
+//
+// Host build stand-in for mbed.h.  Pulls in the POSIX shims for the pieces of
+// mbed OS that the demos and mbed-http use, so source/main.cpp and the
+// scenarios can be built and benchmarked on a Linux box against the loopback
+// httpbin server.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "Callback.h"
+#include "rtos.h"
+#include "nsapi_types.h"
+#include "SocketAddress.h"
+#include "NetworkInterface.h"
+#include "TCPSocket.h"
+#include "mbed_events.h"
+
+#define MBED_ASSERT(expr)   assert(expr)
+
+// Compiler and memory barrier; CMSIS's data memory barrier on the target.
+#define __DMB()             __sync_synchronize()
+
+// Unbuffered, lock-free console output used on error paths.
+extern "C" void mbed_error_printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+// Free running microsecond counter, wraps like the hardware ticker.
+extern "C" uint32_t us_ticker_read(void);
+
+void wait(float seconds);
+void wait_ms(int ms);
+void wait_us(int us);
+
+namespace mbed {
+
+class Timer {
+public:
+    Timer() : _running(false), _start(0), _total(0) {}
+
+    void start();
+    void stop();
+    void reset();
+    float read() { return read_us() / 1000000.0f; }
+    int read_ms() { return (int)(read_high_resolution_us() / 1000); }
+    int read_us() { return (int)read_high_resolution_us(); }
+    uint64_t read_high_resolution_us();
+
+private:
+    bool _running;
+    uint64_t _start;
+    uint64_t _total;
+};
+
+} // namespace mbed
+
+using namespace mbed;
+
+#endif // _HOST_MBED_H_
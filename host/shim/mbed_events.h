@@ -0,0 +1,62 @@
+#ifndef _HOST_MBED_EVENTS_H_
+#define _HOST_MBED_EVENTS_H_
+
+//
+// Host build stand-in for mbed's events/EventQueue.h.  Only argument-less
+// events are supported: call() and call_in() with a Callback<void()> or an
+// (object, method) pair, cancel(), dispatch() and break_dispatch().
+//
+
+#include <stdint.h>
+#include <pthread.h>
+#include "Callback.h"
+
+#define EVENTS_EVENT_SIZE   (4 * sizeof(void *) + sizeof(mbed::Callback<void()>))
+
+namespace events {
+
+class EventQueue {
+public:
+    EventQueue(unsigned size = 32 * EVENTS_EVENT_SIZE, unsigned char *buffer = NULL);
+    ~EventQueue();
+
+    // Runs events for ms milliseconds, or until break_dispatch() when negative.
+    void dispatch(int ms = -1);
+    void dispatch_forever() { dispatch(-1); }
+    void break_dispatch();
+
+    unsigned tick();
+    void cancel(int id);
+
+    int call(mbed::Callback<void()> cb) { return post(0, cb); }
+    template <typename T, typename R>
+    int call(T *obj, R (T::*method)()) { return post(0, mbed::Callback<void()>(obj, method)); }
+
+    int call_in(int ms, mbed::Callback<void()> cb) { return post(ms, cb); }
+    template <typename T, typename R>
+    int call_in(int ms, T *obj, R (T::*method)()) { return post(ms, mbed::Callback<void()>(obj, method)); }
+
+private:
+    struct Event {
+        int id;
+        uint64_t due;
+        mbed::Callback<void()> cb;
+        Event *next;
+    };
+
+    int post(int ms, mbed::Callback<void()> cb);
+
+    pthread_mutex_t _mutex;
+    pthread_cond_t _cond;
+    Event *_events;             // sorted by due time
+    unsigned _capacity;
+    unsigned _count;
+    int _next_id;
+    bool _break;
+};
+
+} // namespace events
+
+using namespace events;
+
+#endif // _HOST_MBED_EVENTS_H_
@@ -0,0 +1,133 @@
+//
+// Host build: pthread backed EventQueue shim.
+//
+
+#include <time.h>
+#include <errno.h>
+#include "mbed.h"
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+events::EventQueue::EventQueue(unsigned size, unsigned char *buffer)
+    : _events(NULL), _capacity(size / EVENTS_EVENT_SIZE), _count(0), _next_id(1), _break(false)
+{
+    (void)buffer;
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&_mutex, NULL);
+}
+
+events::EventQueue::~EventQueue()
+{
+    while (_events) {
+        Event *e = _events;
+        _events = e->next;
+        delete e;
+    }
+    pthread_cond_destroy(&_cond);
+    pthread_mutex_destroy(&_mutex);
+}
+
+unsigned events::EventQueue::tick()
+{
+    return (unsigned)now_ms();
+}
+
+int events::EventQueue::post(int ms, mbed::Callback<void()> cb)
+{
+    pthread_mutex_lock(&_mutex);
+    if (_count >= _capacity) {
+        pthread_mutex_unlock(&_mutex);
+        return 0;
+    }
+    Event *e = new Event;
+    e->id = _next_id++;
+    if (_next_id <= 0) {
+        _next_id = 1;
+    }
+    e->due = now_ms() + (ms > 0 ? ms : 0);
+    e->cb = cb;
+
+    Event **at = &_events;
+    while (*at && (*at)->due <= e->due) {
+        at = &(*at)->next;
+    }
+    e->next = *at;
+    *at = e;
+    _count++;
+    pthread_cond_signal(&_cond);
+    pthread_mutex_unlock(&_mutex);
+    return e->id;
+}
+
+void events::EventQueue::cancel(int id)
+{
+    pthread_mutex_lock(&_mutex);
+    for (Event **at = &_events; *at; at = &(*at)->next) {
+        if ((*at)->id == id) {
+            Event *e = *at;
+            *at = e->next;
+            delete e;
+            _count--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&_mutex);
+}
+
+void events::EventQueue::break_dispatch()
+{
+    pthread_mutex_lock(&_mutex);
+    _break = true;
+    pthread_cond_signal(&_cond);
+    pthread_mutex_unlock(&_mutex);
+}
+
+void events::EventQueue::dispatch(int ms)
+{
+    uint64_t end = ms < 0 ? 0 : now_ms() + ms;
+
+    pthread_mutex_lock(&_mutex);
+    for (;;) {
+        if (_break) {
+            _break = false;
+            break;
+        }
+        uint64_t now = now_ms();
+        if (ms >= 0 && now >= end) {
+            break;
+        }
+        if (_events && _events->due <= now) {
+            Event *e = _events;
+            _events = e->next;
+            _count--;
+            pthread_mutex_unlock(&_mutex);
+            e->cb();
+            delete e;
+            pthread_mutex_lock(&_mutex);
+            continue;
+        }
+
+        uint64_t wake = _events ? _events->due : 0;
+        if (ms >= 0 && (wake == 0 || wake > end)) {
+            wake = end;
+        }
+        if (wake == 0) {
+            pthread_cond_wait(&_cond, &_mutex);
+        } else {
+            struct timespec deadline;
+            deadline.tv_sec = wake / 1000;
+            deadline.tv_nsec = (wake % 1000) * 1000000L;
+            pthread_cond_timedwait(&_cond, &_mutex, &deadline);
+        }
+    }
+    pthread_mutex_unlock(&_mutex);
+}
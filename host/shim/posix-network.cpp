@@ -0,0 +1,408 @@
+//
+// Host build: BSD socket backed NetworkInterface/TCPSocket shims and the
+// loopback PosixInterface handed out by easy_connect().
+//
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "mbed.h"
+#include "easy-connect.h"
+
+nsapi_error_t NetworkInterface::gethostbyname(const char *host, SocketAddress *address, nsapi_version_t version)
+{
+    (void)version;
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, NULL, &hints, &res) != 0 || !res) {
+        return NSAPI_ERROR_DNS_FAILURE;
+    }
+    char ip[NSAPI_IP_SIZE];
+    inet_ntop(AF_INET, &((struct sockaddr_in *)res->ai_addr)->sin_addr, ip, sizeof ip);
+    freeaddrinfo(res);
+    address->set_ip_address(ip);
+    return NSAPI_ERROR_OK;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// sigio: one thread polls every socket that has a sigio() callback and wants
+// to know when it becomes readable or writable.
+//
+#define MAX_WATCHED 32
+
+static Socket *watched[MAX_WATCHED];
+static pthread_mutex_t watch_mutex;
+static int wake_pipe[2] = { -1, -1 };
+
+static void *poll_thread(void *)
+{
+    for (;;) {
+        struct pollfd pfds[MAX_WATCHED + 1];
+        Socket *owners[MAX_WATCHED + 1];
+        int count = 1;
+
+        pfds[0].fd = wake_pipe[0];
+        pfds[0].events = POLLIN;
+        pthread_mutex_lock(&watch_mutex);
+        for (int ix = 0; ix < MAX_WATCHED; ix++) {
+            Socket *s = watched[ix];
+            if (s && s->fd() >= 0 && (s->_want_read || s->_want_write)) {
+                pfds[count].fd = s->fd();
+                pfds[count].events = (s->_want_read ? POLLIN : 0) | (s->_want_write ? POLLOUT : 0);
+                owners[count++] = s;
+            }
+        }
+        pthread_mutex_unlock(&watch_mutex);
+
+        for (int ix = 0; ix < count; ix++) {
+            pfds[ix].revents = 0;
+        }
+        if (::poll(pfds, count, -1) < 0) {
+            continue;
+        }
+        if (pfds[0].revents) {
+            char drain[16];
+            while (::read(wake_pipe[0], drain, sizeof drain) > 0) {
+            }
+        }
+
+        pthread_mutex_lock(&watch_mutex);
+        for (int ix = 1; ix < count; ix++) {
+            Socket *s = owners[ix];
+            bool registered = false;
+            for (int w = 0; w < MAX_WATCHED; w++) {
+                registered = registered || watched[w] == s;
+            }
+            if (!registered || s->fd() != pfds[ix].fd || !pfds[ix].revents) {
+                continue;
+            }
+            bool fire = false;
+            if (s->_want_read && (pfds[ix].revents & (POLLIN | POLLHUP | POLLERR))) {
+                s->_want_read = false;
+                fire = true;
+            }
+            if (s->_want_write && (pfds[ix].revents & (POLLOUT | POLLHUP | POLLERR))) {
+                s->_want_write = false;
+                fire = true;
+            }
+            if (fire) {
+                s->notify();
+            }
+        }
+        pthread_mutex_unlock(&watch_mutex);
+    }
+    return NULL;
+}
+
+static void watch_init(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&watch_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    if (pipe(wake_pipe) == 0) {
+        fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK);
+    }
+    pthread_t thread;
+    pthread_create(&thread, NULL, poll_thread, NULL);
+    pthread_detach(thread);
+}
+
+static pthread_once_t watch_once = PTHREAD_ONCE_INIT;
+
+void Socket::sigio(mbed::Callback<void()> func)
+{
+    pthread_once(&watch_once, watch_init);
+    pthread_mutex_lock(&watch_mutex);
+    _event = func;
+    int free_slot = -1;
+    for (int ix = 0; ix < MAX_WATCHED; ix++) {
+        if (watched[ix] == this) {
+            watched[ix] = NULL;
+        }
+        if (!watched[ix] && free_slot < 0) {
+            free_slot = ix;
+        }
+    }
+    if (func && free_slot >= 0) {
+        watched[free_slot] = this;
+    }
+    pthread_mutex_unlock(&watch_mutex);
+    if (func) {
+        arm(false);
+    }
+}
+
+void Socket::arm(bool for_write)
+{
+    if (!_event) {
+        return;
+    }
+    pthread_mutex_lock(&watch_mutex);
+    if (for_write) {
+        _want_write = true;
+    } else {
+        _want_read = true;
+    }
+    pthread_mutex_unlock(&watch_mutex);
+    char wake = 0;
+    (void)::write(wake_pipe[1], &wake, 1);
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Socket / TCPSocket
+//
+Socket::~Socket()
+{
+    if (_event) {
+        sigio(mbed::Callback<void()>());
+    }
+    close();
+}
+
+nsapi_error_t Socket::open(NetworkInterface *iface)
+{
+    if (_fd >= 0) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+    _fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (_fd < 0) {
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+    int one = 1;
+    setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) | O_NONBLOCK);
+    _iface = iface;
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t Socket::close()
+{
+    if (_event) {
+        pthread_mutex_lock(&watch_mutex);
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _want_read = _want_write = false;
+    if (_event) {
+        pthread_mutex_unlock(&watch_mutex);
+    }
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t Socket::wait_ready(bool for_write)
+{
+    struct pollfd pfd;
+    pfd.fd = _fd;
+    pfd.events = for_write ? POLLOUT : POLLIN;
+    pfd.revents = 0;
+    int rc;
+    do {
+        rc = ::poll(&pfd, 1, _timeout);
+    } while (rc < 0 && errno == EINTR);
+    if (rc < 0) {
+        return NSAPI_ERROR_DEVICE_ERROR;
+    }
+    return rc == 0 ? NSAPI_ERROR_WOULD_BLOCK : NSAPI_ERROR_OK;
+}
+
+nsapi_error_t TCPSocket::connect(const char *host, uint16_t port)
+{
+    if (!_iface) {
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+    SocketAddress address;
+    nsapi_error_t err = _iface->gethostbyname(host, &address);
+    if (err != NSAPI_ERROR_OK) {
+        return err;
+    }
+    address.set_port(port);
+    return connect(address);
+}
+
+nsapi_error_t TCPSocket::connect(const SocketAddress &address)
+{
+    if (_fd < 0) {
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+    bool started = !_connecting;
+    if (!_connecting) {
+        struct sockaddr_in sa;
+        memset(&sa, 0, sizeof sa);
+        sa.sin_family = AF_INET;
+        sa.sin_port = htons(_iface->host_port(address.get_port()));
+        if (!address.get_ip_address() || inet_pton(AF_INET, address.get_ip_address(), &sa.sin_addr) != 1) {
+            return NSAPI_ERROR_PARAMETER;
+        }
+        if (::connect(_fd, (struct sockaddr *)&sa, sizeof sa) == 0) {
+            return NSAPI_ERROR_OK;
+        }
+        if (errno != EINPROGRESS) {
+            return errno == ECONNREFUSED ? NSAPI_ERROR_NO_CONNECTION : NSAPI_ERROR_DEVICE_ERROR;
+        }
+        _connecting = true;
+    }
+
+    // Non-blocking sockets report progress the way mbed's TCPSocket does.
+    nsapi_error_t err = wait_ready(true);
+    if (err == NSAPI_ERROR_WOULD_BLOCK) {
+        if (_timeout != 0) {
+            return NSAPI_ERROR_CONNECTION_TIMEOUT;
+        }
+        arm(true);
+        return started ? NSAPI_ERROR_IN_PROGRESS : NSAPI_ERROR_ALREADY;
+    }
+    _connecting = false;
+    int so_error = 0;
+    socklen_t len = sizeof so_error;
+    if (err != NSAPI_ERROR_OK || getsockopt(_fd, SOL_SOCKET, SO_ERROR, &so_error, &len) != 0) {
+        return NSAPI_ERROR_DEVICE_ERROR;
+    }
+    if (so_error != 0) {
+        return so_error == ECONNREFUSED ? NSAPI_ERROR_NO_CONNECTION : NSAPI_ERROR_DEVICE_ERROR;
+    }
+    return _timeout == 0 ? NSAPI_ERROR_IS_CONNECTED : NSAPI_ERROR_OK;
+}
+
+nsapi_size_or_error_t TCPSocket::send(const void *data, nsapi_size_t size)
+{
+    if (_fd < 0) {
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+    nsapi_size_t sent = 0;
+    while (sent < size) {
+        nsapi_error_t err = wait_ready(true);
+        if (err != NSAPI_ERROR_OK) {
+            if (err == NSAPI_ERROR_WOULD_BLOCK) {
+                arm(true);
+            }
+            return sent ? (nsapi_size_or_error_t)sent : err;
+        }
+        ssize_t n = ::send(_fd, (const char *)data + sent, size - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                continue;
+            }
+            return sent ? (nsapi_size_or_error_t)sent : NSAPI_ERROR_CONNECTION_LOST;
+        }
+        sent += n;
+        if (_timeout == 0) {
+            break;
+        }
+    }
+    return sent;
+}
+
+nsapi_size_or_error_t TCPSocket::recv(void *data, nsapi_size_t size)
+{
+    if (_fd < 0) {
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+    for (;;) {
+        nsapi_error_t err = wait_ready(false);
+        if (err != NSAPI_ERROR_OK) {
+            if (err == NSAPI_ERROR_WOULD_BLOCK) {
+                arm(false);
+            }
+            return err;
+        }
+        ssize_t n = ::recv(_fd, data, size, MSG_DONTWAIT);
+        if (n >= 0) {
+            arm(false);
+            return n;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            if (_timeout == 0) {
+                arm(false);
+                return NSAPI_ERROR_WOULD_BLOCK;
+            }
+            continue;
+        }
+        return NSAPI_ERROR_CONNECTION_LOST;
+    }
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// PosixInterface
+//
+PosixInterface::PosixInterface() : _map_count(0)
+{
+    const char *addr = getenv("HTTPX_HOST_ADDR");
+    strncpy(_addr, addr ? addr : "127.0.0.1", sizeof _addr - 1);
+    _addr[sizeof _addr - 1] = '\0';
+
+    const char *map = getenv("HTTPX_PORT_MAP");
+    if (!map) {
+        map = "80:8080,443:8443";
+    }
+    while (*map && _map_count < MAX_PORT_MAP) {
+        unsigned from, to;
+        if (sscanf(map, "%u:%u", &from, &to) == 2) {
+            _map_from[_map_count] = (uint16_t)from;
+            _map_to[_map_count] = (uint16_t)to;
+            _map_count++;
+        }
+        map = strchr(map, ',');
+        if (!map) {
+            break;
+        }
+        map++;
+    }
+}
+
+nsapi_error_t PosixInterface::connect()
+{
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t PosixInterface::disconnect()
+{
+    return NSAPI_ERROR_OK;
+}
+
+const char *PosixInterface::get_ip_address()
+{
+    return _addr;
+}
+
+nsapi_error_t PosixInterface::gethostbyname(const char *host, SocketAddress *address, nsapi_version_t version)
+{
+    (void)host; (void)version;
+    address->set_ip_address(_addr);
+    return NSAPI_ERROR_OK;
+}
+
+uint16_t PosixInterface::host_port(uint16_t port)
+{
+    for (int i = 0; i < _map_count; i++) {
+        if (_map_from[i] == port) {
+            return _map_to[i];
+        }
+    }
+    return port;
+}
+
+NetworkInterface *easy_connect(bool log_messages)
+{
+    static PosixInterface iface;
+
+    if (log_messages) {
+        printf("[EasyConnect] Using POSIX sockets (host build)\n");
+        printf("[EasyConnect] Connected to Network successfully\n");
+        printf("[EasyConnect] IP address %s\n", iface.get_ip_address());
+    }
+    return &iface;
+}
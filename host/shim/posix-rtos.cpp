@@ -0,0 +1,236 @@
+//
+// Host build: pthread/clock_gettime backed rtos and timing shims.
+//
+
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include "mbed.h"
+
+static uint64_t monotonic_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+
+extern "C" uint32_t us_ticker_read(void)
+{
+    return (uint32_t)monotonic_us();
+}
+
+uint32_t osKernelGetTickCount(void)
+{
+    return (uint32_t)(monotonic_us() / 1000);
+}
+
+extern "C" void mbed_error_printf(const char *format, ...)
+{
+    char buffer[128];
+    va_list args;
+    va_start(args, format);
+    int size = vsnprintf(buffer, sizeof buffer, format, args);
+    va_end(args);
+    if (size > 0) {
+        (void)::write(STDOUT_FILENO, buffer, size < (int)sizeof buffer ? size : sizeof buffer - 1);
+    }
+}
+
+void wait(float seconds)
+{
+    wait_us((int)(seconds * 1000000.0f));
+}
+
+void wait_ms(int ms)
+{
+    wait_us(ms * 1000);
+}
+
+void wait_us(int us)
+{
+    struct timespec ts;
+    ts.tv_sec = us / 1000000;
+    ts.tv_nsec = (us % 1000000) * 1000L;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+        ;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// mbed::Timer
+//
+void mbed::Timer::start()
+{
+    if (!_running) {
+        _start = monotonic_us();
+        _running = true;
+    }
+}
+
+void mbed::Timer::stop()
+{
+    if (_running) {
+        _total += monotonic_us() - _start;
+        _running = false;
+    }
+}
+
+void mbed::Timer::reset()
+{
+    _total = 0;
+    _start = monotonic_us();
+}
+
+uint64_t mbed::Timer::read_high_resolution_us()
+{
+    return _total + (_running ? monotonic_us() - _start : 0);
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// rtos::Thread
+//
+// The stack size asked for on the target is far too small for glibc, so
+// host threads get a stack of their own this big, painted like RTX paints
+// thread stacks so max_stack() can find the high-water mark.
+#define HOST_STACK_SIZE     (1024 * 1024)
+#define STACK_PATTERN       0xE25A2EA5U
+
+rtos::Thread::Thread(osPriority priority, uint32_t stack_size, unsigned char *stack_mem, const char *name)
+    : _started(false), _stack_size(stack_size), _stack(NULL)
+{
+    (void)priority; (void)stack_mem; (void)name;
+}
+
+rtos::Thread::~Thread()
+{
+    join();
+    free(_stack);
+}
+
+uint32_t rtos::Thread::max_stack()
+{
+    if (!_stack) {
+        return 0;
+    }
+    // Stacks grow down, so untouched words are at the low end.
+    size_t untouched = 0;
+    while (untouched < HOST_STACK_SIZE / 4 && _stack[untouched] == STACK_PATTERN) {
+        untouched++;
+    }
+    return HOST_STACK_SIZE - untouched * 4;
+}
+
+void *rtos::Thread::entry(void *self)
+{
+    static_cast<Thread*>(self)->_task.call();
+    return NULL;
+}
+
+osStatus rtos::Thread::start(mbed::Callback<void()> task)
+{
+    if (_started) {
+        return -1;
+    }
+    _task = task;
+    if (!_stack) {
+        _stack = static_cast<uint32_t *>(malloc(HOST_STACK_SIZE));
+        if (!_stack) {
+            return -1;
+        }
+    }
+    for (size_t ix = 0; ix < HOST_STACK_SIZE / 4; ix++) {
+        _stack[ix] = STACK_PATTERN;
+    }
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, _stack, HOST_STACK_SIZE);
+    int ret = pthread_create(&_thread, &attr, &Thread::entry, this);
+    pthread_attr_destroy(&attr);
+    if (ret != 0) {
+        return -1;
+    }
+    _started = true;
+    return osOK;
+}
+
+osStatus rtos::Thread::join()
+{
+    if (_started) {
+        pthread_join(_thread, NULL);
+        _started = false;
+    }
+    return osOK;
+}
+
+osStatus rtos::Thread::wait(uint32_t millisec)
+{
+    if (millisec == osWaitForever) {
+        for (;;) {
+            pause();
+        }
+    }
+    wait_ms(millisec);
+    return osOK;
+}
+
+osStatus rtos::Thread::yield()
+{
+    sched_yield();
+    return osOK;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// rtos::Semaphore
+//
+rtos::Semaphore::Semaphore(int32_t count) : _count(count)
+{
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_cond, NULL);
+}
+
+rtos::Semaphore::~Semaphore()
+{
+    pthread_cond_destroy(&_cond);
+    pthread_mutex_destroy(&_mutex);
+}
+
+int32_t rtos::Semaphore::wait(uint32_t millisec)
+{
+    pthread_mutex_lock(&_mutex);
+    if (millisec == osWaitForever) {
+        while (_count == 0) {
+            pthread_cond_wait(&_cond, &_mutex);
+        }
+    } else {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += millisec / 1000;
+        deadline.tv_nsec += (millisec % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (_count == 0) {
+            if (pthread_cond_timedwait(&_cond, &_mutex, &deadline) == ETIMEDOUT) {
+                break;
+            }
+        }
+    }
+    int32_t tokens = _count;
+    if (_count > 0) {
+        _count--;
+    }
+    pthread_mutex_unlock(&_mutex);
+    return tokens;
+}
+
+osStatus rtos::Semaphore::release()
+{
+    pthread_mutex_lock(&_mutex);
+    _count++;
+    pthread_cond_signal(&_cond);
+    pthread_mutex_unlock(&_mutex);
+    return osOK;
+}
@@ -0,0 +1,92 @@
+#ifndef _HOST_RTOS_H_
+#define _HOST_RTOS_H_
+
+//
+// Host build stand-in for the parts of mbed's rtos/ used by the demos,
+// implemented over pthreads.
+//
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "Callback.h"
+
+typedef int32_t osStatus;
+#define osOK                0
+#define osErrorTimeout      (-2)
+#define osWaitForever       0xFFFFFFFFU
+
+enum osPriority {
+    osPriorityIdle          = 1,
+    osPriorityLow           = 8,
+    osPriorityBelowNormal   = 16,
+    osPriorityNormal        = 24,
+    osPriorityAboveNormal   = 32,
+    osPriorityHigh          = 40,
+    osPriorityRealtime      = 48,
+};
+
+// 1 ms kernel tick, as configured on the K64F.
+uint32_t osKernelGetTickCount(void);
+
+namespace rtos {
+
+class Thread {
+public:
+    Thread(osPriority priority = osPriorityNormal, uint32_t stack_size = 0,
+           unsigned char *stack_mem = NULL, const char *name = NULL);
+    ~Thread();
+
+    osStatus start(mbed::Callback<void()> task);
+    osStatus join();
+    uint32_t stack_size() const { return _stack_size; }
+
+    // Deepest the thread's stack has been, found from the fill pattern left
+    // in the stack the shim gives each thread.  Valid while it runs.
+    uint32_t max_stack();
+
+    static osStatus wait(uint32_t millisec);
+    static osStatus yield();
+
+private:
+    static void *entry(void *self);
+
+    mbed::Callback<void()> _task;
+    pthread_t _thread;
+    bool _started;
+    uint32_t _stack_size;
+    uint32_t *_stack;
+};
+
+class Mutex {
+public:
+    Mutex() { pthread_mutex_init(&_mutex, NULL); }
+    ~Mutex() { pthread_mutex_destroy(&_mutex); }
+    osStatus lock(uint32_t millisec = osWaitForever) { (void)millisec; pthread_mutex_lock(&_mutex); return osOK; }
+    bool trylock() { return pthread_mutex_trylock(&_mutex) == 0; }
+    osStatus unlock() { pthread_mutex_unlock(&_mutex); return osOK; }
+
+private:
+    pthread_mutex_t _mutex;
+};
+
+class Semaphore {
+public:
+    Semaphore(int32_t count = 0);
+    ~Semaphore();
+
+    // Returns the number of available tokens before the call, 0 on timeout.
+    int32_t wait(uint32_t millisec = osWaitForever);
+    osStatus release();
+
+private:
+    pthread_mutex_t _mutex;
+    pthread_cond_t _cond;
+    int32_t _count;
+};
+
+} // namespace rtos
+
+using namespace rtos;
+
+#endif // _HOST_RTOS_H_
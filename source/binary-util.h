@@ -0,0 +1,66 @@
+#ifndef _BINARY_UTIL_H_
+#define _BINARY_UTIL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mbedtls/version.h"
+
+//
+// Helpers shared by the modules that lay records out in flash or in binary
+// exports (http-cache, range-download, telemetry, http-trace, modem-trace)
+// and that hash with mbedTLS (http-sink, range-download).  Internal: not
+// part of any module's API.
+//
+
+// FNV-1a, 32 bits: a cheap check of a record or key of a URL.
+inline uint32_t fnv1a(const void *data, size_t size)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    uint32_t hash = 2166136261u;
+    while (size--) {
+        hash = (hash ^ *p++) * 16777619u;
+    }
+    return hash;
+}
+
+inline uint32_t get_le32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+inline void put_le32(uint8_t *p, uint32_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+// Little-endian writers for binary exports; they return the byte after.
+inline char *put16(char *p, uint16_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    return p + 2;
+}
+
+inline char *put32(char *p, uint32_t value)
+{
+    return put16(put16(p, value), value >> 16);
+}
+
+//
+// mbedTLS 2.7 renamed the SHA-256 calls to report errors; the old names are
+// deprecated from then on.
+//
+#if defined(MBEDTLS_VERSION_NUMBER) && MBEDTLS_VERSION_NUMBER >= 0x02070000
+#define sha256_starts   mbedtls_sha256_starts_ret
+#define sha256_update   mbedtls_sha256_update_ret
+#define sha256_finish   mbedtls_sha256_finish_ret
+#else
+#define sha256_starts   mbedtls_sha256_starts
+#define sha256_update   mbedtls_sha256_update
+#define sha256_finish   mbedtls_sha256_finish
+#endif
+
+#endif // _BINARY_UTIL_H_
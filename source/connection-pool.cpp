@@ -0,0 +1,480 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License"); 
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, 
+   software distributed under the License is distributed on an 
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, 
+   either express or implied. See the License for the specific 
+   language governing permissions and limitations under the License.
+
+    @file          connection-pool.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <strings.h>
+#include "connection-pool.h"
+#include "http-url.h"
+#include "http-header.h"
+#include "http-client.h"
+#include "dns-cache.h"
+
+ConnectionPool::ConnectionPool(NetworkInterface *net, int idle_timeout_ms)
+    : _net(net), _idle_timeout_ms(idle_timeout_ms)
+{
+    memset(_slots, 0, sizeof(_slots));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    for (int i = 0; i < MBED_CONF_APP_POOL_MAX_CONNECTIONS; i++) {
+        if (_slots[i].socket) {
+            dispose(drop(_slots[i]));
+        }
+    }
+}
+
+//
+// Empties the slot, with the pool's lock held, and returns its socket for
+// dispose() to close once the lock is released: on the WNC a close is an AT
+// command round trip, which other threads should not wait behind.
+//
+TCPSocket *ConnectionPool::drop(Slot &slot)
+{
+    TCPSocket *socket = slot.socket;
+    slot.socket = NULL;
+    slot.in_use = false;
+    return socket;
+}
+
+void ConnectionPool::dispose(TCPSocket *socket)
+{
+    if (socket) {
+        socket->close();
+        delete socket;
+    }
+}
+
+//
+// An idle socket within its timeout is still stale when a quick non-blocking
+// read shows the server has closed it (recv returns 0) or sent something we
+// were not waiting for.  On the WNC the read is an AT command round trip, so
+// it is done on a socket already claimed, without the pool's lock.
+//
+bool ConnectionPool::is_stale(TCPSocket *socket)
+{
+    char probe;
+    socket->set_blocking(false);
+    nsapi_size_or_error_t rc = socket->recv(&probe, 1);
+    socket->set_blocking(true);
+    return rc != NSAPI_ERROR_WOULD_BLOCK;
+}
+
+TCPSocket *ConnectionPool::acquire(const char *host, uint16_t port, bool *reused, nsapi_error_t *error)
+{
+    Slot *free_slot = NULL;
+    Slot *oldest = NULL;
+    Slot *candidate = NULL;
+    TCPSocket *dropped[MBED_CONF_APP_POOL_MAX_CONNECTIONS + 1];    // closed after unlocking
+    int drops = 0;
+
+    if (reused) {
+        *reused = false;
+    }
+
+    _mutex.lock();
+    uint32_t now = osKernelGetTickCount();
+    for (int i = 0; i < MBED_CONF_APP_POOL_MAX_CONNECTIONS; i++) {
+        Slot &slot = _slots[i];
+        if (slot.in_use) {
+            continue;
+        }
+        if (!slot.socket) {
+            if (!free_slot) {
+                free_slot = &slot;
+            }
+            continue;
+        }
+        if ((int32_t)(now - slot.last_used) >= slot.idle_timeout_ms) {
+            dropped[drops++] = drop(slot);
+            _stats.expired++;
+            if (!free_slot) {
+                free_slot = &slot;
+            }
+            continue;
+        }
+        if (slot.port == port && strcmp(slot.host, host) == 0) {
+            slot.in_use = true;         // claimed while it is probed
+            candidate = &slot;
+            break;
+        }
+        if (!oldest || (int32_t)(slot.last_used - oldest->last_used) < 0) {
+            oldest = &slot;
+        }
+    }
+
+    if (candidate) {
+        _mutex.unlock();
+        for (int i = 0; i < drops; i++) {
+            dispose(dropped[i]);
+        }
+        drops = 0;
+        bool stale = is_stale(candidate->socket);
+        _mutex.lock();
+        if (!stale) {
+            _stats.reuses++;
+            _mutex.unlock();
+            if (reused) {
+                *reused = true;
+            }
+            return candidate->socket;
+        }
+        // Closed by the server: connect again in its place.
+        dropped[drops++] = drop(*candidate);
+        _stats.stale++;
+        free_slot = candidate;
+    }
+
+    // No idle connection to this server: take a free slot, or evict the
+    // least recently used idle connection to some other server.
+    if (!free_slot && oldest) {
+        dropped[drops++] = drop(*oldest);
+        free_slot = oldest;
+    }
+    if (free_slot) {
+        free_slot->in_use = true;
+        strncpy(free_slot->host, host, sizeof(free_slot->host) - 1);
+        free_slot->host[sizeof(free_slot->host) - 1] = '\0';
+        free_slot->port = port;
+    }
+    _mutex.unlock();
+    for (int i = 0; i < drops; i++) {
+        dispose(dropped[i]);
+    }
+
+    if (!free_slot) {
+        if (error) {
+            *error = NSAPI_ERROR_NO_SOCKET;
+        }
+        return NULL;
+    }
+
+    // Connecting can take seconds over the modem, so do it outside the lock.
+    TCPSocket *socket = new TCPSocket();
+    nsapi_error_t result = socket->open(_net);
+    if (result == NSAPI_ERROR_OK) {
+        SocketAddress address;
+        result = dns_resolve(_net, host, &address);
+        if (result == NSAPI_ERROR_OK) {
+            address.set_port(port);
+            result = socket->connect(address);
+            if (result != NSAPI_ERROR_OK) {
+                dns_invalidate(host);
+            }
+        }
+    }
+
+    _mutex.lock();
+    if (result != NSAPI_ERROR_OK) {
+        delete socket;
+        socket = NULL;
+        free_slot->in_use = false;
+    } else {
+        free_slot->socket = socket;
+        _stats.connects++;
+    }
+    _mutex.unlock();
+
+    if (error) {
+        *error = result;
+    }
+    return socket;
+}
+
+void ConnectionPool::release(TCPSocket *socket, bool keep_alive, int idle_timeout_ms)
+{
+    TCPSocket *dropped = NULL;
+
+    _mutex.lock();
+    for (int i = 0; i < MBED_CONF_APP_POOL_MAX_CONNECTIONS; i++) {
+        Slot &slot = _slots[i];
+        if (slot.socket != socket) {
+            continue;
+        }
+        if (keep_alive) {
+            slot.in_use = false;
+            slot.last_used = osKernelGetTickCount();
+            slot.idle_timeout_ms = _idle_timeout_ms;
+            if (idle_timeout_ms >= 0 && idle_timeout_ms < _idle_timeout_ms) {
+                slot.idle_timeout_ms = idle_timeout_ms;
+            }
+        } else {
+            dropped = drop(slot);
+        }
+        break;
+    }
+    _mutex.unlock();
+    dispose(dropped);
+}
+
+void ConnectionPool::close_idle()
+{
+    TCPSocket *dropped[MBED_CONF_APP_POOL_MAX_CONNECTIONS];
+    int drops = 0;
+
+    _mutex.lock();
+    for (int i = 0; i < MBED_CONF_APP_POOL_MAX_CONNECTIONS; i++) {
+        if (_slots[i].socket && !_slots[i].in_use) {
+            dropped[drops++] = drop(_slots[i]);
+        }
+    }
+    _mutex.unlock();
+    for (int i = 0; i < drops; i++) {
+        dispose(dropped[i]);
+    }
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// PooledHttpRequest
+//
+
+// Case-insensitive strstr(), newlib does not provide strcasestr().
+static const char *find_token(const char *haystack, const char *needle)
+{
+    size_t len = strlen(needle);
+    for (; *haystack; haystack++) {
+        if (strncasecmp(haystack, needle, len) == 0) {
+            return haystack;
+        }
+    }
+    return NULL;
+}
+
+// The idle time a Keep-Alive header allows, or -1 when it names none.  We
+// give up one second early to stay clear of the server's timer.
+static int keep_alive_timeout(const char *value)
+{
+    const char *timeout = find_token(value, "timeout=");
+    if (!timeout) {
+        return -1;
+    }
+    int seconds = atoi(timeout + 8);
+    return seconds > 1 ? (seconds - 1) * 1000 : 0;
+}
+
+//
+// Looks at the response headers to decide whether the connection may be
+// reused: "Connection: close" ends it, "Keep-Alive: timeout=N" bounds the
+// idle time.
+//
+static bool response_allows_reuse(HttpResponse *res, int *idle_timeout_ms)
+{
+    *idle_timeout_ms = -1;
+    for (size_t ix = 0; ix < res->get_headers_length(); ix++) {
+        const char *field = res->get_headers_fields()[ix]->c_str();
+        const char *value = res->get_headers_values()[ix]->c_str();
+
+        HttpHeaderId id = http_header_intern(field);
+
+        if (id == HTTP_HEADER_CONNECTION && find_token(value, "close")) {
+            return false;
+        }
+        if (id == HTTP_HEADER_KEEP_ALIVE) {
+            *idle_timeout_ms = keep_alive_timeout(value);
+        }
+    }
+    return true;
+}
+
+PooledHttpRequest::PooledHttpRequest(ConnectionPool *pool, http_method method, const char *url,
+                                     Callback<void(const char *at, size_t length)> body_callback)
+    : _pool(pool), _method(method), _url(url), _body_callback(body_callback),
+      _socket(NULL), _request(NULL), _error(NSAPI_ERROR_OK), _keep_alive(false), _idle_timeout_ms(-1),
+      _received(false)
+{
+}
+
+PooledHttpRequest::~PooledHttpRequest()
+{
+    release(_keep_alive);
+}
+
+void PooledHttpRequest::set_header(std::string key, std::string value)
+{
+    _headers.push_back(std::make_pair(key, value));
+}
+
+void PooledHttpRequest::release(bool keep_alive)
+{
+    delete _request;
+    _request = NULL;
+    if (_socket) {
+        _pool->release(_socket, keep_alive, _idle_timeout_ms);
+        _socket = NULL;
+    }
+}
+
+HttpResponse *PooledHttpRequest::send_once(bool *reused, const void *body, nsapi_size_t body_size)
+{
+    HttpUrl url;
+    if (!http_url_parse(_url.c_str(), &url) || url.secure) {
+        _error = NSAPI_ERROR_PARAMETER;
+        return NULL;
+    }
+
+    _socket = _pool->acquire(url.host, url.port, reused, &_error);
+    if (!_socket) {
+        return NULL;
+    }
+
+    // Bodies pass through on_body() to note that the response has started.
+    _received = false;
+    Callback<void(const char *at, size_t length)> body_callback;
+    if (_body_callback) {
+        body_callback = callback(this, &PooledHttpRequest::on_body);
+    }
+    _request = new HttpRequest(_socket, _method, _url.c_str(), body_callback);
+    for (size_t ix = 0; ix < _headers.size(); ix++) {
+        _request->set_header(_headers[ix].first, _headers[ix].second);
+    }
+
+    HttpResponse *res = _request->send(body, body_size);
+    if (!res) {
+        _error = _request->get_error();
+    }
+    return res;
+}
+
+void PooledHttpRequest::on_body(const char *at, size_t length)
+{
+    _received = true;
+    _body_callback(at, length);
+}
+
+HttpResponse *PooledHttpRequest::send(const void *body, nsapi_size_t body_size)
+{
+    bool reused;
+
+    release(false);
+    _keep_alive = false;
+
+    HttpResponse *res = send_once(&reused, body, body_size);
+    if (!res && reused && http_method_idempotent(_method) && !_received) {
+        // The server may have dropped the kept-alive connection between our
+        // liveness probe and the request.  mbed-http does not tell whether
+        // any of the response arrived, but replaying an idempotent request
+        // is safe either way, as long as none of its body reached the
+        // caller's callback.  Others could have been acted on: they fail.
+        release(false);
+        _pool->_mutex.lock();
+        _pool->_stats.reconnects++;
+        _pool->_mutex.unlock();
+        res = send_once(&reused, body, body_size);
+    }
+
+    if (!res) {
+        release(false);
+        return NULL;
+    }
+    _keep_alive = response_allows_reuse(res, &_idle_timeout_ms);
+    return res;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// PooledTransport
+//
+PooledTransport::PooledTransport(ConnectionPool *pool, const char *host, uint16_t port)
+    : _pool(pool), _port(port), _socket(NULL)
+{
+    strncpy(_host, host, sizeof(_host) - 1);
+    _host[sizeof(_host) - 1] = '\0';
+}
+
+PooledTransport::~PooledTransport()
+{
+    release();
+}
+
+nsapi_error_t PooledTransport::connect()
+{
+    if (_socket) {
+        return NSAPI_ERROR_IS_CONNECTED;
+    }
+    bool reused = false;
+    nsapi_error_t result = NSAPI_ERROR_OK;
+    memset(&_timing, 0, sizeof(_timing));
+    uint32_t start = us_ticker_read();
+    _socket = _pool->acquire(_host, _port, &reused, &result);
+    if (!_socket) {
+        _timing.connect_us = us_ticker_read() - start;
+        count_connect(result);
+        return result;
+    }
+    // The liveness probe leaves the socket blocking without a timeout.
+    _socket->set_timeout(MBED_CONF_APP_HTTP_RECV_TIMEOUT_MS);
+    if (!reused) {
+        _timing.connect_us = us_ticker_read() - start;
+        count_tcp_open();
+        count_connect(result);
+    }
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_size_or_error_t PooledTransport::send(const void *data, nsapi_size_t size)
+{
+    if (!_socket) {
+        return NSAPI_ERROR_NO_CONNECTION;
+    }
+    nsapi_size_or_error_t result = _socket->send(data, size);
+    count_wire_sent(result);
+    count_app_sent(result);
+    if (result < 0 && result != NSAPI_ERROR_WOULD_BLOCK) {
+        close();
+    }
+    return result;
+}
+
+nsapi_size_or_error_t PooledTransport::recv(void *data, nsapi_size_t size)
+{
+    if (!_socket) {
+        return NSAPI_ERROR_NO_CONNECTION;
+    }
+    nsapi_size_or_error_t result = _socket->recv(data, size);
+    count_wire_received(result);
+    count_app_received(result);
+    if (result == 0 || (result < 0 && result != NSAPI_ERROR_WOULD_BLOCK)) {
+        close();
+    }
+    return result;
+}
+
+// The connection is done with: the pool closes the socket.
+nsapi_error_t PooledTransport::close()
+{
+    if (_socket) {
+        _pool->release(_socket, false);
+        _socket = NULL;
+        count_tcp_close();
+        traffic_flush();
+    }
+    return NSAPI_ERROR_OK;
+}
+
+void PooledTransport::release(HttpClientResponse *response)
+{
+    if (!_socket) {
+        return;
+    }
+    const char *keep_alive = response ? response->get_header(HTTP_HEADER_KEEP_ALIVE) : NULL;
+    _pool->release(_socket, true, keep_alive ? keep_alive_timeout(keep_alive) : -1);
+    _socket = NULL;
+    traffic_flush();
+}
@@ -0,0 +1,149 @@
+#ifndef _CONNECTION_POOL_H_
+#define _CONNECTION_POOL_H_
+
+#include <string>
+#include <vector>
+#include "mbed.h"
+#include "http_request.h"
+#include "http-transport.h"
+
+class HttpClientResponse;
+
+#ifndef MBED_CONF_APP_POOL_MAX_CONNECTIONS
+#define MBED_CONF_APP_POOL_MAX_CONNECTIONS  3
+#endif
+#ifndef MBED_CONF_APP_POOL_IDLE_TIMEOUT_MS
+#define MBED_CONF_APP_POOL_IDLE_TIMEOUT_MS  15000
+#endif
+
+#define POOL_MAX_HOST   64
+
+//
+// Keeps connected TCPSockets around, keyed by host:port, so consecutive
+// requests to the same server skip the TCP setup (one or more cellular round
+// trips).  Sockets are only handed back for reuse when the server agreed to
+// keep the connection alive, and are closed once they sit idle for longer
+// than the pool's or the server's (Keep-Alive: timeout=N) idle timeout.
+//
+class ConnectionPool {
+public:
+    struct Stats {
+        uint32_t connects;      // new TCP connections opened
+        uint32_t reuses;        // requests served on an already open socket
+        uint32_t reconnects;    // requests replayed after a reused socket failed them
+        uint32_t expired;       // idle sockets closed by the timeout
+        uint32_t stale;         // idle sockets the liveness probe found closed, replaced
+    };
+
+    ConnectionPool(NetworkInterface *net, int idle_timeout_ms = MBED_CONF_APP_POOL_IDLE_TIMEOUT_MS);
+    ~ConnectionPool();
+
+    // Returns a connected socket for host:port, or NULL with *error set.  An
+    // idle pooled socket is preferred; *reused tells the caller which it got.
+    TCPSocket *acquire(const char *host, uint16_t port, bool *reused = NULL, nsapi_error_t *error = NULL);
+
+    // Gives a socket obtained from acquire() back.  When keep_alive is false
+    // the socket is closed; idle_timeout_ms < 0 uses the pool default.
+    void release(TCPSocket *socket, bool keep_alive, int idle_timeout_ms = -1);
+
+    // Closes every idle socket, e.g. before the network goes down.
+    void close_idle();
+
+    const Stats &stats() const { return _stats; }
+
+private:
+    friend class PooledHttpRequest;
+
+    struct Slot {
+        TCPSocket *socket;
+        char host[POOL_MAX_HOST];
+        uint16_t port;
+        bool in_use;
+        uint32_t last_used;     // kernel tick (ms)
+        int idle_timeout_ms;
+    };
+
+    bool is_stale(TCPSocket *socket);
+    TCPSocket *drop(Slot &slot);
+    static void dispose(TCPSocket *socket);
+
+    NetworkInterface *_net;
+    int _idle_timeout_ms;
+    Slot _slots[MBED_CONF_APP_POOL_MAX_CONNECTIONS];
+    Stats _stats;
+    Mutex _mutex;
+};
+
+//
+// Drop-in for HttpRequest that borrows its socket from a ConnectionPool.  If a
+// request fails on a reused socket, which the server may have closed, it is
+// replayed once on a fresh connection when its method is idempotent and none
+// of its body was streamed yet; the rule HttpPipeline follows.  The socket
+// goes back to the pool when the PooledHttpRequest is deleted, reusable only
+// if the response allowed it.
+//
+class PooledHttpRequest {
+public:
+    PooledHttpRequest(ConnectionPool *pool, http_method method, const char *url,
+                      Callback<void(const char *at, size_t length)> body_callback = 0);
+    ~PooledHttpRequest();
+
+    void set_header(std::string key, std::string value);
+    HttpResponse *send(const void *body = NULL, nsapi_size_t body_size = 0);
+    nsapi_error_t get_error() { return _error; }
+
+private:
+    HttpResponse *send_once(bool *reused, const void *body, nsapi_size_t body_size);
+    void release(bool keep_alive);
+    void on_body(const char *at, size_t length);
+
+    ConnectionPool *_pool;
+    http_method _method;
+    std::string _url;
+    Callback<void(const char *at, size_t length)> _body_callback;
+    std::vector<std::pair<std::string, std::string> > _headers;
+
+    TCPSocket *_socket;
+    HttpRequest *_request;
+    nsapi_error_t _error;
+    bool _keep_alive;           // the response let us reuse the connection
+    int _idle_timeout_ms;       // from the server's Keep-Alive header, -1 if none
+    bool _received;             // body bytes reached _body_callback
+};
+
+//
+// HttpTransport over a socket borrowed from a ConnectionPool, so an
+// HttpClientRequest can share kept-alive connections the same way.
+// connect() takes an idle pooled connection to host:port, or dials a new
+// one; release() (or deleting the transport) gives it back, reusable only if
+// it is still connected: HttpClientRequest closes the transport when the
+// response does not keep the connection alive.  The pool probes an idle
+// socket before handing it out, but a request that still fails on it is
+// not replayed.
+//
+class PooledTransport : public HttpTransport {
+public:
+    PooledTransport(ConnectionPool *pool, const char *host, uint16_t port);
+    virtual ~PooledTransport();
+
+    virtual nsapi_error_t connect();
+    virtual nsapi_size_or_error_t send(const void *data, nsapi_size_t size);
+    virtual nsapi_size_or_error_t recv(void *data, nsapi_size_t size);
+    virtual nsapi_error_t close();
+    virtual bool connected() const { return _socket != NULL; }
+
+    virtual const char *host() const { return _host; }
+    virtual uint16_t port() const { return _port; }
+
+    // Gives the socket back to the pool.  The response's Keep-Alive timeout,
+    // when one is given, bounds how long it may sit idle.
+    void release(HttpClientResponse *response = NULL);
+
+private:
+    ConnectionPool *_pool;
+    char _host[HTTP_URL_MAX_HOST];
+    uint16_t _port;
+    TCPSocket *_socket;         // borrowed from _pool while connected
+};
+
+#endif // _CONNECTION_POOL_H_
@@ -0,0 +1,196 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          dns-cache.cpp 
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <string.h>
+#include "dns-cache.h"
+
+static DnsCache *active_cache;
+
+void dns_cache_enable(DnsCache *cache)
+{
+    active_cache = cache;
+}
+
+// Literal addresses need no lookup and are not worth a cache slot.
+static bool is_literal(const char *host)
+{
+    if (strchr(host, ':')) {
+        return true;    // IPv6
+    }
+    for (const char *p = host; *p; p++) {
+        if ((*p < '0' || *p > '9') && *p != '.') {
+            return false;
+        }
+    }
+    return true;
+}
+
+nsapi_error_t dns_resolve(NetworkInterface *net, const char *host, SocketAddress *address)
+{
+    if (is_literal(host)) {
+        return address->set_ip_address(host) ? NSAPI_ERROR_OK : NSAPI_ERROR_PARAMETER;
+    }
+    if (active_cache) {
+        return active_cache->gethostbyname(host, address);
+    }
+    return net->gethostbyname(host, address);
+}
+
+void dns_invalidate(const char *host)
+{
+    if (active_cache) {
+        active_cache->invalidate(host);
+    }
+}
+
+DnsCache::DnsCache(NetworkInterface *net, EventQueue *queue, uint32_t ttl_ms, uint32_t stale_ms)
+    : _net(net), _queue(queue), _ttl_ms(ttl_ms), _stale_ms(queue ? stale_ms : 0)
+{
+    memset(&_stats, 0, sizeof(_stats));
+    for (int i = 0; i < MBED_CONF_APP_DNS_CACHE_SIZE; i++) {
+        _entries[i].valid = false;
+        _entries[i].refreshing = false;
+    }
+}
+
+DnsCache::Entry *DnsCache::find(const char *host)
+{
+    for (int i = 0; i < MBED_CONF_APP_DNS_CACHE_SIZE; i++) {
+        Entry &entry = _entries[i];
+        if (entry.valid && strcmp(entry.host, host) == 0) {
+            return &entry;
+        }
+    }
+    return NULL;
+}
+
+DnsCache::Entry *DnsCache::store(const char *host, const SocketAddress &address)
+{
+    Entry *entry = find(host);
+    if (!entry) {
+        entry = &_entries[0];
+        for (int i = 0; i < MBED_CONF_APP_DNS_CACHE_SIZE; i++) {
+            if (!_entries[i].valid) {
+                entry = &_entries[i];
+                break;
+            }
+            if ((int32_t)(_entries[i].last_used - entry->last_used) < 0) {
+                entry = &_entries[i];
+            }
+        }
+        strncpy(entry->host, host, sizeof(entry->host) - 1);
+        entry->host[sizeof(entry->host) - 1] = '\0';
+        entry->valid = true;
+        entry->refreshing = false;
+        entry->last_used = osKernelGetTickCount();
+    }
+    entry->address = address;
+    entry->resolved = osKernelGetTickCount();
+    return entry;
+}
+
+nsapi_error_t DnsCache::gethostbyname(const char *host, SocketAddress *address)
+{
+    _mutex.lock();
+    Entry *entry = find(host);
+    if (entry) {
+        uint32_t now = osKernelGetTickCount();
+        uint32_t age = now - entry->resolved;
+        bool fresh = age < _ttl_ms;
+        if (fresh || age < _ttl_ms + _stale_ms) {
+            // Refresh in the background once three quarters of the TTL have
+            // gone, so a busy host never drops out of the cache.
+            if (_queue && !entry->refreshing && age >= _ttl_ms - _ttl_ms / 4) {
+                entry->refreshing = (_queue->call(this, &DnsCache::refresh) != 0);
+            }
+            if (fresh) {
+                _stats.hits++;
+            } else {
+                _stats.stale_hits++;
+            }
+            entry->last_used = now;
+            *address = entry->address;
+            _mutex.unlock();
+            return NSAPI_ERROR_OK;
+        }
+    }
+    _stats.misses++;
+    _mutex.unlock();
+
+    // The lookup can take seconds over the modem; don't hold the lock.
+    nsapi_error_t result = _net->gethostbyname(host, address);
+
+    _mutex.lock();
+    if (result == NSAPI_ERROR_OK) {
+        store(host, *address);
+    } else {
+        _stats.failures++;
+    }
+    _mutex.unlock();
+    return result;
+}
+
+//
+// Runs on the event queue: resolves every entry marked for refresh.  A
+// failed lookup leaves the old address in place until it expires.
+//
+void DnsCache::refresh()
+{
+    for (int i = 0; i < MBED_CONF_APP_DNS_CACHE_SIZE; i++) {
+        char host[HTTP_URL_MAX_HOST];
+
+        _mutex.lock();
+        bool wanted = _entries[i].valid && _entries[i].refreshing;
+        if (wanted) {
+            strcpy(host, _entries[i].host);
+        }
+        _mutex.unlock();
+        if (!wanted) {
+            continue;
+        }
+
+        SocketAddress address;
+        nsapi_error_t result = _net->gethostbyname(host, &address);
+
+        _mutex.lock();
+        _stats.prefetches++;
+        if (result == NSAPI_ERROR_OK) {
+            store(host, address);
+        } else {
+            _stats.failures++;
+        }
+        Entry *entry = find(host);
+        if (entry) {
+            entry->refreshing = false;
+        }
+        _mutex.unlock();
+    }
+}
+
+void DnsCache::invalidate(const char *host)
+{
+    _mutex.lock();
+    Entry *entry = find(host);
+    if (entry) {
+        entry->valid = false;
+    }
+    _mutex.unlock();
+}
@@ -0,0 +1,90 @@
+#ifndef _DNS_CACHE_H_
+#define _DNS_CACHE_H_
+
+#include "mbed.h"
+#include "http-url.h"
+
+#ifndef MBED_CONF_APP_DNS_CACHE_SIZE
+#define MBED_CONF_APP_DNS_CACHE_SIZE        4
+#endif
+
+#ifndef MBED_CONF_APP_DNS_CACHE_TTL_MS
+#define MBED_CONF_APP_DNS_CACHE_TTL_MS      300000
+#endif
+
+#ifndef MBED_CONF_APP_DNS_CACHE_STALE_MS
+#define MBED_CONF_APP_DNS_CACHE_STALE_MS    60000   // 0 turns stale-while-revalidate off
+#endif
+
+//
+// Remembers the addresses NetworkInterface::gethostbyname() returned so a
+// new connection to a known host does not cost a DNS round trip over the
+// modem.  mbed's gethostbyname() does not report the record's TTL, so every
+// entry lives for the same configured time-to-live.
+//
+// Given an EventQueue, the cache also refreshes entries in the background:
+// a lookup in the last quarter of an entry's life queues a prefetch, and
+// with a stale window set, a lookup after expiry (but within the window)
+// gets the old address at once while the refresh runs.  Without a queue,
+// expired entries are resolved again in the caller's thread.
+//
+// One cache is meant to be shared by every connection in the application;
+// install it with dns_cache_enable().  When it is full the least recently
+// used entry makes room.
+//
+class DnsCache {
+public:
+    struct Stats {
+        uint32_t hits;
+        uint32_t stale_hits;    // expired address served while refreshing
+        uint32_t misses;        // resolved in the caller's thread
+        uint32_t prefetches;    // resolved in the background
+        uint32_t failures;      // lookups that failed
+    };
+
+    DnsCache(NetworkInterface *net, EventQueue *queue = NULL,
+             uint32_t ttl_ms = MBED_CONF_APP_DNS_CACHE_TTL_MS,
+             uint32_t stale_ms = MBED_CONF_APP_DNS_CACHE_STALE_MS);
+
+    nsapi_error_t gethostbyname(const char *host, SocketAddress *address);
+
+    // Forgets host, e.g. when connecting to its cached address failed.
+    void invalidate(const char *host);
+
+    const Stats &stats() const { return _stats; }
+
+private:
+    struct Entry {
+        bool valid;
+        bool refreshing;        // a background refresh is queued or running
+        char host[HTTP_URL_MAX_HOST];
+        SocketAddress address;
+        uint32_t resolved;      // osKernelGetTickCount() when resolved
+        uint32_t last_used;
+    };
+
+    Entry *find(const char *host);
+    Entry *store(const char *host, const SocketAddress &address);
+    void refresh();
+
+    NetworkInterface *_net;
+    EventQueue *_queue;
+    uint32_t _ttl_ms;
+    uint32_t _stale_ms;
+    Entry _entries[MBED_CONF_APP_DNS_CACHE_SIZE];
+    Stats _stats;
+    Mutex _mutex;
+};
+
+// Transports resolve through cache from now on; NULL goes back to asking the
+// network interface every time.
+void dns_cache_enable(DnsCache *cache);
+
+// gethostbyname() through the installed cache, if any.  Literal IPv4 and
+// IPv6 addresses are returned without a lookup.
+nsapi_error_t dns_resolve(NetworkInterface *net, const char *host, SocketAddress *address);
+
+// Drops host from the installed cache, if any.
+void dns_invalidate(const char *host);
+
+#endif // _DNS_CACHE_H_
@@ -0,0 +1,438 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          http-async.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include "http-async.h"
+#include "dns-cache.h"
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// HttpAsyncSlot
+//
+HttpAsyncSlot::HttpAsyncSlot()
+    : _engine(NULL), _open(false), _connected(false), _port(0), _last_used(0), _state(IDLE),
+      _request(NULL), _scratch(0), _head(NULL), _head_size(0), _body(NULL), _body_size(0), _sent(0), _rx(new char[HTTP_CLIENT_RECV_BUFFER_SIZE]), _reused(false),
+      _retried(false), _timeout_id(0), _event_pending(false)
+{
+    _host[0] = '\0';
+}
+
+HttpAsyncSlot::~HttpAsyncSlot()
+{
+    close();
+    delete[] _rx;
+}
+
+// One non-blocking connect step; IN_PROGRESS/ALREADY mean call again on sigio.
+nsapi_error_t HttpAsyncSlot::connect()
+{
+    if (!_open) {
+        // Resolving blocks the queue, but with a DnsCache installed only
+        // the first request to a host waits for the network.
+        uint32_t start = us_ticker_read();
+        nsapi_error_t result = dns_resolve(_engine->_net, _host, &_address);
+        _request->_trace.dns_us = us_ticker_read() - start;
+        memset(&_timing, 0, sizeof(_timing));
+        _timing.dns_us = _request->_trace.dns_us;
+        if (result != NSAPI_ERROR_OK) {
+            return result;
+        }
+        _address.set_port(_port);
+        result = _socket.open(_engine->_net);
+        if (result != NSAPI_ERROR_OK) {
+            return result;
+        }
+        _open = true;
+        _socket.set_blocking(false);
+        _socket.sigio(callback(this, &HttpAsyncSlot::on_sigio));
+        _engine->_stats.connects++;
+    }
+    nsapi_error_t result = _socket.connect(_address);
+    if (result == NSAPI_ERROR_OK || result == NSAPI_ERROR_IS_CONNECTED) {
+        _connected = true;
+        return NSAPI_ERROR_OK;
+    }
+    if (result != NSAPI_ERROR_IN_PROGRESS && result != NSAPI_ERROR_ALREADY &&
+            result != NSAPI_ERROR_WOULD_BLOCK) {
+        dns_invalidate(_host);      // the host may have moved
+    }
+    return result;
+}
+
+nsapi_size_or_error_t HttpAsyncSlot::send(const void *data, nsapi_size_t size)
+{
+    nsapi_size_or_error_t result = _socket.send(data, size);
+    count_wire_sent(result);
+    count_app_sent(result);
+    return result;
+}
+
+nsapi_size_or_error_t HttpAsyncSlot::recv(void *data, nsapi_size_t size)
+{
+    nsapi_size_or_error_t result = _socket.recv(data, size);
+    count_wire_received(result);
+    count_app_received(result);
+    return result;
+}
+
+nsapi_error_t HttpAsyncSlot::close()
+{
+    if (_open) {
+        _socket.close();
+        _open = false;
+        if (_connected) {
+            _connected = false;
+            count_tcp_close();
+            traffic_flush();
+        }
+    }
+    return NSAPI_ERROR_OK;
+}
+
+void HttpAsyncSlot::start(HttpClientRequest *request, Callback<void(HttpClientRequest *)> done,
+                          const void *body, nsapi_size_t body_size, const HttpUrl &url)
+{
+    if (_connected && (strcmp(_host, url.host) != 0 || _port != url.port)) {
+        close();
+    }
+    strcpy(_host, url.host);
+    _port = url.port;
+
+    request->_transport = this;
+    request->_complete = false;
+    request->_started = false;
+    request->_error = NSAPI_ERROR_OK;
+    _request = request;
+    _done = done;
+
+    // The head, and the body if it is compressed, wait in the request's
+    // arena scratch until complete() gives it back.
+    _scratch = request->_arena.back_mark();
+    _head = static_cast<char *>(request->_arena.alloc_back(HTTP_CLIENT_RECV_BUFFER_SIZE));
+    _body = static_cast<const char *>(_head ? request->encode_body(body, &body_size) : body);
+    _body_size = body_size;
+    _head_size = _head ? request->build_head(_head, HTTP_CLIENT_RECV_BUFFER_SIZE, body_size) : 0;
+    if (_head_size == 0) {
+        // The head did not fit: fail now, nothing sent, the connection kept.
+        request->_complete = false;
+        if (request->_error == NSAPI_ERROR_OK) {
+            request->_error = NSAPI_ERROR_NO_MEMORY;
+        }
+        complete(request->_error);
+        return;
+    }
+    _sent = 0;
+    _reused = _connected;
+    _retried = false;
+    if (_reused) {
+        _engine->_stats.reuses++;
+    }
+    _state = _connected ? SENDING : CONNECTING;
+    _timeout_id = _engine->_queue->call_in(MBED_CONF_APP_ASYNC_TIMEOUT_MS, this, &HttpAsyncSlot::on_timeout);
+    process();
+}
+
+// Called by the network stack, possibly from another thread: only posts.
+void HttpAsyncSlot::on_sigio()
+{
+    if (!_event_pending) {
+        _event_pending = true;
+        if (_engine->_queue->call(this, &HttpAsyncSlot::process) == 0) {
+            _event_pending = false;
+        }
+    }
+}
+
+//
+// Advances the request as far as the socket allows without blocking.
+//
+void HttpAsyncSlot::process()
+{
+    nsapi_size_or_error_t result;
+
+    _event_pending = false;
+    switch (_state) {
+    case IDLE:
+        // An idle kept-alive connection only signals when the server hangs up.
+        if (_connected) {
+            char probe;
+            result = _socket.recv(&probe, 1);
+            if (result != NSAPI_ERROR_WOULD_BLOCK) {
+                close();
+            }
+        }
+        return;
+
+    case CONNECTING:
+        result = connect();
+        if (result == NSAPI_ERROR_IN_PROGRESS || result == NSAPI_ERROR_ALREADY ||
+                result == NSAPI_ERROR_WOULD_BLOCK) {
+            return;
+        }
+        if (result != NSAPI_ERROR_OK) {
+            count_connect(result);
+            failed(result);
+            return;
+        }
+        _request->_trace.connect_us = us_ticker_read() - _request->_trace.start_us -
+                                      _request->_trace.dns_us;
+        _request->_trace.flags = HTTP_TRACE_CONNECTED;
+        _timing.connect_us = _request->_trace.connect_us;
+        count_tcp_open();
+        count_connect(result);
+        _state = SENDING;
+        // fall through
+
+    case SENDING:
+        while (_sent < _head_size + _body_size) {
+            if (_sent < _head_size) {
+                result = send(_head + _sent, _head_size - _sent);
+            } else {
+                result = send(_body + _sent - _head_size, _head_size + _body_size - _sent);
+            }
+            if (result == NSAPI_ERROR_WOULD_BLOCK) {
+                return;
+            }
+            if (result < 0) {
+                failed(result);
+                return;
+            }
+            _sent += result;
+        }
+        _request->sent();
+        _state = RECEIVING;
+        _request->begin_response();
+        // fall through
+
+    case RECEIVING:
+        for (;;) {
+            result = recv(_rx, HTTP_CLIENT_RECV_BUFFER_SIZE);
+            if (result == NSAPI_ERROR_WOULD_BLOCK) {
+                return;
+            }
+            if (result < 0) {
+                failed(result);
+                return;
+            }
+            size_t parsed = _request->parse(_rx, result);
+            if (_request->_complete) {
+                complete(_request->end_response() ? NSAPI_ERROR_OK : _request->get_error());
+                return;
+            }
+            if (result == 0 || parsed != (size_t)result) {
+                failed(_request->_error != NSAPI_ERROR_OK ? _request->_error : NSAPI_ERROR_CONNECTION_LOST);
+                return;
+            }
+        }
+    }
+}
+
+void HttpAsyncSlot::on_timeout()
+{
+    _timeout_id = 0;
+    if (_state != IDLE) {
+        _retried = true;
+        failed(NSAPI_ERROR_CONNECTION_TIMEOUT);
+    }
+}
+
+//
+// A kept-alive connection the server had already dropped fails before any
+// of the response arrives: dial again and resend, once, if the method makes
+// that safe.  A POST may have been acted on even though no answer came.
+//
+void HttpAsyncSlot::failed(nsapi_error_t error)
+{
+    if (_reused && !_retried && !_request->_started && http_method_idempotent(_request->_method)) {
+        close();
+        _retried = true;
+        _reused = false;
+        _sent = 0;
+        _state = CONNECTING;
+        process();
+        return;
+    }
+    if (_state == RECEIVING) {
+        _request->_error = error;
+        _request->end_response();
+    } else {
+        _request->_complete = false;
+        _request->_error = error;
+        _request->trace_end();
+    }
+    complete(error);
+}
+
+void HttpAsyncSlot::complete(nsapi_error_t error)
+{
+    if (_timeout_id) {
+        _engine->_queue->cancel(_timeout_id);
+        _timeout_id = 0;
+    }
+    // An IDLE slot never sent anything, so its connection is still good.
+    if (error != NSAPI_ERROR_OK && _state != IDLE) {
+        close();
+    }
+    _state = IDLE;
+    _last_used = osKernelGetTickCount();
+
+    HttpClientRequest *request = _request;
+    Callback<void(HttpClientRequest *)> done = _done;
+    request->_arena.rewind_back(_scratch);
+    _request = NULL;
+    request->_transport = NULL;
+
+    _engine->finished(error == NSAPI_ERROR_OK);
+    if (done) {
+        done(request);
+    }
+    _engine->schedule();
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// HttpAsyncEngine
+//
+HttpAsyncEngine::HttpAsyncEngine(NetworkInterface *net, EventQueue *queue, int max_concurrent)
+    : _net(net), _queue(queue), _max_concurrent(max_concurrent), _head(0), _count(0), _active(0)
+{
+    if (_max_concurrent < 1 || _max_concurrent > MBED_CONF_APP_ASYNC_MAX_CONCURRENT) {
+        _max_concurrent = MBED_CONF_APP_ASYNC_MAX_CONCURRENT;
+    }
+    for (int ix = 0; ix < MBED_CONF_APP_ASYNC_MAX_CONCURRENT; ix++) {
+        _slots[ix]._engine = this;
+    }
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+HttpAsyncEngine::~HttpAsyncEngine()
+{
+    for (int ix = 0; ix < MBED_CONF_APP_ASYNC_MAX_CONCURRENT; ix++) {
+        if (_slots[ix]._timeout_id) {
+            _queue->cancel(_slots[ix]._timeout_id);
+        }
+        _slots[ix].close();
+    }
+}
+
+bool HttpAsyncEngine::submit(HttpClientRequest *request, Callback<void(HttpClientRequest *request)> done,
+                             const void *body, nsapi_size_t body_size)
+{
+    HttpUrl url;
+    if (!http_url_parse(request->get_url(), &url)) {
+        request->_error = NSAPI_ERROR_PARAMETER;
+        return false;
+    }
+    if (url.secure) {
+        request->_error = NSAPI_ERROR_UNSUPPORTED;
+        return false;
+    }
+
+    _mutex.lock();
+    if (_count == MBED_CONF_APP_ASYNC_QUEUE_DEPTH) {
+        _mutex.unlock();
+        request->_error = NSAPI_ERROR_NO_MEMORY;
+        return false;
+    }
+    Pending &pending = _pending[(_head + _count) % MBED_CONF_APP_ASYNC_QUEUE_DEPTH];
+    pending.request = request;
+    pending.done = done;
+    pending.body = body;
+    pending.body_size = body_size;
+    _count++;
+    _stats.submitted++;
+    _mutex.unlock();
+
+    _queue->call(this, &HttpAsyncEngine::schedule);
+    return true;
+}
+
+size_t HttpAsyncEngine::outstanding()
+{
+    _mutex.lock();
+    size_t count = _count + _active;
+    _mutex.unlock();
+    return count;
+}
+
+//
+// Prefers an idle slot already connected to the server, then a slot with no
+// connection, then the least recently used idle one.
+//
+HttpAsyncSlot *HttpAsyncEngine::pick(const HttpUrl &url)
+{
+    HttpAsyncSlot *unused = NULL;
+    HttpAsyncSlot *oldest = NULL;
+
+    for (int ix = 0; ix < _max_concurrent; ix++) {
+        HttpAsyncSlot *slot = &_slots[ix];
+        if (slot->_state != HttpAsyncSlot::IDLE) {
+            continue;
+        }
+        if (slot->_connected && slot->_port == url.port && strcmp(slot->_host, url.host) == 0) {
+            return slot;
+        }
+        if (!slot->_connected) {
+            unused = unused ? unused : slot;
+        } else if (!oldest || (int32_t)(slot->_last_used - oldest->_last_used) < 0) {
+            oldest = slot;
+        }
+    }
+    return unused ? unused : oldest;
+}
+
+// Starts queued requests on free slots; runs on the queue thread.
+void HttpAsyncEngine::schedule()
+{
+    for (;;) {
+        _mutex.lock();
+        if (_count == 0) {
+            _mutex.unlock();
+            return;
+        }
+        Pending next = _pending[_head];
+        HttpUrl url;
+        http_url_parse(next.request->get_url(), &url);
+        HttpAsyncSlot *slot = pick(url);
+        if (!slot) {
+            _mutex.unlock();
+            return;
+        }
+        _head = (_head + 1) % MBED_CONF_APP_ASYNC_QUEUE_DEPTH;
+        _count--;
+        _active++;
+        if (_active > _stats.peak_active) {
+            _stats.peak_active = _active;
+        }
+        _mutex.unlock();
+
+        slot->start(next.request, next.done, next.body, next.body_size, url);
+    }
+}
+
+void HttpAsyncEngine::finished(bool ok)
+{
+    _mutex.lock();
+    _active--;
+    if (ok) {
+        _stats.completed++;
+    } else {
+        _stats.failed++;
+    }
+    _mutex.unlock();
+}
@@ -0,0 +1,145 @@
+#ifndef _HTTP_ASYNC_H_
+#define _HTTP_ASYNC_H_
+
+#include "mbed.h"
+#include "http-client.h"
+
+#ifndef MBED_CONF_APP_ASYNC_MAX_CONCURRENT
+#define MBED_CONF_APP_ASYNC_MAX_CONCURRENT  3
+#endif
+
+#ifndef MBED_CONF_APP_ASYNC_QUEUE_DEPTH
+#define MBED_CONF_APP_ASYNC_QUEUE_DEPTH     8
+#endif
+
+#ifndef MBED_CONF_APP_ASYNC_TIMEOUT_MS
+#define MBED_CONF_APP_ASYNC_TIMEOUT_MS      30000
+#endif
+
+class HttpAsyncEngine;
+
+//
+// One modem socket of an HttpAsyncEngine and the request it is running.  It
+// is the request's HttpTransport, so HttpClientRequest can close it when the
+// server does not keep the connection alive.
+//
+class HttpAsyncSlot : public HttpTransport {
+public:
+    HttpAsyncSlot();
+    virtual ~HttpAsyncSlot();
+
+    virtual nsapi_error_t connect();
+    virtual nsapi_size_or_error_t send(const void *data, nsapi_size_t size);
+    virtual nsapi_size_or_error_t recv(void *data, nsapi_size_t size);
+    virtual nsapi_error_t close();
+    virtual bool connected() const { return _connected; }
+
+    virtual const char *host() const { return _host; }
+    virtual uint16_t port() const { return _port; }
+
+private:
+    friend class HttpAsyncEngine;
+
+    enum State { IDLE, CONNECTING, SENDING, RECEIVING };
+
+    void start(HttpClientRequest *request, Callback<void(HttpClientRequest *)> done,
+               const void *body, nsapi_size_t body_size, const HttpUrl &url);
+    void on_sigio();
+    void process();
+    void on_timeout();
+    void failed(nsapi_error_t error);
+    void complete(nsapi_error_t error);
+
+    HttpAsyncEngine *_engine;
+    TCPSocket _socket;
+    bool _open;
+    bool _connected;
+    char _host[HTTP_URL_MAX_HOST];
+    uint16_t _port;
+    SocketAddress _address;
+    uint32_t _last_used;
+
+    State _state;
+    HttpClientRequest *_request;
+    Callback<void(HttpClientRequest *)> _done;
+    size_t _scratch;            // request's arena back mark under the head
+    char *_head;                // in that scratch
+    size_t _head_size;
+    const char *_body;          // the caller's, or compressed into the scratch
+    nsapi_size_t _body_size;
+    size_t _sent;               // of the head, then the body
+    char *_rx;
+    bool _reused;
+    bool _retried;
+    int _timeout_id;
+    volatile bool _event_pending;
+};
+
+//
+// Runs many HTTP requests at once, up to one per modem socket, from a single
+// EventQueue thread.  Sockets are non-blocking and their sigio() callbacks
+// post work to the queue, so the thread only runs when a socket has
+// something to do and never sits idle through a round trip.  Connections
+// are kept alive and reused for the next request to the same server; a
+// reused connection that turns out to be dead is redialled once for an
+// idempotent method.  A request whose head cannot be built fails at once.
+//
+// Requests are HttpClientRequests made with a NULL transport (the engine
+// assigns a socket).  Only http:// URLs are supported: the TLS handshake in
+// TLSTransport is blocking.
+//
+class HttpAsyncEngine {
+public:
+    struct Stats {
+        uint32_t submitted;
+        uint32_t completed;
+        uint32_t failed;
+        uint32_t connects;
+        uint32_t reuses;
+        uint32_t peak_active;   // most requests in flight at once
+    };
+
+    // queue must be dispatched by the caller; every callback runs there.
+    HttpAsyncEngine(NetworkInterface *net, EventQueue *queue,
+                    int max_concurrent = MBED_CONF_APP_ASYNC_MAX_CONCURRENT);
+    ~HttpAsyncEngine();
+
+    // Queues request; done is called once it completes or fails (check
+    // request->get_response()/get_error()).  body must stay valid until
+    // then.  Safe to call from any thread.  False when the queue is full or
+    // the URL cannot be used, with the reason in request->get_error().
+    bool submit(HttpClientRequest *request, Callback<void(HttpClientRequest *request)> done,
+                const void *body = NULL, nsapi_size_t body_size = 0);
+
+    // Requests submitted and not yet completed.
+    size_t outstanding();
+
+    const Stats &stats() const { return _stats; }
+
+private:
+    friend class HttpAsyncSlot;
+
+    struct Pending {
+        HttpClientRequest *request;
+        Callback<void(HttpClientRequest *)> done;
+        const void *body;
+        nsapi_size_t body_size;
+    };
+
+    void schedule();
+    HttpAsyncSlot *pick(const HttpUrl &url);
+    void finished(bool ok);
+
+    NetworkInterface *_net;
+    EventQueue *_queue;
+    int _max_concurrent;
+    HttpAsyncSlot _slots[MBED_CONF_APP_ASYNC_MAX_CONCURRENT];
+    Pending _pending[MBED_CONF_APP_ASYNC_QUEUE_DEPTH];
+    size_t _head;
+    size_t _count;
+    size_t _active;
+    Mutex _mutex;
+    Stats _stats;
+};
+
+#endif // _HTTP_ASYNC_H_
@@ -0,0 +1,320 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          http-cache.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "http-cache.h"
+#include "http-client.h"
+#include "binary-util.h"
+
+//
+// An entry's header, little-endian, in the last program units of its slot:
+// magic, sequence, body length, the URL, ETag and Last-Modified (each NUL
+// padded) and an FNV-1a check of all that.
+//
+#define CACHE_MAGIC         0x31454348  // "HCE1"
+#define CACHE_URL           12
+#define CACHE_ETAG          (CACHE_URL + HTTP_CACHE_URL_SIZE)
+#define CACHE_MODIFIED      (CACHE_ETAG + HTTP_CACHE_VALIDATOR_SIZE)
+#define CACHE_CHECK         (CACHE_MODIFIED + HTTP_CACHE_VALIDATOR_SIZE)
+#define CACHE_HEADER        (CACHE_CHECK + 4)
+
+static HttpCache *active_cache;
+
+void http_cache_enable(HttpCache *cache)
+{
+    active_cache = cache;
+}
+
+HttpCache *http_cache()
+{
+    return active_cache;
+}
+
+static uint32_t round_up(uint32_t size, uint32_t unit)
+{
+    return (size + unit - 1) / unit * unit;
+}
+
+HttpCache::HttpCache(BlockDevice *bd, bd_addr_t start, bd_size_t size)
+    : _bd(bd), _start(start), _size(size), _slot_size(MBED_CONF_APP_HTTP_CACHE_SLOT_SIZE),
+      _header_size(0), _erase_size(0), _slots(0), _clock(1), _buffer(NULL), _pending(NULL),
+      _writer(bd, start, 0), _storing(-1)
+{
+    memset(_entries, 0, sizeof(_entries));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+HttpCache::~HttpCache()
+{
+    delete[] _buffer;
+    delete[] _pending;
+}
+
+int HttpCache::init()
+{
+    uint32_t unit = _bd->get_program_size();
+    if (_bd->get_read_size() > unit) {
+        unit = _bd->get_read_size();
+    }
+    _erase_size = _bd->get_erase_size();
+    _header_size = round_up(CACHE_HEADER, unit);
+    _slots = _size / _slot_size;
+    if (_slots > MBED_CONF_APP_HTTP_CACHE_ENTRIES) {
+        _slots = MBED_CONF_APP_HTTP_CACHE_ENTRIES;
+    }
+    if (_start % _erase_size != 0 || _slot_size % _erase_size != 0 || _slots == 0 ||
+            _header_size >= _slot_size) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    _mutex.lock();
+    delete[] _buffer;
+    delete[] _pending;
+    _buffer = new uint8_t[_header_size];
+    _pending = new uint8_t[_header_size];
+    _clock = 1;
+    int ret = 0;
+    for (size_t ix = 0; ix < _slots && ret == 0; ix++) {
+        Entry &entry = _entries[ix];
+        entry.valid = false;
+        ret = read_header(ix);
+        if (ret == 0 && get_le32(_buffer) == CACHE_MAGIC &&
+                get_le32(_buffer + CACHE_CHECK) == fnv1a(_buffer, CACHE_CHECK) &&
+                get_le32(_buffer + 8) <= capacity()) {
+            _buffer[CACHE_ETAG - 1] = '\0';
+            entry.url_hash = fnv1a(_buffer + CACHE_URL, strlen((char *)_buffer + CACHE_URL));
+            entry.sequence = entry.used = get_le32(_buffer + 4);
+            entry.length = get_le32(_buffer + 8);
+            entry.valid = true;
+            if (entry.sequence >= _clock) {
+                _clock = entry.sequence + 1;
+            }
+        }
+    }
+    _mutex.unlock();
+    return ret;
+}
+
+int HttpCache::clear()
+{
+    _mutex.lock();
+    int ret = 0;
+    for (size_t ix = 0; ix < _slots; ix++) {
+        if (_entries[ix].valid && (int)ix != _storing) {
+            _entries[ix].valid = false;
+            int error = _bd->erase(slot_addr(ix) + _slot_size - _erase_size, _erase_size);
+            ret = ret ? ret : error;
+        }
+    }
+    _mutex.unlock();
+    return ret;
+}
+
+size_t HttpCache::entries() const
+{
+    size_t count = 0;
+    for (size_t ix = 0; ix < _slots; ix++) {
+        count += _entries[ix].valid;
+    }
+    return count;
+}
+
+int HttpCache::read_header(int entry)
+{
+    return _bd->read(_buffer, slot_addr(entry) + _slot_size - _header_size, _header_size);
+}
+
+// Slot holding url, its header left in _buffer, or -1.
+int HttpCache::find(const char *url)
+{
+    size_t length = strlen(url);
+    if (length >= HTTP_CACHE_URL_SIZE) {
+        return -1;
+    }
+    uint32_t hash = fnv1a(url, length);
+    for (size_t ix = 0; ix < _slots; ix++) {
+        if (_entries[ix].valid && _entries[ix].url_hash == hash && (int)ix != _storing &&
+                read_header(ix) == 0 && strcmp((char *)_buffer + CACHE_URL, url) == 0) {
+            return ix;
+        }
+    }
+    return -1;
+}
+
+size_t HttpCache::validators(const char *url, char *buffer, size_t size, int *entry, uint32_t *sequence)
+{
+    size_t length = 0;
+
+    _mutex.lock();
+    *entry = find(url);
+    if (*entry >= 0) {
+        const char *etag = (char *)_buffer + CACHE_ETAG;
+        const char *modified = (char *)_buffer + CACHE_MODIFIED;
+        int n = 0;
+        if (etag[0]) {
+            n = snprintf(buffer, size, "If-None-Match: %s\r\n", etag);
+        }
+        if (modified[0] && n >= 0 && (size_t)n < size) {
+            int m = snprintf(buffer + n, size - n, "If-Modified-Since: %s\r\n", modified);
+            n = m < 0 ? m : n + m;
+        }
+        if (n > 0 && (size_t)n < size) {
+            length = n;
+            *sequence = _entries[*entry].sequence;
+        } else {
+            *entry = -1;
+        }
+    }
+    _mutex.unlock();
+    return length;
+}
+
+//
+// Starts writing a 200 to flash, if it can be revalidated and may fit.  The
+// old entry of its URL is invalidated first, by erasing the erase block its
+// header is in, so a reset mid-store cannot pair the old header with part
+// of the new body.
+//
+bool HttpCache::store_begin(const char *url, HttpClientResponse *response)
+{
+    const char *etag = response->get_header(HTTP_HEADER_ETAG);
+    const char *modified = response->get_header(HTTP_HEADER_LAST_MODIFIED);
+    const char *control = response->get_header(HTTP_HEADER_CACHE_CONTROL);
+    const char *length = response->get_header(HTTP_HEADER_CONTENT_LENGTH);
+    if (etag && strlen(etag) >= HTTP_CACHE_VALIDATOR_SIZE) {
+        etag = NULL;
+    }
+    if (modified && strlen(modified) >= HTTP_CACHE_VALIDATOR_SIZE) {
+        modified = NULL;
+    }
+    if ((!etag && !modified) || (control && strstr(control, "no-store")) ||
+            (length && strtoul(length, NULL, 10) > capacity()) || strlen(url) >= HTTP_CACHE_URL_SIZE) {
+        _stats.uncacheable++;
+        return false;
+    }
+
+    _mutex.lock();
+    int slot = -1;
+    if (_storing < 0 && _buffer) {
+        slot = find(url);
+        if (slot < 0) {
+            // An empty slot, or else the least recently used.
+            for (size_t ix = 0; ix < _slots; ix++) {
+                if (!_entries[ix].valid) {
+                    slot = ix;
+                    break;
+                }
+                if (slot < 0 || _entries[ix].used < _entries[slot].used) {
+                    slot = ix;
+                }
+            }
+            if (_entries[slot].valid) {
+                _stats.evictions++;
+            }
+        }
+        _entries[slot].valid = false;
+        if (_bd->erase(slot_addr(slot) + _slot_size - _erase_size, _erase_size) != 0) {
+            slot = -1;
+        }
+    }
+    if (slot >= 0) {
+        _storing = slot;
+        memset(_pending, 0xFF, _header_size);
+        memset(_pending + CACHE_URL, 0, CACHE_CHECK - CACHE_URL);
+        strcpy((char *)_pending + CACHE_URL, url);
+        if (etag) {
+            strcpy((char *)_pending + CACHE_ETAG, etag);
+        }
+        if (modified) {
+            strcpy((char *)_pending + CACHE_MODIFIED, modified);
+        }
+        _writer.restart(slot_addr(slot), capacity());
+    }
+    _mutex.unlock();
+    return slot >= 0;
+}
+
+int HttpCache::store_write(const void *data, size_t size)
+{
+    _mutex.lock();
+    int ret = _writer.write(data, size);
+    if (ret < 0) {
+        if (ret == NSAPI_ERROR_NO_MEMORY) {
+            _stats.uncacheable++;       // longer than Content-Length promised, or none was given
+        }
+        _storing = -1;
+    }
+    _mutex.unlock();
+    return ret;
+}
+
+// Programs the header of a complete body, which makes the entry valid.
+void HttpCache::store_end(bool complete)
+{
+    _mutex.lock();
+    int slot = _storing;
+    _storing = -1;
+    if (slot >= 0 && complete && _writer.flush() == 0) {
+        uint32_t sequence = _clock++;
+        put_le32(_pending, CACHE_MAGIC);
+        put_le32(_pending + 4, sequence);
+        put_le32(_pending + 8, _writer.written());
+        put_le32(_pending + CACHE_CHECK, fnv1a(_pending, CACHE_CHECK));
+        if (_bd->program(_pending, slot_addr(slot) + _slot_size - _header_size, _header_size) == 0) {
+            Entry &entry = _entries[slot];
+            entry.url_hash = fnv1a(_pending + CACHE_URL, strlen((char *)_pending + CACHE_URL));
+            entry.sequence = entry.used = sequence;
+            entry.length = _writer.written();
+            entry.valid = true;
+            _stats.stores++;
+        }
+    }
+    _mutex.unlock();
+}
+
+// Hands the stored body of entry to deliver, piece by piece.
+int HttpCache::replay(int entry, uint32_t sequence, Callback<int(const char *at, size_t length)> deliver)
+{
+    _mutex.lock();
+    Entry &e = _entries[entry];
+    if (!e.valid || e.sequence != sequence) {
+        _mutex.unlock();
+        return HTTP_CACHE_ERROR_EVICTED;
+    }
+    int ret = 0;
+    for (uint32_t offset = 0; offset < e.length && ret >= 0; offset += _header_size) {
+        uint32_t size = e.length - offset < _header_size ? e.length - offset : _header_size;
+        ret = _bd->read(_buffer, slot_addr(entry) + offset, _header_size);
+        if (ret == 0) {
+            ret = deliver((const char *)_buffer, size);
+        }
+    }
+    if (ret >= 0) {
+        e.used = _clock++;
+        _stats.hits++;
+        _stats.bytes_saved += e.length;
+        ret = 0;
+    }
+    _mutex.unlock();
+    return ret;
+}
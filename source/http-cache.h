@@ -0,0 +1,118 @@
+#ifndef _HTTP_CACHE_H_
+#define _HTTP_CACHE_H_
+
+#include "mbed.h"
+#include "BlockDevice.h"
+#include "http-sink.h"
+
+#ifndef MBED_CONF_APP_HTTP_CACHE_ENTRIES
+#define MBED_CONF_APP_HTTP_CACHE_ENTRIES    8       // most responses kept
+#endif
+
+#ifndef MBED_CONF_APP_HTTP_CACHE_SLOT_SIZE
+#define MBED_CONF_APP_HTTP_CACHE_SLOT_SIZE  4096    // flash per response, a multiple of the erase size
+#endif
+
+#define HTTP_CACHE_URL_SIZE                 128     // longest URL cached, with its NUL
+#define HTTP_CACHE_VALIDATOR_SIZE           48      // longest ETag or Last-Modified, with its NUL
+
+// The entry a 304 refers to was replaced while the request was out.
+#define HTTP_CACHE_ERROR_EVICTED            -3701
+
+class HttpClientResponse;
+
+//
+// Cache of GET responses in a BlockDevice region, so a config file or asset
+// fetched again and again costs a 304 instead of the whole body.
+//
+// Once installed with http_cache_enable(), every HttpClientRequest GET for a
+// URL in the cache carries the stored response's validators (If-None-Match
+// with its ETag, If-Modified-Since with its Last-Modified), and a 304 is
+// answered from flash: the request sees status 200 and the stored body goes
+// to its body callback, sink or stored body as if it had come over the link
+// (HttpClientResponse::is_from_cache() tells).  A 200 that carries a
+// validator, is not marked no-store and fits in a slot is written to flash
+// as it streams in, replacing the URL's old entry or else the least
+// recently used one.
+//
+// Each response takes one MBED_CONF_APP_HTTP_CACHE_SLOT_SIZE slot: the body
+// from the slot's start and a header (URL, validators, length, checksum) in
+// its last program units, programmed only once the body is complete, so a
+// reset mid-store leaves no entry rather than a torn one.  Recency is kept in
+// RAM; after a restart entries rank by when they were stored.  Bodies are
+// kept as delivered, i.e. already inflated.
+//
+class HttpCache {
+public:
+    struct Stats {
+        uint32_t hits;          // 304s answered from flash
+        uint32_t misses;        // GETs answered with a full body
+        uint32_t stores;        // responses written to flash
+        uint32_t evictions;     // entries dropped for another URL
+        uint32_t uncacheable;   // 200s with no validator, no-store or too big
+        uint32_t bytes_saved;   // body bytes served from flash
+    };
+
+    HttpCache(BlockDevice *bd, bd_addr_t start, bd_size_t size);
+    ~HttpCache();
+
+    // Finds the entries of a previous run; bd must be initialised.
+    // NSAPI_ERROR_PARAMETER when start or MBED_CONF_APP_HTTP_CACHE_SLOT_SIZE
+    // is not erase-block aligned or the region holds no slot.
+    int init();
+
+    // Forgets every entry.
+    int clear();
+
+    size_t entries() const;
+    size_t capacity() const { return _slot_size - _header_size; }   // largest body kept
+    const Stats &stats() const { return _stats; }
+
+private:
+    friend class HttpClientRequest;
+
+    struct Entry {
+        uint32_t url_hash;
+        uint32_t sequence;      // when it was stored
+        uint32_t used;          // last hit, for LRU
+        uint32_t length;        // of the body
+        bool valid;
+    };
+
+    // Called by HttpClientRequest.  validators() writes the conditional
+    // headers for url into buffer and returns their length, or 0 when url
+    // is not cached.  entry and sequence identify the entry for replay().
+    size_t validators(const char *url, char *buffer, size_t size, int *entry, uint32_t *sequence);
+    bool store_begin(const char *url, HttpClientResponse *response);
+    int store_write(const void *data, size_t size);
+    void store_end(bool complete);
+    int replay(int entry, uint32_t sequence, Callback<int(const char *at, size_t length)> deliver);
+    void miss() { _stats.misses++; }
+
+    int find(const char *url);
+    int read_header(int entry);
+    bd_addr_t slot_addr(int entry) const { return _start + (bd_addr_t)entry * _slot_size; }
+
+    BlockDevice *_bd;
+    bd_addr_t _start;
+    bd_size_t _size;
+    uint32_t _slot_size;
+    uint32_t _header_size;
+    uint32_t _erase_size;
+    size_t _slots;
+    Entry _entries[MBED_CONF_APP_HTTP_CACHE_ENTRIES];
+    uint32_t _clock;            // sequence and recency counter
+    uint8_t *_buffer;           // a header, or a piece of body being replayed
+    uint8_t *_pending;          // header of the response being stored
+
+    BlockDeviceSink _writer;
+    int _storing;               // slot being written, or -1
+    Stats _stats;
+    Mutex _mutex;
+};
+
+// Puts a cache in front of every HttpClientRequest GET; NULL removes it.
+void http_cache_enable(HttpCache *cache);
+HttpCache *http_cache();
+
+#endif // _HTTP_CACHE_H_
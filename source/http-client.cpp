@@ -0,0 +1,930 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License"); 
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, 
+   software distributed under the License is distributed on an 
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, 
+   either express or implied. See the License for the specific 
+   language governing permissions and limitations under the License.
+
+    @file          http-client.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <strings.h>
+#include "http-client.h"
+
+#if MBED_HEAP_STATS_ENABLED
+#include "mbed_stats.h"
+#endif
+
+typedef HttpObjectPool<HttpClientRequest, MBED_CONF_APP_HTTP_REQUEST_POOL_SIZE> RequestPool;
+typedef HttpObjectPool<HttpClientResponse, MBED_CONF_APP_HTTP_RESPONSE_POOL_SIZE> ResponsePool;
+
+// A stored body and the NUL after it.
+struct BodyBlock {
+    char bytes[MBED_CONF_APP_HTTP_BODY_SIZE + 1];
+};
+typedef HttpObjectPool<BodyBlock, MBED_CONF_APP_HTTP_BODY_COUNT> BodyPool;
+
+// The pools are static, so the budget is checked when the client is built.
+typedef char http_memory_budget_exceeded
+    [HttpArenaPool::storage_size + RequestPool::storage_size + ResponsePool::storage_size +
+     BodyPool::storage_size <= MBED_CONF_APP_HTTP_MEMORY_BUDGET ? 1 : -1];
+
+// Header entries hold 16-bit arena offsets and _index 8-bit entry numbers.
+typedef char http_arena_fits_header_offsets[MBED_CONF_APP_HTTP_ARENA_SIZE < 0xffff ? 1 : -1];
+typedef char http_max_headers_fits_index[MBED_CONF_APP_HTTP_MAX_HEADERS < 0xff ? 1 : -1];
+
+// A chunk fills at most the receive buffer, so its size is 3 hex digits.
+#define CHUNK_HEAD      5       // "3ff\r\n"
+#define CHUNK_TAIL      7       // "\r\n" and the last chunk, "0\r\n\r\n"
+typedef char http_chunk_fits_header[HTTP_CLIENT_RECV_BUFFER_SIZE <= 0x1000 ? 1 : -1];
+
+static RequestPool request_pool;
+static ResponsePool response_pool;
+static BodyPool body_pool;
+
+void http_memory_stats(HttpMemoryStats *stats)
+{
+    stats->requests_in_use = request_pool.stats().in_use;
+    stats->requests_peak = request_pool.stats().peak;
+    stats->responses_in_use = response_pool.stats().in_use;
+    stats->responses_peak = response_pool.stats().peak;
+    stats->arenas_in_use = http_arena_pool.stats().in_use;
+    stats->arenas_peak = http_arena_pool.stats().peak;
+    stats->bodies_in_use = body_pool.stats().in_use;
+    stats->bodies_peak = body_pool.stats().peak;
+    stats->overflows = request_pool.stats().overflows + response_pool.stats().overflows +
+                       http_arena_pool.stats().overflows + body_pool.stats().overflows;
+}
+
+bool http_method_idempotent(http_method method)
+{
+    switch (method) {
+    case HTTP_GET:
+    case HTTP_HEAD:
+    case HTTP_PUT:
+    case HTTP_DELETE:
+    case HTTP_OPTIONS:
+    case HTTP_TRACE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// HttpClientResponse
+//
+HttpClientResponse::HttpClientResponse(HttpArena *arena) : _arena(arena), _body(NULL)
+{
+    reset();
+}
+
+HttpClientResponse::~HttpClientResponse()
+{
+    body_pool.free(_body);
+}
+
+void *HttpClientResponse::operator new(size_t size) throw()
+{
+    MBED_ASSERT(size == sizeof(HttpClientResponse));
+    return response_pool.alloc();
+}
+
+void HttpClientResponse::operator delete(void *ptr)
+{
+    response_pool.free(ptr);
+}
+
+// Empties the response for the next one and gives its body block back.
+void HttpClientResponse::reset()
+{
+    _status_code = 0;
+    _status_message = NONE;
+    _status_length = 0;
+    _header_count = 0;
+    memset(_index, 0, sizeof(_index));
+    _headers_dropped = 0;
+    _dropping = false;
+    _field_open = false;
+    body_pool.free(_body);
+    _body = NULL;
+    _body_length = 0;
+    _keep_alive = false;
+    _from_cache = false;
+}
+
+const char *HttpClientResponse::get_header_field(size_t ix)
+{
+    const Header &header = _headers[ix];
+    return header.id != HTTP_HEADER_OTHER ? http_header_name((HttpHeaderId)header.id) : string(header.field);
+}
+
+const char *HttpClientResponse::get_header(HttpHeaderId id)
+{
+    return id != HTTP_HEADER_OTHER && _index[id] ? get_header_value(_index[id] - 1) : NULL;
+}
+
+const char *HttpClientResponse::get_header(const char *name)
+{
+    size_t length = strlen(name);
+    uint16_t hash = http_header_hash(name, length);
+    HttpHeaderId id = http_header_intern(name, length, hash);
+    if (id != HTTP_HEADER_OTHER) {
+        return get_header(id);
+    }
+    for (size_t ix = 0; ix < _header_count; ix++) {
+        const Header &header = _headers[ix];
+        if (header.hash == hash && header.id == HTTP_HEADER_OTHER &&
+                strcasecmp(string(header.field), name) == 0) {
+            return get_header_value(ix);
+        }
+    }
+    return NULL;
+}
+
+// Appends a piece of a string kept at *offset in the arena.
+bool HttpClientResponse::append(uint16_t *offset, uint16_t *length, const char *at, size_t size)
+{
+    char *str = *offset == NONE ? NULL : _arena->at(*offset);
+    size_t total = *length;
+    str = _arena->append(str, &total, at, size);
+    if (!str) {
+        return false;
+    }
+    *offset = _arena->offset(str);
+    *length = total;
+    return true;
+}
+
+//
+// The last entry's field name is complete.  Interned names are replaced by
+// their ID; their text is the latest arena allocation, so it is given back.
+//
+void HttpClientResponse::intern_field()
+{
+    Header &header = _headers[_header_count - 1];
+    const char *name = _arena->at(header.field);
+
+    _field_open = false;
+    header.hash = http_header_hash(name, header.field_length);
+    header.id = http_header_intern(name, header.field_length, header.hash);
+    if (header.id != HTTP_HEADER_OTHER) {
+        _arena->rewind(header.field);
+        header.field = NONE;
+        header.field_length = 0;
+        if (!_index[header.id]) {
+            _index[header.id] = _header_count;
+        }
+    }
+}
+
+void HttpClientResponse::drop_header()
+{
+    Header &header = _headers[_header_count - 1];
+    if (header.id != HTTP_HEADER_OTHER && _index[header.id] == _header_count) {
+        _index[header.id] = 0;
+    }
+    _header_count--;
+    _headers_dropped++;
+    _dropping = true;
+    _field_open = false;
+}
+
+// Adds a piece of the body to the stored one.  Returns 0 or an error.
+int HttpClientResponse::store(const char *at, size_t length)
+{
+    if (length > MBED_CONF_APP_HTTP_BODY_SIZE - _body_length) {
+        return HTTP_CLIENT_ERROR_BODY_TOO_LARGE;
+    }
+    if (!_body) {
+        _body = static_cast<char *>(body_pool.alloc());
+        if (!_body) {
+            return NSAPI_ERROR_NO_MEMORY;
+        }
+    }
+    memcpy(_body + _body_length, at, length);
+    _body_length += length;
+    _body[_body_length] = '\0';
+    return 0;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// HttpClientRequest
+//
+HttpClientRequest::HttpClientRequest(HttpTransport *transport, http_method method, const char *url,
+                                     Callback<void(const char *at, size_t length)> body_callback)
+    : _transport(transport), _method(method), _headers(NULL), _headers_length(0),
+      _body_callback(body_callback), _body_sink(NULL), _inflater(NULL), _inflated(this),
+      _body_encoding(HTTP_ENCODING_IDENTITY), _body_encoded(false), _inflating(false), _chunked(false),
+      _head(NULL), _cacheable(true), _cache(NULL), _cache_entry(-1), _cache_sequence(0),
+      _revalidated(false), _caching(false), _response(NULL), _error(NSAPI_ERROR_OK), _in_value(false),
+      _complete(false), _started(false), _resendable(false)
+{
+    _url = _arena.strdup(url, strlen(url));
+    _request_mark = _arena.mark();
+    memset(&_memory, 0, sizeof(_memory));
+    memset(&_traffic, 0, sizeof(_traffic));
+    _memory.arena_size = _arena.size();
+}
+
+HttpClientRequest::HttpClientRequest(HttpTransport *transport, http_method method, const char *url,
+                                     HttpBodySink *body_sink)
+    : _transport(transport), _method(method), _headers(NULL), _headers_length(0),
+      _body_sink(body_sink), _inflater(NULL), _inflated(this), _body_encoding(HTTP_ENCODING_IDENTITY),
+      _body_encoded(false), _inflating(false), _chunked(false), _head(NULL), _cacheable(true),
+      _cache(NULL), _cache_entry(-1), _cache_sequence(0), _revalidated(false), _caching(false),
+      _response(NULL), _error(NSAPI_ERROR_OK), _in_value(false), _complete(false), _started(false),
+      _resendable(false)
+{
+    _url = _arena.strdup(url, strlen(url));
+    _request_mark = _arena.mark();
+    memset(&_memory, 0, sizeof(_memory));
+    memset(&_traffic, 0, sizeof(_traffic));
+    _memory.arena_size = _arena.size();
+}
+
+HttpClientRequest::~HttpClientRequest()
+{
+    delete _response;
+}
+
+void *HttpClientRequest::operator new(size_t size) throw()
+{
+    MBED_ASSERT(size == sizeof(HttpClientRequest));
+    return request_pool.alloc();
+}
+
+void HttpClientRequest::operator delete(void *ptr)
+{
+    request_pool.free(ptr);
+}
+
+bool HttpClientRequest::set_header(const char *key, const char *value)
+{
+    const char *parts[] = { key, ": ", value, "\r\n" };
+    size_t length = _headers_length;
+    char *headers = _headers;
+
+    for (size_t ix = 0; ix < sizeof(parts) / sizeof(parts[0]); ix++) {
+        headers = _arena.append(headers, &length, parts[ix], strlen(parts[ix]));
+        if (!headers) {
+            // Whatever was appended past the old headers is simply ignored.
+            return false;
+        }
+    }
+    _headers = headers;
+    _headers_length = length;
+    _request_mark = _arena.mark();
+    // Part of a body, or the caller's own revalidation: leave the cache out.
+    if (strcasecmp(key, "Range") == 0 || strcasecmp(key, "If-None-Match") == 0 ||
+            strcasecmp(key, "If-Modified-Since") == 0) {
+        _cacheable = false;
+    }
+    return true;
+}
+
+bool HttpClientRequest::set_accept_encoding(InflateSink *inflater)
+{
+    _inflater = inflater;
+    return set_header("Accept-Encoding", "gzip, deflate");
+}
+
+// True once nothing has moved for MBED_CONF_APP_HTTP_RECV_TIMEOUT_MS since since_us.
+static bool http_stalled(uint32_t since_us)
+{
+    return (us_ticker_read() - since_us) / 1000 >= MBED_CONF_APP_HTTP_RECV_TIMEOUT_MS;
+}
+
+nsapi_error_t HttpClientRequest::send_all(const void *data, nsapi_size_t size)
+{
+    const char *p = static_cast<const char *>(data);
+    uint32_t moved_us = us_ticker_read();
+    while (size > 0) {
+        nsapi_size_or_error_t sent = _transport->send(p, size);
+        if (sent == NSAPI_ERROR_WOULD_BLOCK) {
+            if (http_stalled(moved_us)) {
+                return NSAPI_ERROR_CONNECTION_TIMEOUT;
+            }
+            Thread::wait(1);        // let the link drain
+            continue;
+        }
+        if (sent <= 0) {
+            return sent < 0 ? sent : NSAPI_ERROR_CONNECTION_LOST;
+        }
+        p += sent;
+        size -= sent;
+        moved_us = us_ticker_read();
+    }
+    return NSAPI_ERROR_OK;
+}
+
+//
+// Sends the head already in buffer and then the chunked body, one frame per
+// buffer: the producer is asked to fill the frame until it is full or the
+// body ends, and the frame goes out before it is asked again.
+//
+nsapi_error_t HttpClientRequest::send_chunks(char *buffer, size_t length)
+{
+    static const char hex[] = "0123456789abcdef";
+    bool end = false;
+
+    _trace.bytes_sent = 0;
+    while (!end) {
+        if (length + CHUNK_HEAD + CHUNK_TAIL >= HTTP_CLIENT_RECV_BUFFER_SIZE) {
+            nsapi_error_t result = send_all(buffer, length);    // a head that leaves no room
+            if (result != NSAPI_ERROR_OK) {
+                return result;
+            }
+            _trace.bytes_sent += length;
+            length = 0;
+        }
+
+        char *data = buffer + length + CHUNK_HEAD;
+        size_t room = HTTP_CLIENT_RECV_BUFFER_SIZE - length - CHUNK_HEAD - CHUNK_TAIL;
+        size_t filled = 0;
+        while (filled < room) {
+            int produced = _producer(data + filled, room - filled);
+            if (produced < 0) {
+                return produced;
+            }
+            if (produced == 0) {
+                end = true;
+                break;
+            }
+            if ((size_t)produced > room - filled) {
+                return NSAPI_ERROR_PARAMETER;
+            }
+            filled += produced;
+        }
+        _transport->count_payload(filled, 0);
+
+        if (filled > 0) {
+            char *head = buffer + length;
+            head[0] = hex[(filled >> 8) & 0x0f];
+            head[1] = hex[(filled >> 4) & 0x0f];
+            head[2] = hex[filled & 0x0f];
+            head[3] = '\r';
+            head[4] = '\n';
+            length += CHUNK_HEAD + filled;
+            buffer[length++] = '\r';
+            buffer[length++] = '\n';
+        }
+        if (end) {
+            memcpy(buffer + length, "0\r\n\r\n", 5);
+            length += 5;
+        }
+        nsapi_error_t result = send_all(buffer, length);
+        if (result != NSAPI_ERROR_OK) {
+            return result;
+        }
+        _trace.bytes_sent += length;
+        length = 0;
+    }
+    return NSAPI_ERROR_OK;
+}
+
+//
+// Compresses the body into arena scratch when a body encoding is set and
+// that makes it smaller.  Returns the body to send, with its size left in
+// *body_size; the caller's rewind_back() releases the scratch.
+//
+const void *HttpClientRequest::encode_body(const void *body, nsapi_size_t *body_size)
+{
+    _body_encoded = false;
+    if (_body_encoding == HTTP_ENCODING_IDENTITY || *body_size == 0) {
+        return body;
+    }
+    size_t mark = _arena.back_mark();
+    size_t room = _arena.available();
+    if (room >= *body_size) {
+        room = *body_size - 1;      // only worth it when smaller
+    }
+    void *out = room > 0 ? _arena.alloc_back(room) : NULL;
+    size_t size = out ? http_deflate(_body_encoding, body, *body_size, out, room) : 0;
+    if (size == 0) {
+        _arena.rewind_back(mark);
+        return body;
+    }
+    _body_encoded = true;
+    *body_size = size;
+    return out;
+}
+
+//
+// Adds the n bytes a formatter just wrote at buffer + *length, unless they
+// were cut short by the end of the buffer.
+//
+static bool head_append(int n, int *length, size_t size)
+{
+    if (n < 0 || (size_t)n >= size - *length) {
+        return false;
+    }
+    *length += n;
+    return true;
+}
+
+//
+// Writes the request line and headers into buffer.  Returns their length, or
+// 0 when they do not fit.
+//
+size_t HttpClientRequest::build_head(char *buffer, size_t size, nsapi_size_t body_size)
+{
+    int length;
+    if (_head) {
+        // All but the template's blank line; what follows is added below.
+        if (_chunked && _head->length_field) {
+            _error = NSAPI_ERROR_PARAMETER;
+            return 0;
+        }
+        if ((size_t)_head->length - 2 + _headers_length >= size) {
+            _error = NSAPI_ERROR_NO_MEMORY;
+            return 0;
+        }
+        if (_head->length_field) {
+            length = _head->length_field;
+            memcpy(buffer, _head->text, length);
+            length += http_head_put_length(buffer + length, body_size);
+            buffer[length++] = '\r';
+            buffer[length++] = '\n';
+        } else {
+            length = _head->length - 2;
+            memcpy(buffer, _head->text, length);
+        }
+    } else {
+        HttpUrl url;
+        if (!http_url_parse(get_url(), &url)) {
+            _error = NSAPI_ERROR_PARAMETER;
+            return 0;
+        }
+        char port[8] = "";
+        if (url.port != (url.secure ? 443 : 80)) {
+            snprintf(port, sizeof port, ":%u", url.port);
+        }
+        length = snprintf(buffer, size, "%s %s HTTP/1.1\r\nHost: %s%s\r\n",
+                          http_method_str(_method), url.path, url.host, port);
+        if (length < 0 || (size_t)length + _headers_length >= size) {
+            _error = NSAPI_ERROR_NO_MEMORY;
+            return 0;
+        }
+    }
+
+    memset(&_trace, 0, sizeof(_trace));
+    _trace.start_us = us_ticker_read();
+    _trace.method = _method;
+    _sent_us = _first_us = _trace.start_us;
+
+    if (_headers_length > 0) {
+        memcpy(buffer + length, _headers, _headers_length);
+        length += _headers_length;
+    }
+    _cache = _method == HTTP_GET && _cacheable ? http_cache() : NULL;
+    _cache_entry = -1;
+    if (_cache && !head_append(_cache->validators(get_url(), buffer + length, size - length,
+                                                  &_cache_entry, &_cache_sequence), &length, size)) {
+        _error = NSAPI_ERROR_NO_MEMORY;
+        return 0;
+    }
+    if (_body_encoded && !head_append(snprintf(buffer + length, size - length, "Content-Encoding: %s\r\n",
+                                               http_encoding_name(_body_encoding)), &length, size)) {
+        _error = NSAPI_ERROR_NO_MEMORY;
+        return 0;
+    }
+    int framing = 0;
+    if (_chunked) {
+        framing = snprintf(buffer + length, size - length, "Transfer-Encoding: chunked\r\n");
+    } else if ((body_size > 0 || (_method != HTTP_GET && _method != HTTP_HEAD)) &&
+               !(_head && _head->length_field)) {
+        framing = snprintf(buffer + length, size - length, "Content-Length: %u\r\n", (unsigned)body_size);
+    }
+    if (!head_append(framing, &length, size) || (size_t)length + 2 >= size) {
+        _error = NSAPI_ERROR_NO_MEMORY;
+        return 0;
+    }
+    buffer[length++] = '\r';
+    buffer[length++] = '\n';
+    _trace.bytes_sent = length + body_size;
+
+    memset(&_traffic, 0, sizeof(_traffic));
+    _traffic.requests = 1;
+    _traffic.app_sent = length + body_size;
+    _traffic.payload_sent = body_size;
+    _transport->count_request(body_size);
+    return length;
+}
+
+// Starts parsing a new response into a fresh HttpClientResponse.
+void HttpClientRequest::begin_response()
+{
+    _arena.rewind(_request_mark);
+    if (_response) {
+        _response->reset();
+    } else {
+        _response = new HttpClientResponse(&_arena);
+    }
+    _in_value = false;
+    _complete = false;
+    _started = false;
+    _inflating = false;
+    _revalidated = false;
+    _caching = false;
+    _error = NSAPI_ERROR_OK;
+
+    http_parser_init(&_parser, HTTP_RESPONSE);
+    _parser.data = this;
+    memset(&_settings, 0, sizeof(_settings));
+    _settings.on_status = &HttpClientRequest::on_status;
+    _settings.on_header_field = &HttpClientRequest::on_header_field;
+    _settings.on_header_value = &HttpClientRequest::on_header_value;
+    _settings.on_headers_complete = &HttpClientRequest::on_headers_complete;
+    _settings.on_body = &HttpClientRequest::on_body;
+    _settings.on_message_complete = &HttpClientRequest::on_message_complete;
+}
+
+//
+// Feeds received bytes to the parser; size 0 tells it the connection closed,
+// which completes a body without framing.  Returns the bytes consumed: fewer
+// than size once the response is complete (the rest belongs to the next one)
+// or when the parser gave up.
+//
+size_t HttpClientRequest::parse(const char *data, size_t size)
+{
+    if (!_started && size > 0) {
+        _started = true;
+        _first_us = us_ticker_read();
+    }
+    size_t parsed = http_parser_execute(&_parser, &_settings, data, size);
+    _trace.bytes_received += parsed;
+    _traffic.app_received += parsed;
+    return parsed;
+}
+
+// Finishes the response; false (and the transport closed) if it is incomplete.
+bool HttpClientRequest::end_response()
+{
+    if (!_complete && !_started && _resendable) {
+        // Nothing arrived and the caller will send it again: the sink and
+        // the trace stay open for that attempt.
+        if (_error == NSAPI_ERROR_OK) {
+            _error = NSAPI_ERROR_CONNECTION_LOST;
+        }
+        _transport->close();
+        return false;
+    }
+    if (_inflating) {
+        _inflater->finish(_complete);
+        if (_complete && !_inflater->done()) {
+            _error = HTTP_INFLATE_ERROR_TRUNCATED;
+            _complete = false;
+        }
+    }
+    if (_caching) {
+        _caching = false;
+        _cache->store_end(_complete);
+    }
+    if (_revalidated && _complete) {
+        // Not modified: the stored body stands in for the one not sent.
+        int ret = _cache->replay(_cache_entry, _cache_sequence, callback(this, &HttpClientRequest::deliver));
+        if (ret < 0) {
+            _error = ret;
+            _complete = false;
+        } else {
+            _response->_status_code = 200;
+            _response->_from_cache = true;
+        }
+    }
+    if (_body_sink) {
+        _body_sink->finish(_complete);
+    }
+    if (!_complete) {
+        if (_error == NSAPI_ERROR_OK) {
+            _error = NSAPI_ERROR_CONNECTION_LOST;
+        }
+        _transport->close();
+        trace_end();
+        return false;
+    }
+    _response->_keep_alive = http_should_keep_alive(&_parser);
+    if (!_response->_keep_alive) {
+        _transport->close();
+    }
+    trace_end();
+    return true;
+}
+
+// Ends a request end_response() left open that will not be sent again after all.
+void HttpClientRequest::abandon()
+{
+    if (_body_sink) {
+        _body_sink->finish(false);
+    }
+    trace_end();
+}
+
+// Completes the trace record of this request and hands it to the trace, and
+// what the transport counted to the traffic meter.
+void HttpClientRequest::trace_end()
+{
+    _transport->traffic_flush();
+
+    HttpTrace *trace = http_trace();
+    if (!trace) {
+        return;
+    }
+    if (_started) {
+        _trace.ttfb_us = _first_us - _sent_us;
+        _trace.body_us = us_ticker_read() - _first_us;
+    }
+    _trace.status = _started && _response ? _response->_status_code : 0;
+    _trace.error = _error;
+    trace->record(&_trace);
+}
+
+//
+// Reads the reply from the transport until the message is complete.  buffer
+// (of HTTP_CLIENT_RECV_BUFFER_SIZE bytes) starts with *buffered bytes already
+// received; on return it holds the *buffered bytes that came in after the end
+// of this response, which belong to the next one on the connection.
+//
+bool HttpClientRequest::receive(char *buffer, size_t *buffered)
+{
+    begin_response();
+
+    size_t pending = *buffered;
+    *buffered = 0;
+    uint32_t moved_us = us_ticker_read();
+    while (!_complete) {
+        nsapi_size_or_error_t received = pending;
+        if (pending == 0) {
+            received = _transport->recv(buffer, HTTP_CLIENT_RECV_BUFFER_SIZE);
+            if (received == NSAPI_ERROR_WOULD_BLOCK) {
+                // The socket timed out, or TLS wants the rest of a record.
+                if (http_stalled(moved_us)) {
+                    _error = NSAPI_ERROR_CONNECTION_TIMEOUT;
+                    break;
+                }
+                Thread::wait(1);
+                continue;
+            }
+            if (received < 0) {
+                _error = received;
+                break;
+            }
+            moved_us = us_ticker_read();
+        }
+        pending = 0;
+
+        size_t parsed = parse(buffer, received);
+        if (_complete) {
+            // on_message_complete paused the parser right after this message.
+            *buffered = received - parsed;
+            memmove(buffer, buffer + parsed, *buffered);
+            break;
+        }
+        if (received == 0 || parsed != (size_t)received) {
+            break;
+        }
+    }
+    return end_response();
+}
+
+HttpClientResponse *HttpClientRequest::send(const void *body, nsapi_size_t body_size)
+{
+#if MBED_HEAP_STATS_ENABLED
+    mbed_stats_heap_t heap;
+    mbed_stats_heap_get(&heap);
+    uint32_t allocs = heap.alloc_cnt;
+    uint32_t heap_base = heap.current_size;
+    uint32_t heap_max = heap.max_size;
+#endif
+    _arena.reset_peak();
+    TrafficCounters before = _transport->traffic();
+
+    HttpClientResponse *response = transfer(body, body_size);
+
+    traffic_delta(&_traffic, _transport->traffic(), before);
+    _memory.arena_peak = _arena.peak();
+#if MBED_HEAP_STATS_ENABLED
+    mbed_stats_heap_get(&heap);
+    _memory.heap_allocs = heap.alloc_cnt - allocs;
+    // The heap's high-water mark only ever grows: unless this request raised
+    // it, what it still holds is all that can be told.
+    uint32_t left = heap.current_size > heap_base ? heap.current_size - heap_base : 0;
+    _memory.heap_peak = heap.max_size > heap_max ? heap.max_size - heap_base : left;
+#endif
+    return response;
+}
+
+HttpClientResponse *HttpClientRequest::send_chunked(Callback<int(char *buffer, size_t size)> producer)
+{
+    _producer = producer;
+    _chunked = true;
+    HttpClientResponse *response = send();
+    _chunked = false;
+    return response;
+}
+
+HttpClientResponse *HttpClientRequest::transfer(const void *body, nsapi_size_t body_size)
+{
+    // The receive buffer is arena scratch, and holds the outgoing request
+    // line and headers until the response starts arriving.
+    size_t mark = _arena.back_mark();
+    char *buffer = static_cast<char *>(_arena.alloc_back(HTTP_CLIENT_RECV_BUFFER_SIZE));
+    if (!buffer) {
+        _error = NSAPI_ERROR_NO_MEMORY;
+        return NULL;
+    }
+    // A compressed body sits in scratch below the buffer until it is sent.
+    size_t body_mark = _arena.back_mark();
+    body = encode_body(body, &body_size);
+    size_t length = build_head(buffer, HTTP_CLIENT_RECV_BUFFER_SIZE, body_size);
+    if (length == 0) {
+        _arena.rewind_back(mark);
+        return NULL;
+    }
+
+    HttpClientResponse *response = NULL;
+    _error = NSAPI_ERROR_OK;
+    if (!_transport->connected()) {
+        _error = _transport->connect();
+
+        const HttpTransport::ConnectTiming &timing = _transport->connect_timing();
+        _trace.dns_us = timing.dns_us;
+        _trace.connect_us = timing.connect_us;
+        _trace.tls_us = timing.tls_us;
+        _trace.flags = HTTP_TRACE_CONNECTED | (timing.resumed ? HTTP_TRACE_RESUMED : 0);
+    }
+    if (_error == NSAPI_ERROR_OK && _chunked) {
+        _error = send_chunks(buffer, length);
+        sent();
+    } else if (_error == NSAPI_ERROR_OK) {
+        // A body that fits goes out in the same send as the headers.
+        if (body_size > 0 && body_size <= HTTP_CLIENT_RECV_BUFFER_SIZE - length) {
+            memcpy(buffer + length, body, body_size);
+            length += body_size;
+            body_size = 0;
+        }
+        _error = send_all(buffer, length);
+        if (_error == NSAPI_ERROR_OK && body_size > 0) {
+            _error = send_all(body, body_size);
+        }
+        sent();
+    }
+    _arena.rewind_back(body_mark);
+    if (_error == NSAPI_ERROR_OK) {
+        size_t buffered = 0;
+        if (receive(buffer, &buffered)) {
+            response = _response;
+        }
+    } else {
+        _started = false;
+        trace_end();
+    }
+    _arena.rewind_back(mark);
+    return response;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// http_parser callbacks
+//
+int HttpClientRequest::on_status(http_parser *parser, const char *at, size_t length)
+{
+    HttpClientRequest *self = static_cast<HttpClientRequest *>(parser->data);
+    HttpClientResponse *res = self->_response;
+    res->_status_code = parser->status_code;
+    res->append(&res->_status_message, &res->_status_length, at, length);
+    return 0;
+}
+
+//
+// Fields and values can arrive in pieces when they straddle two receive
+// buffers; each piece is appended to the latest arena string, which normally
+// grows in place.  A header that does not fit is dropped whole.
+//
+int HttpClientRequest::on_header_field(http_parser *parser, const char *at, size_t length)
+{
+    HttpClientRequest *self = static_cast<HttpClientRequest *>(parser->data);
+    HttpClientResponse *res = self->_response;
+
+    if (self->_in_value || (res->_header_count == 0 && !res->_dropping)) {
+        self->_in_value = false;
+        res->_dropping = res->_header_count == MBED_CONF_APP_HTTP_MAX_HEADERS;
+        if (res->_dropping) {
+            res->_headers_dropped++;
+            return 0;
+        }
+        HttpClientResponse::Header &header = res->_headers[res->_header_count++];
+        header.id = HTTP_HEADER_OTHER;
+        header.hash = 0;
+        header.field = HttpClientResponse::NONE;
+        header.field_length = 0;
+        header.value = HttpClientResponse::NONE;
+        header.value_length = 0;
+        res->_field_open = true;
+    }
+    if (res->_dropping) {
+        return 0;
+    }
+    HttpClientResponse::Header &header = res->_headers[res->_header_count - 1];
+    if (!res->append(&header.field, &header.field_length, at, length)) {
+        res->drop_header();
+    }
+    return 0;
+}
+
+int HttpClientRequest::on_header_value(http_parser *parser, const char *at, size_t length)
+{
+    HttpClientRequest *self = static_cast<HttpClientRequest *>(parser->data);
+    HttpClientResponse *res = self->_response;
+
+    self->_in_value = true;
+    if (res->_dropping) {
+        return 0;
+    }
+    if (res->_field_open) {
+        res->intern_field();
+    }
+    HttpClientResponse::Header &header = res->_headers[res->_header_count - 1];
+    if (!res->append(&header.value, &header.value_length, at, length)) {
+        res->drop_header();
+    }
+    return 0;
+}
+
+int HttpClientRequest::on_headers_complete(http_parser *parser)
+{
+    HttpClientRequest *self = static_cast<HttpClientRequest *>(parser->data);
+    HttpClientResponse *res = self->_response;
+    if (res->_field_open && !res->_dropping) {
+        res->intern_field();
+    }
+    res->_status_code = parser->status_code;
+    if (self->_inflater) {
+        HttpEncoding encoding = http_encoding_parse(res->get_header(HTTP_HEADER_CONTENT_ENCODING));
+        if (encoding != HTTP_ENCODING_IDENTITY) {
+            self->_inflater->reset(&self->_inflated, encoding);
+            self->_inflating = true;
+        }
+    }
+    if (self->_cache) {
+        if (res->_status_code == 304 && self->_cache_entry >= 0) {
+            self->_revalidated = true;
+        } else if (res->_status_code == 200) {
+            self->_cache->miss();
+            self->_caching = self->_cache->store_begin(self->get_url(), res);
+        }
+    }
+    // A response to HEAD never has a body, whatever Content-Length says.
+    return self->_method == HTTP_HEAD ? 1 : 0;
+}
+
+int HttpClientRequest::on_body(http_parser *parser, const char *at, size_t length)
+{
+    HttpClientRequest *self = static_cast<HttpClientRequest *>(parser->data);
+    // The inflater calls deliver() with each piece it decodes.
+    self->_traffic.payload_received += length;
+    self->_transport->count_payload(0, length);
+    int ret = self->_inflating ? self->_inflater->write(at, length) : self->deliver(at, length);
+    if (ret < 0) {
+        // A failing sink or corrupt compressed data stops the parser.
+        self->_error = ret;
+        return 1;
+    }
+    return 0;
+}
+
+// at points into the receive buffer, or into the inflater's window.
+int HttpClientRequest::deliver(const char *at, size_t length)
+{
+    if (_caching && _cache->store_write(at, length) < 0) {
+        _caching = false;
+    }
+    if (!_body_sink && !_body_callback) {
+        return _response->store(at, length);
+    }
+    _response->_body_length += length;
+    if (_body_sink) {
+        return _body_sink->write(at, length);
+    }
+    _body_callback(at, length);
+    return 0;
+}
+
+int HttpClientRequest::on_message_complete(http_parser *parser)
+{
+    HttpClientRequest *self = static_cast<HttpClientRequest *>(parser->data);
+    self->_complete = true;
+    // Stop here: anything after this message is the next pipelined response.
+    http_parser_pause(parser, 1);
+    return 0;
+}
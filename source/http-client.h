@@ -0,0 +1,301 @@
+#ifndef _HTTP_CLIENT_H_
+#define _HTTP_CLIENT_H_
+
+#include "mbed.h"
+#include "http_parser.h"
+#include "http-transport.h"
+#include "http-sink.h"
+#include "http-memory.h"
+#include "http-header.h"
+#include "http-trace.h"
+#include "http-deflate.h"
+#include "http-cache.h"
+#include "http-head-template.h"
+
+#define HTTP_CLIENT_RECV_BUFFER_SIZE    1024
+
+// A body for the response to store, with no callback or sink given, that is
+// longer than MBED_CONF_APP_HTTP_BODY_SIZE.
+#define HTTP_CLIENT_ERROR_BODY_TOO_LARGE    -3901
+
+// RFC 7231 4.2.2: repeating these has the same effect as sending them once,
+// so a request that may or may not have reached the server can be sent again.
+bool http_method_idempotent(http_method method);
+
+//
+// Response of an HttpClientRequest.  Same accessors as mbed-http's
+// HttpResponse, except that the status message and headers are C strings
+// kept in the request's arena (see http-memory.h) rather than heap-allocated
+// std::strings.
+//
+// Headers form one flat table of fixed-size entries holding offsets into the
+// arena.  Well-known field names (http-header.h) are interned: the entry
+// keeps only the ID, and get_header(id) is a direct index.  Other names are
+// found by hash.  Headers beyond MBED_CONF_APP_HTTP_MAX_HEADERS, or that no
+// longer fit in the arena, are dropped and counted.
+//
+class HttpClientResponse {
+public:
+    HttpClientResponse(HttpArena *arena);
+    ~HttpClientResponse();
+
+    static void *operator new(size_t size) throw();
+    static void operator delete(void *ptr);
+
+    int get_status_code() { return _status_code; }
+    const char *get_status_message() { return string(_status_message); }
+
+    size_t get_headers_length() { return _header_count; }
+    const char *get_header_field(size_t ix);
+    const char *get_header_value(size_t ix) { return string(_headers[ix].value); }
+    HttpHeaderId get_header_id(size_t ix) { return (HttpHeaderId)_headers[ix].id; }
+    size_t get_headers_dropped() { return _headers_dropped; }
+
+    // Value of the first header with that field (name in any case), or NULL.
+    const char *get_header(HttpHeaderId id);
+    const char *get_header(const char *name);
+
+    // Bytes of body received, including any streamed to a callback or sink
+    // (which leave the stored body empty); after inflating, if it was
+    // compressed.
+    size_t get_body_length() { return _body_length; }
+
+    //
+    // The stored body, NUL terminated, in a block of MBED_CONF_APP_HTTP_BODY_SIZE
+    // bytes from a fixed pool that the response holds until it is reset or
+    // deleted.  A longer body fails the request with
+    // HTTP_CLIENT_ERROR_BODY_TOO_LARGE: give those a callback or sink.
+    //
+    const char *get_body() { return _body ? _body : ""; }
+
+    // False when the server asked to close the connection after this response.
+    bool is_keep_alive() { return _keep_alive; }
+
+    // True when the server answered 304 and the body came from the
+    // HttpCache; the status then reads 200 and the headers are the 304's.
+    bool is_from_cache() { return _from_cache; }
+
+private:
+    friend class HttpClientRequest;
+
+    static const uint16_t NONE = 0xffff;    // no string
+
+    struct Header {
+        uint8_t id;                 // HttpHeaderId
+        uint16_t hash;              // http_header_hash() of the field
+        uint16_t field;             // arena offsets; field is NONE when interned
+        uint16_t field_length;
+        uint16_t value;
+        uint16_t value_length;
+    };
+
+    void reset();
+    int store(const char *at, size_t length);
+    const char *string(uint16_t offset) { return offset == NONE ? "" : _arena->at(offset); }
+    bool append(uint16_t *offset, uint16_t *length, const char *at, size_t size);
+    void intern_field();
+    void drop_header();
+
+    HttpArena *_arena;
+    int _status_code;
+    uint16_t _status_message;
+    uint16_t _status_length;
+    Header _headers[MBED_CONF_APP_HTTP_MAX_HEADERS];
+    uint8_t _index[HTTP_HEADER_COUNT];      // entry + 1 of each interned field, or 0
+    size_t _header_count;
+    size_t _headers_dropped;
+    bool _dropping;             // the header being received is being dropped
+    bool _field_open;           // the last entry's field is still arriving
+    char *_body;                // body pool block, taken by the first byte stored
+    size_t _body_length;
+    bool _keep_alive;
+    bool _from_cache;
+};
+
+//
+// HTTP/1.1 request over any HttpTransport, mirroring mbed-http's
+// HttpRequest/HttpsRequest API.  The transport is connected on demand and
+// left open afterwards, so several requests can run over one connection.
+// When a body callback or sink is given the body is streamed to it instead of
+// being stored in the response.
+//
+// The URL, headers, response metadata and receive buffer all live in one
+// arena block taken from a fixed pool; stored bodies and objects made with
+// new come from fixed pools too, so send() on an open connection does not
+// touch the general heap.
+//
+// With http_trace_enable() every request also leaves an HttpTraceRecord of
+// its DNS, connect, TLS, time-to-first-byte and body times.
+//
+// Bodies can be compressed both ways (http-deflate.h): the request body with
+// set_body_encoding(), and the response through an InflateSink given to
+// set_accept_encoding(), which decodes each chunk as it arrives.
+//
+// With http_cache_enable() GETs are revalidated against the HttpCache and a
+// 304 is answered from flash (http-cache.h).
+//
+// Each request tells its transport which bytes were bodies, so the
+// transport's TrafficCounters (traffic-meter.h) split heads from payload.
+//
+class HttpClientRequest {
+public:
+    struct MemoryStats {
+        uint32_t arena_size;
+        uint32_t arena_peak;        // most arena bytes used by the last send()
+        uint32_t heap_allocs;       // heap allocations made during it
+        uint32_t heap_peak;         // most heap it held over what was in use as it began
+    };
+
+    HttpClientRequest(HttpTransport *transport, http_method method, const char *url,
+                      Callback<void(const char *at, size_t length)> body_callback = 0);
+    HttpClientRequest(HttpTransport *transport, http_method method, const char *url,
+                      HttpBodySink *body_sink);
+    ~HttpClientRequest();
+
+    static void *operator new(size_t size) throw();
+    static void operator delete(void *ptr);
+
+    // False when the header does not fit in the arena.
+    bool set_header(const char *key, const char *value);
+
+    // Asks for gzip or deflate responses and inflates them through inflater
+    // on their way to the body callback, sink or stored body.  inflater must
+    // outlive the request and serve only one response at a time.
+    bool set_accept_encoding(InflateSink *inflater);
+
+    //
+    // Sends head (http-head-template.h) instead of the request line and Host
+    // built from the URL, which then only names the request for the cache
+    // and traces.  set_header() lines still follow it.  head must outlive
+    // the request; one with a Content-Length cannot go with send_chunked().
+    //
+    void set_head_template(const HttpHeadTemplate *head) { _head = head; }
+
+    // Compresses request bodies with encoding when that makes them smaller
+    // and the result fits in the arena; other bodies are sent as they are.
+    void set_body_encoding(HttpEncoding encoding) { _body_encoding = encoding; }
+    HttpClientResponse *send(const void *body = NULL, nsapi_size_t body_size = 0);
+
+    //
+    // Streams the body with Transfer-Encoding: chunked, pulling it from
+    // producer, which fills up to size bytes at buffer and returns how many,
+    // 0 at the end of the body or a negative error to abort.  Each chunk is
+    // built in the receive buffer and producer is only asked for more once
+    // the transport has taken the last one, so a body of any length goes out
+    // in constant memory at the pace of the link.  The body is not
+    // compressed, and the request cannot be pipelined or run asynchronously.
+    //
+    HttpClientResponse *send_chunked(Callback<int(char *buffer, size_t size)> producer);
+    nsapi_error_t get_error() { return _error; }
+    const char *get_url() const { return _url ? _url : ""; }
+
+    // Heap statistics need MBED_HEAP_STATS_ENABLED; otherwise they read 0.
+    const MemoryStats &get_memory_stats() const { return _memory; }
+
+    //
+    // What the last request cost.  After send() and send_chunked() these are
+    // the transport's counts over the call: connection setup, TLS and
+    // packets included.  Pipelined and asynchronous requests share their
+    // connection with others, so only their own requests, app and payload
+    // bytes are filled in; the rest is in the transport's and the meter's.
+    //
+    const TrafficCounters &get_traffic() const { return _traffic; }
+
+    // Response of the last send() or pipeline run, or NULL if it failed.
+    HttpClientResponse *get_response() { return _complete ? _response : NULL; }
+
+private:
+    friend class HttpPipeline;
+    friend class HttpAsyncEngine;
+    friend class HttpAsyncSlot;
+
+    // Hands the inflated body on as if it had arrived that way.
+    class Inflated : public HttpBodySink {
+    public:
+        Inflated(HttpClientRequest *request) : _request(request) {}
+        virtual int write(const void *data, size_t size) {
+            return _request->deliver(static_cast<const char *>(data), size);
+        }
+    private:
+        HttpClientRequest *_request;
+    };
+
+    const void *encode_body(const void *body, nsapi_size_t *body_size);
+    size_t build_head(char *buffer, size_t size, nsapi_size_t body_size);
+    HttpClientResponse *transfer(const void *body, nsapi_size_t body_size);
+    nsapi_error_t send_all(const void *data, nsapi_size_t size);
+    nsapi_error_t send_chunks(char *buffer, size_t length);
+    bool receive(char *buffer, size_t *buffered);
+
+    void begin_response();
+    size_t parse(const char *data, size_t size);
+    bool end_response();
+    void abandon();
+    void sent() { _sent_us = us_ticker_read(); }
+    void trace_end();
+
+    static int on_status(http_parser *parser, const char *at, size_t length);
+    static int on_header_field(http_parser *parser, const char *at, size_t length);
+    static int on_header_value(http_parser *parser, const char *at, size_t length);
+    static int on_headers_complete(http_parser *parser);
+    static int on_body(http_parser *parser, const char *at, size_t length);
+    static int on_message_complete(http_parser *parser);
+    int deliver(const char *at, size_t length);
+
+    HttpArena _arena;
+    HttpTransport *_transport;
+    http_method _method;
+    char *_url;
+    char *_headers;
+    size_t _headers_length;
+    size_t _request_mark;       // arena front after the URL and headers
+    Callback<void(const char *at, size_t length)> _body_callback;
+    HttpBodySink *_body_sink;
+    InflateSink *_inflater;
+    Inflated _inflated;
+    HttpEncoding _body_encoding;
+    bool _body_encoded;         // the body being sent was compressed
+    bool _inflating;            // the response body goes through _inflater
+    Callback<int(char *buffer, size_t size)> _producer;
+    bool _chunked;              // the body comes from _producer
+    const HttpHeadTemplate *_head;      // or NULL to build the head from the URL
+    bool _cacheable;            // no Range or validators of the caller's
+    HttpCache *_cache;          // of this GET, or NULL
+    int _cache_entry;           // entry whose validators were sent, or -1
+    uint32_t _cache_sequence;
+    bool _revalidated;          // a 304 for _cache_entry arrived
+    bool _caching;              // the body is being stored
+
+    HttpClientResponse *_response;
+    http_parser _parser;
+    http_parser_settings _settings;
+    nsapi_error_t _error;
+    bool _in_value;             // last header callback was for a value
+    bool _complete;
+    bool _started;              // some of the response has arrived
+    bool _resendable;           // unanswered, it is sent again: end_response() leaves it open
+    MemoryStats _memory;
+    HttpTraceRecord _trace;
+    TrafficCounters _traffic;
+    uint32_t _sent_us;
+    uint32_t _first_us;         // first response byte
+};
+
+//
+// What the HTTP client holds against its budget.
+//
+struct HttpMemoryStats {
+    uint32_t requests_in_use;
+    uint32_t requests_peak;
+    uint32_t responses_in_use;
+    uint32_t responses_peak;
+    uint32_t arenas_in_use;
+    uint32_t arenas_peak;
+    uint32_t bodies_in_use;
+    uint32_t bodies_peak;
+    uint32_t overflows;         // pool allocations that fell back to the heap
+};
+
+void http_memory_stats(HttpMemoryStats *stats);
+
+#endif // _HTTP_CLIENT_H_
@@ -0,0 +1,822 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          http-deflate.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <string.h>
+#include <strings.h>
+#include "http-deflate.h"
+
+#define GZIP_FHCRC      0x02
+#define GZIP_FEXTRA     0x04
+#define GZIP_FNAME      0x08
+#define GZIP_FCOMMENT   0x10
+
+#define DEFLATE_HASH_BITS   8
+#define DEFLATE_MAX_DISTANCE 32768
+
+#define NEED_INPUT      -1
+#define BAD_CODE        -2
+
+// Length and distance codes (RFC 1951, 3.2.5).
+static const uint16_t length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t distance_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t distance_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// Order in which a dynamic block sends the code length code lengths.
+static const uint8_t code_length_order[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+// CRC-32 a nibble at a time: 64 bytes of table instead of 1 KB.
+static const uint32_t crc_nibble[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t size)
+{
+    crc = ~crc;
+    while (size--) {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ crc_nibble[crc & 0x0f];
+        crc = (crc >> 4) ^ crc_nibble[crc & 0x0f];
+    }
+    return ~crc;
+}
+
+static uint32_t adler32_update(uint32_t adler, const uint8_t *data, size_t size)
+{
+    uint32_t a = adler & 0xffff, b = adler >> 16;
+    while (size > 0) {
+        // 5552 bytes is the most that can be summed before b may overflow.
+        size_t run = size < 5552 ? size : 5552;
+        size -= run;
+        while (run--) {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+HttpEncoding http_encoding_parse(const char *content_encoding)
+{
+    if (!content_encoding) {
+        return HTTP_ENCODING_IDENTITY;
+    }
+    if (strcasecmp(content_encoding, "gzip") == 0 || strcasecmp(content_encoding, "x-gzip") == 0) {
+        return HTTP_ENCODING_GZIP;
+    }
+    if (strcasecmp(content_encoding, "deflate") == 0) {
+        return HTTP_ENCODING_DEFLATE;
+    }
+    return HTTP_ENCODING_IDENTITY;
+}
+
+const char *http_encoding_name(HttpEncoding encoding)
+{
+    switch (encoding) {
+    case HTTP_ENCODING_GZIP:
+        return "gzip";
+    case HTTP_ENCODING_DEFLATE:
+        return "deflate";
+    default:
+        return "identity";
+    }
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Compression
+//
+namespace {
+
+class BitWriter {
+public:
+    BitWriter(uint8_t *out, size_t size) : _out(out), _size(size), _pos(0), _bits(0), _count(0) {}
+
+    void put(uint32_t value, unsigned bits)
+    {
+        _bits |= value << _count;
+        _count += bits;
+        while (_count >= 8) {
+            byte(_bits);
+            _bits >>= 8;
+            _count -= 8;
+        }
+    }
+
+    // Huffman codes go out most significant bit first.
+    void put_code(uint32_t code, unsigned bits)
+    {
+        uint32_t reversed = 0;
+        for (unsigned ix = 0; ix < bits; ix++) {
+            reversed = (reversed << 1) | ((code >> ix) & 1);
+        }
+        put(reversed, bits);
+    }
+
+    void align()
+    {
+        if (_count > 0) {
+            put(0, 8 - _count);
+        }
+    }
+
+    void byte(uint8_t value)
+    {
+        if (_pos < _size) {
+            _out[_pos] = value;
+        }
+        _pos++;
+    }
+
+    bool overflowed() const { return _pos > _size; }
+    size_t length() const { return _pos; }
+
+private:
+    uint8_t *_out;
+    size_t _size;
+    size_t _pos;
+    uint32_t _bits;
+    unsigned _count;
+};
+
+} // namespace
+
+// Literal/length symbol with the fixed code (RFC 1951, 3.2.6).
+static void put_literal(BitWriter &out, unsigned symbol)
+{
+    if (symbol < 144) {
+        out.put_code(0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        out.put_code(0x190 + symbol - 144, 9);
+    } else if (symbol < 280) {
+        out.put_code(symbol - 256, 7);
+    } else {
+        out.put_code(0xc0 + symbol - 280, 8);
+    }
+}
+
+static void put_match(BitWriter &out, unsigned length, unsigned distance)
+{
+    unsigned code = 28;
+    while (length_base[code] > length) {
+        code--;
+    }
+    put_literal(out, 257 + code);
+    out.put(length - length_base[code], length_extra[code]);
+
+    code = 29;
+    while (distance_base[code] > distance) {
+        code--;
+    }
+    out.put_code(code, 5);
+    out.put(distance - distance_base[code], distance_extra[code]);
+}
+
+static unsigned hash3(const uint8_t *p)
+{
+    return ((p[0] << 16 | p[1] << 8 | p[2]) * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+}
+
+size_t http_deflate(HttpEncoding encoding, const void *data, size_t size, void *out, size_t out_size)
+{
+    const uint8_t *in = static_cast<const uint8_t *>(data);
+    BitWriter writer(static_cast<uint8_t *>(out), out_size);
+
+    if (encoding == HTTP_ENCODING_GZIP) {
+        static const uint8_t header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff };
+        for (size_t ix = 0; ix < sizeof(header); ix++) {
+            writer.byte(header[ix]);
+        }
+    } else if (encoding == HTTP_ENCODING_DEFLATE) {
+        writer.byte(0x78);      // deflate, 32 KB window
+        writer.byte(0x01);      // fastest, no dictionary
+    } else {
+        return 0;
+    }
+
+    // One final block with the fixed codes.
+    writer.put(1, 1);
+    writer.put(1, 2);
+
+    // Positions are kept modulo 64 KB; every candidate is checked byte by
+    // byte, so a stale or wrapped entry only costs a missed match.
+    uint16_t head[1 << DEFLATE_HASH_BITS];
+    memset(head, 0, sizeof(head));
+
+    size_t pos = 0;
+    while (pos < size && !writer.overflowed()) {
+        if (pos + 3 <= size) {
+            unsigned hash = hash3(in + pos);
+            size_t distance = (uint16_t)(pos - head[hash]);
+            head[hash] = pos;
+            if (distance > 0 && distance <= DEFLATE_MAX_DISTANCE && distance <= pos) {
+                const uint8_t *match = in + pos - distance;
+                size_t limit = size - pos < 258 ? size - pos : 258;
+                size_t length = 0;
+                while (length < limit && match[length] == in[pos + length]) {
+                    length++;
+                }
+                if (length >= 3) {
+                    put_match(writer, length, distance);
+                    // Index the positions inside the match too, cheaply.
+                    for (size_t end = pos + length, ix = pos + 1; ix < end && ix + 3 <= size; ix++) {
+                        head[hash3(in + ix)] = ix;
+                    }
+                    pos += length;
+                    continue;
+                }
+            }
+        }
+        put_literal(writer, in[pos++]);
+    }
+    put_literal(writer, 256);
+    writer.align();
+
+    if (encoding == HTTP_ENCODING_GZIP) {
+        uint32_t crc = crc32_update(0, in, size);
+        writer.put(crc & 0xffff, 16);
+        writer.put(crc >> 16, 16);
+        writer.put(size & 0xffff, 16);
+        writer.put((size >> 16) & 0xffff, 16);
+    } else {
+        uint32_t adler = adler32_update(1, in, size);
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            writer.byte(adler >> shift);
+        }
+    }
+    return writer.overflowed() ? 0 : writer.length();
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// InflateSink
+//
+InflateSink::InflateSink(HttpBodySink *next, HttpEncoding encoding)
+{
+    _lencode.count = _lencount;
+    _lencode.symbol = _lensymbol;
+    _distcode.count = _distcount;
+    _distcode.symbol = _distsymbol;
+    reset(next, encoding);
+}
+
+void InflateSink::reset(HttpBodySink *next, HttpEncoding encoding)
+{
+    _next = next;
+    _encoding = encoding;
+    _state = encoding == HTTP_ENCODING_IDENTITY ? PASS : START;
+    _failure = 0;
+    _bits = 0;
+    _bit_count = 0;
+    _last = false;
+    _check = encoding == HTTP_ENCODING_DEFLATE ? 1 : 0;
+    _input_length = 0;
+    _output_length = 0;
+    _pos = 0;
+    _flushed = 0;
+}
+
+// Pulls input into the bit buffer until it holds at least bits.
+bool InflateSink::need(unsigned bits)
+{
+    while (_bit_count < bits) {
+        if (_in == _in_end) {
+            return false;
+        }
+        _bits |= (uint32_t)*_in++ << _bit_count;
+        _bit_count += 8;
+    }
+    return true;
+}
+
+uint32_t InflateSink::take(unsigned bits)
+{
+    uint32_t value = _bits & ((1u << bits) - 1);
+    _bits >>= bits;
+    _bit_count -= bits;
+    return value;
+}
+
+//
+// Canonical Huffman decoding one bit at a time.  The symbol is not consumed:
+// *length is set to its code length for take().  Returns NEED_INPUT with
+// nothing consumed when the input ran out part way through.
+//
+int InflateSink::decode(const Huffman &huffman, unsigned *length)
+{
+    int code = 0, first = 0, index = 0;
+    for (unsigned bits = 1; bits < 16; bits++) {
+        if (!need(bits)) {
+            return NEED_INPUT;
+        }
+        code |= (_bits >> (bits - 1)) & 1;
+        int count = huffman.count[bits];
+        if (code - count < first) {
+            *length = bits;
+            return huffman.symbol[index + (code - first)];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return BAD_CODE;
+}
+
+// Builds a decoding table from code lengths, which must not be over-subscribed.
+int InflateSink::build(Huffman &huffman, const uint8_t *lengths, unsigned count)
+{
+    memset(huffman.count, 0, 16 * sizeof(uint16_t));
+    for (unsigned symbol = 0; symbol < count; symbol++) {
+        huffman.count[lengths[symbol]]++;
+    }
+    int left = 1;
+    for (unsigned bits = 1; bits < 16; bits++) {
+        left = (left << 1) - huffman.count[bits];
+        if (left < 0) {
+            return HTTP_INFLATE_ERROR_FORMAT;
+        }
+    }
+    uint16_t offsets[16];
+    offsets[1] = 0;
+    for (unsigned bits = 1; bits < 15; bits++) {
+        offsets[bits + 1] = offsets[bits] + huffman.count[bits];
+    }
+    for (unsigned symbol = 0; symbol < count; symbol++) {
+        if (lengths[symbol]) {
+            huffman.symbol[offsets[lengths[symbol]]++] = symbol;
+        }
+    }
+    return 0;
+}
+
+// Tables of a dynamic block from the lengths read into _lengths.
+int InflateSink::build_tables()
+{
+    if (_lengths[256] == 0) {
+        return HTTP_INFLATE_ERROR_FORMAT;       // no end-of-block code
+    }
+    int ret = build(_lencode, _lengths, _literals);
+    if (ret == 0) {
+        ret = build(_distcode, _lengths + _literals, _distances);
+    }
+    return ret;
+}
+
+int InflateSink::flush()
+{
+    size_t size = _pos - _flushed;
+    if (size > 0) {
+        const uint8_t *data = _window + _flushed;
+        if (_encoding == HTTP_ENCODING_GZIP) {
+            _check = crc32_update(_check, data, size);
+        } else {
+            _check = adler32_update(_check, data, size);
+        }
+        if (_next) {
+            int ret = _next->write(data, size);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+    }
+    if (_pos == MBED_CONF_APP_HTTP_INFLATE_WINDOW) {
+        _pos = 0;
+    }
+    _flushed = _pos;
+    return 0;
+}
+
+// Adds one byte of output, passing the window on when it fills.
+inline int InflateSink::put(uint8_t c)
+{
+    _window[_pos++] = c;
+    _output_length++;
+    return _pos == MBED_CONF_APP_HTTP_INFLATE_WINDOW ? flush() : 0;
+}
+
+int InflateSink::copy(unsigned distance, unsigned length)
+{
+    if (distance > _output_length || distance > MBED_CONF_APP_HTTP_INFLATE_WINDOW) {
+        return HTTP_INFLATE_ERROR_DISTANCE;
+    }
+    size_t from = (_pos + MBED_CONF_APP_HTTP_INFLATE_WINDOW - distance) % MBED_CONF_APP_HTTP_INFLATE_WINDOW;
+    while (length--) {
+        int ret = put(_window[from]);
+        if (ret < 0) {
+            return ret;
+        }
+        if (++from == MBED_CONF_APP_HTTP_INFLATE_WINDOW) {
+            from = 0;
+        }
+    }
+    return 0;
+}
+
+//
+// Runs the decoder over the input until it is used up (0), the stream ends
+// (0, in state DONE) or it fails.  Every step first makes sure all the bits
+// it needs are buffered, so a step is either done whole or left for the
+// next write().
+//
+int InflateSink::inflate()
+{
+    int ret = 0;
+    unsigned length;
+    int symbol;
+
+    for (;;) {
+        switch (_state) {
+        case START:
+            if (_encoding == HTTP_ENCODING_GZIP) {
+                _state = GZIP_HEADER;
+            } else if (_encoding == HTTP_ENCODING_DEFLATE) {
+                _state = ZLIB_HEADER;
+            } else {
+                if (!need(8)) {
+                    return 0;
+                }
+                if ((_bits & 0xff) == 0x1f) {
+                    _encoding = HTTP_ENCODING_GZIP;
+                    _state = GZIP_HEADER;
+                    break;
+                }
+                if (!need(16)) {
+                    return 0;
+                }
+                unsigned cmf = _bits & 0xff, flg = (_bits >> 8) & 0xff;
+                if ((cmf & 0x0f) == 8 && (cmf >> 4) <= 7 && ((cmf << 8) | flg) % 31 == 0) {
+                    _encoding = HTTP_ENCODING_DEFLATE;
+                    _check = 1;
+                    _state = ZLIB_HEADER;
+                    break;
+                }
+                // Not compressed: hand on the two bytes held and then the rest.
+                _encoding = HTTP_ENCODING_IDENTITY;
+                _state = PASS;
+                uint8_t held[2] = { (uint8_t)cmf, (uint8_t)flg };
+                _bits = _bit_count = 0;
+                if (_next) {
+                    ret = _next->write(held, sizeof(held));
+                }
+                _output_length += sizeof(held);
+                if (ret < 0) {
+                    return ret;
+                }
+            }
+            break;
+
+        case GZIP_HEADER:
+            if (!need(32)) {
+                return 0;
+            }
+            if (take(8) != 0x1f || take(8) != 0x8b || take(8) != 8) {
+                return HTTP_INFLATE_ERROR_FORMAT;
+            }
+            _flags = take(8);
+            _skip = 6;          // mtime, extra flags, OS
+            _state = GZIP_FIELDS;
+            break;
+
+        case GZIP_FIELDS:
+            if (_skip > 0) {
+                if (!need(8)) {
+                    return 0;
+                }
+                take(8);
+                _skip--;
+            } else if (_flags & GZIP_FEXTRA) {
+                if (!need(16)) {
+                    return 0;
+                }
+                _skip = take(16);
+                _flags &= ~GZIP_FEXTRA;
+            } else if (_flags & (GZIP_FNAME | GZIP_FCOMMENT)) {
+                // Zero-terminated file name, then comment.
+                if (!need(8)) {
+                    return 0;
+                }
+                if (take(8) == 0) {
+                    _flags &= (_flags & GZIP_FNAME) ? ~GZIP_FNAME : ~GZIP_FCOMMENT;
+                }
+            } else if (_flags & GZIP_FHCRC) {
+                _skip = 2;
+                _flags &= ~GZIP_FHCRC;
+            } else {
+                _state = BLOCK;
+            }
+            break;
+
+        case ZLIB_HEADER:
+            if (!need(16)) {
+                return 0;
+            }
+            {
+                unsigned cmf = take(8), flg = take(8);
+                if ((cmf & 0x0f) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) {
+                    return HTTP_INFLATE_ERROR_FORMAT;
+                }
+            }
+            _state = BLOCK;
+            break;
+
+        case BLOCK:
+            if (!need(3)) {
+                return 0;
+            }
+            _last = take(1);
+            switch (take(2)) {
+            case 0:
+                _state = STORED;
+                break;
+            case 1:
+                // The fixed codes (RFC 1951, 3.2.6), rebuilt in the shared tables.
+                memset(_lengths, 8, 144);
+                memset(_lengths + 144, 9, 112);
+                memset(_lengths + 256, 7, 24);
+                memset(_lengths + 280, 8, 8);
+                memset(_lengths + 288, 5, 30);
+                _literals = 288;
+                _distances = 30;
+                build(_lencode, _lengths, _literals);
+                build(_distcode, _lengths + _literals, _distances);
+                _state = CODES;
+                break;
+            case 2:
+                _state = TABLE_COUNTS;
+                break;
+            default:
+                return HTTP_INFLATE_ERROR_FORMAT;
+            }
+            break;
+
+        case STORED:
+            take(_bit_count & 7);
+            if (!need(32)) {
+                return 0;
+            }
+            _length = take(16);
+            if (take(16) != (uint16_t)~_length) {
+                return HTTP_INFLATE_ERROR_FORMAT;
+            }
+            _state = STORED_COPY;
+            break;
+
+        case STORED_COPY:
+            while (_length > 0) {
+                if (_bit_count >= 8) {
+                    ret = put(take(8));
+                } else if (_in < _in_end) {
+                    ret = put(*_in++);
+                } else {
+                    return 0;
+                }
+                if (ret < 0) {
+                    return ret;
+                }
+                _length--;
+            }
+            _state = _last ? TRAILER : BLOCK;
+            break;
+
+        case TABLE_COUNTS:
+            if (!need(14)) {
+                return 0;
+            }
+            _literals = take(5) + 257;
+            _distances = take(5) + 1;
+            _code_lengths = take(4) + 4;
+            if (_literals > 286 || _distances > 30) {
+                return HTTP_INFLATE_ERROR_FORMAT;
+            }
+            memset(_lengths, 0, 19);
+            _index = 0;
+            _state = TABLE_CODES;
+            break;
+
+        case TABLE_CODES:
+            while (_index < _code_lengths) {
+                if (!need(3)) {
+                    return 0;
+                }
+                _lengths[code_length_order[_index++]] = take(3);
+            }
+            // The code length code borrows the literal/length table.
+            if (build(_lencode, _lengths, 19) < 0) {
+                return HTTP_INFLATE_ERROR_FORMAT;
+            }
+            _index = 0;
+            _state = TABLE_LENGTHS;
+            break;
+
+        case TABLE_LENGTHS:
+            while (_index < _literals + _distances) {
+                symbol = decode(_lencode, &length);
+                if (symbol == NEED_INPUT) {
+                    return 0;
+                }
+                if (symbol < 0) {
+                    return HTTP_INFLATE_ERROR_FORMAT;
+                }
+                if (symbol < 16) {
+                    take(length);
+                    _lengths[_index++] = symbol;
+                    continue;
+                }
+                // 16 repeats the previous length 3-6 times, 17 and 18 give
+                // runs of 3-10 and 11-138 zeros.
+                unsigned extra = symbol == 16 ? 2 : symbol == 17 ? 3 : 7;
+                if (!need(length + extra)) {
+                    return 0;
+                }
+                take(length);
+                unsigned repeat = take(extra) + (symbol == 18 ? 11 : 3);
+                if (_index + repeat > _literals + _distances || (symbol == 16 && _index == 0)) {
+                    return HTTP_INFLATE_ERROR_FORMAT;
+                }
+                uint8_t value = symbol == 16 ? _lengths[_index - 1] : 0;
+                memset(_lengths + _index, value, repeat);
+                _index += repeat;
+            }
+            ret = build_tables();
+            if (ret < 0) {
+                return ret;
+            }
+            _state = CODES;
+            break;
+
+        case CODES:
+            for (;;) {
+                symbol = decode(_lencode, &length);
+                if (symbol == NEED_INPUT) {
+                    return 0;
+                }
+                if (symbol < 0 || symbol > 285) {
+                    return HTTP_INFLATE_ERROR_FORMAT;
+                }
+                take(length);
+                if (symbol < 256) {
+                    ret = put(symbol);
+                    if (ret < 0) {
+                        return ret;
+                    }
+                    continue;
+                }
+                if (symbol == 256) {
+                    _state = _last ? TRAILER : BLOCK;
+                } else {
+                    _symbol = symbol - 257;
+                    _state = LENGTH_EXTRA;
+                }
+                break;
+            }
+            break;
+
+        case LENGTH_EXTRA:
+            if (!need(length_extra[_symbol])) {
+                return 0;
+            }
+            _length = length_base[_symbol] + take(length_extra[_symbol]);
+            _state = DISTANCE;
+            break;
+
+        case DISTANCE:
+            symbol = decode(_distcode, &length);
+            if (symbol == NEED_INPUT) {
+                return 0;
+            }
+            if (symbol < 0 || symbol > 29) {
+                return HTTP_INFLATE_ERROR_FORMAT;
+            }
+            take(length);
+            _symbol = symbol;
+            _state = DISTANCE_EXTRA;
+            break;
+
+        case DISTANCE_EXTRA:
+            if (!need(distance_extra[_symbol])) {
+                return 0;
+            }
+            ret = copy(distance_base[_symbol] + take(distance_extra[_symbol]), _length);
+            if (ret < 0) {
+                return ret;
+            }
+            _state = CODES;
+            break;
+
+        case TRAILER:
+            take(_bit_count & 7);
+            if (!need(32)) {
+                return 0;
+            }
+            ret = flush();
+            if (ret < 0) {
+                return ret;
+            }
+            if (_encoding == HTTP_ENCODING_GZIP) {
+                uint32_t crc = take(16);
+                crc |= take(16) << 16;
+                if (crc != _check) {
+                    return HTTP_INFLATE_ERROR_CHECKSUM;
+                }
+                _state = DONE;      // the input size that follows is not checked
+                break;
+            }
+            {
+                uint32_t adler = 0;
+                for (int ix = 0; ix < 4; ix++) {
+                    adler = (adler << 8) | take(8);
+                }
+                if (adler != _check) {
+                    return HTTP_INFLATE_ERROR_CHECKSUM;
+                }
+            }
+            _state = DONE;
+            break;
+
+        case DONE:
+            // Anything after the stream (the gzip size, padding) is ignored.
+            _bits = _bit_count = 0;
+            _in = _in_end;
+            return 0;
+
+        case PASS:
+            if (_in < _in_end && _next) {
+                ret = _next->write(_in, _in_end - _in);
+            }
+            _output_length += _in_end - _in;
+            _in = _in_end;
+            return ret < 0 ? ret : 0;
+        }
+    }
+}
+
+int InflateSink::write(const void *data, size_t size)
+{
+    if (_failure) {
+        return _failure;
+    }
+    _in = static_cast<const uint8_t *>(data);
+    _in_end = _in + size;
+    _input_length += size;
+
+    int ret = inflate();
+    if (ret == 0 && _state != PASS) {
+        ret = flush();
+    }
+    if (ret < 0) {
+        _failure = ret;
+        return ret;
+    }
+    return size;
+}
+
+void InflateSink::finish(bool complete)
+{
+    if (_state == START && _encoding == HTTP_ENCODING_AUTO && _failure == 0) {
+        // Too short to tell: it was not compressed.
+        uint8_t held = _bits;
+        size_t size = _bit_count / 8;
+        _state = PASS;
+        _encoding = HTTP_ENCODING_IDENTITY;
+        _output_length += size;
+        if (size > 0 && _next && _next->write(&held, size) < 0) {
+            complete = false;
+        }
+    }
+    if (_next) {
+        _next->finish(complete && _failure == 0 && done());
+    }
+}
@@ -0,0 +1,131 @@
+#ifndef _HTTP_DEFLATE_H_
+#define _HTTP_DEFLATE_H_
+
+#include "mbed.h"
+#include "http-sink.h"
+
+#ifndef MBED_CONF_APP_HTTP_INFLATE_WINDOW
+#define MBED_CONF_APP_HTTP_INFLATE_WINDOW   4096    // bytes of history kept while inflating
+#endif
+
+// Failures of InflateSink::write(), which become the request's error.
+#define HTTP_INFLATE_ERROR_FORMAT       -3401   // not gzip/zlib, or corrupt deflate data
+#define HTTP_INFLATE_ERROR_DISTANCE     -3402   // back-reference beyond the window
+#define HTTP_INFLATE_ERROR_CHECKSUM     -3403
+#define HTTP_INFLATE_ERROR_TRUNCATED    -3404
+
+enum HttpEncoding {
+    HTTP_ENCODING_IDENTITY,
+    HTTP_ENCODING_DEFLATE,      // zlib stream (RFC 1950), which is what HTTP calls deflate
+    HTTP_ENCODING_GZIP,
+    HTTP_ENCODING_AUTO          // inflating only: decide from the first bytes
+};
+
+// Content-Encoding value to HttpEncoding; IDENTITY for anything unknown.
+HttpEncoding http_encoding_parse(const char *content_encoding);
+const char *http_encoding_name(HttpEncoding encoding);
+
+//
+// Compresses size bytes at data into out as a gzip or zlib stream.  Matches
+// are found greedily through a small hash of the input itself and coded with
+// the fixed Huffman tables, which keeps the compressor to a few hundred bytes
+// of stack and suits the short JSON documents the demos send.  Returns the
+// compressed length, or 0 when it does not fit in out_size.
+//
+size_t http_deflate(HttpEncoding encoding, const void *data, size_t size, void *out, size_t out_size);
+
+//
+// Streaming gzip/zlib decoder that passes the inflated body on to another
+// sink.  Input is taken in whatever pieces the socket delivers: the decoder
+// stops between symbols when a piece runs out and carries on with the next.
+// Output collects in a fixed window of MBED_CONF_APP_HTTP_INFLATE_WINDOW
+// bytes that doubles as the history for back-references, and goes to next
+// whenever the window fills and at the end of every write().
+//
+// Servers compress with up to 32 KB of history, so a body that decodes to
+// more than the window can refer back further than the window reaches; that
+// fails with HTTP_INFLATE_ERROR_DISTANCE.  Set the window to 32768 if such
+// bodies must be accepted.
+//
+// One InflateSink decodes one body at a time; reset() it before the next.
+// With HTTP_ENCODING_AUTO a body that is neither gzip nor zlib is passed on
+// unchanged, which lets it sit behind mbed-http's body callback, where the
+// Content-Encoding is not known in advance.
+//
+class InflateSink : public HttpBodySink {
+public:
+    InflateSink(HttpBodySink *next = NULL, HttpEncoding encoding = HTTP_ENCODING_AUTO);
+
+    void reset(HttpBodySink *next, HttpEncoding encoding = HTTP_ENCODING_AUTO);
+
+    virtual int write(const void *data, size_t size);
+    virtual void finish(bool complete);
+
+    // The whole stream was decoded and its checksum matched.
+    bool done() const { return _state == DONE || _state == PASS; }
+    HttpEncoding encoding() const { return _encoding; }
+    size_t input_length() const { return _input_length; }
+    size_t output_length() const { return _output_length; }
+
+private:
+    enum State {
+        START, GZIP_HEADER, GZIP_FIELDS, ZLIB_HEADER,
+        BLOCK, STORED, STORED_COPY, TABLE_COUNTS, TABLE_CODES, TABLE_LENGTHS,
+        CODES, LENGTH_EXTRA, DISTANCE, DISTANCE_EXTRA,
+        TRAILER, DONE, PASS
+    };
+
+    struct Huffman {
+        uint16_t *count;        // codes of each length
+        uint16_t *symbol;       // symbols in canonical order
+    };
+
+    int inflate();
+    int flush();
+    int put(uint8_t c);
+    int copy(unsigned distance, unsigned length);
+
+    bool need(unsigned bits);
+    uint32_t take(unsigned bits);
+    int decode(const Huffman &huffman, unsigned *length);
+    int build(Huffman &huffman, const uint8_t *lengths, unsigned count);
+    int build_tables();
+
+    HttpBodySink *_next;
+    HttpEncoding _encoding;
+    State _state;
+    int _failure;
+
+    const uint8_t *_in;
+    const uint8_t *_in_end;
+    uint32_t _bits;
+    unsigned _bit_count;
+
+    bool _last;                 // the block being decoded is the final one
+    uint8_t _flags;             // gzip header flags still to skip
+    uint16_t _skip;             // header bytes still to skip
+    uint16_t _index;
+    uint16_t _literals;         // dynamic block code counts
+    uint16_t _distances;
+    uint16_t _code_lengths;
+    uint16_t _symbol;
+    uint16_t _length;
+
+    uint32_t _check;            // CRC-32 (gzip) or Adler-32 (zlib) of the output
+    size_t _input_length;
+    size_t _output_length;
+
+    Huffman _lencode;
+    Huffman _distcode;
+    uint16_t _lencount[16];
+    uint16_t _lensymbol[288];
+    uint16_t _distcount[16];
+    uint16_t _distsymbol[30];
+    uint8_t _lengths[320];
+
+    uint8_t _window[MBED_CONF_APP_HTTP_INFLATE_WINDOW];
+    size_t _pos;                // next byte written in the window
+    size_t _flushed;            // window bytes before this went to next
+};
+
+#endif // _HTTP_DEFLATE_H_
@@ -0,0 +1,53 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          http-head-template.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <string.h>
+#include "http-head-template.h"
+
+size_t http_head_put_length(char *at, uint32_t content_length)
+{
+    char digits[HTTP_LENGTH_FIELD_SIZE];
+    size_t count = 0;
+    do {
+        digits[count++] = '0' + content_length % 10;
+        content_length /= 10;
+    } while (content_length > 0);
+    for (size_t ix = 0; ix < count; ix++) {
+        at[ix] = digits[count - 1 - ix];
+    }
+    return count;
+}
+
+size_t http_head_render(const HttpHeadTemplate *head, uint32_t content_length, char *buffer, size_t size)
+{
+    if (head->length > size) {
+        return 0;
+    }
+    if (!head->length_field) {
+        memcpy(buffer, head->text, head->length);
+        return head->length;
+    }
+    size_t length = head->length_field;
+    memcpy(buffer, head->text, length);
+    length += http_head_put_length(buffer + length, content_length);
+    memcpy(buffer + length, "\r\n\r\n", 4);
+    return length + 4;
+}
@@ -0,0 +1,56 @@
+#ifndef _HTTP_HEAD_TEMPLATE_H_
+#define _HTTP_HEAD_TEMPLATE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// Request heads (request line and headers) for fixed endpoints, put
+// together by the compiler: the macros below concatenate string literals
+// into one constant, so a template costs a flash string and no code runs to
+// build it.  Only Content-Length varies per request: it is the template's
+// last header, so its value is written where the template holds a field of
+// spaces wide enough for any length, and the head ends right after it.
+//
+//   static const HttpHeadTemplate post_json = HTTP_HEAD_TEMPLATE_WITH_BODY(
+//       "POST", "/post", "httpbin.org", HTTP_HEADER_LINE("Content-Type", "application/json"));
+//
+//   size_t length = http_head_render(&post_json, body_size, buffer, sizeof(buffer));
+//
+// Given to HttpClientRequest::set_head_template() a template stands in for
+// the request line and Host; set_header() lines still follow it.
+//
+struct HttpHeadTemplate {
+    const char *text;           // request line and headers, up to and including the blank line
+    uint16_t length;            // of text, the longest a rendered head can be
+    uint16_t length_field;      // offset of the Content-Length value, or 0 without one
+};
+
+#define HTTP_LENGTH_FIELD_SIZE  10      // digits of the largest Content-Length, 2^32 - 1
+#define HTTP_LENGTH_FIELD       "          "
+
+// One header line of a template.
+#define HTTP_HEADER_LINE(field, value)  field ": " value "\r\n"
+
+#define HTTP_HEAD_TEXT(method, path, host, headers) \
+    method " " path " HTTP/1.1\r\nHost: " host "\r\n" headers
+
+// A head for requests without a body (GET, HEAD, DELETE...).
+#define HTTP_HEAD_TEMPLATE(method, path, host, headers) \
+    { HTTP_HEAD_TEXT(method, path, host, headers) "\r\n", \
+      sizeof(HTTP_HEAD_TEXT(method, path, host, headers) "\r\n") - 1, 0 }
+
+// A head with a Content-Length to fill in.
+#define HTTP_HEAD_TEMPLATE_WITH_BODY(method, path, host, headers) \
+    { HTTP_HEAD_TEXT(method, path, host, headers) "Content-Length: " HTTP_LENGTH_FIELD "\r\n\r\n", \
+      sizeof(HTTP_HEAD_TEXT(method, path, host, headers) "Content-Length: " HTTP_LENGTH_FIELD "\r\n\r\n") - 1, \
+      sizeof(HTTP_HEAD_TEXT(method, path, host, headers) "Content-Length: ") - 1 }
+
+// Writes content_length in decimal at at; returns the digits written.
+size_t http_head_put_length(char *at, uint32_t content_length);
+
+// Copies head into buffer with content_length filled in.  Returns the
+// length of the head, or 0 when it does not fit in size.
+size_t http_head_render(const HttpHeadTemplate *head, uint32_t content_length, char *buffer, size_t size);
+
+#endif // _HTTP_HEAD_TEMPLATE_H_
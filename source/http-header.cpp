@@ -0,0 +1,112 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          http-header.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <string.h>
+#include <strings.h>
+#include "http-header.h"
+
+#define HTTP_HEADER_SLOTS   64      // power of two, well above HTTP_HEADER_COUNT
+
+// In HttpHeaderId order.
+static const char *const header_names[HTTP_HEADER_COUNT] = {
+    NULL,
+    "Accept-Ranges",
+    "Age",
+    "Cache-Control",
+    "Connection",
+    "Content-Encoding",
+    "Content-Length",
+    "Content-Range",
+    "Content-Type",
+    "Date",
+    "ETag",
+    "Expires",
+    "Keep-Alive",
+    "Last-Modified",
+    "Location",
+    "Retry-After",
+    "Sec-WebSocket-Accept",
+    "Server",
+    "Set-Cookie",
+    "Transfer-Encoding",
+    "Upgrade",
+    "Vary",
+    "WWW-Authenticate",
+    "Access-Control-Allow-Origin",
+    "Access-Control-Allow-Credentials",
+};
+
+//
+// Open-addressed table from name hash to ID, filled in before main() by the
+// constructor below and only read afterwards.
+//
+static uint8_t header_slots[HTTP_HEADER_SLOTS];
+
+static struct HeaderTableInit {
+    HeaderTableInit()
+    {
+        for (int id = 1; id < HTTP_HEADER_COUNT; id++) {
+            const char *name = header_names[id];
+            unsigned slot = http_header_hash(name, strlen(name)) & (HTTP_HEADER_SLOTS - 1);
+            while (header_slots[slot]) {
+                slot = (slot + 1) & (HTTP_HEADER_SLOTS - 1);
+            }
+            header_slots[slot] = id;
+        }
+    }
+} header_table_init;
+
+// FNV-1a folded to 16 bits, over the lower-cased name.
+uint16_t http_header_hash(const char *name, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t ix = 0; ix < length; ix++) {
+        uint8_t c = name[ix];
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        hash = (hash ^ c) * 16777619u;
+    }
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+
+HttpHeaderId http_header_intern(const char *name, size_t length, uint16_t hash)
+{
+    for (unsigned slot = hash & (HTTP_HEADER_SLOTS - 1); header_slots[slot];
+            slot = (slot + 1) & (HTTP_HEADER_SLOTS - 1)) {
+        const char *candidate = header_names[header_slots[slot]];
+        if (strncasecmp(candidate, name, length) == 0 && candidate[length] == '\0') {
+            return (HttpHeaderId)header_slots[slot];
+        }
+    }
+    return HTTP_HEADER_OTHER;
+}
+
+HttpHeaderId http_header_intern(const char *name)
+{
+    size_t length = strlen(name);
+    return http_header_intern(name, length, http_header_hash(name, length));
+}
+
+const char *http_header_name(HttpHeaderId id)
+{
+    return id > HTTP_HEADER_OTHER && id < HTTP_HEADER_COUNT ? header_names[id] : NULL;
+}
@@ -0,0 +1,52 @@
+#ifndef _HTTP_HEADER_H_
+#define _HTTP_HEADER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// Header field names the client and the demos look at, interned as small
+// integers.  An interned field is stored as its ID alone, and finding it in
+// a response is an array lookup rather than a string search.
+//
+enum HttpHeaderId {
+    HTTP_HEADER_OTHER = 0,          // not interned; compare names
+    HTTP_HEADER_ACCEPT_RANGES,
+    HTTP_HEADER_AGE,
+    HTTP_HEADER_CACHE_CONTROL,
+    HTTP_HEADER_CONNECTION,
+    HTTP_HEADER_CONTENT_ENCODING,
+    HTTP_HEADER_CONTENT_LENGTH,
+    HTTP_HEADER_CONTENT_RANGE,
+    HTTP_HEADER_CONTENT_TYPE,
+    HTTP_HEADER_DATE,
+    HTTP_HEADER_ETAG,
+    HTTP_HEADER_EXPIRES,
+    HTTP_HEADER_KEEP_ALIVE,
+    HTTP_HEADER_LAST_MODIFIED,
+    HTTP_HEADER_LOCATION,
+    HTTP_HEADER_RETRY_AFTER,
+    HTTP_HEADER_SEC_WEBSOCKET_ACCEPT,
+    HTTP_HEADER_SERVER,
+    HTTP_HEADER_SET_COOKIE,
+    HTTP_HEADER_TRANSFER_ENCODING,
+    HTTP_HEADER_UPGRADE,
+    HTTP_HEADER_VARY,
+    HTTP_HEADER_WWW_AUTHENTICATE,
+    HTTP_HEADER_ACCESS_CONTROL_ALLOW_ORIGIN,
+    HTTP_HEADER_ACCESS_CONTROL_ALLOW_CREDENTIALS,
+    HTTP_HEADER_COUNT
+};
+
+// Case-insensitive hash of a field name, the same for every spelling.
+uint16_t http_header_hash(const char *name, size_t length);
+
+// ID of a field name (any case), or HTTP_HEADER_OTHER.  hash is
+// http_header_hash(name, length).
+HttpHeaderId http_header_intern(const char *name, size_t length, uint16_t hash);
+HttpHeaderId http_header_intern(const char *name);
+
+// Canonical spelling of an interned field, e.g. "Content-Length".
+const char *http_header_name(HttpHeaderId id);
+
+#endif // _HTTP_HEADER_H_
@@ -0,0 +1,103 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          http-memory.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include "http-memory.h"
+
+HttpArenaPool http_arena_pool;
+
+HttpArena::HttpArena()
+    : _block(static_cast<char *>(http_arena_pool.alloc())), _front(0),
+      _back(MBED_CONF_APP_HTTP_ARENA_SIZE), _peak(0)
+{
+}
+
+HttpArena::~HttpArena()
+{
+    http_arena_pool.free(_block);
+}
+
+void HttpArena::touch()
+{
+    size_t used = _front + (MBED_CONF_APP_HTTP_ARENA_SIZE - _back);
+    if (used > _peak) {
+        _peak = used;
+    }
+}
+
+void *HttpArena::alloc(size_t size)
+{
+    size_t start = (_front + HTTP_ARENA_ALIGN - 1) & ~(HTTP_ARENA_ALIGN - 1);
+    if (!_block || start > _back || size > _back - start) {
+        return NULL;
+    }
+    _front = start + size;
+    touch();
+    return _block + start;
+}
+
+char *HttpArena::strdup(const char *str, size_t length)
+{
+    char *copy = static_cast<char *>(alloc(length + 1));
+    if (copy) {
+        memcpy(copy, str, length);
+        copy[length] = '\0';
+    }
+    return copy;
+}
+
+char *HttpArena::append(char *str, size_t *length, const char *at, size_t size)
+{
+    if (!str) {
+        str = strdup(at, size);
+        *length = str ? size : 0;
+        return str;
+    }
+    if (str + *length + 1 == _block + _front) {
+        // Latest allocation: grow it where it is.
+        if (size > _back - _front) {
+            return NULL;
+        }
+        _front += size;
+        touch();
+    } else {
+        char *moved = static_cast<char *>(alloc(*length + size + 1));
+        if (!moved) {
+            return NULL;
+        }
+        memcpy(moved, str, *length);
+        str = moved;
+    }
+    memcpy(str + *length, at, size);
+    *length += size;
+    str[*length] = '\0';
+    return str;
+}
+
+void *HttpArena::alloc_back(size_t size)
+{
+    size_t start = (_back - size) & ~(HTTP_ARENA_ALIGN - 1);
+    if (!_block || size > _back || start < _front) {
+        return NULL;
+    }
+    _back = start;
+    touch();
+    return _block + start;
+}
@@ -0,0 +1,186 @@
+#ifndef _HTTP_MEMORY_H_
+#define _HTTP_MEMORY_H_
+
+#include <stdlib.h>
+#include "mbed.h"
+
+//
+// Memory budget of the HTTP client.  Everything a request needs on the
+// steady-state path comes out of these statically sized pools instead of the
+// general heap, so long uptimes cannot fragment it.
+//
+#ifndef MBED_CONF_APP_HTTP_REQUEST_POOL_SIZE
+#define MBED_CONF_APP_HTTP_REQUEST_POOL_SIZE    4       // HttpClientRequests made with new
+#endif
+
+#ifndef MBED_CONF_APP_HTTP_RESPONSE_POOL_SIZE
+#define MBED_CONF_APP_HTTP_RESPONSE_POOL_SIZE   6       // HttpClientResponses alive at once
+#endif
+
+#ifndef MBED_CONF_APP_HTTP_ARENA_COUNT
+#define MBED_CONF_APP_HTTP_ARENA_COUNT          6       // HttpClientRequests alive at once
+#endif
+
+#ifndef MBED_CONF_APP_HTTP_ARENA_SIZE
+#define MBED_CONF_APP_HTTP_ARENA_SIZE           2048    // URL, headers and receive buffer
+#endif
+
+#ifndef MBED_CONF_APP_HTTP_BODY_COUNT
+#define MBED_CONF_APP_HTTP_BODY_COUNT           4       // responses holding a stored body at once
+#endif
+
+#ifndef MBED_CONF_APP_HTTP_BODY_SIZE
+#define MBED_CONF_APP_HTTP_BODY_SIZE            2048    // most body a response stores; more needs a sink
+#endif
+
+#ifndef MBED_CONF_APP_HTTP_MAX_HEADERS
+#define MBED_CONF_APP_HTTP_MAX_HEADERS          24      // response headers kept
+#endif
+
+#ifndef MBED_CONF_APP_HTTP_MEMORY_BUDGET
+#define MBED_CONF_APP_HTTP_MEMORY_BUDGET        28672   // bytes for all of the above
+#endif
+
+//
+// Fixed number of fixed-size blocks for objects of type T, handed out from a
+// free list in constant time.  When the pool is empty it falls back to
+// malloc() and counts an overflow, so an undersized budget shows up in the
+// statistics instead of as a failed request.
+//
+template <typename T, size_t N>
+class HttpObjectPool {
+public:
+    struct Stats {
+        uint32_t in_use;
+        uint32_t peak;          // most blocks in use at once
+        uint32_t overflows;     // allocations that had to use the heap
+    };
+
+    HttpObjectPool() : _free(NULL)
+    {
+        for (size_t ix = 0; ix < N; ix++) {
+            Block *block = reinterpret_cast<Block *>(_storage[ix]);
+            block->next = _free;
+            _free = block;
+        }
+        memset(&_stats, 0, sizeof(_stats));
+    }
+
+    void *alloc()
+    {
+        _mutex.lock();
+        Block *block = _free;
+        if (block) {
+            _free = block->next;
+            if (++_stats.in_use > _stats.peak) {
+                _stats.peak = _stats.in_use;
+            }
+        } else {
+            _stats.overflows++;
+        }
+        _mutex.unlock();
+        return block ? static_cast<void *>(block) : malloc(sizeof(T));
+    }
+
+    void free(void *ptr)
+    {
+        if (!ptr) {
+            return;
+        }
+        if (!owns(ptr)) {
+            ::free(ptr);
+            return;
+        }
+        _mutex.lock();
+        Block *block = static_cast<Block *>(ptr);
+        block->next = _free;
+        _free = block;
+        _stats.in_use--;
+        _mutex.unlock();
+    }
+
+    const Stats &stats() const { return _stats; }
+
+    static const size_t storage_size = N * sizeof(T);
+
+private:
+    union Block {
+        Block *next;
+        uint64_t align;
+    };
+
+    bool owns(const void *ptr) const
+    {
+        const char *p = static_cast<const char *>(ptr);
+        return p >= reinterpret_cast<const char *>(_storage) &&
+               p < reinterpret_cast<const char *>(_storage) + sizeof(_storage);
+    }
+
+    uint64_t _storage[N][(sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+    Block *_free;
+    Mutex _mutex;
+    Stats _stats;
+};
+
+//
+// Per-request bump allocator over one MBED_CONF_APP_HTTP_ARENA_SIZE block
+// from a shared pool.  Long-lived data (URL, request headers, response status
+// and headers) is allocated from the front and released together with
+// rewind(); short-lived scratch space such as the receive buffer comes from
+// the back, so freeing it never disturbs what the front still holds.
+//
+#define HTTP_ARENA_ALIGN    4
+
+class HttpArena {
+public:
+    HttpArena();
+    ~HttpArena();
+
+    // Front allocations; NULL once the block is full.
+    void *alloc(size_t size);
+    char *strdup(const char *str, size_t length);
+
+    // Appends to str, which must be NULL or NUL terminated and *length long,
+    // in place when it is the latest front allocation.  Returns the (possibly moved)
+    // string, or NULL when there is no room, leaving str untouched.
+    char *append(char *str, size_t *length, const char *at, size_t size);
+
+    // Front allocations as offsets into the block, for compact references.
+    char *at(size_t offset) const { return _block + offset; }
+    size_t offset(const void *ptr) const { return static_cast<const char *>(ptr) - _block; }
+
+    size_t mark() const { return _front; }
+    void rewind(size_t mark) { _front = mark; }
+
+    // Back (scratch) allocations, released with rewind_back().
+    void *alloc_back(size_t size);
+    size_t back_mark() const { return _back; }
+    void rewind_back(size_t mark) { _back = mark; }
+
+    // Most that alloc_back() can still hand out.
+    size_t available() const { return (_back - _front) & ~(HTTP_ARENA_ALIGN - 1); }
+
+    size_t size() const { return MBED_CONF_APP_HTTP_ARENA_SIZE; }
+    size_t peak() const { return _peak; }
+    void reset_peak() { _peak = _front + (size() - _back); }
+
+private:
+    HttpArena(const HttpArena &);
+    HttpArena &operator=(const HttpArena &);
+
+    void touch();
+
+    char *_block;
+    size_t _front;
+    size_t _back;
+    size_t _peak;           // most bytes in use at once
+};
+
+struct HttpArenaBlock {
+    char bytes[MBED_CONF_APP_HTTP_ARENA_SIZE];
+};
+
+typedef HttpObjectPool<HttpArenaBlock, MBED_CONF_APP_HTTP_ARENA_COUNT> HttpArenaPool;
+extern HttpArenaPool http_arena_pool;
+
+#endif // _HTTP_MEMORY_H_
@@ -0,0 +1,240 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          http-pipeline.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include "http-pipeline.h"
+
+HttpPipeline::HttpPipeline(HttpTransport *transport) : _transport(transport), _count(0)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool HttpPipeline::add(HttpClientRequest *request, const void *body, nsapi_size_t body_size)
+{
+    MBED_ASSERT(request->_transport == _transport);
+
+    HttpUrl url;
+    if (!http_url_parse(request->get_url(), &url)) {
+        request->_error = NSAPI_ERROR_PARAMETER;
+        return false;
+    }
+    if (_count == MBED_CONF_APP_PIPELINE_MAX_DEPTH) {
+        return false;
+    }
+    request->_complete = false;
+    request->_started = false;
+    request->_error = NSAPI_ERROR_OK;
+
+    Entry &entry = _queue[_count++];
+    entry.request = request;
+    entry.body = body;
+    entry.body_size = body_size;
+    entry.resent = false;
+    entry.open = false;
+    return true;
+}
+
+void HttpPipeline::fail(Entry &entry, nsapi_error_t error)
+{
+    entry.request->_complete = false;
+    if (entry.request->_error == NSAPI_ERROR_OK) {
+        entry.request->_error = error;
+    }
+    if (entry.open) {
+        entry.open = false;
+        entry.request->abandon();
+    }
+    _stats.failed++;
+}
+
+// Sends the requests built into buffer so far.
+nsapi_error_t HttpPipeline::flush(HttpClientRequest *request, const char *buffer, size_t *length, size_t *carried)
+{
+    if (*carried > 1) {
+        _stats.batches++;
+    }
+    nsapi_error_t sent = *length > 0 ? request->send_all(buffer, *length) : NSAPI_ERROR_OK;
+    *length = 0;
+    *carried = 0;
+    return sent;
+}
+
+nsapi_error_t HttpPipeline::run()
+{
+    nsapi_error_t result = NSAPI_ERROR_OK;
+    bool sequential = false;
+    size_t next = 0;                    // oldest request still waiting
+    if (_count == 0) {
+        return result;
+    }
+
+    // The batch is built in, and the responses read through, scratch at the
+    // back of the first request's arena, as transfer() uses its own.
+    HttpArena *scratch = &_queue[0].request->_arena;
+    size_t scratch_mark = scratch->back_mark();
+    char *buffer = static_cast<char *>(scratch->alloc_back(HTTP_CLIENT_RECV_BUFFER_SIZE));
+    if (!buffer) {
+        for (; next < _count; next++) {
+            fail(_queue[next], NSAPI_ERROR_NO_MEMORY);
+        }
+        _count = 0;
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    while (next < _count) {
+        size_t end = sequential ? next + 1 : _count;
+
+        if (!_transport->connected()) {
+            nsapi_error_t error = _transport->connect();
+            if (error != NSAPI_ERROR_OK) {
+                for (; next < _count; next++) {
+                    fail(_queue[next], error);
+                }
+                result = error;
+                break;
+            }
+        }
+
+        //
+        // The requests of the round are written back to back, as many to a
+        // send as fit in the buffer, then the responses are read back in
+        // order.  A body too long to share the buffer goes out on its own.
+        //
+        nsapi_error_t sent = NSAPI_ERROR_OK;
+        size_t length = 0;
+        size_t carried = 0;             // requests in the buffer
+        size_t ix = next;
+        while (ix < end) {
+            HttpClientRequest *request = _queue[ix].request;
+            size_t mark = request->_arena.back_mark();
+            nsapi_size_t body_size = _queue[ix].body_size;
+            const void *body = request->encode_body(_queue[ix].body, &body_size);
+            size_t head = request->build_head(buffer + length, HTTP_CLIENT_RECV_BUFFER_SIZE - length, body_size);
+            if (head == 0 && length > 0) {
+                // Perhaps only no room behind the others: send those first.
+                sent = flush(request, buffer, &length, &carried);
+                request->_error = NSAPI_ERROR_OK;
+                head = sent == NSAPI_ERROR_OK ? request->build_head(buffer, HTTP_CLIENT_RECV_BUFFER_SIZE, body_size) : 0;
+            }
+            if (sent != NSAPI_ERROR_OK) {
+                request->_arena.rewind_back(mark);
+                break;
+            }
+            if (head == 0) {
+                // Its head did not fit (or its URL is bad): it fails on its
+                // own and leaves the queue, so no response is read into it.
+                request->_arena.rewind_back(mark);
+                fail(_queue[ix], NSAPI_ERROR_NO_MEMORY);
+                result = request->_error;
+                for (size_t move = ix + 1; move < _count; move++) {
+                    _queue[move - 1] = _queue[move];
+                }
+                _count--;
+                end--;
+                continue;
+            }
+            length += head;
+            carried++;
+            if (body_size <= HTTP_CLIENT_RECV_BUFFER_SIZE - length) {
+                memcpy(buffer + length, body, body_size);
+                length += body_size;
+            } else {
+                sent = flush(request, buffer, &length, &carried);
+                if (sent == NSAPI_ERROR_OK) {
+                    sent = request->send_all(body, body_size);
+                }
+            }
+            request->_arena.rewind_back(mark);
+            ix++;
+        }
+        if (sent == NSAPI_ERROR_OK) {
+            sent = flush(_queue[next].request, buffer, &length, &carried);
+        }
+        // Those a failed send never reached wait for the next round.
+        end = ix;
+        if (end == next) {
+            continue;
+        }
+        for (ix = next; ix < end; ix++) {
+            _queue[ix].request->sent();
+        }
+
+        bool lost = sent != NSAPI_ERROR_OK;
+        size_t buffered = 0;
+        while (!lost && next < end) {
+            // One that may go out again keeps its sink and trace open if
+            // nothing of its response arrives.
+            Entry &entry = _queue[next];
+            HttpClientRequest *request = entry.request;
+            request->_resendable = !entry.resent && http_method_idempotent(request->_method);
+            bool answered = request->receive(buffer, &buffered);
+            entry.open = !answered && request->_resendable && !request->_started;
+            request->_resendable = false;
+            if (!answered) {
+                lost = true;
+                break;
+            }
+            _stats.responses++;
+            next++;
+            if (!_transport->connected()) {
+                break;
+            }
+        }
+
+        if (!lost) {
+            // Either all answered, or the server closed the connection after
+            // a response it marked Connection: close and so never processed
+            // the ones behind it: those go out again on a new connection.
+            _stats.resent += end - next;
+            continue;
+        }
+
+        //
+        // The connection failed under us.  Decide, oldest first, which of
+        // the unanswered requests may be sent again, and carry on one
+        // request at a time in case the server does not cope with pipelining.
+        //
+        _transport->close();
+        _stats.fallbacks++;
+        sequential = true;
+
+        size_t keep = next;
+        for (size_t ix = next; ix < end; ix++) {
+            Entry &entry = _queue[ix];
+            if (entry.resent || entry.request->_started || !http_method_idempotent(entry.request->_method)) {
+                fail(entry, sent != NSAPI_ERROR_OK ? sent : NSAPI_ERROR_CONNECTION_LOST);
+                result = NSAPI_ERROR_CONNECTION_LOST;
+            } else {
+                entry.resent = true;
+                _stats.resent++;
+                _queue[keep++] = entry;
+            }
+        }
+        // Requests beyond this round were never sent; keep them queued.
+        for (size_t ix = end; ix < _count; ix++) {
+            _queue[keep++] = _queue[ix];
+        }
+        _count = keep;
+    }
+
+    scratch->rewind_back(scratch_mark);
+    _count = 0;
+    return result;
+}
@@ -0,0 +1,69 @@
+#ifndef _HTTP_PIPELINE_H_
+#define _HTTP_PIPELINE_H_
+
+#include "mbed.h"
+#include "http-client.h"
+
+#ifndef MBED_CONF_APP_PIPELINE_MAX_DEPTH
+#define MBED_CONF_APP_PIPELINE_MAX_DEPTH    5
+#endif
+
+//
+// HTTP/1.1 pipelining: the queued requests are written back to back, as
+// many to a send as fit in one receive buffer, then their responses are
+// parsed in order as they arrive, so a batch costs one round trip instead of
+// one per request.  The buffer is scratch in the first request's arena, so a
+// run takes nothing from the heap.  Content-Length, chunked
+// and HEAD framing are handled by each request's parser; bytes received past
+// the end of one response are handed on to the next.
+//
+// If the connection drops before every response is in, the pipeline
+// reconnects and falls back to sending the rest one at a time.  An unanswered
+// request is sent again only when that is safe: the server announced the
+// close (Connection: close), or the method is idempotent and none of its
+// response had arrived.  Otherwise that request fails with
+// NSAPI_ERROR_CONNECTION_LOST.  A request whose head cannot be built fails
+// alone, unsent (NSAPI_ERROR_NO_MEMORY when it is too long for the buffer).
+//
+class HttpPipeline {
+public:
+    struct Stats {
+        uint32_t batches;       // writes carrying more than one request
+        uint32_t responses;
+        uint32_t resent;
+        uint32_t failed;
+        uint32_t fallbacks;     // connections lost mid-pipeline
+    };
+
+    HttpPipeline(HttpTransport *transport);
+
+    // Queues a request made on this pipeline's transport.  body must stay
+    // valid until run() returns.  False when the pipeline is full.
+    bool add(HttpClientRequest *request, const void *body = NULL, nsapi_size_t body_size = 0);
+
+    // Sends everything queued and collects the responses; afterwards each
+    // request's get_response()/get_error() tell how it went.  Returns
+    // NSAPI_ERROR_OK when every request got a response.  Empties the queue.
+    nsapi_error_t run();
+
+    const Stats &stats() const { return _stats; }
+
+private:
+    struct Entry {
+        HttpClientRequest *request;
+        const void *body;
+        nsapi_size_t body_size;
+        bool resent;
+        bool open;              // unanswered, left open by end_response() for the resend
+    };
+
+    void fail(Entry &entry, nsapi_error_t error);
+    nsapi_error_t flush(HttpClientRequest *request, const char *buffer, size_t *length, size_t *carried);
+
+    HttpTransport *_transport;
+    Entry _queue[MBED_CONF_APP_PIPELINE_MAX_DEPTH];
+    size_t _count;
+    Stats _stats;
+};
+
+#endif // _HTTP_PIPELINE_H_
@@ -0,0 +1,282 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          http-sink.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <string.h>
+#include "http-sink.h"
+#include "binary-util.h"
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// RingBufferSink
+//
+RingBufferSink::RingBufferSink(void *buffer, size_t size, bool overwrite)
+    : _buffer(static_cast<uint8_t *>(buffer)), _size(size), _head(0), _count(0), _dropped(0),
+      _overwrite(overwrite), _finished(false), _complete(false), _readable(0), _writable(0)
+{
+}
+
+// Copies as much as fits; called with the mutex held.
+size_t RingBufferSink::copy_in(const uint8_t *data, size_t size)
+{
+    size_t room = _size - _count;
+    if (size > room) {
+        size = room;
+    }
+    size_t first = _size - _head;
+    if (first > size) {
+        first = size;
+    }
+    memcpy(_buffer + _head, data, first);
+    memcpy(_buffer, data + first, size - first);
+    _head = (_head + size) % _size;
+    _count += size;
+    return size;
+}
+
+int RingBufferSink::write(const void *data, size_t size)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+
+    if (_overwrite && size > _size) {
+        _dropped += size - _size;
+        p += size - _size;
+        size = _size;
+    }
+    while (size > 0) {
+        _mutex.lock();
+        if (_overwrite && _count + size > _size) {
+            size_t excess = _count + size - _size;
+            _count -= excess;
+            _dropped += excess;
+        }
+        size_t copied = copy_in(p, size);
+        _mutex.unlock();
+
+        if (copied > 0) {
+            _readable.release();
+            p += copied;
+            size -= copied;
+        } else {
+            _writable.wait();
+        }
+    }
+    return 0;
+}
+
+void RingBufferSink::finish(bool complete)
+{
+    _mutex.lock();
+    _complete = complete;
+    _finished = true;
+    _mutex.unlock();
+    _readable.release();
+}
+
+size_t RingBufferSink::read(void *data, size_t size, uint32_t timeout_ms)
+{
+    uint8_t *p = static_cast<uint8_t *>(data);
+
+    _mutex.lock();
+    while (_count == 0 && !_finished) {
+        _mutex.unlock();
+        if (_readable.wait(timeout_ms) == 0) {
+            return 0;
+        }
+        _mutex.lock();
+    }
+    if (size > _count) {
+        size = _count;
+    }
+    size_t tail = (_head + _size - _count) % _size;
+    size_t first = _size - tail;
+    if (first > size) {
+        first = size;
+    }
+    memcpy(p, _buffer + tail, first);
+    memcpy(p + first, _buffer, size - first);
+    _count -= size;
+    _mutex.unlock();
+
+    if (size > 0) {
+        _writable.release();
+    }
+    return size;
+}
+
+size_t RingBufferSink::available()
+{
+    _mutex.lock();
+    size_t count = _count;
+    _mutex.unlock();
+    return count;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// FileSink
+//
+int FileSink::write(const void *data, size_t size)
+{
+    if (fwrite(data, 1, size, _file) != size) {
+        return NSAPI_ERROR_DEVICE_ERROR;
+    }
+    _written += size;
+    return 0;
+}
+
+void FileSink::finish(bool complete)
+{
+    (void)complete;
+    fflush(_file);
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// BlockDeviceSink
+//
+BlockDeviceSink::BlockDeviceSink(BlockDevice *bd, bd_addr_t start, bd_size_t limit)
+    : _bd(bd), _start(start), _limit(limit), _program_size(bd->get_program_size()),
+      _erase_size(bd->get_erase_size()), _next(start), _erased_to(start), _written(0),
+      _staging(new uint8_t[bd->get_program_size()]), _staged(0)
+{
+}
+
+BlockDeviceSink::~BlockDeviceSink()
+{
+    delete[] _staging;
+}
+
+// Programs whole units at _next, erasing the blocks they reach first.
+int BlockDeviceSink::program(const void *data, bd_size_t size)
+{
+    while (_erased_to < _next + size) {
+        int ret = _bd->erase(_erased_to, _erase_size);
+        if (ret != 0) {
+            return ret;
+        }
+        _erased_to += _erase_size;
+    }
+    int ret = _bd->program(data, _next, size);
+    if (ret != 0) {
+        return ret;
+    }
+    _next += size;
+    return 0;
+}
+
+int BlockDeviceSink::write(const void *data, size_t size)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    int ret;
+
+    if (_written + size > _limit) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+    _written += size;
+
+    // Top up a unit left over from the previous chunk.
+    if (_staged > 0) {
+        bd_size_t fill = _program_size - _staged;
+        if (fill > size) {
+            fill = size;
+        }
+        memcpy(_staging + _staged, p, fill);
+        _staged += fill;
+        p += fill;
+        size -= fill;
+        if (_staged < _program_size) {
+            return 0;
+        }
+        ret = program(_staging, _program_size);
+        if (ret != 0) {
+            return ret;
+        }
+        _staged = 0;
+    }
+
+    // Whole units straight from the caller's buffer.
+    bd_size_t whole = size - size % _program_size;
+    if (whole > 0) {
+        ret = program(p, whole);
+        if (ret != 0) {
+            return ret;
+        }
+        p += whole;
+        size -= whole;
+    }
+
+    memcpy(_staging, p, size);
+    _staged = size;
+    return 0;
+}
+
+int BlockDeviceSink::flush()
+{
+    if (_staged == 0) {
+        return 0;
+    }
+    memset(_staging + _staged, 0xFF, _program_size - _staged);
+    _staged = 0;
+    return program(_staging, _program_size);
+}
+
+void BlockDeviceSink::finish(bool complete)
+{
+    (void)complete;
+    flush();
+}
+
+void BlockDeviceSink::restart(bd_addr_t start, bd_size_t limit)
+{
+    _start = start;
+    _limit = limit;
+    _next = start;
+    _erased_to = start;
+    _written = 0;
+    _staged = 0;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// HashSink
+//
+HashSink::HashSink(HttpBodySink *next) : _next(next), _length(0)
+{
+    memset(_digest, 0, sizeof(_digest));
+    mbedtls_sha256_init(&_sha);
+    sha256_starts(&_sha, 0);
+}
+
+HashSink::~HashSink()
+{
+    mbedtls_sha256_free(&_sha);
+}
+
+int HashSink::write(const void *data, size_t size)
+{
+    sha256_update(&_sha, static_cast<const unsigned char *>(data), size);
+    _length += size;
+    return _next ? _next->write(data, size) : 0;
+}
+
+void HashSink::finish(bool complete)
+{
+    sha256_finish(&_sha, _digest);
+    if (_next) {
+        _next->finish(complete);
+    }
+}
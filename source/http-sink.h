@@ -0,0 +1,163 @@
+#ifndef _HTTP_SINK_H_
+#define _HTTP_SINK_H_
+
+#include <stdio.h>
+#include "mbed.h"
+#include "BlockDevice.h"
+#include "mbedtls/sha256.h"
+
+//
+// Destination for a response body.  HttpClientRequest hands every chunk to
+// write() as soon as http_parser finds it, still pointing into the socket
+// receive buffer, so nothing is copied or allocated on the way.  A negative
+// return from write() aborts the transfer and becomes the request's error.
+// finish() is called once, with true when the whole body arrived.
+//
+class HttpBodySink {
+public:
+    HttpBodySink() : _error(0) {}
+    virtual ~HttpBodySink() {}
+
+    virtual int write(const void *data, size_t size) = 0;
+    virtual void finish(bool complete) { (void)complete; }
+
+    // Adapter for mbed-http's HttpRequest, which only takes a body callback
+    // and cannot be stopped: after the first failed write() the rest of the
+    // body is discarded and the failure is kept in error().
+    Callback<void(const char *at, size_t length)> body_callback() {
+        return callback(this, &HttpBodySink::deliver);
+    }
+    int error() const { return _error; }
+
+private:
+    void deliver(const char *at, size_t length) {
+        if (_error == 0) {
+            int ret = write(at, length);
+            _error = ret < 0 ? ret : 0;
+        }
+    }
+
+    int _error;
+};
+
+//
+// Fixed ring buffer over caller-supplied storage.  Another thread drains it
+// with read(); when it is full write() waits for the reader, which throttles
+// the download to the speed of the consumer.  With overwrite set the oldest
+// bytes are dropped instead, keeping the tail of the body.
+//
+class RingBufferSink : public HttpBodySink {
+public:
+    RingBufferSink(void *buffer, size_t size, bool overwrite = false);
+
+    virtual int write(const void *data, size_t size);
+    virtual void finish(bool complete);
+
+    // Copies up to size bytes out, waiting at most timeout_ms for the first
+    // one.  Returns 0 on timeout or once the body is finished and drained.
+    size_t read(void *data, size_t size, uint32_t timeout_ms = osWaitForever);
+
+    size_t available();
+    bool finished() const { return _finished; }
+    bool complete() const { return _complete; }
+    size_t dropped() const { return _dropped; }
+
+private:
+    size_t copy_in(const uint8_t *data, size_t size);
+
+    uint8_t *_buffer;
+    size_t _size;
+    size_t _head;               // next byte written
+    size_t _count;              // bytes held
+    size_t _dropped;
+    bool _overwrite;
+    volatile bool _finished;
+    bool _complete;
+    Mutex _mutex;
+    Semaphore _readable;
+    Semaphore _writable;
+};
+
+//
+// Writes the body to a FILE opened by the caller (e.g. on a mounted
+// FATFileSystem or LittleFileSystem).
+//
+class FileSink : public HttpBodySink {
+public:
+    FileSink(FILE *file) : _file(file), _written(0) {}
+
+    virtual int write(const void *data, size_t size);
+    virtual void finish(bool complete);
+
+    size_t written() const { return _written; }
+
+private:
+    FILE *_file;
+    size_t _written;
+};
+
+//
+// Writes the body to a raw BlockDevice region starting at start (erase-block
+// aligned) and at most limit bytes long.  Erase blocks are erased just before
+// they are first programmed.  Whole program units go to the device straight
+// from the receive buffer; only the partial unit at either end of a chunk is
+// staged, in a buffer allocated once by the constructor.  The device must
+// already be initialised.
+//
+class BlockDeviceSink : public HttpBodySink {
+public:
+    BlockDeviceSink(BlockDevice *bd, bd_addr_t start, bd_size_t limit);
+    virtual ~BlockDeviceSink();
+
+    virtual int write(const void *data, size_t size);
+    virtual void finish(bool complete);
+
+    // Programs the staged partial unit, padded with 0xFF; finish() does the
+    // same but cannot report a failure.
+    int flush();
+
+    // Starts writing a new region (erase-block aligned) with the same
+    // staging buffer, e.g. for the next block of a ranged download.
+    void restart(bd_addr_t start, bd_size_t limit);
+
+    bd_size_t written() const { return _written; }
+
+private:
+    int program(const void *data, bd_size_t size);
+
+    BlockDevice *_bd;
+    bd_addr_t _start;
+    bd_size_t _limit;
+    bd_size_t _program_size;
+    bd_size_t _erase_size;
+    bd_addr_t _next;            // device address of the next program unit
+    bd_addr_t _erased_to;       // end of the erased area
+    bd_size_t _written;
+    uint8_t *_staging;          // one program unit
+    bd_size_t _staged;
+};
+
+//
+// SHA-256 of the body, optionally passing every chunk on to another sink so a
+// download can be stored and checked in the same pass.
+//
+class HashSink : public HttpBodySink {
+public:
+    HashSink(HttpBodySink *next = NULL);
+    virtual ~HashSink();
+
+    virtual int write(const void *data, size_t size);
+    virtual void finish(bool complete);
+
+    // Valid once finish() has been called.
+    const uint8_t *digest() const { return _digest; }
+    size_t length() const { return _length; }
+
+private:
+    HttpBodySink *_next;
+    mbedtls_sha256_context _sha;
+    uint8_t _digest[32];
+    size_t _length;
+};
+
+#endif // _HTTP_SINK_H_
@@ -0,0 +1,128 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          http-trace.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <stdio.h>
+#include "http-trace.h"
+#include "http_parser.h"
+#include "binary-util.h"
+
+#define HTTP_TRACE_VERSION      1
+
+static HttpTrace *active_trace;
+
+void http_trace_enable(HttpTrace *trace)
+{
+    active_trace = trace;
+}
+
+HttpTrace *http_trace()
+{
+    return active_trace;
+}
+
+HttpTrace::HttpTrace() : _head(0), _count(0), _overwritten(0), _sequence(0)
+{
+}
+
+void HttpTrace::record(HttpTraceRecord *record)
+{
+    _mutex.lock();
+    record->sequence = _sequence++;
+    _records[_head] = *record;
+    _head = (_head + 1) % MBED_CONF_APP_HTTP_TRACE_SIZE;
+    if (_count < MBED_CONF_APP_HTTP_TRACE_SIZE) {
+        _count++;
+    } else {
+        _overwritten++;
+    }
+    _mutex.unlock();
+}
+
+void HttpTrace::clear()
+{
+    _mutex.lock();
+    _head = 0;
+    _count = 0;
+    _overwritten = 0;
+    _mutex.unlock();
+}
+
+void HttpTrace::export_csv(Callback<void(const char *data, size_t size)> output)
+{
+    static const char header[] = "seq,start_us,method,status,error,flags,dns_us,connect_us,tls_us,"
+                                 "ttfb_us,body_us,bytes_sent,bytes_received\n";
+    output(header, sizeof(header) - 1);
+
+    _mutex.lock();
+    size_t count = _count;
+    size_t first = (_head + MBED_CONF_APP_HTTP_TRACE_SIZE - count) % MBED_CONF_APP_HTTP_TRACE_SIZE;
+    _mutex.unlock();
+
+    for (size_t ix = 0; ix < count; ix++) {
+        _mutex.lock();
+        HttpTraceRecord r = _records[(first + ix) % MBED_CONF_APP_HTTP_TRACE_SIZE];
+        _mutex.unlock();
+
+        char line[128];
+        int length = snprintf(line, sizeof(line), "%u,%lu,%s,%d,%d,%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+                              r.sequence, (unsigned long)r.start_us, http_method_str((http_method)r.method),
+                              r.status, r.error, r.flags, (unsigned long)r.dns_us,
+                              (unsigned long)r.connect_us, (unsigned long)r.tls_us,
+                              (unsigned long)r.ttfb_us, (unsigned long)r.body_us,
+                              (unsigned long)r.bytes_sent, (unsigned long)r.bytes_received);
+        output(line, length);
+    }
+}
+
+void HttpTrace::export_binary(Callback<void(const char *data, size_t size)> output)
+{
+    _mutex.lock();
+    size_t count = _count;
+    size_t first = (_head + MBED_CONF_APP_HTTP_TRACE_SIZE - count) % MBED_CONF_APP_HTTP_TRACE_SIZE;
+    _mutex.unlock();
+
+    char header[8] = { 'H', 'T', 'R', 'C', HTTP_TRACE_VERSION, HTTP_TRACE_RECORD_SIZE };
+    put16(header + 6, count);
+    output(header, sizeof(header));
+
+    for (size_t ix = 0; ix < count; ix++) {
+        _mutex.lock();
+        HttpTraceRecord r = _records[(first + ix) % MBED_CONF_APP_HTTP_TRACE_SIZE];
+        _mutex.unlock();
+
+        char out[HTTP_TRACE_RECORD_SIZE];
+        char *p = out;
+        p = put32(p, r.start_us);
+        p = put32(p, r.dns_us);
+        p = put32(p, r.connect_us);
+        p = put32(p, r.tls_us);
+        p = put32(p, r.ttfb_us);
+        p = put32(p, r.body_us);
+        p = put32(p, r.bytes_sent);
+        p = put32(p, r.bytes_received);
+        p = put16(p, r.status);
+        p = put16(p, r.error);
+        *p++ = r.method;
+        *p++ = r.flags;
+        p = put16(p, r.sequence);
+        output(out, p - out);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef _HTTP_TRACE_H_
+#define _HTTP_TRACE_H_
+
+#include "mbed.h"
+
+#ifndef MBED_CONF_APP_HTTP_TRACE_SIZE
+#define MBED_CONF_APP_HTTP_TRACE_SIZE   32      // records kept; older ones are overwritten
+#endif
+
+#define HTTP_TRACE_CONNECTED    0x01    // the request opened the connection
+#define HTTP_TRACE_RESUMED      0x02    // ... with a resumed TLS session
+
+//
+// Where one request spent its time, in microseconds.  The connect phases are
+// zero when the request reused an open connection.
+//
+struct HttpTraceRecord {
+    uint32_t start_us;          // us_ticker_read() when the request was built
+    uint32_t dns_us;
+    uint32_t connect_us;        // TCP handshake
+    uint32_t tls_us;            // TLS handshake
+    uint32_t ttfb_us;           // request sent to first response byte
+    uint32_t body_us;           // first response byte to end of response
+    uint32_t bytes_sent;
+    uint32_t bytes_received;
+    int16_t status;             // HTTP status code, 0 if none arrived
+    int16_t error;              // nsapi or mbedTLS error, 0 on success
+    uint8_t method;             // http_method
+    uint8_t flags;              // HTTP_TRACE_*
+    uint16_t sequence;
+};
+
+//
+// Fixed ring of the most recent HttpTraceRecords.  HttpClientRequest fills
+// in a record as it goes (a handful of us_ticker_read() calls) and adds it
+// when the response ends, so tracing costs microseconds against requests
+// that take tens of milliseconds at best.  Install one with
+// http_trace_enable().
+//
+// The binary export is an 8 byte header ("HTRC", a version byte, a record
+// size byte and the record count as a little-endian uint16) followed by the
+// records, oldest first, each field little-endian in the order declared
+// above.
+//
+class HttpTrace {
+public:
+    HttpTrace();
+
+    void record(HttpTraceRecord *record);
+    void clear();
+
+    size_t count() const { return _count; }
+    uint32_t overwritten() const { return _overwritten; }
+
+    // Oldest first; output receives one line or record at a time.
+    void export_csv(Callback<void(const char *data, size_t size)> output);
+    void export_binary(Callback<void(const char *data, size_t size)> output);
+
+private:
+    HttpTraceRecord _records[MBED_CONF_APP_HTTP_TRACE_SIZE];
+    size_t _head;               // next slot to write
+    size_t _count;
+    uint32_t _overwritten;
+    uint16_t _sequence;
+    Mutex _mutex;
+};
+
+#define HTTP_TRACE_RECORD_SIZE  40      // bytes per record in the binary export
+
+// Every HttpClientRequest records into trace from now on; NULL stops tracing.
+void http_trace_enable(HttpTrace *trace);
+HttpTrace *http_trace();
+
+#endif // _HTTP_TRACE_H_
@@ -0,0 +1,111 @@
+#include "http-transport.h"
+#include "dns-cache.h"
+
+void HttpTransport::traffic_flush()
+{
+    TrafficMeter *meter = traffic_meter();
+    if (meter) {
+        TrafficCounters delta;
+        traffic_delta(&delta, _traffic, _flushed);
+        meter->add(host(), port(), delta);
+    }
+    _flushed = _traffic;
+}
+
+void HttpTransport::count_connect(nsapi_error_t result)
+{
+    if (result == NSAPI_ERROR_OK) {
+        _traffic.connects++;
+    } else {
+        _traffic.failed_connects++;
+    }
+    _traffic.resumed += _timing.resumed ? 1 : 0;
+    _traffic.setup_us += _timing.dns_us + _timing.connect_us + _timing.tls_us;
+    traffic_flush();
+}
+
+nsapi_error_t HttpTransport::dial(TCPSocket *socket, NetworkInterface *net, const char *host, uint16_t port)
+{
+    SocketAddress address;
+    memset(&_timing, 0, sizeof(_timing));
+
+    uint32_t start = us_ticker_read();
+    nsapi_error_t result = dns_resolve(net, host, &address);
+    uint32_t resolved = us_ticker_read();
+    _timing.dns_us = resolved - start;
+    if (result != NSAPI_ERROR_OK) {
+        return result;
+    }
+    address.set_port(port);
+    result = socket->connect(address);
+    _timing.connect_us = us_ticker_read() - resolved;
+    if (result == NSAPI_ERROR_OK) {
+        count_tcp_open();
+        socket->set_timeout(MBED_CONF_APP_HTTP_RECV_TIMEOUT_MS);
+    } else {
+        dns_invalidate(host);       // the host may have moved
+    }
+    return result;
+}
+
+TCPTransport::TCPTransport(NetworkInterface *net, const char *host, uint16_t port)
+    : _net(net), _port(port), _connected(false)
+{
+    strncpy(_host, host, sizeof(_host) - 1);
+    _host[sizeof(_host) - 1] = '\0';
+}
+
+TCPTransport::~TCPTransport()
+{
+    close();
+}
+
+nsapi_error_t TCPTransport::connect()
+{
+    if (_connected) {
+        return NSAPI_ERROR_IS_CONNECTED;
+    }
+    nsapi_error_t result = _socket.open(_net);
+    if (result == NSAPI_ERROR_OK) {
+        result = dial(&_socket, _net, _host, _port);
+        count_connect(result);
+        if (result != NSAPI_ERROR_OK) {
+            _socket.close();
+        }
+    }
+    _connected = (result == NSAPI_ERROR_OK);
+    return result;
+}
+
+nsapi_size_or_error_t TCPTransport::send(const void *data, nsapi_size_t size)
+{
+    nsapi_size_or_error_t result = _socket.send(data, size);
+    count_wire_sent(result);
+    count_app_sent(result);
+    if (result < 0 && result != NSAPI_ERROR_WOULD_BLOCK) {
+        close();
+    }
+    return result;
+}
+
+nsapi_size_or_error_t TCPTransport::recv(void *data, nsapi_size_t size)
+{
+    nsapi_size_or_error_t result = _socket.recv(data, size);
+    count_wire_received(result);
+    count_app_received(result);
+    if (result == 0 || (result < 0 && result != NSAPI_ERROR_WOULD_BLOCK)) {
+        close();
+    }
+    return result;
+}
+
+nsapi_error_t TCPTransport::close()
+{
+    if (_connected) {
+        _socket.close();
+        _connected = false;
+        count_tcp_close();
+        traffic_flush();
+    }
+    return NSAPI_ERROR_OK;
+}
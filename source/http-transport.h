@@ -0,0 +1,127 @@
+#ifndef _HTTP_TRANSPORT_H_
+#define _HTTP_TRANSPORT_H_
+
+#include "mbed.h"
+#include "http-url.h"
+#include "traffic-meter.h"
+
+#ifndef MBED_CONF_APP_HTTP_RECV_TIMEOUT_MS
+#define MBED_CONF_APP_HTTP_RECV_TIMEOUT_MS  30000
+#endif
+
+//
+// A connected byte stream that HttpClientRequest can run over: a plain
+// TCPSocket (TCPTransport) or a TLS session on top of one (TLSTransport).
+// send()/recv() follow TCPSocket semantics: recv() returns 0 once the peer
+// closed the connection and NSAPI_ERROR_WOULD_BLOCK when no data is ready.
+// The socket is given a timeout of MBED_CONF_APP_HTTP_RECV_TIMEOUT_MS once
+// connected, so neither blocks for longer than that on a stalled server.
+//
+// Every transport counts the bytes and packets it carries and the time its
+// connects take (traffic-meter.h), and hands them on to the installed
+// TrafficMeter under host():port().
+//
+class HttpTransport {
+public:
+    // How long the phases of the last connect() took, in microseconds.
+    struct ConnectTiming {
+        uint32_t dns_us;
+        uint32_t connect_us;    // TCP handshake
+        uint32_t tls_us;        // TLS handshake, 0 for plain TCP
+        bool resumed;           // TLS session resumed
+    };
+
+    HttpTransport() {
+        memset(&_timing, 0, sizeof(_timing));
+        memset(&_traffic, 0, sizeof(_traffic));
+        memset(&_flushed, 0, sizeof(_flushed));
+    }
+    virtual ~HttpTransport() {}
+
+    virtual nsapi_error_t connect() = 0;
+    virtual nsapi_size_or_error_t send(const void *data, nsapi_size_t size) = 0;
+    virtual nsapi_size_or_error_t recv(void *data, nsapi_size_t size) = 0;
+    virtual nsapi_error_t close() = 0;
+    virtual bool connected() const = 0;
+
+    // Server this transport connects to; used for the Host header.
+    virtual const char *host() const = 0;
+    virtual uint16_t port() const = 0;
+
+    const ConnectTiming &connect_timing() const { return _timing; }
+
+    // Everything this transport carried since it was made.
+    const TrafficCounters &traffic() const { return _traffic; }
+
+    // Adds what was counted since the last call to the installed
+    // TrafficMeter.  Done after connect(), on close() and by
+    // HttpClientRequest at the end of each request.
+    void traffic_flush();
+
+    // Called by HttpClientRequest for each request with the size of its
+    // body, and as chunked request bodies and response bodies go through.
+    void count_request(uint32_t body_size) { _traffic.requests++; _traffic.payload_sent += body_size; }
+    void count_payload(uint32_t sent, uint32_t received) {
+        _traffic.payload_sent += sent;
+        _traffic.payload_received += received;
+    }
+
+protected:
+    // Resolves host and connects socket (already open) to it, timing both,
+    // and sets its timeout.
+    nsapi_error_t dial(TCPSocket *socket, NetworkInterface *net, const char *host, uint16_t port);
+
+    // Bytes through the TCP socket; errors count nothing.
+    void count_wire_sent(nsapi_size_or_error_t size) {
+        if (size > 0) {
+            _traffic.wire_sent += size;
+            _traffic.packets_sent += (size + TRAFFIC_SEGMENT_SIZE - 1) / TRAFFIC_SEGMENT_SIZE;
+        }
+    }
+    void count_wire_received(nsapi_size_or_error_t size) {
+        if (size > 0) {
+            _traffic.wire_received += size;
+            _traffic.packets_received += (size + TRAFFIC_SEGMENT_SIZE - 1) / TRAFFIC_SEGMENT_SIZE;
+        }
+    }
+    // Bytes through send() and recv().
+    void count_app_sent(nsapi_size_or_error_t size) { _traffic.app_sent += size > 0 ? size : 0; }
+    void count_app_received(nsapi_size_or_error_t size) { _traffic.app_received += size > 0 ? size : 0; }
+
+    // TCP handshake (SYN, SYN-ACK, ACK) and teardown (FIN and ACK each way).
+    void count_tcp_open() { _traffic.packets_sent += 2; _traffic.packets_received += 1; }
+    void count_tcp_close() { _traffic.packets_sent += 2; _traffic.packets_received += 2; }
+
+    // A connect() that ended with result, taking the time in _timing.
+    void count_connect(nsapi_error_t result);
+
+    ConnectTiming _timing;
+    TrafficCounters _traffic;
+    TrafficCounters _flushed;   // _traffic when last handed to the meter
+};
+
+class TCPTransport : public HttpTransport {
+public:
+    TCPTransport(NetworkInterface *net, const char *host, uint16_t port);
+    virtual ~TCPTransport();
+
+    virtual nsapi_error_t connect();
+    virtual nsapi_size_or_error_t send(const void *data, nsapi_size_t size);
+    virtual nsapi_size_or_error_t recv(void *data, nsapi_size_t size);
+    virtual nsapi_error_t close();
+    virtual bool connected() const { return _connected; }
+
+    virtual const char *host() const { return _host; }
+    virtual uint16_t port() const { return _port; }
+
+    TCPSocket *get_tcp_socket() { return &_socket; }
+
+private:
+    NetworkInterface *_net;
+    char _host[HTTP_URL_MAX_HOST];
+    uint16_t _port;
+    TCPSocket _socket;
+    bool _connected;
+};
+
+#endif // _HTTP_TRANSPORT_H_
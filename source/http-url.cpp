@@ -0,0 +1,55 @@
+#include <string.h>
+#include <stdlib.h>
+#include "http-url.h"
+
+// Parses what follows the scheme; secure and port are already set.
+static bool parse_authority(const char *url, HttpUrl *out)
+{
+    size_t host_len = strcspn(url, ":/?");
+    if (host_len == 0 || host_len >= sizeof(out->host)) {
+        return false;
+    }
+    memcpy(out->host, url, host_len);
+    out->host[host_len] = '\0';
+    url += host_len;
+
+    if (*url == ':') {
+        char *end;
+        long port = strtol(url + 1, &end, 10);
+        if (end == url + 1 || port <= 0 || port > 65535) {
+            return false;
+        }
+        out->port = (uint16_t)port;
+        url = end;
+    }
+    out->path = (*url == '/') ? url : "/";
+    return true;
+}
+
+bool http_url_parse(const char *url, HttpUrl *out)
+{
+    if (strncmp(url, "http://", 7) == 0) {
+        out->secure = false;
+        out->port = 80;
+        return parse_authority(url + 7, out);
+    } else if (strncmp(url, "https://", 8) == 0) {
+        out->secure = true;
+        out->port = 443;
+        return parse_authority(url + 8, out);
+    }
+    return false;
+}
+
+bool websocket_url_parse(const char *url, HttpUrl *out)
+{
+    if (strncmp(url, "ws://", 5) == 0) {
+        out->secure = false;
+        out->port = 80;
+        return parse_authority(url + 5, out);
+    } else if (strncmp(url, "wss://", 6) == 0) {
+        out->secure = true;
+        out->port = 443;
+        return parse_authority(url + 6, out);
+    }
+    return false;
+}
@@ -0,0 +1,26 @@
+#ifndef _HTTP_URL_H_
+#define _HTTP_URL_H_
+
+#include <stdint.h>
+
+//
+// Splits an absolute http:// or https:// URL into the pieces needed to open a
+// connection.  The path points into the original string, so the URL has to
+// outlive the HttpUrl.
+//
+#define HTTP_URL_MAX_HOST   64
+
+struct HttpUrl {
+    bool     secure;                        // https:// or wss://
+    char     host[HTTP_URL_MAX_HOST];
+    uint16_t port;                          // explicit port, or 80/443
+    const char *path;                       // "/..." including any query, never NULL
+};
+
+bool http_url_parse(const char *url, HttpUrl *out);
+
+// The same for ws:// and wss:// URLs, which take the ports of http:// and
+// https://.
+bool websocket_url_parse(const char *url, HttpUrl *out);
+
+#endif // _HTTP_URL_H_
@@ -0,0 +1,522 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          json-stream.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <stdio.h>
+#include <string.h>
+#include "json-stream.h"
+
+// Where a number is in its grammar, kept in _hex_count while one is read.
+enum NumberState {
+    NUMBER_SIGN,            // after '-'
+    NUMBER_ZERO,            // a leading 0: no more integer digits
+    NUMBER_INTEGER,
+    NUMBER_POINT,           // after '.'
+    NUMBER_FRACTION,
+    NUMBER_E,               // after 'e'
+    NUMBER_E_SIGN,
+    NUMBER_EXPONENT
+};
+
+static const char *const type_names[] = {
+    "string", "number", "true", "false", "null", "object", "array"
+};
+
+const char *json_type_name(JsonType type)
+{
+    return type <= JSON_ARRAY ? type_names[type] : "unknown";
+}
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// '*' in pattern stands for one key or index of path.  With prefix, whether
+// pattern could match something inside path instead.
+static bool path_match(const char *pattern, const char *path, bool prefix)
+{
+    while (*path) {
+        if (*pattern == '*') {
+            pattern++;
+            while (*path && *path != '.' && *path != '[' && *path != ']') {
+                path++;
+            }
+            continue;
+        }
+        if (*pattern++ != *path++) {
+            return false;
+        }
+    }
+    while (*pattern == '*') {
+        pattern++;
+    }
+    return prefix ? *pattern == '.' || *pattern == '[' : *pattern == '\0';
+}
+
+JsonStreamParser::JsonStreamParser(JsonHandler *handler, const char *const *filters, size_t filter_count)
+    : _handler(handler), _filters(filters), _filter_count(filter_count)
+{
+    reset();
+}
+
+void JsonStreamParser::reset()
+{
+    _state = VALUE;
+    _failure = 0;
+    _in_key = false;
+    _keep = false;
+    _high_surrogate = 0;
+    _depth = 0;
+    _path[0] = '\0';
+    _path_length = 0;
+    _value_length = 0;
+    _documents = 0;
+    _values = 0;
+    _length = 0;
+}
+
+bool JsonStreamParser::matches(const char *path, bool prefix) const
+{
+    if (!_filters) {
+        return true;
+    }
+    for (size_t ix = 0; ix < _filter_count; ix++) {
+        if (path_match(_filters[ix], path, prefix)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int JsonStreamParser::fail(int error)
+{
+    _failure = error;
+    return error;
+}
+
+// Adds c to the key being read, or to the value when it is wanted.
+int JsonStreamParser::put(char c, bool keep)
+{
+    if (_in_key) {
+        if (_path_length + 1 >= sizeof(_path)) {
+            return fail(JSON_ERROR_TOO_LONG);
+        }
+        _path[_path_length++] = c;
+    } else if (keep) {
+        if (_value_length + 1 >= sizeof(_value)) {
+            return fail(JSON_ERROR_TOO_LONG);
+        }
+        _value[_value_length++] = c;
+    }
+    return 0;
+}
+
+int JsonStreamParser::put_utf8(uint32_t code)
+{
+    char out[4];
+    int count;
+    if (code < 0x80) {
+        out[0] = code;
+        count = 1;
+    } else if (code < 0x800) {
+        out[0] = 0xC0 | (code >> 6);
+        out[1] = 0x80 | (code & 0x3F);
+        count = 2;
+    } else if (code < 0x10000) {
+        out[0] = 0xE0 | (code >> 12);
+        out[1] = 0x80 | ((code >> 6) & 0x3F);
+        out[2] = 0x80 | (code & 0x3F);
+        count = 3;
+    } else {
+        out[0] = 0xF0 | (code >> 18);
+        out[1] = 0x80 | ((code >> 12) & 0x3F);
+        out[2] = 0x80 | ((code >> 6) & 0x3F);
+        out[3] = 0x80 | (code & 0x3F);
+        count = 4;
+    }
+    for (int ix = 0; ix < count; ix++) {
+        if (put(out[ix], _keep) < 0) {
+            return _failure;
+        }
+    }
+    return 0;
+}
+
+// The path of the next item of the array being read.
+int JsonStreamParser::item_path()
+{
+    Level &level = _levels[_depth - 1];
+    char index[8];
+    int length = snprintf(index, sizeof(index), "[%u]", (unsigned)level.index++);
+    if (level.path_length + (size_t)length >= sizeof(_path)) {
+        return fail(JSON_ERROR_TOO_LONG);
+    }
+    memcpy(_path + level.path_length, index, length + 1);
+    _path_length = level.path_length + length;
+    return 0;
+}
+
+int JsonStreamParser::start_value(char c)
+{
+    if (_depth == 0) {
+        _path_length = 0;
+        _path[0] = '\0';
+    } else if (_levels[_depth - 1].type == JSON_ARRAY && item_path() < 0) {
+        return _failure;
+    }
+    // Nothing inside a container no filter reaches into is wanted.
+    bool live = _depth == 0 || _levels[_depth - 1].live;
+    _keep = live && matches(_path, false);
+    _value_length = 0;
+
+    if (c == '{' || c == '[') {
+        if (_depth == MBED_CONF_APP_JSON_MAX_DEPTH) {
+            return fail(JSON_ERROR_DEPTH);
+        }
+        Level &level = _levels[_depth++];
+        level.type = c == '{' ? JSON_OBJECT : JSON_ARRAY;
+        level.matched = _keep;
+        level.live = live && (_depth == 1 || matches(_path, true));
+        level.path_length = _path_length;
+        level.index = 0;
+        _state = c == '{' ? FIRST_KEY : FIRST_ITEM;
+        if (_keep) {
+            int ret = _handler->begin(_path, (JsonType)level.type);
+            if (ret < 0) {
+                return fail(ret);
+            }
+        }
+        return 0;
+    }
+    if (c == '"') {
+        _type = JSON_STRING;
+        _in_key = false;
+        _state = STRING;
+        return 0;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        _type = JSON_NUMBER;
+        _hex_count = c == '-' ? NUMBER_SIGN : c == '0' ? NUMBER_ZERO : NUMBER_INTEGER;
+        _state = NUMBER;
+        return put(c, _keep);
+    }
+    if (c == 't' || c == 'f' || c == 'n') {
+        _type = c == 't' ? JSON_TRUE : c == 'f' ? JSON_FALSE : JSON_NULL;
+        _literal = c == 't' ? "true" : c == 'f' ? "false" : "null";
+        _hex_count = 1;
+        _state = LITERAL;
+        return put(c, _keep);
+    }
+    return fail(JSON_ERROR_SYNTAX);
+}
+
+// A value ended: what may follow depends on where it was.
+int JsonStreamParser::end_value()
+{
+    if (_depth == 0) {
+        _documents++;
+        _state = VALUE;
+    } else {
+        _state = NEXT;
+    }
+    return 0;
+}
+
+int JsonStreamParser::end_scalar()
+{
+    if (_keep) {
+        _value[_value_length] = '\0';
+        _values++;
+        int ret = _handler->value(_path, _type, _value, _value_length);
+        if (ret < 0) {
+            return fail(ret);
+        }
+    }
+    return end_value();
+}
+
+int JsonStreamParser::close(char c)
+{
+    Level &level = _levels[_depth - 1];
+    if (c != (level.type == JSON_OBJECT ? '}' : ']')) {
+        return fail(JSON_ERROR_SYNTAX);
+    }
+    _path_length = level.path_length;
+    _path[_path_length] = '\0';
+    _depth--;
+    if (level.matched) {
+        int ret = _handler->end(_path, (JsonType)level.type);
+        if (ret < 0) {
+            return fail(ret);
+        }
+    }
+    return end_value();
+}
+
+int JsonStreamParser::step(char c)
+{
+    switch (_state) {
+    case VALUE:
+    case FIRST_ITEM:
+        if (is_space(c)) {
+            return 0;
+        }
+        if (c == ']' && _state == FIRST_ITEM) {
+            return close(c);
+        }
+        return start_value(c);
+
+    case FIRST_KEY:
+    case KEY:
+        if (is_space(c)) {
+            return 0;
+        }
+        if (c == '}' && _state == FIRST_KEY) {
+            return close(c);
+        }
+        if (c != '"') {
+            return fail(JSON_ERROR_SYNTAX);
+        }
+        _path_length = _levels[_depth - 1].path_length;
+        _in_key = true;
+        _state = STRING;
+        return _path_length ? put('.', false) : 0;
+
+    case COLON:
+        if (is_space(c)) {
+            return 0;
+        }
+        if (c != ':') {
+            return fail(JSON_ERROR_SYNTAX);
+        }
+        _state = VALUE;
+        return 0;
+
+    case NEXT:
+        if (is_space(c)) {
+            return 0;
+        }
+        if (c == ',') {
+            _state = _levels[_depth - 1].type == JSON_OBJECT ? KEY : VALUE;
+            return 0;
+        }
+        return close(c);
+
+    case STRING:
+        if (_high_surrogate && c != '\\') {
+            _high_surrogate = 0;
+            if (put_utf8(0xFFFD) < 0) {
+                return _failure;
+            }
+        }
+        if (c == '"') {
+            if (_in_key) {
+                _path[_path_length] = '\0';
+                _in_key = false;
+                _state = COLON;
+                return 0;
+            }
+            return end_scalar();
+        }
+        if (c == '\\') {
+            _state = ESCAPE;
+            return 0;
+        }
+        if ((uint8_t)c < 0x20) {
+            return fail(JSON_ERROR_SYNTAX);
+        }
+        return put(c, _keep);
+
+    case ESCAPE:
+        _state = STRING;
+        if (c == 'u') {
+            _state = UNICODE;
+            _hex_count = 0;
+            _code = 0;
+            return 0;
+        }
+        if (_high_surrogate) {
+            _high_surrogate = 0;
+            if (put_utf8(0xFFFD) < 0) {
+                return _failure;
+            }
+        }
+        switch (c) {
+        case '"': case '\\': case '/': return put(c, _keep);
+        case 'b': return put('\b', _keep);
+        case 'f': return put('\f', _keep);
+        case 'n': return put('\n', _keep);
+        case 'r': return put('\r', _keep);
+        case 't': return put('\t', _keep);
+        }
+        return fail(JSON_ERROR_SYNTAX);
+
+    case UNICODE: {
+        int digit = hex_value(c);
+        if (digit < 0) {
+            return fail(JSON_ERROR_SYNTAX);
+        }
+        _code = (_code << 4) | digit;
+        if (++_hex_count < 4) {
+            return 0;
+        }
+        _state = STRING;
+        if (_code >= 0xD800 && _code < 0xDC00) {
+            // A high surrogate: the low half should follow as another \u.
+            uint16_t previous = _high_surrogate;
+            _high_surrogate = _code;
+            return previous ? put_utf8(0xFFFD) : 0;
+        }
+        if (_code >= 0xDC00 && _code < 0xE000) {
+            uint32_t high = _high_surrogate;
+            _high_surrogate = 0;
+            return put_utf8(high ? 0x10000 + ((high - 0xD800) << 10) + (_code - 0xDC00) : 0xFFFD);
+        }
+        if (_high_surrogate) {
+            _high_surrogate = 0;
+            if (put_utf8(0xFFFD) < 0) {
+                return _failure;
+            }
+        }
+        return put_utf8(_code);
+    }
+
+    case NUMBER: {
+        bool digit = c >= '0' && c <= '9';
+        int next = -1;
+        switch (_hex_count) {
+        case NUMBER_SIGN:
+            next = c == '0' ? NUMBER_ZERO : digit ? NUMBER_INTEGER : -1;
+            break;
+        case NUMBER_ZERO:
+        case NUMBER_INTEGER:
+            next = digit && _hex_count == NUMBER_INTEGER ? NUMBER_INTEGER :
+                   c == '.' ? NUMBER_POINT : (c == 'e' || c == 'E') ? NUMBER_E : -2;
+            break;
+        case NUMBER_POINT:
+        case NUMBER_FRACTION:
+            next = digit ? NUMBER_FRACTION :
+                   _hex_count == NUMBER_FRACTION && (c == 'e' || c == 'E') ? NUMBER_E :
+                   _hex_count == NUMBER_FRACTION ? -2 : -1;
+            break;
+        case NUMBER_E:
+            next = digit ? NUMBER_EXPONENT : (c == '+' || c == '-') ? NUMBER_E_SIGN : -1;
+            break;
+        case NUMBER_E_SIGN:
+        case NUMBER_EXPONENT:
+            next = digit ? NUMBER_EXPONENT : _hex_count == NUMBER_EXPONENT ? -2 : -1;
+            break;
+        }
+        if (next >= 0) {
+            _hex_count = next;
+            return put(c, _keep);
+        }
+        if (next == -1) {
+            return fail(JSON_ERROR_SYNTAX);
+        }
+        // The number ended before c, which belongs to what follows.
+        if (end_scalar() < 0) {
+            return _failure;
+        }
+        return step(c);
+    }
+
+    case LITERAL:
+        if (c != _literal[_hex_count]) {
+            return fail(JSON_ERROR_SYNTAX);
+        }
+        if (put(c, _keep) < 0) {
+            return _failure;
+        }
+        if (_literal[++_hex_count] == '\0') {
+            return end_scalar();
+        }
+        return 0;
+    }
+    return fail(JSON_ERROR_SYNTAX);
+}
+
+int JsonStreamParser::write(const void *data, size_t size)
+{
+    const char *p = static_cast<const char *>(data);
+    const char *end = p + size;
+
+    if (_failure) {
+        return _failure;
+    }
+    while (p < end) {
+        if (_state == STRING && !_in_key && !_high_surrogate) {
+            // Runs of plain string characters are the bulk of most bodies:
+            // copy or skip them in one go.
+            const char *run = p;
+            while (run < end && *run != '"' && *run != '\\' && (uint8_t)*run >= 0x20) {
+                run++;
+            }
+            if (_keep && run > p) {
+                size_t length = run - p;
+                if (_value_length + length >= sizeof(_value)) {
+                    return fail(JSON_ERROR_TOO_LONG);
+                }
+                memcpy(_value + _value_length, p, length);
+                _value_length += length;
+            }
+            _length += run - p;
+            p = run;
+            if (p == end) {
+                break;
+            }
+        }
+        if (step(*p++) < 0) {
+            return _failure;
+        }
+        _length++;
+    }
+    return size;
+}
+
+void JsonStreamParser::finish(bool complete)
+{
+    if (_failure) {
+        return;
+    }
+    if (_state == NUMBER && _depth == 0 && (_hex_count == NUMBER_ZERO || _hex_count == NUMBER_INTEGER ||
+                                            _hex_count == NUMBER_FRACTION || _hex_count == NUMBER_EXPONENT)) {
+        // A bare number at the end of the body has nothing after it to end it.
+        end_scalar();
+    }
+    if (!_failure && (!complete || _state != VALUE || _depth != 0)) {
+        fail(JSON_ERROR_TRUNCATED);
+    }
+}
@@ -0,0 +1,144 @@
+#ifndef _JSON_STREAM_H_
+#define _JSON_STREAM_H_
+
+#include "mbed.h"
+#include "http-sink.h"
+
+#ifndef MBED_CONF_APP_JSON_MAX_DEPTH
+#define MBED_CONF_APP_JSON_MAX_DEPTH    12      // objects and arrays nested in each other
+#endif
+
+#ifndef MBED_CONF_APP_JSON_PATH_SIZE
+#define MBED_CONF_APP_JSON_PATH_SIZE    96      // bytes of the longest path, with its NUL
+#endif
+
+#ifndef MBED_CONF_APP_JSON_VALUE_SIZE
+#define MBED_CONF_APP_JSON_VALUE_SIZE   64      // bytes of the longest value kept, with its NUL
+#endif
+
+// Failures of JsonStreamParser::write(), which become the request's error.
+#define JSON_ERROR_SYNTAX               -3501
+#define JSON_ERROR_DEPTH                -3502   // nested deeper than MBED_CONF_APP_JSON_MAX_DEPTH
+#define JSON_ERROR_TOO_LONG             -3503   // a path or a wanted value does not fit
+#define JSON_ERROR_TRUNCATED            -3504   // the body ended inside a document
+
+enum JsonType {
+    JSON_STRING,
+    JSON_NUMBER,
+    JSON_TRUE,
+    JSON_FALSE,
+    JSON_NULL,
+    JSON_OBJECT,
+    JSON_ARRAY
+};
+
+const char *json_type_name(JsonType type);
+
+//
+// Receives the parser's events.  A path names where a value sits in its
+// document: members are joined with '.', array items are indexed, and the
+// document itself is "":
+//
+//   {"config":{"interval":30},"commands":[{"id":7}]}
+//   config.interval = 30, commands[0].id = 7
+//
+// text is the unescaped string, or the number or literal as written, with a
+// NUL after it; both it and path are only valid during the call.  A negative
+// return stops the parse and becomes its error.
+//
+class JsonHandler {
+public:
+    virtual ~JsonHandler() {}
+
+    virtual int value(const char *path, JsonType type, const char *text, size_t length) = 0;
+    virtual int begin(const char *path, JsonType type) { (void)path; (void)type; return 0; }
+    virtual int end(const char *path, JsonType type) { (void)path; (void)type; return 0; }
+};
+
+//
+// Incremental JSON parser fed with whatever pieces the body arrives in: it
+// stops wherever a piece runs out, in the middle of a key, a string escape
+// or a number, and carries on with the next.  Nothing is allocated; the
+// state is a stack of MBED_CONF_APP_JSON_MAX_DEPTH levels, the path and one
+// value buffer.
+//
+// With filters, only the values whose path matches one of them are copied
+// out and reported; the rest are scanned past without being kept, so a
+// wanted field can be picked out of a document far bigger than the buffers.
+// In a filter '*' stands for any one key or index:
+//
+//   static const char *const wanted[] = { "config.interval", "commands[*].id" };
+//   JsonStreamParser parser(&handler, wanted, 2);
+//
+// Objects and arrays are reported through begin() and end() when their own
+// path matches.  A body may hold several documents one after another (as
+// /stream/N sends them); each starts again from path "".
+//
+class JsonStreamParser : public HttpBodySink {
+public:
+    JsonStreamParser(JsonHandler *handler, const char *const *filters = NULL, size_t filter_count = 0);
+
+    // Starts over, for the next body.
+    void reset();
+
+    virtual int write(const void *data, size_t size);
+    virtual void finish(bool complete);
+
+    // Where the parse stopped: 0, or a JSON_ERROR_* or the handler's error.
+    int failure() const { return _failure; }
+    uint32_t documents() const { return _documents; }
+    uint32_t values() const { return _values; }     // reported to the handler
+    size_t length() const { return _length; }       // bytes parsed
+
+private:
+    enum State {
+        VALUE, FIRST_ITEM, FIRST_KEY, KEY, COLON, NEXT,
+        STRING, ESCAPE, UNICODE, NUMBER, LITERAL
+    };
+
+    struct Level {
+        uint8_t type;               // JSON_OBJECT or JSON_ARRAY
+        bool matched;
+        bool live;                  // a filter may match something inside
+        uint16_t path_length;       // of the container's own path
+        uint16_t index;             // array items so far
+    };
+
+    int step(char c);
+    int start_value(char c);
+    int end_value();
+    int end_scalar();
+    int close(char c);
+    int item_path();
+    bool matches(const char *path, bool prefix) const;
+    int put(char c, bool keep);
+    int put_utf8(uint32_t code);
+    int fail(int error);
+
+    JsonHandler *_handler;
+    const char *const *_filters;
+    size_t _filter_count;
+
+    State _state;
+    int _failure;
+    bool _in_key;               // the string being read is a key
+    bool _keep;                 // the current value is wanted
+    JsonType _type;             // of the scalar being read
+    const char *_literal;       // "true", "false" or "null" being matched
+    uint8_t _hex_count;         // \u digits read, literal position or NumberState
+    uint32_t _code;             // \u escape being read
+    uint16_t _high_surrogate;
+
+    Level _levels[MBED_CONF_APP_JSON_MAX_DEPTH];
+    int _depth;
+    char _path[MBED_CONF_APP_JSON_PATH_SIZE];
+    size_t _path_length;
+    char _value[MBED_CONF_APP_JSON_VALUE_SIZE];
+    size_t _value_length;
+
+    uint32_t _documents;
+    uint32_t _values;
+    size_t _length;
+};
+
+#endif // _JSON_STREAM_H_
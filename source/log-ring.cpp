@@ -0,0 +1,222 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          log-ring.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <stdarg.h>
+#include "log-ring.h"
+
+// Positions are masked into the buffer, so its size must be a power of two.
+typedef char log_ring_size_is_power_of_two
+    [(MBED_CONF_APP_LOG_RING_SIZE & (MBED_CONF_APP_LOG_RING_SIZE - 1)) == 0 ? 1 : -1];
+
+#define LOG_RING_MASK       (MBED_CONF_APP_LOG_RING_SIZE - 1)
+#define LOG_FAULT_CHUNK     100     // mbed_error_printf formats into 128 bytes
+
+LogRing::LogRing(Callback<void(const char *data, size_t size)> output)
+    : _head(0), _tail(0), _stop(false), _output(output), _thread(NULL)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+LogRing::~LogRing()
+{
+    if (_thread) {
+        _stop = true;
+        _thread->join();
+        delete _thread;
+    }
+}
+
+void LogRing::start(osPriority priority, uint32_t stack_size)
+{
+    if (!_thread) {
+        _thread = new Thread(priority, stack_size);
+        _thread->start(callback(this, &LogRing::drain_thread));
+    }
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Producer
+//
+bool LogRing::write(const char *data, size_t size)
+{
+    return copy_in(data, size, true);
+}
+
+// Copies a record in whole, or not at all.
+bool LogRing::copy_in(const char *data, size_t size, bool count_drop)
+{
+    uint32_t head = _head;
+    uint32_t used = head - _tail;
+
+    if (size > MBED_CONF_APP_LOG_RING_SIZE - used) {
+        if (count_drop) {
+            _stats.dropped_records++;
+            _stats.dropped_bytes += size;
+        }
+        return false;
+    }
+
+    size_t offset = head & LOG_RING_MASK;
+    size_t first = MBED_CONF_APP_LOG_RING_SIZE - offset;
+    if (first > size) {
+        first = size;
+    }
+    memcpy(_buffer + offset, data, first);
+    memcpy(_buffer, data + first, size - first);
+
+    // The bytes must be in place before the consumer can see the new head.
+    __DMB();
+    _head = head + size;
+
+    _stats.records++;
+    _stats.bytes += size;
+    if (used + size > _stats.high_water) {
+        _stats.high_water = used + size;
+    }
+    return true;
+}
+
+bool LogRing::printf(const char *format, ...)
+{
+    char record[LOG_RING_MAX_RECORD];
+    va_list args;
+
+    va_start(args, format);
+    int size = vsnprintf(record, sizeof(record), format, args);
+    va_end(args);
+    if (size < 0) {
+        return false;
+    }
+    if (size >= (int)sizeof(record)) {
+        size = sizeof(record) - 1;      // truncated
+    }
+    return write(record, size);
+}
+
+bool LogRing::write_all(const char *data, size_t size, uint32_t timeout_ms)
+{
+    uint32_t waited = 0;
+
+    while (size > 0) {
+        size_t piece = size < MBED_CONF_APP_LOG_RING_SIZE / 2 ? size : MBED_CONF_APP_LOG_RING_SIZE / 2;
+        if (copy_in(data, piece, false)) {
+            data += piece;
+            size -= piece;
+            waited = 0;
+            continue;
+        }
+        if (!_thread) {
+            drain(false);
+            continue;
+        }
+        if (waited >= timeout_ms) {
+            // The console is stuck: the rest goes, as a record would.
+            _stats.dropped_records++;
+            _stats.dropped_bytes += size;
+            return false;
+        }
+        Thread::wait(LOG_RING_IDLE_MS);
+        waited += LOG_RING_IDLE_MS;
+    }
+    return true;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Consumer
+//
+void LogRing::emit(const char *data, size_t size)
+{
+    if (_output) {
+        _output(data, size);
+    } else {
+        fwrite(data, 1, size, stdout);
+    }
+}
+
+// Writes out everything queued when called; returns the bytes written.
+size_t LogRing::drain(bool from_fault)
+{
+    uint32_t tail = _tail;
+    uint32_t head = _head;
+    size_t total = head - tail;
+
+    // Only read the bytes once the head that covers them has been seen.
+    __DMB();
+    while (tail != head) {
+        size_t offset = tail & LOG_RING_MASK;
+        size_t size = MBED_CONF_APP_LOG_RING_SIZE - offset;
+        if (size > head - tail) {
+            size = head - tail;
+        }
+        if (from_fault) {
+            if (size > LOG_FAULT_CHUNK) {
+                size = LOG_FAULT_CHUNK;
+            }
+            mbed_error_printf("%.*s", (int)size, _buffer + offset);
+        } else {
+            emit(_buffer + offset, size);
+        }
+        tail += size;
+
+        // Copied out before the producer may reuse the space.
+        __DMB();
+        _tail = tail;
+    }
+    return total;
+}
+
+void LogRing::drain_thread()
+{
+    while (!_stop || _head != _tail) {
+        if (drain(false) == 0) {
+            if (!_output) {
+                fflush(stdout);
+            }
+            Thread::wait(LOG_RING_IDLE_MS);
+        }
+    }
+    if (!_output) {
+        fflush(stdout);
+    }
+}
+
+bool LogRing::flush(uint32_t timeout_ms)
+{
+    uint32_t waited = 0;
+
+    if (!_thread) {
+        drain(false);
+        return true;
+    }
+    while (_head != _tail) {
+        if (timeout_ms != osWaitForever && waited >= timeout_ms) {
+            return false;
+        }
+        Thread::wait(LOG_RING_IDLE_MS);
+        waited += LOG_RING_IDLE_MS;
+    }
+    return true;
+}
+
+void LogRing::flush_on_fault()
+{
+    drain(true);
+}
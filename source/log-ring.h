@@ -0,0 +1,77 @@
+#ifndef _LOG_RING_H_
+#define _LOG_RING_H_
+
+#include "mbed.h"
+
+#ifndef MBED_CONF_APP_LOG_RING_SIZE
+#define MBED_CONF_APP_LOG_RING_SIZE     4096
+#endif
+
+#define LOG_RING_MAX_RECORD             128     // longest printf() record
+#define LOG_RING_IDLE_MS                10      // drain thread poll period
+#define LOG_RING_STALL_MS               1000    // write_all() gives up after this without room
+
+//
+// Console output that does not block the thread producing it.  Records are
+// copied into a ring buffer and a low-priority thread writes them out to the
+// UART at whatever rate it can take.  The ring is lock-free with exactly one
+// producer thread (the one making the HTTP requests) and one consumer (the
+// drain thread): the producer only moves _head and the consumer only moves
+// _tail, so neither ever waits for the other.  A record that does not fit is
+// dropped whole and counted rather than stalling the receive path.  Another
+// thread that prints needs a LogRing of its own.  The one exception is
+// write_all(), for dumps bigger than the ring, which does wait for room.
+//
+class LogRing {
+public:
+    struct Stats {
+        uint32_t records;
+        uint32_t bytes;
+        uint32_t dropped_records;
+        uint32_t dropped_bytes;
+        uint32_t high_water;    // most bytes ever waiting
+    };
+
+    // output receives the drained bytes; the default writes to stdout.
+    LogRing(Callback<void(const char *data, size_t size)> output = 0);
+    ~LogRing();
+
+    // Starts the drain thread.  Until then records just accumulate.
+    void start(osPriority priority = osPriorityLow, uint32_t stack_size = 1024);
+
+    // Producer side.  Both return false when the record was dropped.
+    bool write(const char *data, size_t size);
+    bool printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+    // For dumps that may be bigger than the free space, or the whole ring:
+    // writes in pieces, waiting for the drain thread to make room.  When it
+    // makes none for timeout_ms the rest is dropped and false returned.
+    bool write_all(const char *data, size_t size, uint32_t timeout_ms = LOG_RING_STALL_MS);
+
+    // Waits up to timeout_ms for the drain thread to empty the ring.
+    bool flush(uint32_t timeout_ms = osWaitForever);
+
+    // Writes whatever is queued straight to the UART without taking any lock
+    // or waiting on the RTOS, for use from fault and error handlers once the
+    // other threads have stopped.
+    void flush_on_fault();
+
+    size_t pending() const { return _head - _tail; }
+    const Stats &stats() const { return _stats; }
+
+private:
+    bool copy_in(const char *data, size_t size, bool count_drop);
+    void drain_thread();
+    size_t drain(bool from_fault);
+    void emit(const char *data, size_t size);
+
+    char _buffer[MBED_CONF_APP_LOG_RING_SIZE];
+    volatile uint32_t _head;    // free running, written by the producer only
+    volatile uint32_t _tail;    // free running, written by the consumer only
+    volatile bool _stop;
+    Stats _stats;
+    Callback<void(const char *data, size_t size)> _output;
+    Thread *_thread;
+};
+
+#endif // _LOG_RING_H_
@@ -0,0 +1,172 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          main.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mbed.h"
+#include "easy-connect.h"
+#include "WNC14A2AInterface.h"
+#include "scenario.h"
+#include "traffic-meter.h"
+#ifndef HTTPX_HOST_BUILD
+#include "modem-trace-interface.h"
+#endif
+
+//
+// Connects, then runs the scenario named by bench_scenario ("all" for every
+// one) bench_runs times.  With a single run the scenarios print everything
+// as the demos always have; with more they run quietly and only the
+// benchmark CSV comes out, one line per scenario.
+//
+// Everything the scenarios send and receive through an HttpTransport is
+// counted per endpoint (traffic-meter.h), reported every traffic_report_ms
+// during single runs and once at the end.
+//
+
+// Everything the scenarios print goes through a ring buffer drained to the
+// UART by a low-priority thread, so a slow console never holds up the sockets.
+LogRing console;
+
+static void console_write(const char *data, size_t size)
+{
+    console.write(data, size);
+}
+
+// The periodic traffic reports come from a thread of their own, and a
+// LogRing takes a single producer, so they go through a ring of their own.
+static LogRing report_console;
+
+static void report_write(const char *data, size_t size)
+{
+    report_console.write(data, size);
+}
+
+#ifndef HTTPX_HOST_BUILD
+// For dumps bigger than the ring: waits for room instead of dropping.
+static void console_write_all(const char *data, size_t size)
+{
+    console.write_all(data, size);
+}
+
+// Hard faults and error() end here.  Whatever the ring still holds is the
+// last thing the demo printed before it died, so it goes out first, then the
+// same SOS on LED1 as mbed OS's own mbed_die().
+extern "C" void mbed_die(void)
+{
+    core_util_critical_section_enter();
+    console.flush_on_fault();
+    report_console.flush_on_fault();
+
+    gpio_t led_err;
+    gpio_init_out(&led_err, LED1);
+    while (1) {
+        for (int ix = 0; ix < 8; ++ix) {
+            int ms = ix < 4 ? 150 : 400;
+            gpio_write(&led_err, 1);
+            wait_ms(ms);
+            gpio_write(&led_err, 0);
+            wait_ms(ms);
+        }
+    }
+}
+#endif
+
+int main() {
+
+    console.start();
+    console.printf("Test HTTP and HTTPS interface\n");
+
+    NetworkInterface *network = easy_connect(true);
+
+    console.printf(" software.\n");
+    if (!network) {
+        console.printf("Unable to connect to network!\n");
+        console.flush();
+        return 1;
+    }
+    console.printf("My IP Address is: %s \n\n", network->get_ip_address());
+    console.printf("Modem SW Revision: %s\n", FIRMWARE_REV(network));
+
+#ifndef HTTPX_HOST_BUILD
+    // Every AT command round trip the scenarios cause is timed from here on
+    // (modem-trace.h); cheap enough to leave on, unlike wnc_debug.
+    static ModemTrace modem_trace;
+    static ModemTraceInterface traced(static_cast<WNC14A2AInterface *>(network), &modem_trace);
+    network = &traced;
+#endif
+
+    static TrafficMeter traffic;
+    traffic_meter_enable(&traffic);
+
+    const char *name = MBED_CONF_APP_BENCH_SCENARIO;
+    int runs = MBED_CONF_APP_BENCH_RUNS;
+#ifdef HTTPX_HOST_BUILD
+    // On the host both can be changed without rebuilding.
+    if (getenv("HTTPX_SCENARIO"))
+        name = getenv("HTTPX_SCENARIO");
+    if (getenv("HTTPX_RUNS"))
+        runs = atoi(getenv("HTTPX_RUNS"));
+#endif
+
+    bool all = (strcmp(name, "all") == 0);
+    const Scenario *only = all ? NULL : Scenario::find(name);
+    if (!all && !only) {
+        console.printf("No scenario \"%s\"; the scenarios are:\n", name);
+        for (const Scenario *s = Scenario::first(); s; s = s->next())
+            console.printf("  %-20s %s\n", s->name(), s->description());
+    } else {
+        bool verbose = (runs == 1);
+        // Reports come from a thread of their own, so they keep coming while
+        // a scenario waits on the network; not amid the benchmark CSV.
+        EventQueue report_events(4 * EVENTS_EVENT_SIZE);
+        Thread report_thread(osPriorityLow, 2*1024, NULL);
+        bool reporting = verbose && MBED_CONF_APP_TRAFFIC_REPORT_MS > 0;
+        if (reporting) {
+            report_console.start();
+            report_thread.start(callback(&report_events, &EventQueue::dispatch_forever));
+            traffic.report_every(&report_events, MBED_CONF_APP_TRAFFIC_REPORT_MS, callback(report_write));
+        }
+        if (!verbose)
+            scenario_bench_header(callback(console_write));
+        for (const Scenario *s = all ? Scenario::first() : only; s; s = all ? s->next() : NULL) {
+            if (verbose)
+                console.printf("\n - - - - - - - %s: %s - - - - - - - \n", s->name(), s->description());
+            scenario_bench(s, network, runs, verbose, callback(console_write));
+        }
+        if (reporting) {
+            traffic.stop_reports();
+            report_events.break_dispatch();
+            report_thread.join();
+            report_console.flush();
+        }
+    }
+
+    network->disconnect();
+    console.printf("\nTraffic:\n");
+    traffic.report(callback(console_write));
+#ifndef HTTPX_HOST_BUILD
+    console.printf("\nModem round trips:\n");
+    modem_trace.export_summary(callback(console_write));
+    modem_trace.export_hex(callback(console_write_all));
+#endif
+    console.printf(" - - - - - - - ALL DONE - - - - - - - \n");
+    console.flush();
+}
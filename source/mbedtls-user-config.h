@@ -0,0 +1,42 @@
+#ifndef _MBEDTLS_USER_CONFIG_H_
+#define _MBEDTLS_USER_CONFIG_H_
+
+//
+// Additions to mbedTLS's config.h, pulled in through MBEDTLS_USER_CONFIG_FILE
+// (mbed_app.json macros), so they apply to mbed-http's TLSSocket as much as
+// to TLSTransport.
+//
+// The record buffers are most of a TLS connection's RAM: one for incoming
+// and one for outgoing records, each the content size plus some 100 bytes
+// of header, MAC and padding.  mbedTLS 2.12 and later size them separately;
+// earlier versions use the larger of the two for both.
+//
+// A record the server sends that is bigger than the incoming buffer kills
+// the connection, so tls_in_record_size under 16384 is only safe with
+// servers that honour the max_fragment_length extension (see
+// tls_max_fragment_length) or never send big records.  The outgoing buffer
+// only limits how much goes into one record: HttpClientRequest already
+// sends in pieces, so it can be small.
+//
+
+#ifndef MBED_CONF_APP_TLS_IN_RECORD_SIZE
+#define MBED_CONF_APP_TLS_IN_RECORD_SIZE    16384
+#endif
+
+#ifndef MBED_CONF_APP_TLS_OUT_RECORD_SIZE
+#define MBED_CONF_APP_TLS_OUT_RECORD_SIZE   16384
+#endif
+
+#define MBEDTLS_SSL_IN_CONTENT_LEN          MBED_CONF_APP_TLS_IN_RECORD_SIZE
+#define MBEDTLS_SSL_OUT_CONTENT_LEN         MBED_CONF_APP_TLS_OUT_RECORD_SIZE
+
+#if MBED_CONF_APP_TLS_IN_RECORD_SIZE > MBED_CONF_APP_TLS_OUT_RECORD_SIZE
+#define MBEDTLS_SSL_MAX_CONTENT_LEN         MBED_CONF_APP_TLS_IN_RECORD_SIZE
+#else
+#define MBEDTLS_SSL_MAX_CONTENT_LEN         MBED_CONF_APP_TLS_OUT_RECORD_SIZE
+#endif
+
+// Needed to ask for smaller records; on in the default config too.
+#define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+
+#endif // _MBEDTLS_USER_CONFIG_H_
@@ -0,0 +1,242 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          modem-trace-interface.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include "modem-trace-interface.h"
+
+//
+// NetworkStack's socket calls are protected, for Socket's use only.  A class
+// derived from NetworkStack may still take pointers to them and call those
+// on any stack, which is how the calls reach the modem.
+//
+struct ModemStack : public NetworkStack {
+    static nsapi_error_t open(NetworkStack *stack, nsapi_socket_t *handle, nsapi_protocol_t proto)
+    {
+        return (stack->*(&ModemStack::socket_open))(handle, proto);
+    }
+    static nsapi_error_t close(NetworkStack *stack, nsapi_socket_t handle)
+    {
+        return (stack->*(&ModemStack::socket_close))(handle);
+    }
+    static nsapi_error_t bind(NetworkStack *stack, nsapi_socket_t handle, const SocketAddress &address)
+    {
+        return (stack->*(&ModemStack::socket_bind))(handle, address);
+    }
+    static nsapi_error_t listen(NetworkStack *stack, nsapi_socket_t handle, int backlog)
+    {
+        return (stack->*(&ModemStack::socket_listen))(handle, backlog);
+    }
+    static nsapi_error_t connect(NetworkStack *stack, nsapi_socket_t handle, const SocketAddress &address)
+    {
+        return (stack->*(&ModemStack::socket_connect))(handle, address);
+    }
+    static nsapi_error_t accept(NetworkStack *stack, nsapi_socket_t server, nsapi_socket_t *handle,
+                                SocketAddress *address)
+    {
+        return (stack->*(&ModemStack::socket_accept))(server, handle, address);
+    }
+    static nsapi_size_or_error_t send(NetworkStack *stack, nsapi_socket_t handle, const void *data,
+                                      nsapi_size_t size)
+    {
+        return (stack->*(&ModemStack::socket_send))(handle, data, size);
+    }
+    static nsapi_size_or_error_t recv(NetworkStack *stack, nsapi_socket_t handle, void *data,
+                                      nsapi_size_t size)
+    {
+        return (stack->*(&ModemStack::socket_recv))(handle, data, size);
+    }
+    static nsapi_size_or_error_t sendto(NetworkStack *stack, nsapi_socket_t handle,
+                                        const SocketAddress &address, const void *data, nsapi_size_t size)
+    {
+        return (stack->*(&ModemStack::socket_sendto))(handle, address, data, size);
+    }
+    static nsapi_size_or_error_t recvfrom(NetworkStack *stack, nsapi_socket_t handle, SocketAddress *address,
+                                          void *buffer, nsapi_size_t size)
+    {
+        return (stack->*(&ModemStack::socket_recvfrom))(handle, address, buffer, size);
+    }
+    static void attach(NetworkStack *stack, nsapi_socket_t handle, void (*callback)(void *), void *data)
+    {
+        (stack->*(&ModemStack::socket_attach))(handle, callback, data);
+    }
+};
+
+// Payload bytes moved, for a call that returns a size or an error.
+static uint32_t moved(nsapi_size_or_error_t result)
+{
+    return result > 0 ? result : 0;
+}
+
+static int error_of(nsapi_size_or_error_t result)
+{
+    return result < 0 ? result : 0;
+}
+
+ModemTraceInterface::ModemTraceInterface(WNC14A2AInterface *modem, ModemTrace *trace)
+    : _modem(modem), _trace(trace)
+{
+    memset(_sockets, 0, sizeof(_sockets));
+}
+
+uint8_t ModemTraceInterface::socket_id(nsapi_socket_t handle)
+{
+    uint8_t id = 0;
+    _mutex.lock();
+    for (int ix = 0; ix < MODEM_TRACE_SOCKETS && !id; ix++) {
+        if (_sockets[ix] == handle) {
+            id = ix + 1;
+        }
+    }
+    _mutex.unlock();
+    return id;
+}
+
+nsapi_error_t ModemTraceInterface::connect()
+{
+    uint32_t start = us_ticker_read();
+    nsapi_error_t result = _modem->connect();
+    _trace->record(MODEM_CONNECT, 0, start, 0, result);
+    return result;
+}
+
+nsapi_error_t ModemTraceInterface::disconnect()
+{
+    uint32_t start = us_ticker_read();
+    nsapi_error_t result = _modem->disconnect();
+    _trace->record(MODEM_DISCONNECT, 0, start, 0, result);
+    return result;
+}
+
+const char *ModemTraceInterface::get_ip_address()
+{
+    return _modem->get_ip_address();
+}
+
+const char *ModemTraceInterface::get_mac_address()
+{
+    return _modem->get_mac_address();
+}
+
+nsapi_error_t ModemTraceInterface::gethostbyname(const char *host, SocketAddress *address,
+                                                 nsapi_version_t version)
+{
+    uint32_t start = us_ticker_read();
+    nsapi_error_t result = static_cast<NetworkStack *>(_modem)->gethostbyname(host, address, version);
+    _trace->record(MODEM_DNS, 0, start, 0, result);
+    return result;
+}
+
+nsapi_error_t ModemTraceInterface::socket_open(nsapi_socket_t *handle, nsapi_protocol_t proto)
+{
+    uint32_t start = us_ticker_read();
+    nsapi_error_t result = ModemStack::open(_modem, handle, proto);
+    uint8_t id = 0;
+    if (result == NSAPI_ERROR_OK) {
+        _mutex.lock();
+        for (int ix = 0; ix < MODEM_TRACE_SOCKETS && !id; ix++) {
+            if (!_sockets[ix]) {
+                _sockets[ix] = *handle;
+                id = ix + 1;
+            }
+        }
+        _mutex.unlock();
+    }
+    _trace->record(MODEM_SOCKET_OPEN, id, start, 0, result);
+    return result;
+}
+
+nsapi_error_t ModemTraceInterface::socket_close(nsapi_socket_t handle)
+{
+    uint8_t id = socket_id(handle);
+    uint32_t start = us_ticker_read();
+    nsapi_error_t result = ModemStack::close(_modem, handle);
+    _trace->record(MODEM_SOCKET_CLOSE, id, start, 0, result);
+    if (id) {
+        _mutex.lock();
+        _sockets[id - 1] = NULL;
+        _mutex.unlock();
+    }
+    return result;
+}
+
+nsapi_error_t ModemTraceInterface::socket_bind(nsapi_socket_t handle, const SocketAddress &address)
+{
+    return ModemStack::bind(_modem, handle, address);
+}
+
+nsapi_error_t ModemTraceInterface::socket_listen(nsapi_socket_t handle, int backlog)
+{
+    return ModemStack::listen(_modem, handle, backlog);
+}
+
+nsapi_error_t ModemTraceInterface::socket_connect(nsapi_socket_t handle, const SocketAddress &address)
+{
+    uint32_t start = us_ticker_read();
+    nsapi_error_t result = ModemStack::connect(_modem, handle, address);
+    _trace->record(MODEM_SOCKET_CONNECT, socket_id(handle), start, 0, result);
+    return result;
+}
+
+nsapi_error_t ModemTraceInterface::socket_accept(nsapi_socket_t server, nsapi_socket_t *handle,
+                                                 SocketAddress *address)
+{
+    return ModemStack::accept(_modem, server, handle, address);
+}
+
+nsapi_size_or_error_t ModemTraceInterface::socket_send(nsapi_socket_t handle, const void *data,
+                                                       nsapi_size_t size)
+{
+    uint32_t start = us_ticker_read();
+    nsapi_size_or_error_t result = ModemStack::send(_modem, handle, data, size);
+    _trace->record(MODEM_SOCKET_SEND, socket_id(handle), start, moved(result), error_of(result));
+    return result;
+}
+
+nsapi_size_or_error_t ModemTraceInterface::socket_recv(nsapi_socket_t handle, void *data,
+                                                       nsapi_size_t size)
+{
+    uint32_t start = us_ticker_read();
+    nsapi_size_or_error_t result = ModemStack::recv(_modem, handle, data, size);
+    _trace->record(MODEM_SOCKET_RECV, socket_id(handle), start, moved(result), error_of(result));
+    return result;
+}
+
+nsapi_size_or_error_t ModemTraceInterface::socket_sendto(nsapi_socket_t handle, const SocketAddress &address,
+                                                         const void *data, nsapi_size_t size)
+{
+    uint32_t start = us_ticker_read();
+    nsapi_size_or_error_t result = ModemStack::sendto(_modem, handle, address, data, size);
+    _trace->record(MODEM_SOCKET_SEND, socket_id(handle), start, moved(result), error_of(result));
+    return result;
+}
+
+nsapi_size_or_error_t ModemTraceInterface::socket_recvfrom(nsapi_socket_t handle, SocketAddress *address,
+                                                           void *buffer, nsapi_size_t size)
+{
+    uint32_t start = us_ticker_read();
+    nsapi_size_or_error_t result = ModemStack::recvfrom(_modem, handle, address, buffer, size);
+    _trace->record(MODEM_SOCKET_RECV, socket_id(handle), start, moved(result), error_of(result));
+    return result;
+}
+
+void ModemTraceInterface::socket_attach(nsapi_socket_t handle, void (*callback)(void *), void *data)
+{
+    ModemStack::attach(_modem, handle, callback, data);
+}
@@ -0,0 +1,69 @@
+#ifndef _MODEM_TRACE_INTERFACE_H_
+#define _MODEM_TRACE_INTERFACE_H_
+
+#include "mbed.h"
+#include "WNC14A2AInterface.h"
+#include "modem-trace.h"
+
+#define MODEM_TRACE_SOCKETS     8       // sockets told apart in the trace
+
+//
+// Stands in front of the WNC14A2AInterface and times every call that turns
+// into an AT command round trip (bringing the session up, DNS, socket open,
+// connect, send, receive, close) into a ModemTrace.  Sockets opened on it are
+// opened on the modem, so everything above (mbed-http, the transports, the
+// pool) is traced without knowing.
+//
+//   static ModemTrace trace;
+//   static ModemTraceInterface traced(modem, &trace);
+//   NetworkInterface *net = &traced;
+//
+// The trace is of the interface calls, which is what socket latency is made
+// of: a receive the driver answers from its own buffer shows up as a round
+// trip of a few microseconds.  Target only; the host build has no modem.
+//
+class ModemTraceInterface : public NetworkInterface, public NetworkStack {
+public:
+    ModemTraceInterface(WNC14A2AInterface *modem, ModemTrace *trace);
+
+    ModemTrace *trace() const { return _trace; }
+
+    // NetworkInterface
+    virtual nsapi_error_t connect();
+    virtual nsapi_error_t disconnect();
+    virtual const char *get_ip_address();
+    virtual const char *get_mac_address();
+
+    // NetworkInterface and NetworkStack
+    virtual nsapi_error_t gethostbyname(const char *host, SocketAddress *address,
+                                        nsapi_version_t version = NSAPI_UNSPEC);
+
+protected:
+    virtual NetworkStack *get_stack() { return this; }
+
+    // NetworkStack
+    virtual nsapi_error_t socket_open(nsapi_socket_t *handle, nsapi_protocol_t proto);
+    virtual nsapi_error_t socket_close(nsapi_socket_t handle);
+    virtual nsapi_error_t socket_bind(nsapi_socket_t handle, const SocketAddress &address);
+    virtual nsapi_error_t socket_listen(nsapi_socket_t handle, int backlog);
+    virtual nsapi_error_t socket_connect(nsapi_socket_t handle, const SocketAddress &address);
+    virtual nsapi_error_t socket_accept(nsapi_socket_t server, nsapi_socket_t *handle,
+                                        SocketAddress *address = 0);
+    virtual nsapi_size_or_error_t socket_send(nsapi_socket_t handle, const void *data, nsapi_size_t size);
+    virtual nsapi_size_or_error_t socket_recv(nsapi_socket_t handle, void *data, nsapi_size_t size);
+    virtual nsapi_size_or_error_t socket_sendto(nsapi_socket_t handle, const SocketAddress &address,
+                                                const void *data, nsapi_size_t size);
+    virtual nsapi_size_or_error_t socket_recvfrom(nsapi_socket_t handle, SocketAddress *address,
+                                                  void *buffer, nsapi_size_t size);
+    virtual void socket_attach(nsapi_socket_t handle, void (*callback)(void *), void *data);
+
+private:
+    uint8_t socket_id(nsapi_socket_t handle);
+
+    WNC14A2AInterface *_modem;
+    ModemTrace *_trace;
+    nsapi_socket_t _sockets[MODEM_TRACE_SOCKETS];
+    Mutex _mutex;               // for _sockets
+};
+
+#endif // _MODEM_TRACE_INTERFACE_H_
@@ -0,0 +1,205 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          modem-trace.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <stdio.h>
+#include <string.h>
+#include "modem-trace.h"
+#include "binary-util.h"
+
+#define MODEM_TRACE_VERSION     1
+
+static const char *const command_names[MODEM_COMMANDS] = {
+    "none", "connect", "disconnect", "dnsresvdoname", "sockcreat", "sockconn", "sockwrite", "sockread", "sockclose"
+};
+
+const char *modem_command_name(int command)
+{
+    return command > 0 && command < MODEM_COMMANDS ? command_names[command] : "unknown";
+}
+
+ModemTrace::ModemTrace() : _head(0), _count(0), _overwritten(0), _sequence(0)
+{
+    memset(_totals, 0, sizeof(_totals));
+}
+
+void ModemTrace::record(uint8_t command, uint8_t socket, uint32_t start_us, uint32_t bytes, int result)
+{
+    uint32_t latency = us_ticker_read() - start_us;
+
+    _mutex.lock();
+    ModemTraceRecord &r = _records[_head];
+    r.start_us = start_us;
+    r.latency_us = latency;
+    r.bytes = bytes > 0xFFFF ? 0xFFFF : bytes;
+    r.result = result;
+    r.command = command;
+    r.socket = socket;
+    r.sequence = _sequence++;
+    _head = (_head + 1) % MBED_CONF_APP_MODEM_TRACE_SIZE;
+    if (_count < MBED_CONF_APP_MODEM_TRACE_SIZE) {
+        _count++;
+    } else {
+        _overwritten++;
+    }
+
+    if (command < MODEM_COMMANDS) {
+        Totals &t = _totals[command];
+        t.count++;
+        if (result == NSAPI_ERROR_WOULD_BLOCK) {
+            t.would_block++;
+        } else if (result != 0) {
+            t.errors++;
+        }
+        t.total_us += latency;
+        if (latency > t.max_us) {
+            t.max_us = latency;
+        }
+        t.bytes += bytes;
+    }
+    _mutex.unlock();
+}
+
+void ModemTrace::clear()
+{
+    _mutex.lock();
+    _head = 0;
+    _count = 0;
+    _overwritten = 0;
+    memset(_totals, 0, sizeof(_totals));
+    _mutex.unlock();
+}
+
+ModemTrace::Totals ModemTrace::totals(int command)
+{
+    Totals t;
+    memset(&t, 0, sizeof(t));
+    if (command > 0 && command < MODEM_COMMANDS) {
+        _mutex.lock();
+        t = _totals[command];
+        _mutex.unlock();
+    }
+    return t;
+}
+
+void ModemTrace::export_csv(Callback<void(const char *data, size_t size)> output)
+{
+    static const char header[] = "seq,start_us,command,socket,result,latency_us,bytes\n";
+    output(header, sizeof(header) - 1);
+
+    _mutex.lock();
+    size_t count = _count;
+    size_t first = (_head + MBED_CONF_APP_MODEM_TRACE_SIZE - count) % MBED_CONF_APP_MODEM_TRACE_SIZE;
+    _mutex.unlock();
+
+    for (size_t ix = 0; ix < count; ix++) {
+        _mutex.lock();
+        ModemTraceRecord r = _records[(first + ix) % MBED_CONF_APP_MODEM_TRACE_SIZE];
+        _mutex.unlock();
+
+        char line[96];
+        int length = snprintf(line, sizeof(line), "%u,%lu,%s,%u,%d,%lu,%u\n",
+                              r.sequence, (unsigned long)r.start_us, modem_command_name(r.command),
+                              r.socket, r.result, (unsigned long)r.latency_us, r.bytes);
+        output(line, length);
+    }
+}
+
+void ModemTrace::export_summary(Callback<void(const char *data, size_t size)> output)
+{
+    static const char header[] = "command,count,errors,would_block,total_us,mean_us,max_us,bytes\n";
+    output(header, sizeof(header) - 1);
+
+    for (int command = 1; command < MODEM_COMMANDS; command++) {
+        Totals t = totals(command);
+        if (!t.count) {
+            continue;
+        }
+        char line[128];
+        int length = snprintf(line, sizeof(line), "%s,%lu,%lu,%lu,%llu,%lu,%lu,%lu\n",
+                              modem_command_name(command), (unsigned long)t.count,
+                              (unsigned long)t.errors, (unsigned long)t.would_block,
+                              (unsigned long long)t.total_us, (unsigned long)(t.total_us / t.count),
+                              (unsigned long)t.max_us, (unsigned long)t.bytes);
+        output(line, length);
+    }
+}
+
+void ModemTrace::export_binary(Callback<void(const char *data, size_t size)> output)
+{
+    _mutex.lock();
+    size_t count = _count;
+    size_t first = (_head + MBED_CONF_APP_MODEM_TRACE_SIZE - count) % MBED_CONF_APP_MODEM_TRACE_SIZE;
+    _mutex.unlock();
+
+    char header[8] = { 'M', 'T', 'R', 'C', MODEM_TRACE_VERSION, MODEM_TRACE_RECORD_SIZE };
+    put16(header + 6, count);
+    output(header, sizeof(header));
+
+    for (size_t ix = 0; ix < count; ix++) {
+        _mutex.lock();
+        ModemTraceRecord r = _records[(first + ix) % MBED_CONF_APP_MODEM_TRACE_SIZE];
+        _mutex.unlock();
+
+        char out[MODEM_TRACE_RECORD_SIZE];
+        char *p = out;
+        p = put32(p, r.start_us);
+        p = put32(p, r.latency_us);
+        p = put16(p, r.bytes);
+        p = put16(p, r.result);
+        *p++ = r.command;
+        *p++ = r.socket;
+        p = put16(p, r.sequence);
+        output(out, p - out);
+    }
+}
+
+// Turns each chunk of the binary export into one text line.
+struct HexLines {
+    Callback<void(const char *data, size_t size)> output;
+
+    void write(const char *data, size_t size)
+    {
+        static const char digits[] = "0123456789abcdef";
+        char line[13 + 2 * MODEM_TRACE_RECORD_SIZE + 1];
+        size_t length = 13;
+
+        memcpy(line, "modem-trace: ", 13);
+        for (size_t ix = 0; ix < size; ix++) {
+            line[length++] = digits[(uint8_t)data[ix] >> 4];
+            line[length++] = digits[data[ix] & 0x0F];
+            if (length == sizeof(line) - 1) {
+                line[length++] = '\n';
+                output(line, length);
+                length = 13;
+            }
+        }
+        if (length > 13) {
+            line[length++] = '\n';
+            output(line, length);
+        }
+    }
+};
+
+void ModemTrace::export_hex(Callback<void(const char *data, size_t size)> output)
+{
+    HexLines lines = { output };
+    export_binary(callback(&lines, &HexLines::write));
+}
@@ -0,0 +1,99 @@
+#ifndef _MODEM_TRACE_H_
+#define _MODEM_TRACE_H_
+
+#include "mbed.h"
+
+#ifndef MBED_CONF_APP_MODEM_TRACE_SIZE
+#define MBED_CONF_APP_MODEM_TRACE_SIZE  128     // records kept; older ones are overwritten
+#endif
+
+//
+// The modem operations traced, each named after the AT command the WNC14A2A
+// driver issues for it.  CONNECT and DISCONNECT bring the data session up
+// and down, which takes a run of commands.
+//
+enum ModemCommand {
+    MODEM_CONNECT = 1,          // AT%PDNSET, AT@INTERNET, AT@SOCKDIAL...
+    MODEM_DISCONNECT,
+    MODEM_DNS,                  // AT@DNSRESVDONAME
+    MODEM_SOCKET_OPEN,          // AT@SOCKCREAT
+    MODEM_SOCKET_CONNECT,       // AT@SOCKCONN
+    MODEM_SOCKET_SEND,          // AT@SOCKWRITE
+    MODEM_SOCKET_RECV,          // AT@SOCKREAD
+    MODEM_SOCKET_CLOSE,         // AT@SOCKCLOSE
+    MODEM_COMMANDS
+};
+
+const char *modem_command_name(int command);
+
+//
+// One modem round trip: when it was issued, how long the answer took and how
+// many payload bytes it moved.
+//
+struct ModemTraceRecord {
+    uint32_t start_us;          // us_ticker_read() when the command was issued
+    uint32_t latency_us;
+    uint16_t bytes;             // sent or received; 0 for control commands
+    int16_t result;             // nsapi error, 0 on success
+    uint8_t command;            // ModemCommand
+    uint8_t socket;             // 1.. for the socket it ran on, 0 for none
+    uint16_t sequence;
+};
+
+//
+// Fixed ring of the most recent modem round trips, plus running totals per
+// command that survive the ring wrapping.  Recording is a copy into the ring
+// under a mutex, against AT round trips of tens of milliseconds, so the trace
+// can stay on where the wnc_debug text output would change the timing it
+// is meant to show.
+//
+// The binary export has the layout of HttpTrace's: an 8 byte header ("MTRC",
+// a version byte, a record size byte and the record count as a little-endian
+// uint16) followed by the records, oldest first, each field little-endian in
+// the order declared above.  tools/modem-trace.py decodes it, raw or as the
+// hex lines export_hex() prints.
+//
+class ModemTrace {
+public:
+    struct Totals {
+        uint32_t count;
+        uint32_t errors;        // results other than 0 and WOULD_BLOCK
+        uint32_t would_block;
+        uint64_t total_us;
+        uint32_t max_us;
+        uint32_t bytes;
+    };
+
+    ModemTrace();
+
+    void record(uint8_t command, uint8_t socket, uint32_t start_us, uint32_t bytes, int result);
+    void clear();
+
+    size_t count() const { return _count; }
+    uint32_t overwritten() const { return _overwritten; }
+    Totals totals(int command);
+
+    // Oldest first; output receives one line or record at a time.
+    void export_csv(Callback<void(const char *data, size_t size)> output);
+    void export_binary(Callback<void(const char *data, size_t size)> output);
+
+    // One line per command: count, errors, total/mean/max latency, bytes.
+    void export_summary(Callback<void(const char *data, size_t size)> output);
+
+    // The binary export as "modem-trace: <hex>" text lines, for a serial
+    // console to capture.
+    void export_hex(Callback<void(const char *data, size_t size)> output);
+
+private:
+    ModemTraceRecord _records[MBED_CONF_APP_MODEM_TRACE_SIZE];
+    size_t _head;               // next slot to write
+    size_t _count;
+    uint32_t _overwritten;
+    uint16_t _sequence;
+    Totals _totals[MODEM_COMMANDS];
+    Mutex _mutex;
+};
+
+#define MODEM_TRACE_RECORD_SIZE 16      // bytes per record in the binary export
+
+#endif // _MODEM_TRACE_H_
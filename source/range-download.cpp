@@ -0,0 +1,371 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          range-download.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <stdio.h>
+#include <string.h>
+#include "range-download.h"
+#include "binary-util.h"
+
+//
+// A progress record, little-endian: magic, sequence, URL hash, file length,
+// bytes committed, the ETag (NUL padded) and an FNV-1a check of all that.
+// The rest of its program units stays 0xFF.
+//
+#define PROGRESS_MAGIC      0x314c4452  // "RDL1"
+#define PROGRESS_ETAG       20
+#define PROGRESS_CHECK      (PROGRESS_ETAG + DOWNLOAD_ETAG_SIZE)
+#define PROGRESS_RECORD     (PROGRESS_CHECK + 4)
+#define REHASH_CHUNK        256
+
+// Worth another try: a server error status, or a link that dropped or
+// stalled.  Anything else (bad parameters, no memory, refused TLS, the file
+// or flash) fails the same way again.
+static bool retriable(int error)
+{
+    switch (error) {
+    case NSAPI_ERROR_WOULD_BLOCK:
+    case NSAPI_ERROR_CONNECTION_LOST:
+    case NSAPI_ERROR_CONNECTION_TIMEOUT:
+    case NSAPI_ERROR_DNS_FAILURE:
+        return true;
+    default:
+        return error > 0;
+    }
+}
+
+RangeDownload::RangeDownload(HttpTransport *transport, const char *url, BlockDevice *bd,
+                             bd_addr_t start, bd_size_t size, bd_addr_t progress_start, bd_size_t progress_size)
+    : _transport(transport), _url(url), _bd(bd), _start(start), _size(size),
+      _progress_start(progress_start), _progress_size(progress_size),
+      _url_hash(fnv1a(url, strlen(url))), _writer(bd, start, 0), _sink(this),
+      _check_digest(false), _length(0), _committed(0), _erase_size(0), _slot_size(0),
+      _slot(0), _sequence(1), _record(NULL)
+{
+    mbedtls_sha256_init(&_sha);
+    mbedtls_sha256_init(&_block_sha);
+    sha256_starts(&_sha, 0);
+    memset(_digest, 0, sizeof(_digest));
+    memset(_expected, 0, sizeof(_expected));
+    memset(_etag, 0, sizeof(_etag));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+RangeDownload::~RangeDownload()
+{
+    mbedtls_sha256_free(&_sha);
+    mbedtls_sha256_free(&_block_sha);
+    delete[] _record;
+}
+
+void RangeDownload::set_digest(const uint8_t digest[32])
+{
+    memcpy(_expected, digest, sizeof(_expected));
+    _check_digest = true;
+}
+
+int RangeDownload::init()
+{
+    uint32_t program_size = _bd->get_program_size();
+    _erase_size = _bd->get_erase_size();
+    _slot_size = (PROGRESS_RECORD + program_size - 1) / program_size * program_size;
+    _progress_size -= _progress_size % _erase_size;
+    if (_start % _erase_size != 0 || _progress_start % _erase_size != 0 ||
+            MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE % _erase_size != 0 || _size < MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE ||
+            _progress_size < 2 * _erase_size || _slot_size > _erase_size) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    delete[] _record;
+    _record = new uint8_t[_slot_size];
+    int ret = load();
+    if (ret == 0 && _committed > 0) {
+        ret = rehash();
+    }
+    _stats.resumed_at = _committed;
+    return ret;
+}
+
+//
+// Finds the newest valid record.  Records fill each erase block from its
+// start, so a block is only read up to its first erased slot; the next
+// record goes there, after anything a reset left half-programmed.
+//
+int RangeDownload::load()
+{
+    uint32_t newest = 0;
+    uint32_t free_slot = 0;
+    bool found = false;
+
+    for (uint32_t block = 0; block < _progress_size; block += _erase_size) {
+        bool newest_here = false;
+        uint32_t slot = block;
+        for (; slot + _slot_size <= block + _erase_size; slot += _slot_size) {
+            int ret = _bd->read(_record, _progress_start + slot, _slot_size);
+            if (ret != 0) {
+                return ret;
+            }
+            uint32_t erased = 0;
+            while (erased < _slot_size && _record[erased] == 0xFF) {
+                erased++;
+            }
+            if (erased == _slot_size) {
+                break;
+            }
+            uint32_t sequence = get_le32(_record + 4);
+            if (get_le32(_record) != PROGRESS_MAGIC ||
+                    get_le32(_record + PROGRESS_CHECK) != fnv1a(_record, PROGRESS_CHECK) ||
+                    (found && sequence <= newest)) {
+                continue;
+            }
+            found = newest_here = true;
+            newest = sequence;
+            if (get_le32(_record + 8) == _url_hash) {
+                _length = get_le32(_record + 12);
+                _committed = get_le32(_record + 16);
+                memcpy(_etag, _record + PROGRESS_ETAG, DOWNLOAD_ETAG_SIZE);
+                _etag[DOWNLOAD_ETAG_SIZE - 1] = '\0';
+            } else {
+                _length = _committed = 0;
+                _etag[0] = '\0';
+            }
+        }
+        if (newest_here) {
+            free_slot = slot;
+        }
+    }
+    // Blocks are only committed whole, except the last.
+    if (_length > _size || _committed > _length ||
+            (_committed % MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE != 0 && _committed != _length)) {
+        _length = _committed = 0;
+        _etag[0] = '\0';
+    }
+    _sequence = newest + 1;
+    if (free_slot % _erase_size + _slot_size > _erase_size) {
+        free_slot += _erase_size - free_slot % _erase_size;
+    }
+    _slot = free_slot % _progress_size;
+    return 0;
+}
+
+// Appends a record of the current progress to the journal.
+int RangeDownload::save()
+{
+    if (!_record) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+    if (_slot % _erase_size == 0) {
+        int ret = _bd->erase(_progress_start + _slot, _erase_size);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    memset(_record, 0xFF, _slot_size);
+    put_le32(_record, PROGRESS_MAGIC);
+    put_le32(_record + 4, _sequence);
+    put_le32(_record + 8, _url_hash);
+    put_le32(_record + 12, _length);
+    put_le32(_record + 16, _committed);
+    memset(_record + PROGRESS_ETAG, 0, DOWNLOAD_ETAG_SIZE);
+    memcpy(_record + PROGRESS_ETAG, _etag, strlen(_etag));
+    put_le32(_record + PROGRESS_CHECK, fnv1a(_record, PROGRESS_CHECK));
+    int ret = _bd->program(_record, _progress_start + _slot, _slot_size);
+    if (ret != 0) {
+        return ret;
+    }
+
+    _sequence++;
+    _slot += _slot_size;
+    if (_slot % _erase_size + _slot_size > _erase_size) {
+        _slot += _erase_size - _slot % _erase_size;
+    }
+    _slot %= _progress_size;
+    return 0;
+}
+
+// Hashes the committed part back from flash, after a restart.
+int RangeDownload::rehash()
+{
+    uint32_t read_size = _bd->get_read_size();
+    uint32_t chunk = (REHASH_CHUNK + read_size - 1) / read_size * read_size;
+    uint8_t *buffer = new uint8_t[chunk];
+    int ret = 0;
+
+    sha256_starts(&_sha, 0);
+    for (uint32_t offset = 0; offset < _committed; offset += chunk) {
+        ret = _bd->read(buffer, _start + offset, chunk);
+        if (ret != 0) {
+            break;
+        }
+        sha256_update(&_sha, buffer, _committed - offset < chunk ? _committed - offset : chunk);
+    }
+    delete[] buffer;
+    return ret;
+}
+
+int RangeDownload::reset()
+{
+    _length = 0;
+    _committed = 0;
+    _etag[0] = '\0';
+    sha256_starts(&_sha, 0);
+    return save();
+}
+
+int RangeDownload::run(uint32_t max_blocks)
+{
+    uint32_t blocks = 0;
+    int failures = 0;
+
+    if (!_record) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+    while (!complete() && (max_blocks == 0 || blocks < max_blocks)) {
+        uint32_t committed = _committed;
+        int ret = fetch();
+        if (ret == 0) {
+            failures = 0;
+            if (_committed > committed) {
+                blocks++;
+            }
+            continue;
+        }
+        if (!retriable(ret) || failures == MBED_CONF_APP_DOWNLOAD_RETRIES) {
+            return ret > 0 ? DOWNLOAD_ERROR_STATUS : ret;
+        }
+        _stats.failures++;
+        Thread::wait(MBED_CONF_APP_DOWNLOAD_RETRY_MS << failures++);
+    }
+    return complete() ? finish_file() : 0;
+}
+
+//
+// Requests the block at _committed.  0 once it is committed, the HTTP status
+// of a server error (worth retrying), or a negative error.
+//
+int RangeDownload::fetch()
+{
+    uint32_t offset = _committed;
+    uint32_t want = MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE;
+    if (_length > 0 && _length - offset < want) {
+        want = _length - offset;
+    }
+    char range[32];
+    snprintf(range, sizeof(range), "bytes=%lu-%lu", (unsigned long)offset, (unsigned long)(offset + want - 1));
+
+    _writer.restart(_start + offset, want);
+    mbedtls_sha256_clone(&_block_sha, &_sha);
+
+    HttpClientRequest *request = new HttpClientRequest(_transport, HTTP_GET, _url, &_sink);
+    if (!request) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+    request->set_header("Range", range);
+    _stats.requests++;
+    HttpClientResponse *response = request->send();
+    int ret = response ? accept(response, offset) : request->get_error();
+    delete request;
+    return ret;
+}
+
+int RangeDownload::receive(const void *data, size_t size)
+{
+    if (_writer.written() + size > MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE) {
+        // More than the block: a whole file in answer to the Range.
+        return DOWNLOAD_ERROR_NO_RANGE;
+    }
+    int ret = _writer.write(data, size);
+    if (ret < 0) {
+        return ret;
+    }
+    sha256_update(&_block_sha, static_cast<const unsigned char *>(data), size);
+    return size;
+}
+
+// Checks the response is the block asked for, of the same file, and commits it.
+int RangeDownload::accept(HttpClientResponse *response, uint32_t offset)
+{
+    int status = response->get_status_code();
+    if (status >= 500) {
+        return status;
+    }
+    if (status != 206) {
+        return status == 200 ? DOWNLOAD_ERROR_NO_RANGE : DOWNLOAD_ERROR_STATUS;
+    }
+
+    const char *range = response->get_header(HTTP_HEADER_CONTENT_RANGE);
+    unsigned long first, last, total;
+    if (!range || sscanf(range, "bytes %lu-%lu/%lu", &first, &last, &total) != 3 ||
+            first != offset || last < first || last >= total) {
+        return DOWNLOAD_ERROR_NO_RANGE;
+    }
+    uint32_t received = last - first + 1;
+    uint32_t want = total - offset < MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE ? total - offset
+                                                                       : MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE;
+    if (received != want || received != _writer.written()) {
+        return DOWNLOAD_ERROR_NO_RANGE;
+    }
+    if (total > _size) {
+        return DOWNLOAD_ERROR_TOO_BIG;
+    }
+
+    // An ETag too long to keep is not compared.
+    const char *etag = response->get_header(HTTP_HEADER_ETAG);
+    if (etag && strlen(etag) >= DOWNLOAD_ETAG_SIZE) {
+        etag = NULL;
+    }
+    if (_length > 0 && (total != _length || (etag && _etag[0] && strcmp(etag, _etag) != 0))) {
+        // The file changed under us: what is committed belongs to the old one.
+        _stats.restarts++;
+        int ret = reset();
+        if (ret != 0 || offset > 0) {
+            return ret;
+        }
+    }
+    _length = total;
+    if (etag) {
+        strcpy(_etag, etag);
+    }
+    return commit(received);
+}
+
+int RangeDownload::commit(uint32_t length)
+{
+    int ret = _writer.flush();
+    if (ret != 0) {
+        return ret;
+    }
+    mbedtls_sha256_clone(&_sha, &_block_sha);
+    _committed += length;
+    return save();
+}
+
+// Digest of the whole file; a wrong one forgets the download.
+int RangeDownload::finish_file()
+{
+    mbedtls_sha256_clone(&_block_sha, &_sha);
+    sha256_finish(&_block_sha, _digest);
+    if (_check_digest && memcmp(_digest, _expected, sizeof(_digest)) != 0) {
+        reset();
+        return DOWNLOAD_ERROR_DIGEST;
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+#ifndef _RANGE_DOWNLOAD_H_
+#define _RANGE_DOWNLOAD_H_
+
+#include "mbed.h"
+#include "BlockDevice.h"
+#include "mbedtls/sha256.h"
+#include "http-client.h"
+
+#ifndef MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE
+#define MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE   4096    // bytes per Range request, a multiple of the erase size
+#endif
+
+#ifndef MBED_CONF_APP_DOWNLOAD_RETRIES
+#define MBED_CONF_APP_DOWNLOAD_RETRIES      5       // failed requests in a row before run() gives up
+#endif
+
+#ifndef MBED_CONF_APP_DOWNLOAD_RETRY_MS
+#define MBED_CONF_APP_DOWNLOAD_RETRY_MS     1000    // wait after the first failure, doubled after each
+#endif
+
+#define DOWNLOAD_ETAG_SIZE                  48      // longest ETag kept, with its NUL
+
+// Failures of RangeDownload::run().
+#define DOWNLOAD_ERROR_NO_RANGE             -3601   // the server ignored the Range header
+#define DOWNLOAD_ERROR_STATUS               -3602   // neither 206 nor a server error
+#define DOWNLOAD_ERROR_TOO_BIG              -3603   // the file does not fit the region
+#define DOWNLOAD_ERROR_DIGEST               -3604   // SHA-256 of the whole file is not the expected one
+
+//
+// Downloads a file of any size into a BlockDevice region one Range request
+// of MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE bytes at a time, for firmware images
+// and other files larger than RAM.  Each block goes from the receive buffer
+// straight to flash, and only once it has arrived whole is it committed: the
+// SHA-256 of the file so far moves past it and the progress is saved to a
+// second region.  After a dropped connection the block is fetched again;
+// after a reset, init() finds the saved progress and run() carries on at the
+// first block not committed, re-hashing the committed part from flash.
+//
+// Progress records are journalled through the progress region (two erase
+// blocks or more), each in its own program unit with a sequence number and
+// a checksum, so saving one costs a program and only every few saves an
+// erase, and a reset while saving leaves the previous record intact.  The
+// record holds the URL's hash, the file length and its ETag: a different
+// URL starts over, and a file that changed on the server (another length or
+// ETag) is downloaded again from the start.
+//
+//   RangeDownload download(&transport, url, &bd, 0, 512 * 1024, 512 * 1024, 8192);
+//   download.set_digest(expected);
+//   if (download.init() == 0 && download.run() == 0 && download.complete()) ...
+//
+// transport and url must outlive the download; bd must be initialised.
+//
+class RangeDownload {
+public:
+    struct Stats {
+        uint32_t requests;      // Range requests sent
+        uint32_t failures;      // of them, failed and retried
+        uint32_t restarts;      // times the file changed and was started over
+        uint32_t resumed_at;    // bytes already committed when init() ran
+    };
+
+    RangeDownload(HttpTransport *transport, const char *url, BlockDevice *bd,
+                  bd_addr_t start, bd_size_t size, bd_addr_t progress_start, bd_size_t progress_size);
+    ~RangeDownload();
+
+    // Expected SHA-256 of the file; without one the digest is only reported.
+    void set_digest(const uint8_t digest[32]);
+
+    // Reads back the saved progress.  NSAPI_ERROR_PARAMETER when the regions
+    // are not erase-block aligned, the progress region is under two erase
+    // blocks, or MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE is not a multiple of the
+    // erase size.
+    int init();
+
+    //
+    // Fetches blocks until the file is complete, retrying a failed request
+    // MBED_CONF_APP_DOWNLOAD_RETRIES times with a growing wait, or until
+    // max_blocks blocks were committed when it is not 0 (so the caller can
+    // do other work between them).  Returns 0, or the error that stopped
+    // it; the committed part survives either way.  A file whose digest does
+    // not match is forgotten, so the next run() starts over.
+    //
+    int run(uint32_t max_blocks = 0);
+
+    // Forgets the saved progress.
+    int reset();
+
+    bool complete() const { return _length > 0 && _committed == _length; }
+    uint32_t length() const { return _length; }         // 0 until the first response
+    uint32_t committed() const { return _committed; }
+    const char *etag() const { return _etag; }
+    const uint8_t *digest() const { return _digest; }   // valid once complete()
+    const Stats &stats() const { return _stats; }
+
+private:
+    // Passes a block on to the flash, hashing it on the way.
+    class BlockSink : public HttpBodySink {
+    public:
+        BlockSink(RangeDownload *download) : _download(download) {}
+        virtual int write(const void *data, size_t size) { return _download->receive(data, size); }
+    private:
+        RangeDownload *_download;
+    };
+
+    int fetch();
+    int receive(const void *data, size_t size);
+    int accept(HttpClientResponse *response, uint32_t offset);
+    int commit(uint32_t length);
+    int finish_file();
+    int rehash();
+    int load();
+    int save();
+
+    HttpTransport *_transport;
+    const char *_url;
+    BlockDevice *_bd;
+    bd_addr_t _start;
+    bd_size_t _size;
+    bd_addr_t _progress_start;
+    bd_size_t _progress_size;
+    uint32_t _url_hash;
+
+    BlockDeviceSink _writer;
+    BlockSink _sink;
+    mbedtls_sha256_context _sha;        // the committed part
+    mbedtls_sha256_context _block_sha;  // ... and the block arriving
+    uint8_t _digest[32];
+    uint8_t _expected[32];
+    bool _check_digest;
+
+    uint32_t _length;
+    uint32_t _committed;
+    char _etag[DOWNLOAD_ETAG_SIZE];
+
+    uint32_t _erase_size;
+    uint32_t _slot_size;        // one progress record, in program units
+    uint32_t _slot;             // where the next record goes
+    uint32_t _sequence;         // of the next record
+    uint8_t *_record;
+
+    Stats _stats;
+};
+
+#endif // _RANGE_DOWNLOAD_H_
@@ -0,0 +1,72 @@
+#include "mbed.h"
+#include "http_request.h"
+#include "scenario.h"
+
+SCENARIO(http_socket_reuse, "http-socket-reuse", "GET and POST with mbed-http over one TCP connection")
+{
+    // Create a TCP socket
+    if (verbose) {
+        console.printf("\n----- Setting up TCP connection -----\n");
+    }
+
+    TCPSocket* socket = new TCPSocket();
+    nsapi_error_t open_result = socket->open(net);
+    if (open_result != 0) {
+        console.printf("Opening TCPSocket failed... %d\n", open_result);
+        delete socket;
+        return open_result;
+    }
+
+    nsapi_error_t connect_result = socket->connect("httpbin.org", 80);
+    if (connect_result != 0) {
+        console.printf("Connecting over TCPSocket failed... %d\n", connect_result);
+        delete socket;
+        return connect_result;
+    }
+
+    if (verbose) {
+        console.printf("Connected over TCP to httpbin.org:80\n");
+    }
+
+    int result = 0;
+
+    // Do a GET request to httpbin.org
+    {
+        HttpRequest* get_req = new HttpRequest(socket, HTTP_GET, "http://httpbin.org/status/418");
+
+        // By default the body is automatically parsed and stored in a string, this is memory heavy.
+        // To receive chunked response, pass in a callback as third parameter to 'send'.
+        HttpResponse* get_res = get_req->send();
+        if (!get_res) {
+            result = get_req->get_error();
+            console.printf("HttpRequest failed (error code %d)\n", result);
+        } else if (verbose) {
+            console.printf("\n----- HTTP GET response -----\n");
+            dump_response(get_res);
+        }
+
+        delete get_req;
+    }
+
+    // POST request to httpbin.org
+    if (result == 0) {
+        HttpRequest* post_req = new HttpRequest(socket, HTTP_POST, "http://httpbin.org/post");
+        post_req->set_header("Content-Type", "application/json");
+
+        const char body[] = "{\"hello\":\"world\"}";
+
+        HttpResponse* post_res = post_req->send(body, strlen(body));
+        if (!post_res) {
+            result = post_req->get_error();
+            console.printf("HttpRequest failed (error code %d)\n", result);
+        } else if (verbose) {
+            console.printf("\n----- HTTP POST response -----\n");
+            dump_response(post_res);
+        }
+
+        delete post_req;
+    }
+
+    delete socket;
+    return result;
+}
@@ -0,0 +1,53 @@
+#include "mbed.h"
+#include "http_request.h"
+#include "scenario.h"
+
+SCENARIO(http, "http", "GET and POST with mbed-http, a new connection each")
+{
+    // Do a GET request to httpbin.org
+    {
+        // By default the body is automatically parsed and stored in a buffer, this is memory heavy.
+        // To receive chunked response, pass in a callback as last parameter to the constructor.
+        HttpRequest* get_req = new HttpRequest(net, HTTP_GET, "http://httpbin.org/status/418");
+
+        HttpResponse* get_res = get_req->send();
+        if (!get_res) {
+            int error = get_req->get_error();
+            console.printf("HttpRequest failed (error code %d)\n", error);
+            delete get_req;
+            return error;
+        }
+
+        if (verbose) {
+            console.printf("\n----- HTTP GET response -----\n");
+            dump_response(get_res);
+        }
+
+        delete get_req;
+    }
+
+    // POST request to httpbin.org
+    {
+        HttpRequest* post_req = new HttpRequest(net, HTTP_POST, "http://httpbin.org/post");
+        post_req->set_header("Content-Type", "application/json");
+
+        const char body[] = "{\"hello\":\"world\"}";
+
+        HttpResponse* post_res = post_req->send(body, strlen(body));
+        if (!post_res) {
+            int error = post_req->get_error();
+            console.printf("HttpRequest failed (error code %d)\n", error);
+            delete post_req;
+            return error;
+        }
+
+        if (verbose) {
+            console.printf("\n----- HTTP POST response -----\n");
+            dump_response(post_res);
+        }
+
+        delete post_req;
+    }
+
+    return 0;
+}
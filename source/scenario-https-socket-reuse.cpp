@@ -0,0 +1,67 @@
+#include "mbed.h"
+#include "http-client.h"
+#include "tls-transport.h"
+#include "scenario.h"
+
+// Trusted root CA certificates come from the shared trust store (trust-store.h),
+// generated from certs/ by tools/pem2der.py.
+
+/**
+ * This scenario shows how to re-use sockets, so the TLS handshake only has to happen once
+ */
+SCENARIO(https_socket_reuse, "https-socket-reuse", "GET and POST over one TLS connection")
+{
+    // Create a TLS transport (which holds a TCPSocket)
+    if (verbose) {
+        console.printf("\n----- Setting up TLS connection -----\n");
+    }
+
+    TLSTransport* socket = new TLSTransport(net, "httpbin.org", 443);
+    socket->set_debug(verbose);
+    if (socket->connect() != 0) {
+        int error = socket->error();
+        console.printf("TLS Connect failed %d\n", error);
+        delete socket;
+        return error ? error : NSAPI_ERROR_NO_CONNECTION;
+    }
+
+    int result = 0;
+
+    // GET request to httpbin.org
+    {
+        HttpClientRequest* get_req = new HttpClientRequest(socket, HTTP_GET, "https://httpbin.org/status/418");
+
+        HttpClientResponse* get_res = get_req->send();
+        if (!get_res) {
+            result = get_req->get_error();
+            console.printf("HttpRequest failed (error code %d)\n", result);
+        } else if (verbose) {
+            console.printf("\n----- HTTPS GET response -----\n");
+            dump_httpsresponse(get_res);
+        }
+
+        delete get_req;
+    }
+
+    // POST request to httpbin.org
+    if (result == 0) {
+        HttpClientRequest* post_req = new HttpClientRequest(socket, HTTP_POST, "https://httpbin.org/post");
+        post_req->set_header("Content-Type", "application/json");
+
+        const char body[] = "{\"hello\":\"world\"}";
+
+        HttpClientResponse* post_res = post_req->send(body, strlen(body));
+        if (!post_res) {
+            result = post_req->get_error();
+            console.printf("HttpRequest failed (error code %d)\n", result);
+        } else if (verbose) {
+            console.printf("\n----- HTTPS POST response -----\n");
+            dump_httpsresponse(post_res);
+        }
+
+        delete post_req;
+    }
+
+    delete socket;
+    return result;
+}
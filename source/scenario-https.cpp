@@ -0,0 +1,70 @@
+#include "mbed.h"
+#include "http-client.h"
+#include "tls-transport.h"
+#include "scenario.h"
+
+// Trusted root CA certificates come from the shared trust store (trust-store.h),
+// generated from certs/ by tools/pem2der.py.
+
+SCENARIO(https, "https", "GET and POST over TLS, a full handshake each")
+{
+    // GET request to developer.mbed.org
+    {
+        if (verbose) {
+            console.printf("\n----- HTTPS GET request -----\n");
+        }
+
+        TLSTransport* socket = new TLSTransport(net, "developer.mbed.org", 443);
+        socket->set_debug(verbose);
+        HttpClientRequest* get_req = new HttpClientRequest(socket, HTTP_GET, "https://developer.mbed.org/media/uploads/mbed_official/hello.txt");
+
+        HttpClientResponse* get_res = get_req->send();
+        if (!get_res) {
+            int error = get_req->get_error();
+            console.printf("HttpRequest failed (error code %d)\n", error);
+            delete get_req;
+            delete socket;
+            return error;
+        }
+        if (verbose) {
+            console.printf("\n----- HTTPS GET response -----\n");
+            dump_httpsresponse(get_res);
+        }
+
+        delete get_req;
+        delete socket;
+    }
+
+    // POST request to httpbin.org
+    {
+        if (verbose) {
+            console.printf("\n----- HTTPS POST request -----\n");
+        }
+
+        TLSTransport* socket = new TLSTransport(net, "httpbin.org", 443);
+        socket->set_debug(verbose);
+        HttpClientRequest* post_req = new HttpClientRequest(socket, HTTP_POST, "https://httpbin.org/post");
+        post_req->set_header("Content-Type", "application/json");
+
+        const char body[] = "{\"hello\":\"world\"}";
+
+        HttpClientResponse* post_res = post_req->send(body, strlen(body));
+        if (!post_res) {
+            int error = post_req->get_error();
+            console.printf("HttpRequest failed (error code %d)\n", error);
+            delete post_req;
+            delete socket;
+            return error;
+        }
+
+        if (verbose) {
+            console.printf("\n----- HTTPS POST response -----\n");
+            dump_httpsresponse(post_res);
+        }
+
+        delete post_req;
+        delete socket;
+    }
+
+    return 0;
+}
@@ -0,0 +1,735 @@
+/* =====================================================================
+   Copyright © 2016, Avnet (R)
+
+   Contributors:
+     * James M Flynn, www.em.avnet.com 
+ 
+   Licensed under the Apache License, Version 2.0 (the "License"); 
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, 
+   software distributed under the License is distributed on an 
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, 
+   either express or implied. See the License for the specific 
+   language governing permissions and limitations under the License.
+
+    @file          scenario-httpx.cpp / WNC14A2AInterface_HTTP_exampel
+    @version       1.0
+    @date          Dec 2016
+
+======================================================================== */
+
+#include "mbed.h"
+#include "easy-connect.h"
+#include "WNC14A2AInterface.h"
+#include "connection-pool.h"
+#include "http-client.h"
+#include "tls-transport.h"
+#include "log-ring.h"
+#include "http-pipeline.h"
+#include "http-async.h"
+#include "dns-cache.h"
+#include "http-deflate.h"
+#include "json-stream.h"
+#include "telemetry.h"
+#include "range-download.h"
+#include "http-cache.h"
+#include "HeapBlockDevice.h"
+#include "scenario.h"
+
+#define STREAM_CNT  10          //when we test streaming, this is how many times to stream the string
+#define STR_SIZE    150*(STREAM_CNT+1) //use a fixed size string buffer based on the streaming data count
+
+#define TOSTR(x) #x
+#define INTSTR(x) TOSTR(x)
+
+//
+// We do the same thing for both http and https, so create a macro to eaze the typing...
+//
+
+
+//
+// Trusted root CA certificates are compiled into flash from certs/ (see
+// trust-store.h) and shared by every TLS connection.
+//
+
+//
+// The two test functions do the same set of tests, the first one uses standard HTTP methods while
+// the second test uses HTTPS.  Each returns 0, or the error of the request that stopped it.
+//
+
+int test_http(NetworkInterface *net);     //function makes standard HTTP calls
+int test_https(NetworkInterface *net);    //function makes standard HTTPS calls
+void pipeline_requests(HttpTransport *socket, const char *kind);  //pipelines a request sequence on one connection
+void test_async(NetworkInterface *net);   //runs HTTP requests concurrently from an event queue
+void test_telemetry(NetworkInterface *net);  //batches sensor readings into a few uploads
+void test_download(NetworkInterface *net);   //resumable download to a block device
+void test_cache(NetworkInterface *net);      //GETs revalidated against a flash cache
+
+// TLS sessions outlive the connections that negotiated them, so reconnects
+// to a server resume instead of paying for a full handshake.
+TLSSessionCache tls_sessions;
+
+// Where each HttpClientRequest spent its time, printed as CSV at the end.
+HttpTrace http_timing;
+
+// Compressed responses are inflated through this one window, so only the
+// test thread's sequential requests use it, never the async ones.
+InflateSink inflater;
+
+static void console_write(const char *data, size_t size)
+{
+    console.write(data, size);
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
+// The whole demo: every test below, one after the other.
+//
+SCENARIO(httpx, "httpx", "HTTP and HTTPS tests of every client feature, one after the other")
+{
+    // Host addresses are looked up once and refreshed in the background by a
+    // low-priority thread, so reconnects skip the modem's DNS round trip.
+    EventQueue dns_events(4 * EVENTS_EVENT_SIZE);
+    Thread dns_refresh(osPriorityBelowNormal, 2*1024, NULL);
+    DnsCache dns(net, &dns_events);
+    dns_cache_enable(&dns);
+    dns_refresh.start(callback(&dns_events, &EventQueue::dispatch_forever));
+    http_trace_enable(&http_timing);
+
+    int result = test_http(net);
+    test_async(net);
+    int https_result = test_https(net);
+    test_telemetry(net);
+    test_download(net);
+    test_cache(net);
+
+    dns_events.break_dispatch();
+    dns_refresh.join();
+    dns_cache_enable(NULL);
+    http_trace_enable(NULL);
+
+    if (verbose) {
+        console.printf("DNS cache: %lu hits, %lu stale hits, %lu misses, %lu prefetches, %lu failures\n",
+                       (unsigned long)dns.stats().hits, (unsigned long)dns.stats().stale_hits,
+                       (unsigned long)dns.stats().misses, (unsigned long)dns.stats().prefetches,
+                       (unsigned long)dns.stats().failures);
+        console.printf("Console: %lu records, %lu dropped (%lu bytes), %lu bytes high water\n",
+                       (unsigned long)console.stats().records, (unsigned long)console.stats().dropped_records,
+                       (unsigned long)console.stats().dropped_bytes, (unsigned long)console.stats().high_water);
+        console.printf("\nRequest timing (%lu overwritten):\n", (unsigned long)http_timing.overwritten());
+        http_timing.export_csv(callback(console_write));
+        HttpMemoryStats mem;
+        http_memory_stats(&mem);
+        console.printf("HTTP pools: %lu requests, %lu responses, %lu arenas, %lu bodies at peak, %lu heap overflows\n",
+                       (unsigned long)mem.requests_peak, (unsigned long)mem.responses_peak,
+                       (unsigned long)mem.arenas_peak, (unsigned long)mem.bodies_peak,
+                       (unsigned long)mem.overflows);
+    }
+    return result ? result : https_result;
+}
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
+// Utility functions to print out responses (dump_httpsresponse() is in scenario.cpp)
+//
+void stream_callback(const char *data, size_t len)
+{
+    console.printf("Chunk Received:\n");
+    console.write(data, len);
+    console.write("\n", 1);
+}
+
+// stream_callback() as a sink, for bodies that are inflated on the way,
+// optionally passing every chunk on to another sink.
+class StreamSink : public HttpBodySink {
+public:
+    StreamSink(HttpBodySink *next = NULL) : _next(next) {}
+
+    virtual int write(const void *data, size_t size) {
+        stream_callback(static_cast<const char *>(data), size);
+        return _next ? _next->write(data, size) : (int)size;
+    }
+    virtual void finish(bool complete) {
+        if (_next) {
+            _next->finish(complete);
+        }
+    }
+
+private:
+    HttpBodySink *_next;
+};
+
+// Prints the fields a JsonStreamParser picked out of a body.
+class JsonFieldPrinter : public JsonHandler {
+public:
+    virtual int value(const char *path, JsonType type, const char *text, size_t length) {
+        (void)length;
+        console.printf("JSON %s (%s): %s\n", path, json_type_name(type), text);
+        return 0;
+    }
+};
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
+// test the HTTP client class
+//
+int test_http(NetworkInterface *net) 
+{
+    //
+    // Sockets come from a pool keyed by host:port: each request borrows one
+    // through its own PooledTransport, so every request after the first one
+    // to a server rides on the kept-alive connection.
+    //
+    ConnectionPool pool(net);
+    int result = 0;
+
+    console.printf(">>>>>>>>>>>><<<<<<<<<<<<\n");
+    console.printf(">>>  TEST HTTPClient <<<\n");
+    console.printf(">>>>>>>>>>>><<<<<<<<<<<<\n\n");
+
+    console.printf(" >>>First, lets get a page from http://developer.mbed.org\n");
+    {
+        PooledTransport transport(&pool, "developer.mbed.org", 80);
+        HttpClientRequest* get_req = new HttpClientRequest(&transport,HTTP_GET,"http://developer.mbed.org/media/uploads/mbed_official/hello.txt");
+        HttpClientResponse* get_res = get_req->send();
+        if (!get_res) {
+            console.printf("HttpRequest failed (error code %d)\n", get_req->get_error());
+            result = get_req->get_error();
+        } else {
+            console.printf("\n----- RESPONSE: -----\n");
+            dump_httpsresponse(get_res);
+            transport.release(get_res);
+        }
+        delete get_req;
+    }
+
+    if (result == 0) {
+        console.printf("\n\n >>>Post data... **\n");
+        PooledTransport transport(&pool, "httpbin.org", 80);
+        HttpClientRequest* post_req = new HttpClientRequest(&transport, HTTP_POST, "http://httpbin.org/post");
+        post_req->set_header("Content-Type", "application/json");
+        const char body[] = "{\"hello\":\"world\"},"
+                            "{\"test\":\"1234\"}";
+
+        HttpClientResponse* post_res = post_req->send(body, strlen(body));
+        if (!post_res) {
+            console.printf("HttpRequest failed (error code %d)\n", post_req->get_error());
+            result = post_req->get_error();
+        } else {
+            console.printf("\n----- RESPONSE: -----\n");
+            dump_httpsresponse(post_res);
+            transport.release(post_res);
+        }
+        delete post_req;
+    }
+
+    if (result == 0) {
+        console.printf("\n\n >>>Put data... \n");
+        PooledTransport transport(&pool, "httpbin.org", 80);
+        HttpClientRequest* put_req = new HttpClientRequest(&transport, HTTP_PUT, "http://httpbin.org/put");
+        put_req->set_header("Content-Type", "application/json");
+
+        const char body[] = "This is a PUT test!";
+
+        HttpClientResponse* put_res = put_req->send(body, strlen(body));
+        if (!put_res) {
+            console.printf("HttpRequest failed (error code %d)\n", put_req->get_error());
+            result = put_req->get_error();
+        } else {
+            console.printf("\n----- RESPONSE: -----\n");
+            dump_httpsresponse(put_res);
+            transport.release(put_res);
+        }
+        delete put_req;
+    }
+
+    if (result == 0) {
+        console.printf("\n\n >>>Delete data... \n");
+        PooledTransport transport(&pool, "httpbin.org", 80);
+        HttpClientRequest* del_req = new HttpClientRequest(&transport, HTTP_DELETE, "http://httpbin.org/delete");
+        del_req->set_header("Content-Type", "application/json");
+
+        HttpClientResponse* del_res = del_req->send();
+        if (!del_res) {
+            console.printf("HttpRequest failed (error code %d)\n", del_req->get_error());
+            result = del_req->get_error();
+        } else {
+            console.printf("\n----- RESPONSE: -----\n");
+            dump_httpsresponse(del_res);
+            transport.release(del_res);
+        }
+        delete del_req;
+    }
+
+    //
+    // /stream/N sends N JSON documents one after another; while the chunks
+    // are printed, the parser picks each document's id and url out of them
+    // as they arrive, whichever chunk boundaries they straddle.
+    //
+    if (result == 0) {
+        console.printf("\n\n >>>HTTP:stream, send http://httpbin.org/stream/" INTSTR(STREAM_CNT) "... \n");
+        static const char *const fields[] = { "id", "url" };
+        JsonFieldPrinter printer;
+        JsonStreamParser parser(&printer, fields, 2);
+        StreamSink stream(&parser);
+        PooledTransport transport(&pool, "httpbin.org", 80);
+        HttpClientRequest* stream_req = new HttpClientRequest(&transport, HTTP_GET, "http://httpbin.org/stream/" INTSTR(STREAM_CNT),
+                                                              &stream);
+        HttpClientResponse* stream_res = stream_req->send();
+        if (!stream_res || parser.failure()) {
+            console.printf("HttpRequest failed (error code %d)\n", stream_res ? parser.failure() : stream_req->get_error());
+        } else {
+            console.printf("%u JSON documents, %u bytes parsed\n", (unsigned)parser.documents(), (unsigned)parser.length());
+            transport.release(stream_res);
+        }
+        delete stream_req;
+    }
+
+    //
+    // The inflater recognises a gzip or zlib body by its Content-Encoding
+    // and hands each inflated piece to stream_callback() as it streams in.
+    //
+    if (result == 0) {
+        console.printf("\n\n >>>HTTP:gzip, inflated as it streams in...\n");
+        StreamSink stream;
+        PooledTransport transport(&pool, "httpbin.org", 80);
+        HttpClientRequest* gzip_req = new HttpClientRequest(&transport, HTTP_GET, "http://httpbin.org/gzip", &stream);
+        gzip_req->set_accept_encoding(&inflater);
+        HttpClientResponse* gzip_res = gzip_req->send();
+        if (!gzip_res) {
+            console.printf("HttpRequest failed (error code %d)\n", gzip_req->get_error());
+        } else {
+            console.printf("%s: %u bytes received, %u inflated\n", http_encoding_name(inflater.encoding()),
+                           (unsigned)inflater.input_length(), (unsigned)inflater.output_length());
+            transport.release(gzip_res);
+        }
+        delete gzip_req;
+    }
+
+    if (result == 0) {
+        console.printf("\n\n >>>HTTP:Status...\n");
+        PooledTransport transport(&pool, "httpbin.org", 80);
+        HttpClientRequest* get_req = new HttpClientRequest(&transport,HTTP_GET,"http://httpbin.org/get?show_env=1");
+        HttpClientResponse* get_res = get_req->send();
+        if (!get_res) {
+            console.printf("HttpRequest failed (error code %d)\n", get_req->get_error());
+            result = get_req->get_error();
+        } else {
+            console.printf("\n----- RESPONSE: -----\n");
+            dump_httpsresponse(get_res);
+            transport.release(get_res);
+        }
+        delete get_req;
+    }
+
+    console.printf("\nConnection pool: %lu connects, %lu reuses, %lu reconnects, %lu expired, %lu stale\n",
+           (unsigned long)pool.stats().connects, (unsigned long)pool.stats().reuses,
+           (unsigned long)pool.stats().reconnects, (unsigned long)pool.stats().expired,
+           (unsigned long)pool.stats().stale);
+    if (result != 0) {
+        return result;
+    }
+
+    //
+    // The same sequence again, pipelined on one connection.
+    //
+    TCPTransport* socket = new TCPTransport(net, "httpbin.org", 80);
+    pipeline_requests(socket, "HttpRequest");
+    delete socket;
+    return 0;
+}
+
+
+void dump_digest(HashSink *hash)
+{
+    console.printf("Streamed %u bytes, SHA-256 ", (unsigned)hash->length());
+    for (size_t x = 0; x < 32; x++)
+        console.printf("%02x", hash->digest()[x]);
+    console.printf("\n");
+}
+
+void dump_memory(HttpClientRequest *req)
+{
+    const HttpClientRequest::MemoryStats &mem = req->get_memory_stats();
+    console.printf("Memory: %lu of %lu arena bytes, %lu heap allocations, %lu heap bytes at peak\n",
+                   (unsigned long)mem.arena_peak, (unsigned long)mem.arena_size,
+                   (unsigned long)mem.heap_allocs, (unsigned long)mem.heap_peak);
+}
+
+void dump_traffic(HttpClientRequest *req)
+{
+    const TrafficCounters &traffic = req->get_traffic();
+    console.printf("Traffic: %lu bytes sent, %lu received (%lu and %lu of TLS), %lu/%lu on air, %lu uJ\n",
+                   (unsigned long)traffic.wire_sent, (unsigned long)traffic.wire_received,
+                   (unsigned long)(traffic.wire_sent - traffic.app_sent),
+                   (unsigned long)(traffic.wire_received - traffic.app_received),
+                   (unsigned long)traffic_air_sent(traffic), (unsigned long)traffic_air_received(traffic),
+                   (unsigned long)traffic_energy_uj(traffic));
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
+// POST, PUT, DELETE and stream go out back to back on one connection (HTTP/1.1
+// pipelining), so together they cost one round trip instead of four.  kind
+// names the transport in failure messages: HttpRequest or HttpsRequest.
+//
+// Heads of the pipelined POST and PUT, put together at compile time
+// (http-head-template.h): only their Content-Length is filled in.
+static const HttpHeadTemplate post_head = HTTP_HEAD_TEMPLATE_WITH_BODY(
+    "POST", "/post", "httpbin.org", HTTP_HEADER_LINE("Content-Type", "application/json"));
+static const HttpHeadTemplate put_head = HTTP_HEAD_TEMPLATE_WITH_BODY(
+    "PUT", "/put", "httpbin.org", HTTP_HEADER_LINE("Content-Type", "application/json"));
+
+void pipeline_requests(HttpTransport *socket, const char *kind)
+{
+    const char post_body[] = "{\"hello\":\"world\"},"
+                             "{\"test\":\"1234\"}";
+    const char put_body[] = "This is a PUT test!";
+    HashSink hash;
+
+    HttpClientRequest* post_req = new HttpClientRequest(socket, HTTP_POST, "http://httpbin.org/post");
+    post_req->set_head_template(&post_head);
+    post_req->set_body_encoding(HTTP_ENCODING_GZIP);        // if it makes the body smaller
+    HttpClientRequest* put_req = new HttpClientRequest(socket, HTTP_PUT, "http://httpbin.org/put");
+    put_req->set_head_template(&put_head);
+    HttpClientRequest* del_req = new HttpClientRequest(socket, HTTP_DELETE, "http://httpbin.org/delete");
+    del_req->set_header("Content-Type", "application/json");
+    HttpClientRequest* stream_req = new HttpClientRequest(socket, HTTP_GET, "http://httpbin.org/stream/" INTSTR(STREAM_CNT), 
+                                              &hash );
+
+    console.printf("\n\n >>>Pipelined: Post, Put, Delete and stream " INTSTR(STREAM_CNT) "... \n");
+    HttpPipeline pipeline(socket);
+    pipeline.add(post_req, post_body, strlen(post_body));
+    pipeline.add(put_req, put_body, strlen(put_body));
+    pipeline.add(del_req);
+    pipeline.add(stream_req);
+    pipeline.run();
+
+    HttpClientRequest* reqs[] = { post_req, put_req, del_req };
+    for (size_t x = 0; x < sizeof(reqs) / sizeof(reqs[0]); x++) {
+        if (!reqs[x]->get_response()) {
+            console.printf("%s failed (error code %d)\n", kind, reqs[x]->get_error());
+            continue;
+        }
+        console.printf("\n----- RESPONSE: -----\n");
+        dump_httpsresponse(reqs[x]->get_response());
+    }
+    if (stream_req->get_response())
+        dump_digest(&hash);
+    else
+        console.printf("%s failed (error code %d)\n", kind, stream_req->get_error());
+
+    console.printf("\nPipeline: %lu responses, %lu resent, %lu failed, %lu fallbacks\n",
+                   (unsigned long)pipeline.stats().responses, (unsigned long)pipeline.stats().resent,
+                   (unsigned long)pipeline.stats().failed, (unsigned long)pipeline.stats().fallbacks);
+
+    delete post_req;
+    delete put_req;
+    delete del_req;
+    delete stream_req;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
+// The same requests again, all submitted at once to the async engine and run
+// concurrently over separate modem sockets.  Responses print as they finish,
+// which need not be the order they were submitted in.
+//
+struct AsyncTest {
+    EventQueue *queue;
+    HttpAsyncEngine *engine;
+
+    void done(HttpClientRequest *req)
+    {
+        if (!req->get_response())
+            console.printf("\nAsync %s failed (error code %d)\n", req->get_url(), req->get_error());
+        else {
+            console.printf("\n----- RESPONSE: %s -----\n", req->get_url());
+            dump_httpsresponse(req->get_response());
+        }
+        if (engine->outstanding() == 0)
+            queue->break_dispatch();
+    }
+};
+
+void test_async(NetworkInterface *net)
+{
+    const char post_body[] = "{\"hello\":\"world\"},"
+                             "{\"test\":\"1234\"}";
+    const char put_body[] = "This is a PUT test!";
+    HashSink hash;
+
+    EventQueue queue(16 * EVENTS_EVENT_SIZE);
+    HttpAsyncEngine engine(net, &queue);
+    AsyncTest test = { &queue, &engine };
+    Callback<void(HttpClientRequest *)> done(&test, &AsyncTest::done);
+
+    HttpClientRequest get_req(NULL, HTTP_GET, "http://httpbin.org/get");
+    HttpClientRequest post_req(NULL, HTTP_POST, "http://httpbin.org/post");
+    post_req.set_header("Content-Type", "application/json");
+    HttpClientRequest put_req(NULL, HTTP_PUT, "http://httpbin.org/put");
+    put_req.set_header("Content-Type", "application/json");
+    HttpClientRequest stream_req(NULL, HTTP_GET, "http://httpbin.org/stream/" INTSTR(STREAM_CNT), &hash);
+    HttpClientRequest status_req(NULL, HTTP_GET, "http://httpbin.org/status/418");
+
+    console.printf("\n\n >>>Async: Get, Post, Put, stream " INTSTR(STREAM_CNT) " and Status at once... \n");
+    engine.submit(&get_req, done);
+    engine.submit(&post_req, done, post_body, strlen(post_body));
+    engine.submit(&put_req, done, put_body, strlen(put_body));
+    engine.submit(&stream_req, done);
+    engine.submit(&status_req, done);
+    if (engine.outstanding())
+        queue.dispatch(2 * MBED_CONF_APP_ASYNC_TIMEOUT_MS);
+
+    if (stream_req.get_response())
+        dump_digest(&hash);
+
+    console.printf("\nAsync: %lu completed, %lu failed, %lu connects, %lu reuses, %lu at once\n",
+                   (unsigned long)engine.stats().completed, (unsigned long)engine.stats().failed,
+                   (unsigned long)engine.stats().connects, (unsigned long)engine.stats().reuses,
+                   (unsigned long)engine.stats().peak_active);
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
+// A batch of sensor readings far bigger than any buffer here, produced a
+// piece at a time for a chunked upload.
+//
+struct SensorBatch {
+    int next;
+    int count;
+    char line[48];
+    int length;             // of line
+    int offset;             // of line already produced
+
+    int produce(char *buffer, size_t size)
+    {
+        if (offset == length) {
+            if (next == count)
+                return 0;
+            length = snprintf(line, sizeof(line), "%s{\"t\":%d,\"temp\":%d.%d}%s", next ? "" : "[",
+                              next, 20 + next % 5, next % 10, next + 1 == count ? "]" : ",");
+            offset = 0;
+            next++;
+        }
+        // A reading split across two chunks is fine: chunks are just framing.
+        size_t n = (size_t)(length - offset) < size ? length - offset : size;
+        memcpy(buffer, line + offset, n);
+        offset += n;
+        return n;
+    }
+};
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
+// test the HTTPS client class
+//
+int test_https(NetworkInterface *net) 
+{
+
+    console.printf(">>>>>>>>>>>>>>>>>>>>>><<<<<<<<<<<<<<<<<<<<<<\n");
+    console.printf(">>>  TEST HTTPS - set up TLS connection  <<<\n");
+    console.printf(">>>>>>>>>>>>>>>>>>>>>><<<<<<<<<<<<<<<<<<<<<<\n\n");
+
+    TLSTransport* socket = new TLSTransport(net, "httpbin.org", 443, &tls_sessions);
+    socket->set_debug(true);
+    if (socket->connect() != 0) {
+        console.printf("TLS Connect failed %d\n", socket->error());
+        return NSAPI_ERROR_NO_CONNECTION;
+    }
+
+    pipeline_requests(socket, "HttpsRequest");
+
+    //
+    // Drop the connection and reconnect, as happens whenever the server times
+    // out an idle connection: the cached session makes it an abbreviated
+    // handshake.
+    //
+    console.printf("\n\n >>>Reconnect, resuming the TLS session...\n");
+    socket->close();
+    if (socket->connect() != 0) {
+        console.printf("TLS Connect failed %d\n", socket->error());
+        return NSAPI_ERROR_NO_CONNECTION;
+    }
+
+    console.printf("\n\n >>>HTTP:Status...\n");
+    {
+        HttpClientRequest* get_req = new HttpClientRequest(socket,HTTP_GET,"http://httpbin.org/get?show_env=1");
+        HttpClientResponse* get_res = get_req->send();
+        if (!get_res) {
+            console.printf("HttpsRequest failed (error code %d)\n", get_req->get_error());
+            return get_req->get_error();
+            }
+
+        console.printf("\n----- RESPONSE: -----\n");
+        dump_httpsresponse(get_res);
+        dump_memory(get_req);
+        dump_traffic(get_req);
+        delete get_req;
+    }
+
+    console.printf("\n\n >>>HTTP:gzip...\n");
+    {
+        HttpClientRequest* gzip_req = new HttpClientRequest(socket, HTTP_GET, "http://httpbin.org/gzip");
+        gzip_req->set_accept_encoding(&inflater);
+        HttpClientResponse* gzip_res = gzip_req->send();
+        if (!gzip_res) {
+            console.printf("HttpsRequest failed (error code %d)\n", gzip_req->get_error());
+        } else {
+            console.printf("\n----- RESPONSE: -----\n");
+            dump_httpsresponse(gzip_res);
+            console.printf("Inflated %u bytes to %u\n", (unsigned)inflater.input_length(),
+                           (unsigned)inflater.output_length());
+        }
+        delete gzip_req;
+    }
+
+    console.printf("\n\n >>>HTTP:chunked upload of 1000 sensor readings...\n");
+    {
+        SensorBatch batch = { 0, 1000, "", 0, 0 };
+        HashSink echo;
+        HttpClientRequest* upload_req = new HttpClientRequest(socket, HTTP_POST, "http://httpbin.org/post", &echo);
+        upload_req->set_header("Content-Type", "application/json");
+        HttpClientResponse* upload_res = upload_req->send_chunked(callback(&batch, &SensorBatch::produce));
+        if (!upload_res) {
+            console.printf("HttpsRequest failed (error code %d)\n", upload_req->get_error());
+        } else {
+            console.printf("Status: %d, %d readings sent, %u byte echo\n", upload_res->get_status_code(),
+                           batch.next, (unsigned)echo.length());
+            dump_memory(upload_req);
+            dump_traffic(upload_req);
+        }
+        delete upload_req;
+    }
+    delete socket;
+
+    console.printf("\nTLS handshakes: %lu full, %lu resumed, %lu failed resumptions\n",
+           (unsigned long)tls_sessions.stats().full_handshakes,
+           (unsigned long)tls_sessions.stats().resumed_handshakes,
+           (unsigned long)tls_sessions.stats().failed_resumptions);
+    return 0;
+}
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
+// Report sensor readings through a TelemetryUploader: fifty small records go
+// out in a couple of POSTs.  A RAM disk stands in for the flash a deployed
+// board would spill to while the link is down.
+//
+void test_telemetry(NetworkInterface *net)
+{
+    console.printf("\n\n >>>Telemetry: 50 readings, batched...\n");
+
+    HeapBlockDevice spill_bd(8 * 512, 512);
+    spill_bd.init();
+    SpillLog spill(&spill_bd, 0, spill_bd.size());
+    bool spilling = (spill.init() == 0);
+
+    EventQueue queue(4 * EVENTS_EVENT_SIZE);
+    TCPTransport* socket = new TCPTransport(net, "httpbin.org", 80);
+    TelemetryUploader* uploader = new TelemetryUploader(socket, "http://httpbin.org/post", &queue,
+                                                        spilling ? &spill : NULL);
+    for (int i = 0; i < 50; i++) {
+        char reading[48];
+        int length = snprintf(reading, sizeof(reading), "{\"t\":%d,\"temp\":%d.%d}", i, 20 + i % 5, i % 10);
+        uploader->add(reading, length);
+    }
+    uploader->flush();
+
+    // The uploads run right here, as the queue is dispatched.
+    for (int i = 0; i < 20 && (uploader->queued() > 0 || spill.pending() > 0); i++)
+        queue.dispatch(500);
+
+    const TelemetryUploader::Stats &stats = uploader->stats();
+    console.printf("Telemetry: %lu records in %lu uploads (%lu bytes), %lu failures, %lu spilled, %lu dropped\n",
+                   (unsigned long)stats.uploaded, (unsigned long)stats.batches, (unsigned long)stats.bytes,
+                   (unsigned long)stats.failures, (unsigned long)stats.spilled, (unsigned long)stats.dropped);
+    delete uploader;
+    delete socket;
+    spill_bd.deinit();
+}
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
+// Download a file in Range blocks to a block device, the way a firmware image
+// would come down.  The first attempt stops after one block, as if the board
+// had been reset; the second finds its progress on the device and carries on
+// from there.  A RAM disk stands in for the flash.
+//
+void test_download(NetworkInterface *net)
+{
+    console.printf("\n\n >>>Download: 3 blocks by Range, interrupted after the first...\n");
+
+    const bd_size_t image_size = 3 * MBED_CONF_APP_DOWNLOAD_BLOCK_SIZE;
+    HeapBlockDevice download_bd(image_size + 2 * 512, 512);
+    download_bd.init();
+    char url[48];
+    snprintf(url, sizeof(url), "http://httpbin.org/range/%lu", (unsigned long)image_size);
+
+    TCPTransport* socket = new TCPTransport(net, "httpbin.org", 80);
+    for (int boot = 0; boot < 2; boot++) {
+        RangeDownload* download = new RangeDownload(socket, url, &download_bd, 0, image_size,
+                                                    image_size, 2 * 512);
+        int ret = download->init();
+        if (ret == 0) {
+            ret = download->run(boot == 0 ? 1 : 0);
+        }
+        if (ret != 0) {
+            console.printf("Download failed (error code %d)\n", ret);
+        } else if (download->complete()) {
+            console.printf("Download: resumed at %lu of %lu bytes, %lu requests, SHA-256 ",
+                           (unsigned long)download->stats().resumed_at, (unsigned long)download->length(),
+                           (unsigned long)download->stats().requests);
+            for (size_t x = 0; x < 32; x++)
+                console.printf("%02x", download->digest()[x]);
+            console.printf("\n");
+        } else {
+            console.printf("Download: stopped at %lu of %lu bytes\n",
+                           (unsigned long)download->committed(), (unsigned long)download->length());
+        }
+        delete download;
+    }
+    delete socket;
+    download_bd.deinit();
+}
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
+// Fetch httpbin's /etag page twice through a response cache.  The first GET
+// stores the body; the second carries its ETag, gets a 304 and is answered
+// from flash.
+// A RAM disk stands in for the flash.
+//
+void test_cache(NetworkInterface *net)
+{
+    console.printf("\n\n >>>Cache: /etag/hello twice, the second from flash...\n");
+
+    HeapBlockDevice cache_bd(4 * MBED_CONF_APP_HTTP_CACHE_SLOT_SIZE, 512);
+    cache_bd.init();
+    HttpCache cache(&cache_bd, 0, cache_bd.size());
+    int ret = cache.init();
+    if (ret != 0) {
+        console.printf("Cache init failed (error code %d)\n", ret);
+        cache_bd.deinit();
+        return;
+    }
+    http_cache_enable(&cache);
+
+    TCPTransport* socket = new TCPTransport(net, "httpbin.org", 80);
+    for (int i = 0; i < 2; i++) {
+        HttpClientRequest* get_req = new HttpClientRequest(socket, HTTP_GET, "http://httpbin.org/etag/hello");
+        HttpClientResponse* get_res = get_req->send();
+        if (!get_res) {
+            console.printf("HttpRequest failed (error code %d)\n", get_req->get_error());
+        } else {
+            console.printf("Status %d%s, %d bytes\n", get_res->get_status_code(),
+                           get_res->is_from_cache() ? " (from cache)" : "", (int)get_res->get_body_length());
+        }
+        delete get_req;
+    }
+    delete socket;
+
+    http_cache_enable(NULL);
+    console.printf("Cache: %lu hits, %lu misses, %lu stores, %lu bytes saved\n",
+                   (unsigned long)cache.stats().hits, (unsigned long)cache.stats().misses,
+                   (unsigned long)cache.stats().stores, (unsigned long)cache.stats().bytes_saved);
+    cache_bd.deinit();
+}
@@ -0,0 +1,85 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          scenario-tls-connections.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include "mbed.h"
+#include "http-client.h"
+#include "tls-transport.h"
+#include "scenario.h"
+
+#ifndef MBED_CONF_APP_TLS_TEST_CONNECTIONS
+#define MBED_CONF_APP_TLS_TEST_CONNECTIONS  3       // TLS connections the tls-connections scenario holds at once
+#endif
+
+//
+// Opens MBED_CONF_APP_TLS_TEST_CONNECTIONS TLS connections to httpbin.org,
+// one after the other, keeps them all open, and GETs over each.  Every
+// handshake is a full one (no session cache), the worst case.  Prints what
+// each connection holds on the heap, its handshake peak and what was
+// negotiated; the benchmark CSV's stack_peak is the deepest any of it went.
+//
+SCENARIO(tls_connections, "tls-connections", "several TLS connections open at once, and what each costs")
+{
+    TLSTransport *sockets[MBED_CONF_APP_TLS_TEST_CONNECTIONS] = { NULL };
+    int result = 0;
+    int open = 0;
+
+    if (verbose) {
+        console.printf("TLS records: %u bytes in, %u out; asking for %u byte fragments; TLSTransport %u bytes\n",
+                       (unsigned)TLS_IN_RECORD_SIZE, (unsigned)TLS_OUT_RECORD_SIZE,
+                       (unsigned)MBED_CONF_APP_TLS_MAX_FRAGMENT_LENGTH, (unsigned)sizeof(TLSTransport));
+    }
+
+    for (; open < MBED_CONF_APP_TLS_TEST_CONNECTIONS; open++) {
+        sockets[open] = new TLSTransport(net, "httpbin.org", 443);
+        if (sockets[open]->connect() != 0) {
+            result = sockets[open]->error() ? sockets[open]->error() : NSAPI_ERROR_NO_CONNECTION;
+            console.printf("TLS connection %d failed %d\n", open + 1, result);
+            delete sockets[open];
+            break;
+        }
+    }
+
+    for (int ix = 0; ix < open && result == 0; ix++) {
+        HttpClientRequest *get_req = new HttpClientRequest(sockets[ix], HTTP_GET, "https://httpbin.org/get");
+        if (!get_req->send()) {
+            result = get_req->get_error();
+            console.printf("HttpRequest over connection %d failed (error code %d)\n", ix + 1, result);
+        }
+        delete get_req;
+    }
+
+    uint32_t heap_total = 0;
+    for (int ix = 0; ix < open; ix++) {
+        const TLSTransport::MemoryStats &mem = sockets[ix]->memory_stats();
+        heap_total += mem.heap_in_use;
+        if (verbose) {
+            console.printf("Connection %d: %lu bytes of heap held, %lu at the handshake's peak, %s, "
+                           "max fragment length %s\n", ix + 1, (unsigned long)mem.heap_in_use,
+                           (unsigned long)mem.heap_peak, sockets[ix]->ciphersuite() ? sockets[ix]->ciphersuite() : "-",
+                           sockets[ix]->fragment_length_agreed() ? "agreed" : "not agreed");
+        }
+        delete sockets[ix];
+    }
+    if (verbose) {
+        console.printf("%d connections open at once: %lu bytes of heap\n", open, (unsigned long)heap_total);
+    }
+    return result;
+}
@@ -0,0 +1,162 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          scenario-websocket.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include "mbed.h"
+#include "http-client.h"
+#include "websocket.h"
+#include "scenario.h"
+
+#define WEBSOCKET_TEST_READINGS     10
+
+// Counts what the echo server sends back.
+class EchoCounter : public WebSocketHandler {
+public:
+    EchoCounter() : messages(0), bytes(0), pieces(0), code(0) {}
+
+    virtual int message(WebSocketOpcode opcode, const char *data, size_t size, bool first, bool last)
+    {
+        (void)opcode; (void)data; (void)first;
+        bytes += size;
+        pieces++;
+        messages += last;
+        return 0;
+    }
+    virtual void closed(uint16_t code) { this->code = code; }
+
+    int messages;
+    size_t bytes;
+    int pieces;
+    uint16_t code;
+};
+
+// Reads until the handler has seen count messages in all.
+static int wait_for(WebSocketClient *ws, EchoCounter *echo, int count)
+{
+    while (echo->messages < count) {
+        int result = ws->receive();
+        if (result < 0 && result != NSAPI_ERROR_WOULD_BLOCK) {
+            return result;
+        }
+    }
+    return 0;
+}
+
+static void print_traffic(const char *what, const TrafficCounters &traffic, int messages)
+{
+    console.printf("%s: %lu bytes sent, %lu received, %lu/%lu on air, %lu uJ; per message %lu/%lu on air\n",
+                   what, (unsigned long)traffic.wire_sent, (unsigned long)traffic.wire_received,
+                   (unsigned long)traffic_air_sent(traffic), (unsigned long)traffic_air_received(traffic),
+                   (unsigned long)traffic_energy_uj(traffic),
+                   (unsigned long)(traffic_air_sent(traffic) / messages),
+                   (unsigned long)(traffic_air_received(traffic) / messages));
+}
+
+//
+// The same telemetry readings sent two ways: as HTTP POSTs to httpbin.org
+// over one kept-alive connection, then as WebSocket messages to the echo
+// server at echo.websocket.org, and what each cost on air.  The WebSocket
+// run also sends a text message, a message in three fragments and a ping.
+//
+SCENARIO(websocket, "websocket", "telemetry over a WebSocket, against the same as HTTP POSTs")
+{
+    const char reading[] = "{\"t\":21.5,\"rh\":40,\"v\":3.3}";
+    int result = 0;
+
+    TCPTransport http(net, "httpbin.org", 80);
+    for (int ix = 0; ix < WEBSOCKET_TEST_READINGS && result == 0; ix++) {
+        HttpClientRequest *post_req = new HttpClientRequest(&http, HTTP_POST, "http://httpbin.org/post");
+        post_req->set_header("Content-Type", "application/json");
+        if (!post_req->send(reading, sizeof(reading) - 1)) {
+            result = post_req->get_error();
+            console.printf("HttpRequest failed (error code %d)\n", result);
+        }
+        delete post_req;
+    }
+    TrafficCounters http_traffic = http.traffic();
+    http.close();
+    if (result != 0) {
+        return result;
+    }
+
+    TCPTransport socket(net, "echo.websocket.org", 80);
+    EchoCounter echo;
+    // Off the scenario thread's stack: the client carries its buffers.
+    WebSocketClient *ws = new WebSocketClient(&socket, &echo);
+    result = ws->connect("ws://echo.websocket.org/");
+    if (result != 0) {
+        console.printf("WebSocket handshake failed (error code %d)\n", result);
+        delete ws;
+        return result;
+    }
+    TrafficCounters handshake = socket.traffic();
+
+    uint32_t start = us_ticker_read();
+    for (int ix = 0; ix < WEBSOCKET_TEST_READINGS && result == 0; ix++) {
+        result = ws->send(reading, sizeof(reading) - 1);
+        if (result == 0) {
+            result = wait_for(ws, &echo, ix + 1);
+        }
+    }
+    uint32_t elapsed = us_ticker_read() - start;
+    TrafficCounters readings;
+    traffic_delta(&readings, socket.traffic(), handshake);
+
+    if (result == 0) {
+        result = ws->send_text("hello");
+    }
+    for (int ix = 0; ix < 3 && result == 0; ix++) {
+        result = ws->send_fragment(reading, sizeof(reading) - 1, ix == 2);
+    }
+    if (result == 0) {
+        result = wait_for(ws, &echo, WEBSOCKET_TEST_READINGS + 2);
+    }
+    if (result == 0) {
+        result = ws->ping();
+    }
+    while (result == 0 && ws->stats().ping_rtt_us == 0) {
+        result = ws->receive();
+        result = result == NSAPI_ERROR_WOULD_BLOCK || result > 0 ? 0 : result;
+    }
+    if (result != 0) {
+        console.printf("WebSocket failed (error code %d)\n", result);
+        delete ws;
+        return result;
+    }
+    ws->close();
+
+    if (verbose) {
+        const WebSocketClient::Stats &stats = ws->stats();
+        console.printf("WebSocket: %lu messages sent in %lu frames (%lu bytes of framing), "
+                       "%lu received in %lu frames (%lu bytes of framing)\n",
+                       (unsigned long)stats.messages_sent, (unsigned long)stats.frames_sent,
+                       (unsigned long)stats.framing_sent, (unsigned long)stats.messages_received,
+                       (unsigned long)stats.frames_received, (unsigned long)stats.framing_received);
+        console.printf("%d pieces handed over, ping %lu us, closed with %u\n",
+                       echo.pieces, (unsigned long)stats.ping_rtt_us, echo.code);
+        console.printf("%d readings echoed in %lu us, %lu us each\n", WEBSOCKET_TEST_READINGS,
+                       (unsigned long)elapsed, (unsigned long)(elapsed / WEBSOCKET_TEST_READINGS));
+        print_traffic("HTTP POST", http_traffic, WEBSOCKET_TEST_READINGS);
+        print_traffic("WebSocket handshake", handshake, 1);
+        print_traffic("WebSocket readings", readings, WEBSOCKET_TEST_READINGS);
+    }
+    delete ws;
+    return 0;
+}
@@ -0,0 +1,193 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          scenario.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <string.h>
+#include "scenario.h"
+
+#if MBED_HEAP_STATS_ENABLED
+#include "mbed_stats.h"
+#endif
+
+// Zero before any constructor runs, so registration order does not matter.
+Scenario *Scenario::_first;
+
+Scenario::Scenario(const char *name, const char *description, Function function)
+    : _name(name), _description(description), _function(function)
+{
+    Scenario **link = &_first;
+    while (*link && strcmp((*link)->_name, name) < 0) {
+        link = &(*link)->_next;
+    }
+    _next = *link;
+    *link = this;
+}
+
+const Scenario *Scenario::find(const char *name)
+{
+    for (const Scenario *s = _first; s; s = s->_next) {
+        if (strcmp(s->_name, name) == 0) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Benchmark runner
+//
+// The stack high-water mark can only be read while the thread is alive, so
+// each run measures its own on the way out.
+//
+struct ScenarioRun {
+    const Scenario *scenario;
+    NetworkInterface *net;
+    bool verbose;
+    Thread *thread;
+    int result;
+    uint32_t stack_used;
+
+    void main()
+    {
+        result = scenario->run(net, verbose);
+        stack_used = thread->max_stack();
+    }
+};
+
+// Nearest-rank percentile of sorted samples.
+static uint32_t percentile(const uint32_t *samples, int count, int p)
+{
+    int rank = (count * p + 99) / 100;
+    return samples[rank > 0 ? rank - 1 : 0];
+}
+
+void scenario_bench_header(Callback<void(const char *data, size_t size)> output)
+{
+    static const char header[] = "scenario,runs,failures,min_us,p50_us,p90_us,p99_us,max_us,runs_per_s,"
+                                 "heap_peak,heap_in_use,stack_peak,stack_size\n";
+    output(header, sizeof(header) - 1);
+}
+
+int scenario_bench(const Scenario *scenario, NetworkInterface *net, int runs, bool verbose,
+                   Callback<void(const char *data, size_t size)> output)
+{
+    static uint32_t samples[MBED_CONF_APP_BENCH_MAX_RUNS];
+    int failures = 0;
+    uint32_t stack_peak = 0;
+    Timer total;
+
+    if (runs > MBED_CONF_APP_BENCH_MAX_RUNS) {
+        runs = MBED_CONF_APP_BENCH_MAX_RUNS;
+    }
+#if MBED_HEAP_STATS_ENABLED
+    // The heap's high-water mark only ever grows, so this scenario's peak is
+    // measured from what was in use and the mark as it starts.
+    mbed_stats_heap_t heap;
+    mbed_stats_heap_get(&heap);
+    uint32_t heap_base = heap.current_size;
+    uint32_t heap_max = heap.max_size;
+#endif
+    total.start();
+    for (int ix = 0; ix < runs; ix++) {
+        Thread thread(osPriorityNormal, MBED_CONF_APP_BENCH_STACK_SIZE, NULL);
+        ScenarioRun run = { scenario, net, verbose, &thread, 0, 0 };
+
+        uint32_t start = us_ticker_read();
+        thread.start(callback(&run, &ScenarioRun::main));
+        thread.join();
+        uint32_t elapsed = us_ticker_read() - start;
+
+        if (run.result != 0) {
+            failures++;
+        }
+        if (run.stack_used > stack_peak) {
+            stack_peak = run.stack_used;
+        }
+
+        // Insertion sort as we go: a hundred samples at most.
+        int pos = ix;
+        while (pos > 0 && samples[pos - 1] > elapsed) {
+            samples[pos] = samples[pos - 1];
+            pos--;
+        }
+        samples[pos] = elapsed;
+    }
+    total.stop();
+
+    uint32_t heap_peak = 0, heap_in_use = 0;
+#if MBED_HEAP_STATS_ENABLED
+    mbed_stats_heap_get(&heap);
+    heap_in_use = heap.current_size;
+    uint32_t left = heap.current_size > heap_base ? heap.current_size - heap_base : 0;
+    heap_peak = heap.max_size > heap_max ? heap.max_size - heap_base : left;
+#endif
+
+    // Runs per second to two places, in integers.
+    uint64_t total_us = total.read_high_resolution_us();
+    uint32_t rate = total_us ? (uint32_t)(runs * 100000000ULL / total_us) : 0;
+
+    // After a verbose run the line needs its header to make sense.
+    if (verbose) {
+        scenario_bench_header(output);
+    }
+
+    char line[160];
+    int length = snprintf(line, sizeof(line), "%s,%d,%d,%lu,%lu,%lu,%lu,%lu,%lu.%02lu,%lu,%lu,%lu,%lu\n",
+                          scenario->name(), runs, failures,
+                          (unsigned long)(runs ? samples[0] : 0),
+                          (unsigned long)(runs ? percentile(samples, runs, 50) : 0),
+                          (unsigned long)(runs ? percentile(samples, runs, 90) : 0),
+                          (unsigned long)(runs ? percentile(samples, runs, 99) : 0),
+                          (unsigned long)(runs ? samples[runs - 1] : 0),
+                          (unsigned long)(rate / 100), (unsigned long)(rate % 100),
+                          (unsigned long)heap_peak, (unsigned long)heap_in_use,
+                          (unsigned long)stack_peak, (unsigned long)MBED_CONF_APP_BENCH_STACK_SIZE);
+    output(line, length);
+    return failures;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Utility functions to print out responses
+//
+void dump_response(HttpResponse* res)
+{
+    console.printf("Status: %d - %s\n", res->get_status_code(), res->get_status_message().c_str());
+
+    console.printf("Headers:\n");
+    for (size_t ix = 0; ix < res->get_headers_length(); ix++) {
+        console.printf("\t%s: %s\n", res->get_headers_fields()[ix]->c_str(), res->get_headers_values()[ix]->c_str());
+    }
+    console.printf("\nBody (%u bytes):\n\n", (unsigned)res->get_body_length());
+    console.write_all(res->get_body(), res->get_body_length());
+    console.write_all("\n", 1);
+}
+
+void dump_httpsresponse(HttpClientResponse* res)
+{
+    console.printf("Status: %d - %s\n", res->get_status_code(), res->get_status_message());
+
+    console.printf("Headers:\n");
+    for (size_t ix = 0; ix < res->get_headers_length(); ix++) {
+        console.printf("\t%s: %s\n", res->get_header_field(ix), res->get_header_value(ix));
+    }
+    console.printf("\nBody (%u bytes):\n\n", (unsigned)res->get_body_length());
+    console.write_all(res->get_body(), strlen(res->get_body()));
+    console.write_all("\n", 1);
+}
@@ -0,0 +1,89 @@
+#ifndef _SCENARIO_H_
+#define _SCENARIO_H_
+
+#include "mbed.h"
+#include "log-ring.h"
+#include "http_request.h"
+#include "http-client.h"
+
+#ifndef MBED_CONF_APP_BENCH_SCENARIO
+#define MBED_CONF_APP_BENCH_SCENARIO    "httpx"     // a scenario name, or "all"
+#endif
+
+#ifndef MBED_CONF_APP_BENCH_RUNS
+#define MBED_CONF_APP_BENCH_RUNS        1           // 1 runs the demo once, printing everything
+#endif
+
+#ifndef MBED_CONF_APP_BENCH_MAX_RUNS
+#define MBED_CONF_APP_BENCH_MAX_RUNS    100         // latency samples kept per scenario
+#endif
+
+#ifndef MBED_CONF_APP_BENCH_STACK_SIZE
+#define MBED_CONF_APP_BENCH_STACK_SIZE  (4*1024)    // of the thread each run gets
+#endif
+
+//
+// One demo flow (plain HTTP, socket reuse, HTTPS...) that the benchmark
+// runner can execute any number of times in the same binary.  A scenario is
+// defined with the SCENARIO() macro, which also registers it, and returns 0
+// on success or the error that stopped it.  verbose is false during timed
+// runs, where the responses are not worth printing.
+//
+//   SCENARIO(http, "http", "GET and POST with mbed-http")
+//   {
+//       ...
+//   }
+//
+class Scenario {
+public:
+    typedef int (*Function)(NetworkInterface *net, bool verbose);
+
+    Scenario(const char *name, const char *description, Function function);
+
+    const char *name() const { return _name; }
+    const char *description() const { return _description; }
+    int run(NetworkInterface *net, bool verbose) const { return _function(net, verbose); }
+
+    // Registered scenarios in order of name.
+    static const Scenario *first() { return _first; }
+    const Scenario *next() const { return _next; }
+    static const Scenario *find(const char *name);
+
+private:
+    const char *_name;
+    const char *_description;
+    Function _function;
+    Scenario *_next;
+
+    static Scenario *_first;
+};
+
+#define SCENARIO(id, name, description) \
+    static int id(NetworkInterface *net, bool verbose); \
+    static Scenario id##_scenario(name, description, id); \
+    static int id(NetworkInterface *net, bool verbose)
+
+//
+// Runs scenario runs times, each in a new thread of
+// MBED_CONF_APP_BENCH_STACK_SIZE, and writes one CSV line: the run time
+// percentiles, runs per second, the heap peak and bytes still allocated
+// afterwards (MBED_HEAP_STATS_ENABLED), and the deepest stack any run used
+// (MBED_STACK_STATS_ENABLED).  The heap peak is the most the runs held over
+// what was in use when they began, when they raised the heap's high-water
+// mark; otherwise only what they left allocated, a lower bound.
+// verbose is passed on to the scenario, and also puts the CSV header in
+// front of the line, as the scenario's own output comes between them.
+// Returns the number of failed runs.
+//
+void scenario_bench_header(Callback<void(const char *data, size_t size)> output);
+int scenario_bench(const Scenario *scenario, NetworkInterface *net, int runs, bool verbose,
+                   Callback<void(const char *data, size_t size)> output);
+
+// Everything the scenarios print goes through this ring (main.cpp).
+extern LogRing console;
+
+// Prints a response: status, headers and body.
+void dump_response(HttpResponse* res);
+void dump_httpsresponse(HttpClientResponse* res);
+
+#endif // _SCENARIO_H_
@@ -1,11 +0,0 @@
-#ifndef _SELECT_METHOD_H_
-#define _SELECT_METHOD_H_
-
-#define         DEMO_HTTP                   1
-#define         DEMO_HTTP_SOCKET_REUSE      2
-#define         DEMO_HTTPS                  3
-#define         DEMO_HTTPS_SOCKET_REUSE     4
-#define         DEMO_HTTPx                  5
-
-#define         DEMO            DEMO_HTTPx
-#endif // _SELECT_METHOD_H_
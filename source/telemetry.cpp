@@ -0,0 +1,713 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          telemetry.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <string.h>
+#include "telemetry.h"
+#include "binary-util.h"
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// SpillLog
+//
+// Each erase block begins with SPILL_HEADER bytes (magic, block sequence),
+// followed by records: a 16-bit little-endian length and the text.  A length
+// word never straddles a page and a record never straddles a block; at a
+// record boundary a length of 0 means "carry on at the next page" (the rest
+// of a page padded out by sync()) and 0xFFFE or erased flash means "carry on
+// at the next block".
+//
+#define SPILL_MAGIC         0x31474c54  // "TLG1"
+#define SPILL_HEADER        8
+#define SPILL_NEXT_PAGE     0x0000
+#define SPILL_NEXT_BLOCK    0xFFFE
+#define SPILL_ERASED        0xFFFF
+#define SPILL_MIN_PAGE      32          // staging unit on byte-programmable flash
+#define SPILL_NO_PAGE       0xFFFFFFFF
+
+SpillLog::SpillLog(BlockDevice *bd, bd_addr_t start, bd_size_t size)
+    : _bd(bd), _start(start), _size(size), _erase_size(0), _page_size(0),
+      _staging(NULL), _read_page(NULL), _read_index(SPILL_NO_PAGE),
+      _tail(0), _head(0), _cursor(0), _sequence(1), _pending(0), _read(0)
+{
+}
+
+SpillLog::~SpillLog()
+{
+    delete[] _staging;
+    delete[] _read_page;
+}
+
+int SpillLog::init()
+{
+    uint32_t program_size = _bd->get_program_size();
+    _erase_size = _bd->get_erase_size();
+    _page_size = (SPILL_MIN_PAGE + program_size - 1) / program_size * program_size;
+    if (_erase_size % _page_size != 0) {
+        _page_size = program_size;
+    }
+    _size -= _size % _erase_size;
+    if (_size < 2 * _erase_size || _page_size < SPILL_HEADER + 2) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    delete[] _staging;
+    delete[] _read_page;
+    _staging = new uint8_t[_page_size];
+    _read_page = new uint8_t[_page_size];
+    _read_index = SPILL_NO_PAGE;
+    return scan();
+}
+
+uint32_t SpillLog::next_page(uint32_t offset) const
+{
+    return (offset - offset % _page_size + _page_size) % _size;
+}
+
+uint32_t SpillLog::next_block(uint32_t offset) const
+{
+    return (offset - offset % _erase_size + _erase_size) % _size;
+}
+
+// The page holding offset: still in RAM if it is the one being filled.
+const uint8_t *SpillLog::page_at(uint32_t offset, int *error)
+{
+    uint32_t index = offset / _page_size;
+    if (index == _tail / _page_size && _tail % _page_size != 0) {
+        return _staging;
+    }
+    if (index != _read_index) {
+        *error = _bd->read(_read_page, _start + (bd_addr_t)index * _page_size, _page_size);
+        if (*error != 0) {
+            _read_index = SPILL_NO_PAGE;
+            return NULL;
+        }
+        _read_index = index;
+    }
+    return _read_page;
+}
+
+int SpillLog::fetch(uint32_t offset, void *data, size_t size)
+{
+    uint8_t *p = static_cast<uint8_t *>(data);
+    int error = 0;
+
+    while (size > 0) {
+        const uint8_t *page = page_at(offset, &error);
+        if (!page) {
+            return error;
+        }
+        size_t n = _page_size - offset % _page_size;
+        if (n > size) {
+            n = size;
+        }
+        memcpy(p, page + offset % _page_size, n);
+        p += n;
+        offset += n;
+        size -= n;
+    }
+    return 0;
+}
+
+// Copies data in at _tail, programming each page as it fills.
+int SpillLog::put(const void *data, size_t size)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+
+    while (size > 0) {
+        uint32_t offset = _tail % _page_size;
+        size_t n = _page_size - offset;
+        if (n > size) {
+            n = size;
+        }
+        memcpy(_staging + offset, p, n);
+        if (offset + n == _page_size) {
+            uint32_t page = _tail - offset;
+            int ret = _bd->program(_staging, _start + page, _page_size);
+            if (ret != 0) {
+                return ret;
+            }
+            if (page / _page_size == _read_index) {
+                _read_index = SPILL_NO_PAGE;
+            }
+            _tail = next_page(page);
+        } else {
+            _tail += n;
+        }
+        p += n;
+        size -= n;
+    }
+    return 0;
+}
+
+// Zero-fills the rest of the page being staged and programs it.
+int SpillLog::pad()
+{
+    uint32_t offset = _tail % _page_size;
+    if (offset == 0) {
+        return 0;
+    }
+    memset(_staging + offset, 0, _page_size - offset);
+    int ret = _bd->program(_staging, _start + _tail - offset, _page_size);
+    if (ret != 0) {
+        return ret;
+    }
+    if (_tail / _page_size == _read_index) {
+        _read_index = SPILL_NO_PAGE;
+    }
+    _tail = next_page(_tail);
+    return 0;
+}
+
+// Erases the block at _tail and writes its header.
+int SpillLog::start_block()
+{
+    if (_pending > 0 && _head - _head % _erase_size == _tail) {
+        return NSAPI_ERROR_NO_MEMORY;     // would overwrite the oldest records
+    }
+    int ret = _bd->erase(_start + _tail, _erase_size);
+    if (ret != 0) {
+        return ret;
+    }
+    _read_index = SPILL_NO_PAGE;
+
+    uint8_t header[SPILL_HEADER];
+    put_le32(header, SPILL_MAGIC);
+    put_le32(header + 4, _sequence++);
+    ret = put(header, sizeof(header));
+    if (ret == 0 && _pending == 0) {
+        // Past the header, so a full log (_tail back at the head's block)
+        // is never mistaken for an empty one.
+        _head = _cursor = _tail;
+    }
+    return ret;
+}
+
+int SpillLog::append(const char *record, size_t length)
+{
+    if (length == 0 || length >= SPILL_NEXT_BLOCK || SPILL_HEADER + 2 + length > _erase_size || !_staging) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    _mutex.lock();
+    int ret = 0;
+    if (_tail % _erase_size != 0 && _page_size - _tail % _page_size < 2) {
+        ret = pad();
+    }
+    if (ret == 0 && _tail % _erase_size != 0 && _erase_size - _tail % _erase_size < 2 + length) {
+        // Close the block; the record starts the next one.
+        uint32_t next = next_block(_tail);
+        uint8_t word[2] = { SPILL_NEXT_BLOCK & 0xFF, SPILL_NEXT_BLOCK >> 8 };
+        ret = put(word, sizeof(word));
+        if (ret == 0) {
+            ret = pad();
+        }
+        if (ret == 0) {
+            _tail = next;
+        }
+    }
+    if (ret == 0 && _tail % _erase_size == 0) {
+        ret = start_block();
+    }
+    if (ret == 0) {
+        uint8_t word[2] = { (uint8_t)length, (uint8_t)(length >> 8) };
+        ret = put(word, sizeof(word));
+    }
+    if (ret == 0) {
+        ret = put(record, length);
+    }
+    if (ret == 0) {
+        _pending++;
+    }
+    _mutex.unlock();
+    return ret;
+}
+
+int SpillLog::sync()
+{
+    _mutex.lock();
+    int ret = _staging ? pad() : 0;
+    _mutex.unlock();
+    return ret;
+}
+
+int SpillLog::read(char *buffer, size_t size)
+{
+    _mutex.lock();
+    int ret = 0;
+    while (_cursor != _tail) {
+        if (_cursor % _erase_size == 0) {
+            _cursor += SPILL_HEADER;
+            continue;
+        }
+        if (_page_size - _cursor % _page_size < 2) {
+            _cursor = next_page(_cursor);
+            continue;
+        }
+        uint8_t word[2];
+        ret = fetch(_cursor, word, sizeof(word));
+        if (ret != 0) {
+            break;
+        }
+        uint16_t length = word[0] | word[1] << 8;
+        if (length == SPILL_NEXT_PAGE) {
+            _cursor = next_page(_cursor);
+        } else if (length == SPILL_NEXT_BLOCK || length == SPILL_ERASED) {
+            _cursor = next_block(_cursor);
+        } else if (length > size) {
+            ret = NSAPI_ERROR_NO_MEMORY;
+            break;
+        } else {
+            ret = fetch(_cursor + 2, buffer, length);
+            if (ret == 0) {
+                _cursor = (_cursor + 2 + length) % _size;
+                _read++;
+                ret = length;
+            }
+            break;
+        }
+    }
+    _mutex.unlock();
+    return ret;
+}
+
+//
+// Forgets the records read since the last commit or rewind.  Blocks the
+// cursor has left are erased; once everything has been delivered the block
+// being written goes too, so a restart finds nothing to send twice.
+//
+int SpillLog::commit()
+{
+    _mutex.lock();
+    int ret = 0;
+    if (_read > 0) {
+        uint32_t block = _head - _head % _erase_size;
+        if (_cursor == _tail) {
+            uint32_t end = _tail % _erase_size == 0 ? _tail : next_block(_tail);
+            do {
+                ret = _bd->erase(_start + block, _erase_size);
+                block = next_block(block);
+            } while (ret == 0 && block != end);
+            _tail -= _tail % _erase_size;
+            _cursor = _tail;
+        } else {
+            uint32_t end = _cursor - _cursor % _erase_size;
+            while (ret == 0 && block != end) {
+                ret = _bd->erase(_start + block, _erase_size);
+                block = next_block(block);
+            }
+        }
+        _read_index = SPILL_NO_PAGE;
+        _head = _cursor;
+        _pending -= _read;
+        _read = 0;
+    }
+    _mutex.unlock();
+    return ret;
+}
+
+void SpillLog::rewind()
+{
+    _mutex.lock();
+    _cursor = _head;
+    _read = 0;
+    _mutex.unlock();
+}
+
+//
+// Finds the oldest and newest blocks by their sequence numbers, then walks
+// the records between them to count them and find where the newest ends.  A
+// partly programmed page cannot be topped up, so writing then resumes at the
+// next block unless the end falls on a page boundary.
+//
+int SpillLog::scan()
+{
+    uint32_t blocks = _size / _erase_size;
+    uint32_t first = 0, last = 0;
+    uint32_t first_sequence = 0, last_sequence = 0;
+    bool found = false;
+    int ret;
+
+    _tail = _size;      // no page is staged yet
+    for (uint32_t b = 0; b < blocks; b++) {
+        uint8_t header[SPILL_HEADER];
+        ret = fetch(b * _erase_size, header, sizeof(header));
+        if (ret != 0) {
+            return ret;
+        }
+        if (get_le32(header) != SPILL_MAGIC) {
+            continue;
+        }
+        uint32_t sequence = get_le32(header + 4);
+        if (!found || (int32_t)(sequence - first_sequence) < 0) {
+            first = b;
+            first_sequence = sequence;
+        }
+        if (!found || (int32_t)(sequence - last_sequence) > 0) {
+            last = b;
+            last_sequence = sequence;
+        }
+        found = true;
+    }
+
+    _pending = 0;
+    _read = 0;
+    if (!found) {
+        _head = _cursor = _tail = 0;
+        _sequence = 1;
+        return 0;
+    }
+    _sequence = last_sequence + 1;
+    _head = _cursor = first * _erase_size + SPILL_HEADER;
+
+    uint32_t offset = _head;
+    uint32_t end = next_block(last * _erase_size);
+    while (offset != end) {
+        bool newest = offset / _erase_size == last;
+        if (offset % _erase_size == 0) {
+            uint8_t header[SPILL_HEADER];
+            ret = fetch(offset, header, sizeof(header));
+            if (ret != 0) {
+                return ret;
+            }
+            offset = get_le32(header) == SPILL_MAGIC ? offset + SPILL_HEADER : next_block(offset);
+            continue;
+        }
+        if (_page_size - offset % _page_size < 2) {
+            offset = next_page(offset);
+            continue;
+        }
+        uint8_t word[2];
+        ret = fetch(offset, word, sizeof(word));
+        if (ret != 0) {
+            return ret;
+        }
+        uint16_t length = word[0] | word[1] << 8;
+        if (length == SPILL_NEXT_PAGE) {
+            offset = next_page(offset);
+        } else if (length == SPILL_ERASED && newest) {
+            break;      // the end of what was written
+        } else if (length == SPILL_NEXT_BLOCK || length == SPILL_ERASED ||
+                   2u + length > _erase_size - offset % _erase_size) {
+            offset = next_block(offset);
+        } else {
+            offset = (offset + 2 + length) % _size;
+            _pending++;
+        }
+    }
+    _tail = offset % _page_size == 0 ? offset : next_block(offset);
+    if (_pending == 0) {
+        _head = _cursor = _tail;
+    }
+    _read_index = SPILL_NO_PAGE;
+    return 0;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// TelemetryUploader
+//
+TelemetryUploader::TelemetryUploader(HttpTransport *transport, const char *url, EventQueue *queue,
+                                     SpillLog *spill)
+    : _transport(transport), _url(url), _queue(queue), _spill(spill),
+      _ring_head(0), _ring_used(0), _ring_count(0),
+      _event(0), _event_due(0), _link_down(false), _sending(false),
+      _source(FROM_QUEUE), _batch_records(0), _batch_limit(0), _batch_bytes(0), _batch_offset(0),
+      _batch_closed(false), _record_length(0), _record_offset(0)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+TelemetryUploader::~TelemetryUploader()
+{
+    _mutex.lock();
+    if (_event) {
+        _queue->cancel(_event);
+    }
+    _mutex.unlock();
+}
+
+bool TelemetryUploader::add(const char *record, size_t length)
+{
+    _mutex.lock();
+    if (length == 0 || length > MBED_CONF_APP_TELEMETRY_RECORD_MAX) {
+        _stats.dropped++;
+        _mutex.unlock();
+        return false;
+    }
+    bool fits = _ring_used + 2 + length <= sizeof(_ring);
+    if (!fits && _spill && !_sending) {
+        // Older records go to flash first, so the log keeps them in order.
+        spill_queued(_ring_count);
+        fits = true;
+    }
+    if (!fits) {
+        // No spill log, or a batch is being read from the ring: the record
+        // cannot go to flash ahead of older ones, which may still follow it
+        // there if the upload fails.
+        _stats.dropped++;
+        _mutex.unlock();
+        return false;
+    }
+    uint8_t word[2] = { (uint8_t)length, (uint8_t)(length >> 8) };
+    ring_write(word, sizeof(word));
+    ring_write(record, length);
+    _ring_count++;
+    _stats.records++;
+
+    if (_link_down) {
+        schedule(MBED_CONF_APP_TELEMETRY_RETRY_MS);
+    } else if (_ring_used >= MBED_CONF_APP_TELEMETRY_BATCH_BYTES) {
+        schedule(0);
+    } else {
+        schedule(MBED_CONF_APP_TELEMETRY_WINDOW_MS);
+    }
+    _mutex.unlock();
+    return true;
+}
+
+void TelemetryUploader::flush()
+{
+    _mutex.lock();
+    schedule(0);
+    _mutex.unlock();
+}
+
+// Posts upload() to run after delay_ms, unless it is already due sooner.
+void TelemetryUploader::schedule(int delay_ms)
+{
+    uint32_t due = osKernelGetTickCount() + delay_ms;
+    if (_event) {
+        if ((int32_t)(due - _event_due) >= 0) {
+            return;
+        }
+        _queue->cancel(_event);
+    }
+    _event = _queue->call_in(delay_ms, this, &TelemetryUploader::upload);
+    _event_due = due;
+}
+
+//
+// Runs on the event queue: sends one batch, spilled records first, and
+// posts itself again if there is more.  While the link is down it only runs
+// every MBED_CONF_APP_TELEMETRY_RETRY_MS.
+//
+void TelemetryUploader::upload()
+{
+    _mutex.lock();
+    _event = 0;
+    bool spilled = _spill && _spill->pending() > 0;
+    bool queued = _ring_count > 0;
+    _mutex.unlock();
+    if (!spilled && !queued) {
+        return;
+    }
+
+    bool delivered = send_batch(spilled ? FROM_SPILL : FROM_QUEUE);
+
+    _mutex.lock();
+    _link_down = !delivered;
+    if (!delivered) {
+        schedule(MBED_CONF_APP_TELEMETRY_RETRY_MS);
+    } else if ((_spill && _spill->pending() > 0) || _ring_used >= MBED_CONF_APP_TELEMETRY_BATCH_BYTES) {
+        schedule(0);
+    } else if (_ring_count > 0) {
+        // Records that waited out a drain have waited long enough.
+        schedule(spilled ? 0 : MBED_CONF_APP_TELEMETRY_WINDOW_MS);
+    }
+    _mutex.unlock();
+}
+
+//
+// POSTs one batch from source.  True when it is done with: delivered, or
+// refused by the server for good.  After a failure the RAM queue moves to
+// the spill log, if there is one, so it has room while the link is down.
+//
+bool TelemetryUploader::send_batch(Source source)
+{
+    _mutex.lock();
+    _source = source;
+    _batch_records = 0;
+    _batch_limit = source == FROM_QUEUE ? _ring_count : MBED_CONF_APP_TELEMETRY_DRAIN_BYTES;
+    _batch_bytes = 0;
+    _batch_offset = 0;
+    _batch_closed = false;
+    _record_length = 0;
+    _record_offset = 0;
+    _sending = (source == FROM_QUEUE);
+    _mutex.unlock();
+    if (source == FROM_SPILL) {
+        _spill->rewind();
+    }
+
+    int status = 0;
+    HttpClientRequest *request = new HttpClientRequest(_transport, HTTP_POST, _url, &_discard);
+    if (request) {
+        request->set_header("Content-Type", "application/json");
+        HttpClientResponse *response = request->send_chunked(callback(this, &TelemetryUploader::produce));
+        if (response) {
+            status = response->get_status_code();
+        }
+        delete request;
+    }
+
+    _mutex.lock();
+    _sending = false;
+    bool delivered = status >= 200 && status < 300;
+    bool refused = status >= 400 && status < 500 && status != 408 && status != 429;
+    if (delivered) {
+        _stats.batches++;
+        _stats.uploaded += _batch_records;
+        _stats.bytes += _batch_bytes;
+    } else if (refused) {
+        _stats.rejected += _batch_records;
+    } else {
+        _stats.failures++;
+    }
+    if (delivered || refused) {
+        if (source == FROM_QUEUE) {
+            ring_drop(_batch_records);
+        } else {
+            _spill->commit();
+        }
+    } else if (source == FROM_SPILL) {
+        _spill->rewind();
+    } else if (_spill) {
+        spill_queued(_ring_count);
+    }
+    _mutex.unlock();
+    return delivered || refused;
+}
+
+//
+// send_chunked() producer: the batch as a JSON array, "[" and the first
+// record, "," and each further record, then "]".
+//
+int TelemetryUploader::produce(char *buffer, size_t size)
+{
+    size_t length = 0;
+    while (length < size) {
+        if (_record_offset == _record_length && !next_record()) {
+            break;
+        }
+        size_t n = _record_length - _record_offset;
+        if (n > size - length) {
+            n = size - length;
+        }
+        memcpy(buffer + length, _record + _record_offset, n);
+        _record_offset += n;
+        _batch_bytes += n;
+        length += n;
+    }
+    return length;
+}
+
+bool TelemetryUploader::next_record()
+{
+    if (_batch_closed) {
+        return false;
+    }
+
+    int length = 0;
+    if (_source == FROM_QUEUE) {
+        _mutex.lock();
+        if (_batch_records < _batch_limit) {
+            uint8_t word[2];
+            ring_copy(_batch_offset, word, sizeof(word));
+            length = word[0] | word[1] << 8;
+            ring_copy(_batch_offset + 2, _record + 1, length);
+            _batch_offset += 2 + length;
+        }
+        _mutex.unlock();
+    } else if (_batch_bytes < _batch_limit) {
+        length = _spill->read(_record + 1, MBED_CONF_APP_TELEMETRY_RECORD_MAX);
+        if (length < 0) {
+            length = 0;     // unreadable: send what we have
+        }
+    }
+
+    if (length > 0) {
+        _record[0] = _batch_records ? ',' : '[';
+        _record_length = length + 1;
+        _batch_records++;
+    } else {
+        _record_length = 0;
+        if (_batch_records == 0) {
+            _record[_record_length++] = '[';
+        }
+        _record[_record_length++] = ']';
+        _batch_closed = true;
+    }
+    _record_offset = 0;
+    return true;
+}
+
+void TelemetryUploader::ring_write(const void *data, size_t size)
+{
+    const char *p = static_cast<const char *>(data);
+    size_t pos = (_ring_head + _ring_used) % sizeof(_ring);
+    for (size_t i = 0; i < size; i++) {
+        _ring[pos] = p[i];
+        pos = pos + 1 == sizeof(_ring) ? 0 : pos + 1;
+    }
+    _ring_used += size;
+}
+
+// Copies from offset bytes past the oldest record.
+void TelemetryUploader::ring_copy(size_t offset, void *data, size_t size)
+{
+    char *p = static_cast<char *>(data);
+    size_t pos = (_ring_head + offset) % sizeof(_ring);
+    size_t first = sizeof(_ring) - pos;
+    if (first > size) {
+        first = size;
+    }
+    memcpy(p, _ring + pos, first);
+    memcpy(p + first, _ring, size - first);
+}
+
+void TelemetryUploader::ring_drop(size_t records)
+{
+    while (records-- > 0 && _ring_count > 0) {
+        uint8_t word[2];
+        ring_copy(0, word, sizeof(word));
+        size_t size = 2 + (word[0] | word[1] << 8);
+        _ring_head = (_ring_head + size) % sizeof(_ring);
+        _ring_used -= size;
+        _ring_count--;
+    }
+}
+
+// Moves the oldest records to the spill log; those it cannot take are lost.
+void TelemetryUploader::spill_queued(size_t records)
+{
+    char record[MBED_CONF_APP_TELEMETRY_RECORD_MAX];
+
+    while (records-- > 0 && _ring_count > 0) {
+        uint8_t word[2];
+        ring_copy(0, word, sizeof(word));
+        size_t length = word[0] | word[1] << 8;
+        ring_copy(2, record, length);
+        if (_spill->append(record, length) == 0) {
+            _stats.spilled++;
+        } else {
+            _stats.dropped++;
+        }
+        ring_drop(1);
+    }
+}
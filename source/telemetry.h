@@ -0,0 +1,194 @@
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include "mbed.h"
+#include "mbed_events.h"
+#include "BlockDevice.h"
+#include "http-client.h"
+
+#ifndef MBED_CONF_APP_TELEMETRY_QUEUE_SIZE
+#define MBED_CONF_APP_TELEMETRY_QUEUE_SIZE      2048    // bytes of records held in RAM
+#endif
+
+#ifndef MBED_CONF_APP_TELEMETRY_BATCH_BYTES
+#define MBED_CONF_APP_TELEMETRY_BATCH_BYTES     1024    // upload as soon as this much is queued
+#endif
+
+#ifndef MBED_CONF_APP_TELEMETRY_WINDOW_MS
+#define MBED_CONF_APP_TELEMETRY_WINDOW_MS       10000   // ... or this long after the first record
+#endif
+
+#ifndef MBED_CONF_APP_TELEMETRY_RETRY_MS
+#define MBED_CONF_APP_TELEMETRY_RETRY_MS        30000   // between attempts while the link is down
+#endif
+
+#ifndef MBED_CONF_APP_TELEMETRY_DRAIN_BYTES
+#define MBED_CONF_APP_TELEMETRY_DRAIN_BYTES     8192    // most spilled bytes per upload
+#endif
+
+#ifndef MBED_CONF_APP_TELEMETRY_RECORD_MAX
+#define MBED_CONF_APP_TELEMETRY_RECORD_MAX      256     // longest record accepted
+#endif
+
+//
+// Append-only log of records in a BlockDevice region, used as overflow for
+// telemetry the link cannot take right now.  Each erase block starts with a
+// header carrying a sequence number, so init() finds the records a previous
+// run left behind; erased blocks must read back as 0xFF for that.  Records
+// are staged a page at a time in RAM and programmed when a page fills or on
+// sync().
+//
+// Reading goes through a cursor: read() walks forward from the oldest
+// record, commit() forgets everything before the cursor (erasing the blocks
+// it leaves behind) and rewind() puts the cursor back, so records are only
+// dropped once they have been delivered.  A block in which only some records
+// were delivered is read again after a restart.  When the region is full
+// append() refuses new records rather than overwrite unsent ones.
+//
+class SpillLog {
+public:
+    SpillLog(BlockDevice *bd, bd_addr_t start, bd_size_t size);
+    ~SpillLog();
+
+    // Recovers the records of a previous run; bd must be initialised.
+    int init();
+
+    // 0, or NSAPI_ERROR_NO_MEMORY when the log is full.
+    int append(const char *record, size_t length);
+    int sync();
+
+    // Copies the next record to buffer and returns its length, or 0 when
+    // the cursor reached the end.
+    int read(char *buffer, size_t size);
+    int commit();
+    void rewind();
+
+    uint32_t pending() const { return _pending; }
+
+private:
+    uint32_t next_page(uint32_t offset) const;
+    uint32_t next_block(uint32_t offset) const;
+    int put(const void *data, size_t size);
+    int pad();
+    int start_block();
+    int fetch(uint32_t offset, void *data, size_t size);
+    const uint8_t *page_at(uint32_t offset, int *error);
+    int scan();
+
+    BlockDevice *_bd;
+    bd_addr_t _start;
+    uint32_t _size;
+    uint32_t _erase_size;
+    uint32_t _page_size;
+    uint8_t *_staging;          // the page at _tail, not yet programmed
+    uint8_t *_read_page;        // last page read back, at _read_index
+    uint32_t _read_index;
+    uint32_t _tail;             // region offset of the next byte written
+    uint32_t _head;             // oldest record not yet committed
+    uint32_t _cursor;
+    uint32_t _sequence;         // of the next block started
+    uint32_t _pending;          // records between _head and _tail
+    uint32_t _read;             // records between _head and _cursor
+    Mutex _mutex;
+};
+
+//
+// Collects small JSON records (one sensor reading, one event) and uploads
+// them together as a JSON array in one POST, so a day's worth of telemetry
+// costs a handful of requests instead of one full HTTP exchange each.
+//
+// Records wait in a fixed RAM queue until MBED_CONF_APP_TELEMETRY_BATCH_BYTES
+// have collected or MBED_CONF_APP_TELEMETRY_WINDOW_MS have passed since the
+// first one, then go out on the EventQueue's thread, streamed straight from
+// the queue with send_chunked().  When an upload fails the link is taken to
+// be down: the batch moves to the SpillLog (if one was given), and so does
+// anything that no longer fits in RAM, until a retry gets through.  The spill
+// is then drained oldest first, at most MBED_CONF_APP_TELEMETRY_DRAIN_BYTES
+// per request and one request per event, so draining never holds up the
+// queue or outruns the link.  Records that do not fit are dropped when there
+// is no spill log, or while a batch is being streamed from the RAM queue:
+// spilled then, they would land in the log ahead of that batch.
+//
+// A batch the server refuses with a 4xx status is dropped rather than
+// retried forever.  add() may be called from any thread; transport and url
+// must outlive the uploader.
+//
+class TelemetryUploader {
+public:
+    struct Stats {
+        uint32_t records;       // accepted by add()
+        uint32_t dropped;       // refused: RAM full and no room in the spill log, or a batch in flight
+        uint32_t batches;       // successful uploads
+        uint32_t uploaded;      // records they carried
+        uint32_t bytes;         // body bytes they carried
+        uint32_t failures;      // uploads that failed
+        uint32_t spilled;       // records written to the spill log
+        uint32_t rejected;      // records in batches the server refused
+    };
+
+    TelemetryUploader(HttpTransport *transport, const char *url, EventQueue *queue,
+                      SpillLog *spill = NULL);
+    ~TelemetryUploader();
+
+    bool add(const char *record, size_t length);
+    bool add(const char *record) { return add(record, strlen(record)); }
+
+    // Uploads whatever is queued without waiting for the window.
+    void flush();
+
+    bool link_up() const { return !_link_down; }
+    size_t queued() const { return _ring_used; }
+    const Stats &stats() const { return _stats; }
+
+private:
+    enum Source { FROM_QUEUE, FROM_SPILL };
+
+    // Throws the response away; only the status matters.
+    class Discard : public HttpBodySink {
+    public:
+        virtual int write(const void *data, size_t size) { (void)data; return size; }
+    };
+
+    void schedule(int delay_ms);
+    void upload();
+    bool send_batch(Source source);
+    int produce(char *buffer, size_t size);
+    bool next_record();
+    void ring_write(const void *data, size_t size);
+    void ring_copy(size_t offset, void *data, size_t size);
+    void ring_drop(size_t records);
+    void spill_queued(size_t records);
+
+    HttpTransport *_transport;
+    const char *_url;
+    EventQueue *_queue;
+    SpillLog *_spill;
+    Discard _discard;
+
+    // Records in RAM, each a 16-bit length and the text, wrapping around.
+    char _ring[MBED_CONF_APP_TELEMETRY_QUEUE_SIZE];
+    size_t _ring_head;
+    size_t _ring_used;
+    size_t _ring_count;
+
+    int _event;                 // pending upload(), or 0
+    uint32_t _event_due;
+    bool _link_down;
+    bool _sending;              // a batch is being read from the ring
+
+    // The batch being sent.
+    Source _source;
+    size_t _batch_records;      // taken so far
+    size_t _batch_limit;        // records (queue) or bytes (spill) to take
+    size_t _batch_bytes;        // body produced so far
+    size_t _batch_offset;       // ring offset of the next record
+    bool _batch_closed;
+    char _record[MBED_CONF_APP_TELEMETRY_RECORD_MAX + 2];
+    size_t _record_length;
+    size_t _record_offset;
+
+    Stats _stats;
+    Mutex _mutex;
+};
+
+#endif // _TELEMETRY_H_
@@ -0,0 +1,102 @@
+#include "tls-session-cache.h"
+
+TLSSessionCache::TLSSessionCache()
+{
+    memset(&_stats, 0, sizeof(_stats));
+    for (int i = 0; i < MBED_CONF_APP_TLS_SESSION_CACHE_SIZE; i++) {
+        _entries[i].valid = false;
+        mbedtls_ssl_session_init(&_entries[i].session);
+    }
+}
+
+TLSSessionCache::~TLSSessionCache()
+{
+    for (int i = 0; i < MBED_CONF_APP_TLS_SESSION_CACHE_SIZE; i++) {
+        mbedtls_ssl_session_free(&_entries[i].session);
+    }
+}
+
+TLSSessionCache::Entry *TLSSessionCache::find(const char *host, uint16_t port)
+{
+    for (int i = 0; i < MBED_CONF_APP_TLS_SESSION_CACHE_SIZE; i++) {
+        Entry &entry = _entries[i];
+        if (entry.valid && entry.port == port && strcmp(entry.host, host) == 0) {
+            return &entry;
+        }
+    }
+    return NULL;
+}
+
+bool TLSSessionCache::resume(const char *host, uint16_t port, mbedtls_ssl_context *ssl)
+{
+    bool offered = false;
+
+    _mutex.lock();
+    Entry *entry = find(host, port);
+    // mbedtls_ssl_set_session() takes a deep copy, so the entry stays ours.
+    if (entry && mbedtls_ssl_set_session(ssl, &entry->session) == 0) {
+        entry->last_used = osKernelGetTickCount();
+        offered = true;
+    }
+    _mutex.unlock();
+    return offered;
+}
+
+void TLSSessionCache::save(const char *host, uint16_t port, const mbedtls_ssl_context *ssl)
+{
+    _mutex.lock();
+    Entry *entry = find(host, port);
+    if (!entry) {
+        entry = &_entries[0];
+        for (int i = 0; i < MBED_CONF_APP_TLS_SESSION_CACHE_SIZE; i++) {
+            if (!_entries[i].valid) {
+                entry = &_entries[i];
+                break;
+            }
+            if ((int32_t)(_entries[i].last_used - entry->last_used) < 0) {
+                entry = &_entries[i];
+            }
+        }
+    }
+
+    mbedtls_ssl_session_free(&entry->session);
+    mbedtls_ssl_session_init(&entry->session);
+    entry->valid = (mbedtls_ssl_get_session(ssl, &entry->session) == 0);
+    if (entry->valid) {
+        strncpy(entry->host, host, sizeof(entry->host) - 1);
+        entry->host[sizeof(entry->host) - 1] = '\0';
+        entry->port = port;
+        entry->last_used = osKernelGetTickCount();
+    }
+    _mutex.unlock();
+}
+
+void TLSSessionCache::invalidate(const char *host, uint16_t port)
+{
+    _mutex.lock();
+    Entry *entry = find(host, port);
+    if (entry) {
+        mbedtls_ssl_session_free(&entry->session);
+        mbedtls_ssl_session_init(&entry->session);
+        entry->valid = false;
+    }
+    _mutex.unlock();
+}
+
+void TLSSessionCache::count_handshake(bool resumed)
+{
+    _mutex.lock();
+    if (resumed) {
+        _stats.resumed_handshakes++;
+    } else {
+        _stats.full_handshakes++;
+    }
+    _mutex.unlock();
+}
+
+void TLSSessionCache::count_failed_resumption()
+{
+    _mutex.lock();
+    _stats.failed_resumptions++;
+    _mutex.unlock();
+}
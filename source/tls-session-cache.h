@@ -0,0 +1,64 @@
+#ifndef _TLS_SESSION_CACHE_H_
+#define _TLS_SESSION_CACHE_H_
+
+#include "mbed.h"
+#include "mbedtls/ssl.h"
+#include "http-url.h"
+
+#ifndef MBED_CONF_APP_TLS_SESSION_CACHE_SIZE
+#define MBED_CONF_APP_TLS_SESSION_CACHE_SIZE    2
+#endif
+
+//
+// Remembers the last TLS session (session ID and/or session ticket) agreed
+// with each host:port so the next connection to it can resume with an
+// abbreviated handshake: no certificate chain, no key exchange, one round
+// trip less.  On LTE-M a full handshake costs seconds and several KB.
+//
+// One cache is meant to be shared by every TLSTransport in the application.
+// When it is full the least recently used entry makes room.
+//
+class TLSSessionCache {
+public:
+    struct Stats {
+        uint32_t full_handshakes;       // certificate chain sent and verified
+        uint32_t resumed_handshakes;    // abbreviated handshake from a cached session
+        uint32_t failed_resumptions;    // handshake failed after offering a session
+    };
+
+    TLSSessionCache();
+    ~TLSSessionCache();
+
+    // Offers the cached session for host:port, if any, to a context that is
+    // about to handshake.  Returns true when a session was set.
+    bool resume(const char *host, uint16_t port, mbedtls_ssl_context *ssl);
+
+    // Stores the session negotiated by a completed handshake.
+    void save(const char *host, uint16_t port, const mbedtls_ssl_context *ssl);
+
+    // Forgets host:port, e.g. after the server rejected the session.
+    void invalidate(const char *host, uint16_t port);
+
+    // Handshake bookkeeping, called by TLSTransport.
+    void count_handshake(bool resumed);
+    void count_failed_resumption();
+
+    const Stats &stats() const { return _stats; }
+
+private:
+    struct Entry {
+        bool valid;
+        char host[HTTP_URL_MAX_HOST];
+        uint16_t port;
+        uint32_t last_used;
+        mbedtls_ssl_session session;
+    };
+
+    Entry *find(const char *host, uint16_t port);
+
+    Entry _entries[MBED_CONF_APP_TLS_SESSION_CACHE_SIZE];
+    Stats _stats;
+    Mutex _mutex;
+};
+
+#endif // _TLS_SESSION_CACHE_H_
@@ -0,0 +1,374 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License"); 
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, 
+   software distributed under the License is distributed on an 
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, 
+   either express or implied. See the License for the specific 
+   language governing permissions and limitations under the License.
+
+    @file          tls-transport.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include "mbedtls/error.h"
+#include "mbedtls/net_sockets.h"
+#include "tls-transport.h"
+
+#if MBED_HEAP_STATS_ENABLED
+#include "mbed_stats.h"
+#endif
+
+static const char DRBG_PERS[] = "httpx-tls-transport";
+
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+static unsigned char mfl_code(int length)
+{
+    switch (length) {
+        case 512:  return MBEDTLS_SSL_MAX_FRAG_LEN_512;
+        case 1024: return MBEDTLS_SSL_MAX_FRAG_LEN_1024;
+        case 2048: return MBEDTLS_SSL_MAX_FRAG_LEN_2048;
+        case 4096: return MBEDTLS_SSL_MAX_FRAG_LEN_4096;
+        default:   return MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+    }
+}
+#endif
+
+TLSTransport::TLSTransport(NetworkInterface *net, const char *hostname, uint16_t port,
+                           TLSSessionCache *session_cache, mbedtls_x509_crt *ca_chain)
+    : _net(net), _port(port), _session_cache(session_cache), _ca_chain(ca_chain),
+      _configured(false), _connected(false), _debug(false), _resumed(false),
+      _chain_verified(false), _error(0), _heap_base(0), _heap_max(0)
+{
+    strncpy(_hostname, hostname, sizeof(_hostname) - 1);
+    _hostname[sizeof(_hostname) - 1] = '\0';
+    _ciphersuites[0] = 0;
+    memset(&_memory, 0, sizeof(_memory));
+
+    mbedtls_entropy_init(&_entropy);
+    mbedtls_ctr_drbg_init(&_ctr_drbg);
+    mbedtls_ssl_init(&_ssl);
+    mbedtls_ssl_config_init(&_ssl_conf);
+}
+
+TLSTransport::~TLSTransport()
+{
+    close();
+    mbedtls_ssl_free(&_ssl);
+    mbedtls_ssl_config_free(&_ssl_conf);
+    mbedtls_ctr_drbg_free(&_ctr_drbg);
+    mbedtls_entropy_free(&_entropy);
+}
+
+void TLSTransport::print_error(const char *what, int err)
+{
+    char buf[100];
+    mbedtls_strerror(err, buf, sizeof buf);
+    mbedtls_printf("%s returned -0x%04X - %s\n", what, -err, buf);
+}
+
+// Takes the mbedTLS IDs of MBED_CONF_APP_TLS_CIPHERSUITES, skipping unknown names.
+void TLSTransport::setup_ciphersuites()
+{
+    const char *p = MBED_CONF_APP_TLS_CIPHERSUITES;
+    size_t count = 0;
+
+    while (*p && count < TLS_MAX_CIPHERSUITES) {
+        const char *end = strchr(p, ',');
+        size_t length = end ? (size_t)(end - p) : strlen(p);
+        char name[64];
+        if (length > 0 && length < sizeof(name)) {
+            memcpy(name, p, length);
+            name[length] = '\0';
+            int id = mbedtls_ssl_get_ciphersuite_id(name);
+            if (id != 0) {
+                _ciphersuites[count++] = id;
+            } else {
+                mbedtls_printf("Unknown ciphersuite %s\n", name);
+            }
+        }
+        p += length + (end ? 1 : 0);
+    }
+    _ciphersuites[count] = 0;
+    if (count > 0) {
+        mbedtls_ssl_conf_ciphersuites(&_ssl_conf, _ciphersuites);
+    }
+}
+
+bool TLSTransport::fragment_length_agreed() const
+{
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    return _connected && _ssl.session && _ssl.session->mfl_code != MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+#else
+    return false;
+#endif
+}
+
+//
+// Heap accounting around connect(): the level before the first setup() is
+// the base everything the connection holds is measured from.
+//
+void TLSTransport::heap_mark()
+{
+#if MBED_HEAP_STATS_ENABLED
+    mbed_stats_heap_t heap;
+    mbed_stats_heap_get(&heap);
+    if (!_configured) {
+        _heap_base = heap.current_size;
+    }
+    _heap_max = heap.max_size;
+#endif
+}
+
+void TLSTransport::heap_measure()
+{
+#if MBED_HEAP_STATS_ENABLED
+    mbed_stats_heap_t heap;
+    mbed_stats_heap_get(&heap);
+    _memory.heap_in_use = heap.current_size > _heap_base ? heap.current_size - _heap_base : 0;
+    uint32_t peak = heap.max_size > _heap_max ? heap.max_size - _heap_base : _memory.heap_in_use;
+    if (peak > _memory.heap_peak) {
+        _memory.heap_peak = peak;
+    }
+#endif
+    _memory.handshakes++;
+}
+
+//
+// One-time configuration, kept across reconnects.
+//
+nsapi_error_t TLSTransport::setup()
+{
+    int ret;
+
+    if ((ret = mbedtls_ctr_drbg_seed(&_ctr_drbg, mbedtls_entropy_func, &_entropy,
+                                     (const unsigned char *)DRBG_PERS, sizeof(DRBG_PERS))) != 0) {
+        print_error("mbedtls_ctr_drbg_seed", ret);
+        return ret;
+    }
+    if (!_ca_chain && !(_ca_chain = trust_store_chain())) {
+        mbedtls_printf("No trusted root certificates\n");
+        return MBEDTLS_ERR_X509_CERT_VERIFY_FAILED;
+    }
+    if ((ret = mbedtls_ssl_config_defaults(&_ssl_conf, MBEDTLS_SSL_IS_CLIENT,
+                                           MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT)) != 0) {
+        print_error("mbedtls_ssl_config_defaults", ret);
+        return ret;
+    }
+    mbedtls_ssl_conf_ca_chain(&_ssl_conf, _ca_chain, NULL);
+    mbedtls_ssl_conf_rng(&_ssl_conf, mbedtls_ctr_drbg_random, &_ctr_drbg);
+    mbedtls_ssl_conf_authmode(&_ssl_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    mbedtls_ssl_conf_verify(&_ssl_conf, &TLSTransport::ssl_verify, this);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_conf_session_tickets(&_ssl_conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    if ((ret = mbedtls_ssl_conf_max_frag_len(&_ssl_conf, mfl_code(MBED_CONF_APP_TLS_MAX_FRAGMENT_LENGTH))) != 0) {
+        print_error("mbedtls_ssl_conf_max_frag_len", ret);
+        return ret;
+    }
+#endif
+    setup_ciphersuites();
+
+    if ((ret = mbedtls_ssl_setup(&_ssl, &_ssl_conf)) != 0) {
+        print_error("mbedtls_ssl_setup", ret);
+        return ret;
+    }
+    if ((ret = mbedtls_ssl_set_hostname(&_ssl, _hostname)) != 0) {
+        print_error("mbedtls_ssl_set_hostname", ret);
+        return ret;
+    }
+    mbedtls_ssl_set_bio(&_ssl, this, &TLSTransport::ssl_send, &TLSTransport::ssl_recv, NULL);
+
+    _configured = true;
+    return 0;
+}
+
+nsapi_error_t TLSTransport::connect()
+{
+    int ret;
+
+    if (_connected) {
+        return NSAPI_ERROR_IS_CONNECTED;
+    }
+    heap_mark();
+    if (!_configured) {
+        if ((_error = setup()) != 0) {
+            return _error;
+        }
+    } else if ((ret = mbedtls_ssl_session_reset(&_ssl)) != 0) {
+        print_error("mbedtls_ssl_session_reset", ret);
+        return _error = ret;
+    }
+
+    if (_debug) {
+        mbedtls_printf("Connecting to %s:%d\n", _hostname, _port);
+    }
+    if ((ret = _tcp.open(_net)) != NSAPI_ERROR_OK || (ret = dial(&_tcp, _net, _hostname, _port)) != NSAPI_ERROR_OK) {
+        mbedtls_printf("Failed to connect to %s:%d (%d)\n", _hostname, _port, ret);
+        _tcp.close();
+        count_connect(ret);
+        return _error = ret;
+    }
+
+    bool offered = _session_cache && _session_cache->resume(_hostname, _port, &_ssl);
+    _chain_verified = false;
+
+    if (_debug) {
+        mbedtls_printf("Starting the TLS handshake%s...\n", offered ? " (offering cached session)" : "");
+    }
+    uint32_t handshake_start = us_ticker_read();
+    do {
+        ret = mbedtls_ssl_handshake(&_ssl);
+    } while (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE);
+    _timing.tls_us = us_ticker_read() - handshake_start;
+
+    if (ret != 0) {
+        print_error("mbedtls_ssl_handshake", ret);
+        if (offered) {
+            // Don't keep offering a session the server chokes on.
+            _session_cache->invalidate(_hostname, _port);
+            _session_cache->count_failed_resumption();
+        }
+        _tcp.close();
+        count_connect(ret);
+        return _error = ret;
+    }
+
+    // The verify callback only runs when the server sent its certificate
+    // chain, i.e. on a full handshake.
+    _resumed = offered && !_chain_verified;
+    _timing.resumed = _resumed;
+    _connected = true;
+    _error = 0;
+    heap_measure();
+    count_connect(NSAPI_ERROR_OK);
+
+    if (_session_cache) {
+        _session_cache->count_handshake(_resumed);
+        _session_cache->save(_hostname, _port, &_ssl);
+    }
+
+    if (_debug) {
+        mbedtls_printf("TLS connection to %s:%d established%s\n", _hostname, _port,
+                       _resumed ? " (session resumed)" : "");
+        mbedtls_printf("Ciphersuite %s, max fragment length %s\n", mbedtls_ssl_get_ciphersuite(&_ssl),
+                       fragment_length_agreed() ? "agreed" : "not agreed");
+        const mbedtls_x509_crt *peer = mbedtls_ssl_get_peer_cert(&_ssl);
+        if (peer && !_resumed) {
+            char *buf = new char[1024];
+            mbedtls_x509_crt_info(buf, 1024, "    ", peer);
+            mbedtls_printf("Server certificate:\n%s\n", buf);
+            delete[] buf;
+        }
+        uint32_t flags = mbedtls_ssl_get_verify_result(&_ssl);
+        if (flags != 0) {
+            char buf[256];
+            mbedtls_x509_crt_verify_info(buf, sizeof buf, "  ! ", flags);
+            mbedtls_printf("Certificate verification failed:\n%s\n", buf);
+        } else {
+            mbedtls_printf("Certificate verification passed\n\n");
+        }
+    }
+    return 0;
+}
+
+nsapi_size_or_error_t TLSTransport::send(const void *data, nsapi_size_t size)
+{
+    int ret;
+    do {
+        ret = mbedtls_ssl_write(&_ssl, (const unsigned char *)data, size);
+    } while (ret == MBEDTLS_ERR_SSL_WANT_WRITE);
+
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ) {
+        return NSAPI_ERROR_WOULD_BLOCK;
+    }
+    count_app_sent(ret);
+    if (ret < 0) {
+        print_error("mbedtls_ssl_write", ret);
+        _error = ret;
+        close();
+    }
+    return ret;
+}
+
+nsapi_size_or_error_t TLSTransport::recv(void *data, nsapi_size_t size)
+{
+    int ret = mbedtls_ssl_read(&_ssl, (unsigned char *)data, size);
+
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+        return NSAPI_ERROR_WOULD_BLOCK;
+    }
+    if (ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) {
+        ret = 0;
+    }
+    count_app_received(ret);
+    if (ret < 0) {
+        print_error("mbedtls_ssl_read", ret);
+        _error = ret;
+    }
+    if (ret <= 0) {
+        close();
+    }
+    return ret;
+}
+
+nsapi_error_t TLSTransport::close()
+{
+    if (_connected) {
+        mbedtls_ssl_close_notify(&_ssl);
+        _connected = false;
+        count_tcp_close();
+        traffic_flush();
+    }
+    _tcp.close();
+    return NSAPI_ERROR_OK;
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// mbedTLS callbacks
+//
+int TLSTransport::ssl_send(void *ctx, const unsigned char *buf, size_t len)
+{
+    TLSTransport *self = static_cast<TLSTransport *>(ctx);
+    nsapi_size_or_error_t sent = self->_tcp.send(buf, len);
+    self->count_wire_sent(sent);
+    if (!self->_connected && sent > 0) {
+        self->_traffic.handshake_sent += sent;
+    }
+
+    if (sent == NSAPI_ERROR_WOULD_BLOCK) {
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
+    return sent < 0 ? MBEDTLS_ERR_NET_SEND_FAILED : sent;
+}
+
+int TLSTransport::ssl_recv(void *ctx, unsigned char *buf, size_t len)
+{
+    TLSTransport *self = static_cast<TLSTransport *>(ctx);
+    nsapi_size_or_error_t received = self->_tcp.recv(buf, len);
+    self->count_wire_received(received);
+    if (!self->_connected && received > 0) {
+        self->_traffic.handshake_received += received;
+    }
+
+    if (received == NSAPI_ERROR_WOULD_BLOCK) {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+    return received < 0 ? MBEDTLS_ERR_NET_RECV_FAILED : received;
+}
+
+int TLSTransport::ssl_verify(void *ctx, mbedtls_x509_crt *crt, int depth, uint32_t *flags)
+{
+    (void)crt; (void)depth; (void)flags;
+    static_cast<TLSTransport *>(ctx)->_chain_verified = true;
+    return 0;
+}
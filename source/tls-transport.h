@@ -0,0 +1,134 @@
+#ifndef _TLS_TRANSPORT_H_
+#define _TLS_TRANSPORT_H_
+
+#include "mbed.h"
+#include "mbedtls/platform.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/x509_crt.h"
+#include "http-transport.h"
+#include "tls-session-cache.h"
+#include "trust-store.h"
+
+#ifndef MBED_CONF_APP_TLS_MAX_FRAGMENT_LENGTH
+#define MBED_CONF_APP_TLS_MAX_FRAGMENT_LENGTH   0       // 512, 1024, 2048 or 4096 to ask for; 0 does not ask
+#endif
+
+#ifndef MBED_CONF_APP_TLS_CIPHERSUITES
+#define MBED_CONF_APP_TLS_CIPHERSUITES          ""      // mbedTLS names, comma separated; "" for its defaults
+#endif
+
+#define TLS_MAX_CIPHERSUITES                    8       // most taken from MBED_CONF_APP_TLS_CIPHERSUITES
+
+// Record content sizes mbedTLS was built with (mbedtls-user-config.h).
+#if defined(MBEDTLS_SSL_IN_CONTENT_LEN)
+#define TLS_IN_RECORD_SIZE                      MBEDTLS_SSL_IN_CONTENT_LEN
+#define TLS_OUT_RECORD_SIZE                     MBEDTLS_SSL_OUT_CONTENT_LEN
+#else
+#define TLS_IN_RECORD_SIZE                      MBEDTLS_SSL_MAX_CONTENT_LEN
+#define TLS_OUT_RECORD_SIZE                     MBEDTLS_SSL_MAX_CONTENT_LEN
+#endif
+
+//
+// TLS client stream over a TCPSocket, the counterpart of mbed-http's
+// TLSSocket for HttpClientRequest.  Unlike TLSSocket it can be closed and
+// connected again, and when given a TLSSessionCache it offers the session
+// from the previous connection to the same host:port, so reconnects resume
+// with an abbreviated handshake instead of a full one.
+//
+// Server certificates are verified against ca_chain, by default the shared
+// chain of the trust store, which is parsed once for all connections.
+//
+// To fit more connections in RAM the handshake asks for records of at most
+// MBED_CONF_APP_TLS_MAX_FRAGMENT_LENGTH bytes (RFC 6066), which lets mbedTLS
+// be built with smaller record buffers (mbedtls-user-config.h), and offers
+// only the MBED_CONF_APP_TLS_CIPHERSUITES, which keeps the handshake's
+// working memory down.  memory_stats() tells what a connection costs.
+//
+class TLSTransport : public HttpTransport {
+public:
+    //
+    // Heap a connection holds and needs, from the heap counters
+    // (MBED_HEAP_STATS_ENABLED; otherwise they read 0).  Allocations by
+    // other threads during connect() count too, so measure with one thread
+    // connecting at a time.
+    //
+    struct MemoryStats {
+        uint32_t heap_in_use;       // held while connected: record buffers, session, peer certificate
+        uint32_t heap_peak;         // most held during a handshake, when it raised the heap's
+                                    // high-water mark; otherwise heap_in_use
+        uint32_t handshakes;
+    };
+
+    TLSTransport(NetworkInterface *net, const char *hostname, uint16_t port,
+                 TLSSessionCache *session_cache = NULL, mbedtls_x509_crt *ca_chain = NULL);
+    virtual ~TLSTransport();
+
+    // Connects the TCP socket and runs the handshake.  Returns 0 or an mbedTLS
+    // (negative) or NSAPI error code.
+    virtual nsapi_error_t connect();
+    virtual nsapi_size_or_error_t send(const void *data, nsapi_size_t size);
+    virtual nsapi_size_or_error_t recv(void *data, nsapi_size_t size);
+    virtual nsapi_error_t close();
+    virtual bool connected() const { return _connected; }
+
+    virtual const char *host() const { return _hostname; }
+    virtual uint16_t port() const { return _port; }
+
+    // Prints the handshake progress and the server certificate.
+    void set_debug(bool debug) { _debug = debug; }
+
+    // True when the last handshake resumed a cached session.
+    bool resumed() const { return _resumed; }
+
+    // True when the server agreed to MBED_CONF_APP_TLS_MAX_FRAGMENT_LENGTH;
+    // if it did not, records up to 16 KB can still arrive.
+    bool fragment_length_agreed() const;
+
+    // Ciphersuite of the connection, or NULL.
+    const char *ciphersuite() const { return _connected ? mbedtls_ssl_get_ciphersuite(&_ssl) : NULL; }
+
+    const MemoryStats &memory_stats() const { return _memory; }
+
+    nsapi_error_t error() const { return _error; }
+    TCPSocket *get_tcp_socket() { return &_tcp; }
+    mbedtls_ssl_context *get_ssl_context() { return &_ssl; }
+
+private:
+    nsapi_error_t setup();
+    void setup_ciphersuites();
+    void print_error(const char *what, int err);
+    void heap_mark();
+    void heap_measure();
+
+    static int ssl_send(void *ctx, const unsigned char *buf, size_t len);
+    static int ssl_recv(void *ctx, unsigned char *buf, size_t len);
+    static int ssl_verify(void *ctx, mbedtls_x509_crt *crt, int depth, uint32_t *flags);
+
+    NetworkInterface *_net;
+    char _hostname[HTTP_URL_MAX_HOST];
+    uint16_t _port;
+    TLSSessionCache *_session_cache;
+    mbedtls_x509_crt *_ca_chain;
+
+    TCPSocket _tcp;
+    mbedtls_entropy_context _entropy;
+    mbedtls_ctr_drbg_context _ctr_drbg;
+    mbedtls_ssl_context _ssl;
+    mbedtls_ssl_config _ssl_conf;
+    int _ciphersuites[TLS_MAX_CIPHERSUITES + 1];    // 0 terminated; must outlive _ssl_conf
+
+    bool _configured;
+    bool _connected;
+    bool _debug;
+    bool _resumed;
+    bool _chain_verified;       // set by ssl_verify, only called on full handshakes
+    nsapi_error_t _error;
+
+    MemoryStats _memory;
+    uint32_t _heap_base;        // heap in use before the first setup()
+    uint32_t _heap_max;         // heap high-water mark when connect() started
+};
+
+#endif // _TLS_TRANSPORT_H_
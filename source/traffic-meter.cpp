@@ -0,0 +1,243 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          traffic-meter.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <stdio.h>
+#include <string.h>
+#include "traffic-meter.h"
+
+#define TRAFFIC_FIELDS  (sizeof(TrafficCounters) / sizeof(uint32_t))
+
+static TrafficMeter *active_meter;
+
+void traffic_meter_enable(TrafficMeter *meter)
+{
+    active_meter = meter;
+}
+
+TrafficMeter *traffic_meter()
+{
+    return active_meter;
+}
+
+void traffic_add(TrafficCounters *to, const TrafficCounters &counters)
+{
+    uint32_t *p = reinterpret_cast<uint32_t *>(to);
+    const uint32_t *q = reinterpret_cast<const uint32_t *>(&counters);
+    for (size_t ix = 0; ix < TRAFFIC_FIELDS; ix++) {
+        p[ix] += q[ix];
+    }
+}
+
+void traffic_delta(TrafficCounters *delta, const TrafficCounters &now, const TrafficCounters &before)
+{
+    uint32_t *p = reinterpret_cast<uint32_t *>(delta);
+    const uint32_t *a = reinterpret_cast<const uint32_t *>(&now);
+    const uint32_t *b = reinterpret_cast<const uint32_t *>(&before);
+    for (size_t ix = 0; ix < TRAFFIC_FIELDS; ix++) {
+        p[ix] = a[ix] - b[ix];
+    }
+}
+
+uint32_t traffic_air_sent(const TrafficCounters &counters)
+{
+    return counters.wire_sent + counters.packets_sent * TRAFFIC_PACKET_OVERHEAD;
+}
+
+uint32_t traffic_air_received(const TrafficCounters &counters)
+{
+    return counters.wire_received + counters.packets_received * TRAFFIC_PACKET_OVERHEAD;
+}
+
+uint32_t traffic_energy_uj(const TrafficCounters &counters)
+{
+    uint64_t uj = (uint64_t)traffic_air_sent(counters) * MBED_CONF_APP_TRAFFIC_TX_UJ_PER_KB / 1024 +
+                  (uint64_t)traffic_air_received(counters) * MBED_CONF_APP_TRAFFIC_RX_UJ_PER_KB / 1024 +
+                  (uint64_t)counters.setup_us * MBED_CONF_APP_TRAFFIC_SETUP_MW / 1000;     // mW x us = nJ
+    return uj > 0xffffffffu ? 0xffffffffu : (uint32_t)uj;
+}
+
+// a - b, or 0 when counts taken at different moments cross.
+static uint32_t minus(uint32_t a, uint32_t b)
+{
+    return a > b ? a - b : 0;
+}
+
+TrafficMeter::TrafficMeter()
+    : _count(0), _overflow(false), _queue(NULL), _interval_ms(0), _event(0)
+{
+}
+
+void TrafficMeter::add(const char *host, uint16_t port, const TrafficCounters &counters)
+{
+    _mutex.lock();
+    Endpoint *endpoint = NULL;
+    for (size_t ix = 0; ix < _count && !endpoint; ix++) {
+        if (_endpoints[ix].port == port && strcmp(_endpoints[ix].host, host) == 0) {
+            endpoint = &_endpoints[ix];
+        }
+    }
+    if (!endpoint && _count < MBED_CONF_APP_TRAFFIC_ENDPOINTS) {
+        endpoint = &_endpoints[_count++];
+        strncpy(endpoint->host, host, sizeof(endpoint->host) - 1);
+        endpoint->host[sizeof(endpoint->host) - 1] = '\0';
+        endpoint->port = port;
+        memset(&endpoint->counters, 0, sizeof(endpoint->counters));
+    }
+    if (!endpoint) {
+        // Full: the last endpoint makes way for everything that did not fit.
+        endpoint = &_endpoints[_count - 1];
+        if (!_overflow) {
+            _overflow = true;
+            strcpy(endpoint->host, "*");
+            endpoint->port = 0;
+        }
+    }
+    traffic_add(&endpoint->counters, counters);
+    _mutex.unlock();
+}
+
+void TrafficMeter::clear()
+{
+    _mutex.lock();
+    _count = 0;
+    _overflow = false;
+    _mutex.unlock();
+}
+
+size_t TrafficMeter::endpoints()
+{
+    _mutex.lock();
+    size_t count = _count;
+    _mutex.unlock();
+    return count;
+}
+
+bool TrafficMeter::endpoint(size_t index, Endpoint *endpoint)
+{
+    _mutex.lock();
+    bool found = index < _count;
+    if (found) {
+        *endpoint = _endpoints[index];
+    }
+    _mutex.unlock();
+    return found;
+}
+
+void TrafficMeter::total(TrafficCounters *total)
+{
+    memset(total, 0, sizeof(*total));
+    _mutex.lock();
+    for (size_t ix = 0; ix < _count; ix++) {
+        traffic_add(total, _endpoints[ix].counters);
+    }
+    _mutex.unlock();
+}
+
+static void report_line(const char *host, uint16_t port, const TrafficCounters &c,
+                        Callback<void(const char *data, size_t size)> output)
+{
+    char name[HTTP_URL_MAX_HOST + 8];
+    if (port) {
+        snprintf(name, sizeof(name), "%s:%u", host, port);
+    } else {
+        snprintf(name, sizeof(name), "%s", host);
+    }
+    char line[256];
+    int length = snprintf(line, sizeof(line),
+                          "%s %lu req, %lu conn (%lu resumed, %lu failed), setup %lu ms; "
+                          "tx %lu (body %lu, head %lu, tls %lu); rx %lu (body %lu, head %lu, tls %lu); "
+                          "on air %lu/%lu; %lu mJ\n",
+                          name, (unsigned long)c.requests, (unsigned long)c.connects,
+                          (unsigned long)c.resumed, (unsigned long)c.failed_connects,
+                          (unsigned long)(c.setup_us / 1000),
+                          (unsigned long)c.wire_sent, (unsigned long)c.payload_sent,
+                          (unsigned long)minus(c.app_sent, c.payload_sent),
+                          (unsigned long)minus(c.wire_sent, c.app_sent),
+                          (unsigned long)c.wire_received, (unsigned long)c.payload_received,
+                          (unsigned long)minus(c.app_received, c.payload_received),
+                          (unsigned long)minus(c.wire_received, c.app_received),
+                          (unsigned long)traffic_air_sent(c), (unsigned long)traffic_air_received(c),
+                          (unsigned long)(traffic_energy_uj(c) / 1000));
+    if (length >= (int)sizeof(line)) {
+        length = sizeof(line) - 1;
+        line[length - 1] = '\n';
+    }
+    output(line, length);
+}
+
+void TrafficMeter::report(Callback<void(const char *data, size_t size)> output)
+{
+    for (size_t ix = 0; ; ix++) {
+        Endpoint endpoint;
+        if (!this->endpoint(ix, &endpoint)) {
+            break;
+        }
+        report_line(endpoint.host, endpoint.port, endpoint.counters, output);
+    }
+    TrafficCounters sum;
+    total(&sum);
+    report_line("total", 0, sum, output);
+}
+
+void TrafficMeter::report_every(EventQueue *queue, uint32_t interval_ms,
+                                Callback<void(const char *data, size_t size)> output)
+{
+    stop_reports();
+    _report_mutex.lock();
+    _queue = queue;
+    _interval_ms = interval_ms;
+    _output = output;
+    _event = _queue->call_in(_interval_ms, this, &TrafficMeter::periodic_report);
+    _report_mutex.unlock();
+}
+
+void TrafficMeter::stop_reports()
+{
+    _report_mutex.lock();
+    if (_queue && _event) {
+        _queue->cancel(_event);
+    }
+    _queue = NULL;
+    _event = 0;
+    _report_mutex.unlock();
+}
+
+// Re-armed each time rather than call_every(), so a slow output only delays
+// the next report.  The lock is not held while reporting; a stop_reports()
+// meanwhile is seen when re-arming.
+void TrafficMeter::periodic_report()
+{
+    _report_mutex.lock();
+    if (!_queue) {
+        _report_mutex.unlock();
+        return;
+    }
+    Callback<void(const char *data, size_t size)> output = _output;
+    _report_mutex.unlock();
+
+    report(output);
+
+    _report_mutex.lock();
+    if (_queue) {
+        _event = _queue->call_in(_interval_ms, this, &TrafficMeter::periodic_report);
+    }
+    _report_mutex.unlock();
+}
@@ -0,0 +1,147 @@
+#ifndef _TRAFFIC_METER_H_
+#define _TRAFFIC_METER_H_
+
+#include "mbed.h"
+#include "http-url.h"
+
+#ifndef MBED_CONF_APP_TRAFFIC_ENDPOINTS
+#define MBED_CONF_APP_TRAFFIC_ENDPOINTS     8       // host:port pairs counted apart; the rest go under "*"
+#endif
+
+#ifndef MBED_CONF_APP_TRAFFIC_REPORT_MS
+#define MBED_CONF_APP_TRAFFIC_REPORT_MS     60000   // between periodic reports; 0 turns them off
+#endif
+
+#ifndef MBED_CONF_APP_TRAFFIC_TX_UJ_PER_KB
+#define MBED_CONF_APP_TRAFFIC_TX_UJ_PER_KB  5000    // radio energy per KB sent
+#endif
+
+#ifndef MBED_CONF_APP_TRAFFIC_RX_UJ_PER_KB
+#define MBED_CONF_APP_TRAFFIC_RX_UJ_PER_KB  500     // radio energy per KB received
+#endif
+
+#ifndef MBED_CONF_APP_TRAFFIC_SETUP_MW
+#define MBED_CONF_APP_TRAFFIC_SETUP_MW      600     // modem power while connections are set up
+#endif
+
+// What a packet costs on air beyond its TCP payload: IPv4 and TCP headers
+// without options, in segments of at most TRAFFIC_SEGMENT_SIZE.
+#define TRAFFIC_SEGMENT_SIZE                1400
+#define TRAFFIC_PACKET_OVERHEAD             40
+
+//
+// What an HttpTransport carried.  The wire counts are the bytes that went
+// through the TCP socket: for TLS the records, handshake and close_notify
+// included.  The app counts are the bytes given to send() and got from
+// recv(), heads and bodies; payload is the part of those that were bodies.
+// So a connection's TLS overhead is wire - app and its HTTP overhead
+// (request lines, headers, chunk framing) app - payload.  Packets are an
+// estimate: the TCP handshake and teardown, and each send() or recv() cut
+// in TRAFFIC_SEGMENT_SIZE segments; bare ACKs are not counted.
+//
+// Every field is a uint32_t; traffic_add() and traffic_delta() rely on it.
+// Counts wrap after 4 GB.
+//
+struct TrafficCounters {
+    uint32_t requests;
+    uint32_t connects;              // connect() calls that succeeded
+    uint32_t failed_connects;
+    uint32_t resumed;               // TLS handshakes that resumed a session
+    uint32_t setup_us;              // DNS, TCP and TLS handshakes, failed ones too
+    uint32_t wire_sent;
+    uint32_t wire_received;
+    uint32_t handshake_sent;        // TLS handshake, part of wire
+    uint32_t handshake_received;
+    uint32_t app_sent;
+    uint32_t app_received;
+    uint32_t payload_sent;          // HTTP bodies, part of app
+    uint32_t payload_received;
+    uint32_t packets_sent;
+    uint32_t packets_received;
+};
+
+void traffic_add(TrafficCounters *to, const TrafficCounters &counters);
+
+// *delta = now - before, field by field.
+void traffic_delta(TrafficCounters *delta, const TrafficCounters &now, const TrafficCounters &before);
+
+// Bytes on air, payload and IP/TCP headers; link layer framing not included.
+uint32_t traffic_air_sent(const TrafficCounters &counters);
+uint32_t traffic_air_received(const TrafficCounters &counters);
+
+//
+// Radio energy the traffic cost, in microjoules, by a simple model: the
+// bytes on air at MBED_CONF_APP_TRAFFIC_TX/RX_UJ_PER_KB, and the connection
+// setup time at MBED_CONF_APP_TRAFFIC_SETUP_MW.  The defaults are rough
+// figures for an LTE Cat-1 modem; measure the one in use and configure its
+// own.  The radio's idle tail after each burst is not modelled, so fewer,
+// larger exchanges save more than this shows.
+//
+uint32_t traffic_energy_uj(const TrafficCounters &counters);
+
+//
+// Traffic of every HttpTransport, summed per endpoint (host:port).
+// Transports count as they go, into their own TrafficCounters, and hand what
+// is new to the installed meter at the end of each request, after each
+// connect() and on close(), so the meter's lock is taken a few times per
+// request rather than per send().  Install one with traffic_meter_enable().
+//
+// report() writes one line per endpoint and a total:
+//
+//   httpbin.org:443 4 req, 1 conn (0 resumed, 0 failed), setup 812 ms;
+//     tx 2210 (body 66, head 480, tls 1664); rx 6960 (body 1120, head 880, tls 4960);
+//     on air 2490/7160; 20 mJ
+//
+// (one line, wrapped here), where tx and rx are wire bytes and head the
+// HTTP overhead.  Sockets used outside HttpTransport (mbed-http's
+// HttpRequest and TLSSocket) are not counted.
+//
+class TrafficMeter {
+public:
+    struct Endpoint {
+        char host[HTTP_URL_MAX_HOST];   // "*" for the endpoints that did not fit
+        uint16_t port;
+        TrafficCounters counters;
+    };
+
+    TrafficMeter();
+
+    void add(const char *host, uint16_t port, const TrafficCounters &counters);
+    void clear();
+
+    size_t endpoints();
+    // Copies endpoint index, 0 to endpoints() - 1; false past the end.
+    bool endpoint(size_t index, Endpoint *endpoint);
+    void total(TrafficCounters *total);
+
+    void report(Callback<void(const char *data, size_t size)> output);
+
+    // Calls report() every interval_ms from queue, until stop_reports().
+    // output runs on the queue's thread: not a LogRing another thread writes.
+    void report_every(EventQueue *queue, uint32_t interval_ms,
+                      Callback<void(const char *data, size_t size)> output);
+    void stop_reports();
+
+private:
+    void periodic_report();
+
+    Endpoint _endpoints[MBED_CONF_APP_TRAFFIC_ENDPOINTS];
+    size_t _count;
+    bool _overflow;             // the last endpoint is "*"
+    Mutex _mutex;
+
+    // Report scheduling, changed by report_every() and stop_reports() on the
+    // caller's thread and read by periodic_report() on the queue's.
+    Mutex _report_mutex;
+    EventQueue *_queue;
+    uint32_t _interval_ms;
+    Callback<void(const char *data, size_t size)> _output;
+    int _event;
+};
+
+// Every HttpTransport reports into meter from now on; NULL stops metering.
+// Transports keep their own counts either way.
+void traffic_meter_enable(TrafficMeter *meter);
+TrafficMeter *traffic_meter();
+
+#endif // _TRAFFIC_METER_H_
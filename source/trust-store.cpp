@@ -0,0 +1,45 @@
+#include "mbed.h"
+#include "mbedtls/platform.h"
+#include "mbedtls/version.h"
+#include "trust-store.h"
+
+static mbedtls_x509_crt trust_chain;
+static bool trust_chain_ready;
+static Mutex trust_chain_mutex;
+
+//
+// Newer mbedTLS can point the chain straight at the flash copy instead of
+// duplicating every certificate on the heap.
+//
+static int parse_anchor(const TrustAnchor &anchor)
+{
+#if defined(MBEDTLS_VERSION_NUMBER) && MBEDTLS_VERSION_NUMBER >= 0x02110000
+    return mbedtls_x509_crt_parse_der_nocopy(&trust_chain, anchor.der, anchor.len);
+#else
+    return mbedtls_x509_crt_parse_der(&trust_chain, anchor.der, anchor.len);
+#endif
+}
+
+mbedtls_x509_crt *trust_store_chain(void)
+{
+    trust_chain_mutex.lock();
+    if (!trust_chain_ready) {
+        size_t parsed = 0;
+
+        mbedtls_x509_crt_init(&trust_chain);
+        for (size_t ix = 0; ix < TRUST_ANCHOR_COUNT; ix++) {
+            int ret = parse_anchor(TRUST_ANCHORS[ix]);
+            if (ret != 0) {
+                mbedtls_printf("Trust store: %s rejected (-0x%04X)\n", TRUST_ANCHORS[ix].name, -ret);
+            } else {
+                parsed++;
+            }
+        }
+        trust_chain_ready = parsed > 0;
+        if (!trust_chain_ready) {
+            mbedtls_x509_crt_free(&trust_chain);
+        }
+    }
+    trust_chain_mutex.unlock();
+    return trust_chain_ready ? &trust_chain : NULL;
+}
@@ -0,0 +1,26 @@
+#ifndef _TRUST_STORE_H_
+#define _TRUST_STORE_H_
+
+#include <stddef.h>
+#include "mbedtls/x509_crt.h"
+
+//
+// Root certificates trusted by the TLS connections.  The DER images are
+// generated into ca-roots.cpp by tools/pem2der.py and live in flash; they are
+// parsed once, on first use, into a single mbedtls_x509_crt chain that every
+// TLSTransport references (instead of each connection decoding and parsing
+// its own copy of a PEM string).
+//
+struct TrustAnchor {
+    const char *name;
+    const unsigned char *der;
+    size_t len;
+};
+
+extern const TrustAnchor TRUST_ANCHORS[];
+extern const size_t TRUST_ANCHOR_COUNT;
+
+// The shared, parsed chain, or NULL if no root could be parsed.
+mbedtls_x509_crt *trust_store_chain(void);
+
+#endif // _TRUST_STORE_H_
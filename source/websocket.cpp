@@ -0,0 +1,590 @@
+/* =====================================================================
+   Copyright © 2018, Avnet (R)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing,
+   software distributed under the License is distributed on an
+   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+   either express or implied. See the License for the specific
+   language governing permissions and limitations under the License.
+
+    @file          websocket.cpp
+    @version       1.0
+    @date          Jan 2018
+
+======================================================================== */
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "mbedtls/sha1.h"
+#include "mbedtls/base64.h"
+#include "mbedtls/version.h"
+#include "websocket.h"
+#include "http-url.h"
+
+// mbedTLS 2.7 renamed the SHA-1 call to report errors; the old name is
+// deprecated from then on.
+#if defined(MBEDTLS_VERSION_NUMBER) && MBEDTLS_VERSION_NUMBER >= 0x02070000
+#define sha1            mbedtls_sha1_ret
+#else
+#define sha1            mbedtls_sha1
+#endif
+
+#define WEBSOCKET_GUID  "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+#define CLOSE_NO_CODE   1005
+#define CLOSE_ABNORMAL  1006
+
+WebSocketClient::WebSocketClient(HttpTransport *transport, WebSocketHandler *handler)
+    : _transport(transport), _handler(handler), _state(IDLE), _sending(false), _rx_pending(0),
+      _header_length(0), _header_needed(2), _opcode(0), _fin(false), _remaining(0), _message(-1),
+      _message_first(false), _control_length(0), _last_rx_ms(0), _ping_outstanding(false),
+      _ping_sent_ms(0), _ping_us(0)
+{
+    _mask_state = us_ticker_read() ^ (uint32_t)(uintptr_t)this;
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+WebSocketClient::~WebSocketClient()
+{
+    if (_state == OPEN || _state == CLOSING) {
+        _transport->close();
+    }
+}
+
+//
+// Masking keys only have to be unpredictable to intermediaries reading the
+// stream (RFC 6455 10.3, against cache poisoning by scripts in browsers), so
+// xorshift32 stirred with the timer at each handshake will do here.
+//
+uint32_t WebSocketClient::next_mask()
+{
+    uint32_t x = _mask_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return _mask_state = x;
+}
+
+int WebSocketClient::connect(const char *url, const char *protocol)
+{
+    HttpUrl parsed;
+    if (!websocket_url_parse(url, &parsed)) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+    if (_state == OPEN || _state == CLOSING) {
+        return NSAPI_ERROR_IS_CONNECTED;
+    }
+    if (!_transport->connected()) {
+        nsapi_error_t result = _transport->connect();
+        if (result != NSAPI_ERROR_OK) {
+            return result;
+        }
+    }
+
+    // Sec-WebSocket-Key is 16 random bytes in base64; the server proves it
+    // speaks the protocol by answering with the SHA-1 of it and the GUID.
+    _mask_state ^= us_ticker_read();
+    if (_mask_state == 0) {
+        _mask_state = 1;
+    }
+    unsigned char nonce[16];
+    for (size_t ix = 0; ix < sizeof(nonce); ix += 4) {
+        uint32_t r = next_mask();
+        memcpy(nonce + ix, &r, 4);
+    }
+    char key[25];
+    size_t key_length = 0;
+    mbedtls_base64_encode((unsigned char *)key, sizeof(key), &key_length, nonce, sizeof(nonce));
+    key[key_length] = '\0';
+
+    char keyed[sizeof(key) - 1 + sizeof(WEBSOCKET_GUID) - 1];
+    memcpy(keyed, key, key_length);
+    memcpy(keyed + key_length, WEBSOCKET_GUID, sizeof(WEBSOCKET_GUID) - 1);
+    unsigned char digest[20];
+    sha1((const unsigned char *)keyed, key_length + sizeof(WEBSOCKET_GUID) - 1, digest);
+    char accept[29];
+    size_t accept_length = 0;
+    mbedtls_base64_encode((unsigned char *)accept, sizeof(accept), &accept_length, digest, sizeof(digest));
+    accept[accept_length] = '\0';
+
+    char port[8] = "";
+    if (parsed.port != (parsed.secure ? 443 : 80)) {
+        snprintf(port, sizeof port, ":%u", parsed.port);
+    }
+    int length = snprintf(_rx, sizeof(_rx),
+                          "GET %s HTTP/1.1\r\nHost: %s%s\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                          "Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n%s%s%s\r\n",
+                          parsed.path, parsed.host, port, key,
+                          protocol ? "Sec-WebSocket-Protocol: " : "", protocol ? protocol : "",
+                          protocol ? "\r\n" : "");
+    if (length < 0 || (size_t)length >= sizeof(_rx)) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+    int result = send_all(_rx, length);
+    if (result == NSAPI_ERROR_OK) {
+        result = handshake_response(accept);
+    }
+    if (result != NSAPI_ERROR_OK) {
+        _transport->close();
+        return result;
+    }
+
+    _state = OPEN;
+    _sending = false;
+    _header_length = 0;
+    _header_needed = 2;
+    _message = -1;
+    _ping_outstanding = false;
+    _last_rx_ms = osKernelGetTickCount();
+    return 0;
+}
+
+//
+// Reads the server's response to the upgrade up to its blank line; frames
+// that came in behind it are left at the start of _rx for receive().
+//
+int WebSocketClient::handshake_response(const char *accept)
+{
+    size_t length = 0;
+    size_t head = 0;
+    while (head == 0) {
+        if (length == sizeof(_rx)) {
+            return WEBSOCKET_ERROR_HANDSHAKE;
+        }
+        nsapi_size_or_error_t received = _transport->recv(_rx + length, sizeof(_rx) - length);
+        if (received == NSAPI_ERROR_WOULD_BLOCK) {
+            Thread::wait(1);
+            continue;
+        }
+        if (received <= 0) {
+            return received < 0 ? received : NSAPI_ERROR_CONNECTION_LOST;
+        }
+        size_t from = length > 3 ? length - 3 : 0;
+        length += received;
+        for (size_t ix = from; ix + 4 <= length; ix++) {
+            if (memcmp(_rx + ix, "\r\n\r\n", 4) == 0) {
+                head = ix + 4;
+                break;
+            }
+        }
+    }
+
+    bool switched = head > 12 && (memcmp(_rx, "HTTP/1.1 101", 12) == 0);
+    bool accepted = false;
+    static const char field[] = "Sec-WebSocket-Accept:";
+    const char *line = static_cast<const char *>(memchr(_rx, '\n', head)) + 1;
+    const char *end = _rx + head;
+    while (switched && !accepted && line < end) {
+        const char *next = static_cast<const char *>(memchr(line, '\n', end - line));
+        next = next ? next + 1 : end;
+        if ((size_t)(next - line) > sizeof(field) - 1 && strncasecmp(line, field, sizeof(field) - 1) == 0) {
+            const char *value = line + sizeof(field) - 1;
+            while (value < next && *value == ' ') {
+                value++;
+            }
+            size_t accept_length = strlen(accept);
+            accepted = (size_t)(next - value) >= accept_length + 2 &&
+                       memcmp(value, accept, accept_length) == 0 &&
+                       (value[accept_length] == '\r' || value[accept_length] == ' ');
+        }
+        line = next;
+    }
+    if (!switched || !accepted) {
+        return WEBSOCKET_ERROR_HANDSHAKE;
+    }
+
+    _rx_pending = length - head;
+    memmove(_rx, _rx + head, _rx_pending);
+    return NSAPI_ERROR_OK;
+}
+
+int WebSocketClient::send_all(const void *data, size_t size)
+{
+    const char *p = static_cast<const char *>(data);
+    while (size > 0) {
+        nsapi_size_or_error_t sent = _transport->send(p, size);
+        if (sent == NSAPI_ERROR_WOULD_BLOCK) {
+            Thread::wait(1);        // let the link drain
+            continue;
+        }
+        if (sent <= 0) {
+            return sent < 0 ? sent : NSAPI_ERROR_CONNECTION_LOST;
+        }
+        p += sent;
+        size -= sent;
+    }
+    return NSAPI_ERROR_OK;
+}
+
+//
+// One frame: the header and as much masked payload as fits go out in one
+// send, the rest of the payload masked through _tx a buffer at a time.
+//
+int WebSocketClient::send_frame(int opcode, const void *data, size_t size, bool fin)
+{
+    _send_mutex.lock();
+    if (_state != OPEN && !(_state == CLOSING && (opcode & 0x8))) {
+        _send_mutex.unlock();
+        return WEBSOCKET_ERROR_CLOSED;
+    }
+
+    uint8_t *tx = reinterpret_cast<uint8_t *>(_tx);
+    size_t length = 0;
+    tx[length++] = (fin ? 0x80 : 0) | opcode;
+    if (size < 126) {
+        tx[length++] = 0x80 | size;
+    } else if (size <= 0xffff) {
+        tx[length++] = 0x80 | 126;
+        tx[length++] = size >> 8;
+        tx[length++] = size;
+    } else {
+        tx[length++] = 0x80 | 127;
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            tx[length++] = shift < 32 ? (uint8_t)(size >> shift) : 0;
+        }
+    }
+    uint32_t key = next_mask();
+    const uint8_t *mask = reinterpret_cast<const uint8_t *>(&key);
+    memcpy(tx + length, mask, 4);
+    length += 4;
+    _stats.frames_sent++;
+    _stats.framing_sent += length;
+    if (!(opcode & 0x8)) {
+        _transport->count_payload(size, 0);
+    }
+
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    size_t offset = 0;
+    int result = NSAPI_ERROR_OK;
+    do {
+        size_t chunk = sizeof(_tx) - length;
+        if (chunk > size - offset) {
+            chunk = size - offset;
+        }
+        for (size_t ix = 0; ix < chunk; ix++) {
+            tx[length + ix] = p[offset + ix] ^ mask[(offset + ix) & 3];
+        }
+        result = send_all(tx, length + chunk);
+        offset += chunk;
+        length = 0;
+    } while (result == NSAPI_ERROR_OK && offset < size);
+    _send_mutex.unlock();
+
+    if (result != NSAPI_ERROR_OK) {
+        shut(CLOSE_ABNORMAL);
+    }
+    return result;
+}
+
+int WebSocketClient::send(const void *data, size_t size, WebSocketOpcode opcode)
+{
+    if (_sending) {
+        return NSAPI_ERROR_PARAMETER;       // a fragmented message is still open
+    }
+    const char *p = static_cast<const char *>(data);
+    int frame_opcode = opcode;
+    do {
+        size_t chunk = size < MBED_CONF_APP_WEBSOCKET_FRAME_SIZE ? size : MBED_CONF_APP_WEBSOCKET_FRAME_SIZE;
+        int result = send_frame(frame_opcode, p, chunk, chunk == size);
+        if (result != NSAPI_ERROR_OK) {
+            return result;
+        }
+        p += chunk;
+        size -= chunk;
+        frame_opcode = WEBSOCKET_CONTINUATION;
+    } while (size > 0);
+    _stats.messages_sent++;
+    return NSAPI_ERROR_OK;
+}
+
+int WebSocketClient::send_fragment(const void *data, size_t size, bool last, WebSocketOpcode opcode)
+{
+    const char *p = static_cast<const char *>(data);
+    int frame_opcode = _sending ? WEBSOCKET_CONTINUATION : opcode;
+    do {
+        size_t chunk = size < MBED_CONF_APP_WEBSOCKET_FRAME_SIZE ? size : MBED_CONF_APP_WEBSOCKET_FRAME_SIZE;
+        int result = send_frame(frame_opcode, p, chunk, last && chunk == size);
+        if (result != NSAPI_ERROR_OK) {
+            _sending = false;
+            return result;
+        }
+        p += chunk;
+        size -= chunk;
+        frame_opcode = WEBSOCKET_CONTINUATION;
+    } while (size > 0);
+    _sending = !last;
+    if (last) {
+        _stats.messages_sent++;
+    }
+    return NSAPI_ERROR_OK;
+}
+
+int WebSocketClient::receive()
+{
+    if (_state != OPEN && _state != CLOSING) {
+        return WEBSOCKET_ERROR_CLOSED;
+    }
+    size_t size = _rx_pending;
+    _rx_pending = 0;
+    if (size == 0) {
+        nsapi_size_or_error_t received = _transport->recv(_rx, sizeof(_rx));
+        if (received == NSAPI_ERROR_WOULD_BLOCK) {
+            return received;
+        }
+        if (received <= 0) {
+            shut(CLOSE_ABNORMAL);
+            return received < 0 ? received : WEBSOCKET_ERROR_CLOSED;
+        }
+        size = received;
+    }
+    _last_rx_ms = osKernelGetTickCount();
+    return parse(_rx, size);
+}
+
+//
+// Walks the frames in data: headers are gathered into _header (they can
+// straddle reads), payload goes to the handler straight from data, and
+// control frame payload, at most 125 bytes, is gathered into _control.
+//
+int WebSocketClient::parse(const char *data, size_t size)
+{
+    int messages = 0;
+    while (size > 0 && (_state == OPEN || _state == CLOSING)) {
+        if (_header_length < _header_needed) {
+            int result = frame_header(&data, &size);
+            if (result <= 0) {
+                if (result < 0) {
+                    shut(CLOSE_ABNORMAL);
+                    return result;
+                }
+                break;
+            }
+            if (_remaining > 0) {
+                continue;
+            }
+        } else {
+            size_t chunk = size < _remaining ? size : _remaining;
+            _remaining -= chunk;
+            if (_opcode & 0x8) {
+                memcpy(_control + _control_length, data, chunk);
+                _control_length += chunk;
+            } else {
+                _transport->count_payload(0, chunk);
+                int result = _handler->message((WebSocketOpcode)_message, data, chunk, _message_first,
+                                               _fin && _remaining == 0);
+                _message_first = false;
+                if (result < 0) {
+                    shut(CLOSE_ABNORMAL);
+                    return result;
+                }
+            }
+            data += chunk;
+            size -= chunk;
+            if (_remaining > 0) {
+                continue;
+            }
+        }
+        int result = frame_end();
+        if (result < 0) {
+            return result;
+        }
+        messages += result;
+    }
+    return messages;
+}
+
+// Returns 1 once a header is complete, 0 when data ran out first.
+int WebSocketClient::frame_header(const char **data, size_t *size)
+{
+    while (_header_length < _header_needed && *size > 0) {
+        _header[_header_length++] = **data;
+        (*data)++;
+        (*size)--;
+        if (_header_length == 2) {
+            if (_header[1] & 0x80) {
+                return WEBSOCKET_ERROR_PROTOCOL;        // servers must not mask
+            }
+            uint8_t length = _header[1] & 0x7f;
+            _header_needed = 2 + (length == 126 ? 2 : length == 127 ? 8 : 0);
+        }
+    }
+    if (_header_length < _header_needed) {
+        return 0;
+    }
+
+    _fin = (_header[0] & 0x80) != 0;
+    _opcode = _header[0] & 0x0f;
+    if (_header[0] & 0x70) {
+        return WEBSOCKET_ERROR_PROTOCOL;                // no extensions were negotiated
+    }
+    uint32_t length = _header[1] & 0x7f;
+    if (length == 126) {
+        length = (_header[2] << 8) | _header[3];
+    } else if (length == 127) {
+        if (_header[2] | _header[3] | _header[4] | _header[5]) {
+            return WEBSOCKET_ERROR_PROTOCOL;            // 4 GB or more
+        }
+        length = ((uint32_t)_header[6] << 24) | ((uint32_t)_header[7] << 16) | (_header[8] << 8) | _header[9];
+    }
+    _remaining = length;
+    _stats.frames_received++;
+    _stats.framing_received += _header_length;
+
+    if (_opcode & 0x8) {
+        if (!_fin || length > sizeof(_control) ||
+                (_opcode != WEBSOCKET_CLOSE && _opcode != WEBSOCKET_PING && _opcode != WEBSOCKET_PONG)) {
+            return WEBSOCKET_ERROR_PROTOCOL;
+        }
+        _control_length = 0;
+    } else if (_opcode == WEBSOCKET_CONTINUATION) {
+        if (_message < 0) {
+            return WEBSOCKET_ERROR_PROTOCOL;
+        }
+    } else if (_opcode == WEBSOCKET_TEXT || _opcode == WEBSOCKET_BINARY) {
+        if (_message >= 0) {
+            return WEBSOCKET_ERROR_PROTOCOL;            // the last message is not finished
+        }
+        _message = _opcode;
+        _message_first = true;
+    } else {
+        return WEBSOCKET_ERROR_PROTOCOL;
+    }
+    return 1;
+}
+
+// The current frame's payload is all in; returns the messages it completed.
+int WebSocketClient::frame_end()
+{
+    _header_length = 0;
+    _header_needed = 2;
+    if (_opcode & 0x8) {
+        return control_frame();
+    }
+    if (!_fin) {
+        return 0;
+    }
+    if (_message_first) {
+        // An empty final frame, and nothing delivered yet: the message is empty.
+        int result = _handler->message((WebSocketOpcode)_message, _rx, 0, true, true);
+        if (result < 0) {
+            shut(CLOSE_ABNORMAL);
+            return result;
+        }
+    } else if (_remaining == 0 && _header[1] == 0) {
+        // An empty final continuation: its message still needs its end.
+        int result = _handler->message((WebSocketOpcode)_message, _rx, 0, false, true);
+        if (result < 0) {
+            shut(CLOSE_ABNORMAL);
+            return result;
+        }
+    }
+    _message = -1;
+    _stats.messages_received++;
+    return 1;
+}
+
+int WebSocketClient::control_frame()
+{
+    if (_opcode == WEBSOCKET_PING) {
+        _stats.pongs++;
+        int result = send_frame(WEBSOCKET_PONG, _control, _control_length, true);
+        return result < 0 ? result : 0;
+    }
+    if (_opcode == WEBSOCKET_PONG) {
+        if (_ping_outstanding && _control_length == sizeof(_ping_us) &&
+                memcmp(_control, &_ping_us, sizeof(_ping_us)) == 0) {
+            _stats.ping_rtt_us = us_ticker_read() - _ping_us;
+            _ping_outstanding = false;
+        }
+        return 0;
+    }
+
+    // Close: answer with the same code unless this answers ours.
+    uint16_t code = CLOSE_NO_CODE;
+    if (_control_length >= 2) {
+        code = ((uint8_t)_control[0] << 8) | (uint8_t)_control[1];
+    }
+    if (_state == OPEN) {
+        _state = CLOSING;
+        send_frame(WEBSOCKET_CLOSE, _control, _control_length >= 2 ? 2 : 0, true);
+    }
+    shut(code);
+    return 0;
+}
+
+int WebSocketClient::ping()
+{
+    _ping_us = us_ticker_read();
+    _ping_sent_ms = osKernelGetTickCount();
+    _ping_outstanding = true;       // before sending: the pong may be read on another thread
+    _stats.pings++;
+    int result = send_frame(WEBSOCKET_PING, &_ping_us, sizeof(_ping_us), true);
+    if (result != NSAPI_ERROR_OK) {
+        _ping_outstanding = false;
+    }
+    return result;
+}
+
+int WebSocketClient::keepalive()
+{
+    if (_state != OPEN) {
+        return WEBSOCKET_ERROR_CLOSED;
+    }
+    _transport->traffic_flush();
+    uint32_t now = osKernelGetTickCount();
+    if (_ping_outstanding) {
+        if (now - _ping_sent_ms >= MBED_CONF_APP_WEBSOCKET_PONG_TIMEOUT_MS) {
+            shut(CLOSE_ABNORMAL);
+            return WEBSOCKET_ERROR_TIMEOUT;
+        }
+        return 0;
+    }
+    if (MBED_CONF_APP_WEBSOCKET_PING_MS > 0 && now - _last_rx_ms >= MBED_CONF_APP_WEBSOCKET_PING_MS) {
+        return ping();
+    }
+    return 0;
+}
+
+int WebSocketClient::close(uint16_t code)
+{
+    if (_state != OPEN) {
+        return _state == CLOSED || _state == IDLE ? 0 : WEBSOCKET_ERROR_CLOSED;
+    }
+    _state = CLOSING;
+    char payload[2] = { (char)(code >> 8), (char)code };
+    int result = send_frame(WEBSOCKET_CLOSE, payload, sizeof(payload), true);
+    while (result == NSAPI_ERROR_OK && _state == CLOSING) {
+        int received = receive();
+        if (received == NSAPI_ERROR_WOULD_BLOCK) {
+            Thread::wait(1);
+        } else if (received < 0) {
+            break;
+        }
+    }
+    if (_state != CLOSED) {
+        shut(CLOSE_ABNORMAL);
+    }
+    return result;
+}
+
+// Drops the connection; the handler hears of it once.
+void WebSocketClient::shut(uint16_t code)
+{
+    if (_state == CLOSED) {
+        return;
+    }
+    _state = CLOSED;
+    _sending = false;
+    _message = -1;
+    _rx_pending = 0;
+    _header_length = 0;
+    _header_needed = 2;
+    _transport->close();
+    _handler->closed(code);
+}
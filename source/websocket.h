@@ -0,0 +1,185 @@
+#ifndef _WEBSOCKET_H_
+#define _WEBSOCKET_H_
+
+#include "mbed.h"
+#include "http-transport.h"
+
+#ifndef MBED_CONF_APP_WEBSOCKET_BUFFER_SIZE
+#define MBED_CONF_APP_WEBSOCKET_BUFFER_SIZE     1024    // receive buffer, which also takes the handshake response
+#endif
+
+#ifndef MBED_CONF_APP_WEBSOCKET_FRAME_SIZE
+#define MBED_CONF_APP_WEBSOCKET_FRAME_SIZE      1024    // payload per outgoing frame; longer messages are fragmented
+#endif
+
+#ifndef MBED_CONF_APP_WEBSOCKET_PING_MS
+#define MBED_CONF_APP_WEBSOCKET_PING_MS         30000   // quiet time before keepalive() pings; 0 never pings
+#endif
+
+#ifndef MBED_CONF_APP_WEBSOCKET_PONG_TIMEOUT_MS
+#define MBED_CONF_APP_WEBSOCKET_PONG_TIMEOUT_MS 10000   // a ping without a pong after this ends the connection
+#endif
+
+#define WEBSOCKET_TX_BUFFER_SIZE        256     // masked payload is staged through this much, with the header
+
+#define WEBSOCKET_ERROR_HANDSHAKE       -3801   // the server did not switch to the WebSocket protocol
+#define WEBSOCKET_ERROR_PROTOCOL        -3802   // a frame the RFC does not allow
+#define WEBSOCKET_ERROR_CLOSED          -3803   // the connection is closed
+#define WEBSOCKET_ERROR_TIMEOUT         -3804   // no pong to a keepalive ping
+
+enum WebSocketOpcode {
+    WEBSOCKET_CONTINUATION  = 0x0,
+    WEBSOCKET_TEXT          = 0x1,
+    WEBSOCKET_BINARY        = 0x2,
+    WEBSOCKET_CLOSE         = 0x8,
+    WEBSOCKET_PING          = 0x9,
+    WEBSOCKET_PONG          = 0xa
+};
+
+//
+// Receives the messages of a WebSocketClient as they arrive.  A message
+// comes in pieces, however its frames and the reads that carried them fell:
+// first is set on its first piece and last on its final one, and opcode
+// (WEBSOCKET_TEXT or WEBSOCKET_BINARY) is the message's on every piece.
+// data points into the client's receive buffer and is only valid during the
+// call.  A negative return closes the connection and becomes receive()'s
+// error.
+//
+class WebSocketHandler {
+public:
+    virtual ~WebSocketHandler() {}
+
+    virtual int message(WebSocketOpcode opcode, const char *data, size_t size, bool first, bool last) = 0;
+    // The connection closed: with the code of the server's close frame (1005
+    // when it gave none), or 1006 when it was lost without one.
+    virtual void closed(uint16_t code) { (void)code; }
+};
+
+//
+// RFC 6455 client over an HttpTransport: a persistent channel on which each
+// message costs 6 to 8 bytes of framing going out (the client masks) and 2
+// to 4 coming back, instead of a request's line and headers.
+//
+// connect() upgrades the transport, connecting it first if need be, so a
+// connection that has just carried HTTP requests can be taken over.  From
+// then on the client owns the transport until close().
+//
+// Incoming frames are parsed in place in the receive buffer and their
+// payload handed to the handler from there, so no message is ever copied or
+// reassembled, whatever its size.  Pings are answered as they arrive.
+// Outgoing messages longer than MBED_CONF_APP_WEBSOCKET_FRAME_SIZE go out as
+// fragments, and a message of unknown length can be sent piece by piece
+// with send_fragment(); pongs can go out between fragments.  Payload is
+// masked through a small buffer on its way out, leaving the caller's data
+// untouched.
+//
+// receive() reads once from the transport and dispatches what came in; it
+// blocks as the transport does.  keepalive(), called regularly (from the
+// same thread or another), pings after MBED_CONF_APP_WEBSOCKET_PING_MS
+// without traffic from the server and times the round trip.  Messages are
+// sent from one thread at a time.  Destroying an open client drops the
+// connection without the closing handshake.
+//
+//   WebSocketClient ws(&transport, &handler);
+//   if (ws.connect("ws://echo.websocket.org/") == 0) {
+//       ws.send(reading, sizeof(reading));
+//       ws.receive();
+//       ws.close();
+//   }
+//
+class WebSocketClient {
+public:
+    struct Stats {
+        uint32_t messages_sent;
+        uint32_t messages_received;
+        uint32_t frames_sent;
+        uint32_t frames_received;
+        uint32_t framing_sent;          // header bytes of the frames sent
+        uint32_t framing_received;
+        uint32_t pings;                 // sent by keepalive()
+        uint32_t pongs;                 // sent in answer to the server's pings
+        uint32_t ping_rtt_us;           // of the last ping answered
+    };
+
+    WebSocketClient(HttpTransport *transport, WebSocketHandler *handler);
+    ~WebSocketClient();
+
+    // Runs the opening handshake for url (ws:// or wss://, naming the
+    // transport's server).  protocol, if given, is offered as
+    // Sec-WebSocket-Protocol.  Returns 0, a WEBSOCKET_ERROR_* or the
+    // transport's error.
+    int connect(const char *url, const char *protocol = NULL);
+
+    // Sends a whole message.
+    int send(const void *data, size_t size, WebSocketOpcode opcode = WEBSOCKET_BINARY);
+    int send_text(const char *text) { return send(text, strlen(text), WEBSOCKET_TEXT); }
+
+    // Sends the next piece of a message; last ends it.  opcode only counts
+    // on the first piece.
+    int send_fragment(const void *data, size_t size, bool last, WebSocketOpcode opcode = WEBSOCKET_BINARY);
+
+    // Reads what the transport has and hands it to the handler.  Returns the
+    // messages completed, or an error; WEBSOCKET_ERROR_CLOSED once the
+    // connection is closed.
+    int receive();
+
+    // Pings when the server has been quiet for MBED_CONF_APP_WEBSOCKET_PING_MS;
+    // WEBSOCKET_ERROR_TIMEOUT (and the transport closed) when the last ping
+    // went unanswered for MBED_CONF_APP_WEBSOCKET_PONG_TIMEOUT_MS.  Also
+    // hands the transport's traffic so far to the TrafficMeter, which would
+    // otherwise only hear of it on close().
+    int keepalive();
+    int ping();
+
+    // Starts the closing handshake with code and reads until the server
+    // answers or hangs up, still delivering messages; then closes the
+    // transport.
+    int close(uint16_t code = 1000);
+
+    bool is_open() const { return _state == OPEN; }
+    const Stats &stats() const { return _stats; }
+
+private:
+    enum State { IDLE, OPEN, CLOSING, CLOSED };
+
+    int handshake_response(const char *accept);
+    int send_frame(int opcode, const void *data, size_t size, bool fin);
+    int send_all(const void *data, size_t size);
+    int parse(const char *data, size_t size);
+    int frame_header(const char **data, size_t *size);
+    int frame_end();
+    int control_frame();
+    void shut(uint16_t code);
+    uint32_t next_mask();
+
+    HttpTransport *_transport;
+    WebSocketHandler *_handler;
+    State _state;
+    Mutex _send_mutex;              // a pong can go out while the caller sends
+    bool _sending;                  // inside a fragmented message
+    char _tx[WEBSOCKET_TX_BUFFER_SIZE];
+
+    char _rx[MBED_CONF_APP_WEBSOCKET_BUFFER_SIZE];
+    size_t _rx_pending;             // bytes after the handshake response, not yet parsed
+
+    // The frame being received.
+    uint8_t _header[14];
+    size_t _header_length;
+    size_t _header_needed;
+    int _opcode;
+    bool _fin;
+    uint32_t _remaining;            // payload bytes still to come
+    int _message;                   // opcode of the message in progress, or -1
+    bool _message_first;            // no piece of it delivered yet
+    char _control[125];
+    size_t _control_length;
+
+    uint32_t _mask_state;           // xorshift32 for masking keys
+    uint32_t _last_rx_ms;           // osKernelGetTickCount() of the last read
+    bool _ping_outstanding;
+    uint32_t _ping_sent_ms;
+    uint32_t _ping_us;              // us_ticker_read() in the ping's payload
+    Stats _stats;
+};
+
+#endif // _WEBSOCKET_H_
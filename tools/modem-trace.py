@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+#
+# Decodes a modem trace (source/modem-trace.h) and shows which modem round
+# trips the time went into.  Takes either the raw binary export or a console
+# log holding the "modem-trace: <hex>" lines main.cpp prints at the end:
+#
+#   python3 tools/modem-trace.py console.log
+#   python3 tools/modem-trace.py console.log --csv > trace.csv
+#
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"MTRC"
+VERSION = 1
+RECORD = struct.Struct("<IIHhBBH")
+HEX_PREFIX = "modem-trace: "
+
+COMMANDS = ["none", "connect", "disconnect", "dnsresvdoname", "sockcreat", "sockconn",
+            "sockwrite", "sockread", "sockclose"]
+WOULD_BLOCK = -3001
+
+
+def read_export(path):
+    data = open(path, "rb").read()
+    if data.startswith(MAGIC):
+        return data
+    hexed = []
+    for line in data.decode("latin-1").splitlines():
+        at = line.find(HEX_PREFIX)
+        if at >= 0:
+            hexed.append(line[at + len(HEX_PREFIX):].strip())
+    if not hexed:
+        raise SystemExit("%s: no modem trace found" % path)
+    return bytes.fromhex("".join(hexed))
+
+
+def decode(data):
+    if data[:4] != MAGIC:
+        raise SystemExit("not a modem trace")
+    version, size, count = struct.unpack_from("<BBH", data, 4)
+    if version != VERSION or size != RECORD.size:
+        raise SystemExit("modem trace version %d, record size %d: not supported" % (version, size))
+    if len(data) < 8 + count * size:
+        raise SystemExit("modem trace cut short: %d of %d records" % ((len(data) - 8) // size, count))
+    records = []
+    for ix in range(count):
+        start, latency, nbytes, result, command, socket, seq = RECORD.unpack_from(data, 8 + ix * size)
+        name = COMMANDS[command] if command < len(COMMANDS) else "unknown"
+        records.append((seq, start, name, socket, result, latency, nbytes))
+    return records
+
+
+def percentile(sorted_values, p):
+    rank = max(1, (len(sorted_values) * p + 99) // 100)
+    return sorted_values[rank - 1]
+
+
+def summarize(records, out):
+    by_command = {}
+    for seq, start, name, socket, result, latency, nbytes in records:
+        by_command.setdefault(name, []).append((latency, nbytes, result))
+    total = sum(r[5] for r in records) or 1
+    if records:
+        span = (records[-1][1] + records[-1][5] - records[0][1]) & 0xFFFFFFFF
+        out.write("%d round trips over %.3f s, %.3f s of it waiting on the modem\n\n"
+                  % (len(records), span / 1e6, total / 1e6))
+    out.write("%-14s %6s %6s %6s %10s %6s %8s %8s %8s %9s\n"
+              % ("command", "count", "errors", "wblock", "total_ms", "share",
+                 "p50_us", "p90_us", "max_us", "bytes"))
+    rows = []
+    for name, samples in by_command.items():
+        latencies = sorted(s[0] for s in samples)
+        rows.append((sum(latencies), name, samples, latencies))
+    for spent, name, samples, latencies in sorted(rows, reverse=True):
+        errors = sum(1 for s in samples if s[2] not in (0, WOULD_BLOCK))
+        would_block = sum(1 for s in samples if s[2] == WOULD_BLOCK)
+        out.write("%-14s %6d %6d %6d %10.1f %5.1f%% %8d %8d %8d %9d\n"
+                  % (name, len(samples), errors, would_block, spent / 1e3, 100.0 * spent / total,
+                     percentile(latencies, 50), percentile(latencies, 90), latencies[-1],
+                     sum(s[1] for s in samples)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a WNC14A2A modem trace.")
+    parser.add_argument("trace", help="binary export or console log with modem-trace lines")
+    parser.add_argument("--csv", action="store_true", help="print every round trip as CSV instead")
+    args = parser.parse_args()
+
+    records = decode(read_export(args.trace))
+    if args.csv:
+        sys.stdout.write("seq,start_us,command,socket,result,latency_us,bytes\n")
+        for record in records:
+            sys.stdout.write("%d,%d,%s,%d,%d,%d,%d\n" % record)
+    else:
+        summarize(records, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
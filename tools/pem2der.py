@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+#
+# Converts the PEM root certificates in certs/ into DER byte arrays compiled
+# into flash (source/ca-roots.cpp), so the firmware never carries or decodes
+# PEM text.  Re-run after adding or removing a root:
+#
+#   python3 tools/pem2der.py certs/*.pem -o source/ca-roots.cpp
+#
+
+import argparse
+import base64
+import os
+import re
+
+PEM_RE = re.compile(r"-----BEGIN CERTIFICATE-----(.*?)-----END CERTIFICATE-----", re.S)
+
+
+def read_roots(path):
+    text = open(path).read()
+    blocks = PEM_RE.findall(text)
+    if not blocks:
+        raise SystemExit("%s: no certificate found" % path)
+    name = os.path.splitext(os.path.basename(path))[0]
+    for ix, block in enumerate(blocks):
+        suffix = "" if len(blocks) == 1 else "_%d" % ix
+        yield name + suffix, base64.b64decode("".join(block.split()))
+
+
+def c_identifier(name):
+    return "ca_" + re.sub(r"[^0-9A-Za-z]", "_", name)
+
+
+def render(roots, sources):
+    out = []
+    out.append("//")
+    out.append("// Generated by tools/pem2der.py from %s -- do not edit." % ", ".join(sources))
+    out.append("//")
+    out.append("// Trusted root certificates in DER form.  Being const they stay in flash;")
+    out.append("// trust-store.cpp parses them once into the chain shared by every TLS")
+    out.append("// connection.")
+    out.append("//")
+    out.append("")
+    out.append('#include "trust-store.h"')
+    out.append("")
+    for name, der in roots:
+        out.append("// %s, %d bytes" % (name, len(der)))
+        out.append("static const unsigned char %s[] = {" % c_identifier(name))
+        for ix in range(0, len(der), 16):
+            out.append("    " + " ".join("0x%02x," % b for b in der[ix:ix + 16]))
+        out.append("};")
+        out.append("")
+    out.append("const TrustAnchor TRUST_ANCHORS[] = {")
+    for name, der in roots:
+        out.append('    { "%s", %s, sizeof(%s) },' % (name, c_identifier(name), c_identifier(name)))
+    out.append("};")
+    out.append("")
+    out.append("const size_t TRUST_ANCHOR_COUNT = sizeof(TRUST_ANCHORS) / sizeof(TRUST_ANCHORS[0]);")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="PEM root certificates to a DER C array")
+    parser.add_argument("pem", nargs="+")
+    parser.add_argument("-o", "--output", required=True)
+    opts = parser.parse_args()
+
+    roots = []
+    for path in opts.pem:
+        roots.extend(read_roots(path))
+    with open(opts.output, "w") as f:
+        f.write(render(roots, [os.path.basename(p) for p in opts.pem]))
+
+
+if __name__ == "__main__":
+    main()